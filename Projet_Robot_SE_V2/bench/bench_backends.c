@@ -0,0 +1,222 @@
+/**
+ * @file  bench_backends.c
+ *
+ * @brief Syscalls per command and command round trip latency of the commando with the epoll and the io_uring backends.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/*
+ * The real Server runs in a thread of the bench, over the simulated robots of
+ * sim_prose.c, once per backend. Each telco thread subscribes to the
+ * telemetry of its robot, then repeats a burst of velocity commands followed
+ * by an askLog and waits for the answer:
+ *  - syscalls per command = system calls of the network thread / frames received;
+ *  - latency = time between the sending of the askLog and its answer, which
+ *    crosses the network thread, the worker and the network thread again.
+ * It fails when an askLog is not answered or no telemetry is pushed.
+ *
+ * usage : bench_backends [nb_telcos] [nb_rounds] [burst]
+ * The logs of the server go to /dev/null, the results to stdout.
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "bench_common.h"
+#include "commando/server.h"
+#include "commun/frame.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/socket.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+#define NB_TELCOS (4)
+#define NB_ROUNDS (2000)
+#define BURST (8)
+#define TELEMETRY_PERIOD_MS (10)
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+typedef struct
+{
+	int robot;
+	int nb_rounds;
+	int burst;
+	double* latencies; //nb_rounds round trips, in us.
+}Telco;
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+static void* Bench_telco(void* pArg);
+static int Bench_run(ServerBackend backend, int nb_telcos, int nb_rounds, int burst);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+int main(int argc, char *argv[])
+{
+	int nb_telcos = (argc > 1)? atoi(argv[1]) : NB_TELCOS;
+	int nb_rounds = (argc > 2)? atoi(argv[2]) : NB_ROUNDS;
+	int burst = (argc > 3)? atoi(argv[3]) : BURST;
+	int nb_errors = 0;
+
+	printf("%d telcos, %d rounds of %d velocity commands + 1 askLog, telemetry every %d ms\n",
+			nb_telcos, nb_rounds, burst, TELEMETRY_PERIOD_MS);
+	nb_errors += Bench_run(SERVER_BACKEND_EPOLL, nb_telcos, nb_rounds, burst);
+	nb_errors += Bench_run(SERVER_BACKEND_URING, nb_telcos, nb_rounds, burst);
+	return (nb_errors == 0)? 0 : 1;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static int Bench_run(ServerBackend backend, int nb_telcos, int nb_rounds, int burst)
+{
+	Server* pServer = Server_new(nb_telcos, 1, NULL);
+	Telco* telcos = (Telco*) calloc(nb_telcos, sizeof(Telco));
+	pthread_t* threads = (pthread_t*) malloc(nb_telcos * sizeof(pthread_t));
+	double* latencies = (double*) malloc(nb_telcos * nb_rounds * sizeof(double));
+	pthread_t server;
+	int nb = 0;
+	int stdout_fd;
+	int null_fd;
+
+	//The server prints its start, its connections and its statistics, they would mix with the results.
+	fflush(stdout);
+	stdout_fd = dup(STDOUT_FILENO);
+	null_fd = open("/dev/null", O_WRONLY);
+	dup2(null_fd, STDOUT_FILENO);
+
+	Server_setBackend(pServer, backend);
+	pthread_create(&server, NULL, Bench_serve, pServer);
+	for(int i = 0; i < nb_telcos; i++)
+	{
+		telcos[i].robot = i;
+		telcos[i].nb_rounds = nb_rounds;
+		telcos[i].burst = burst;
+		telcos[i].latencies = latencies + i * nb_rounds;
+		pthread_create(&threads[i], NULL, Bench_telco, &telcos[i]);
+	}
+	for(int i = 0; i < nb_telcos; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+	//The server returns once every robot is stopped.
+	Bench_stopRobots(nb_telcos);
+	pthread_join(server, NULL);
+	ServerStats stats = Server_getStats(pServer);
+	backend = pServer->backend; //epoll if io_uring is not supported.
+	Server_free(pServer);
+
+	fflush(stdout);
+	dup2(stdout_fd, STDOUT_FILENO);
+	close(stdout_fd);
+	close(null_fd);
+
+	for(int i = 0; i < nb_telcos * nb_rounds; i++)
+	{
+		if(latencies[i] > 0)
+		{
+			latencies[nb++] = latencies[i];
+		}
+	}
+	qsort(latencies, nb, sizeof(double), Bench_compare);
+	printf("%-8s : %5.3f syscalls per command (%lu for %lu frames)", (backend == SERVER_BACKEND_URING)? "io_uring" : "epoll",
+			(double) stats.nb_syscalls / stats.nb_frames, stats.nb_syscalls, stats.nb_frames);
+	if(nb > 0)
+	{
+		printf("  round trip p50 %7.1f us  p99 %7.1f us  max %7.1f us", latencies[nb / 2], latencies[(nb * 99) / 100], latencies[nb - 1]);
+	}
+	printf("  %lu telemetry\n", stats.nb_telemetry);
+	free(latencies);
+	free(threads);
+	free(telcos);
+	if(nb < nb_telcos * nb_rounds || stats.nb_telemetry == 0)
+	{
+		printf("ERROR : %d of the %d askLogs answered, %lu telemetry\n", nb, nb_telcos * nb_rounds, stats.nb_telemetry);
+		return 1;
+	}
+	return 0;
+}
+
+static void* Bench_telco(void* pArg)
+{
+	Telco* pTelco = (Telco*) pArg;
+	Decoder* pDecoder = (Decoder*) malloc(sizeof(Decoder));
+	uint8_t buffer[FRAME_MAX_SIZE];
+	uint8_t* burst = (uint8_t*) malloc((pTelco->burst + 1) * FRAME_MAX_SIZE);
+	int un_socket = Bench_connect();
+	DesDonnees donnees = {FORWARD, 0, 0, 0, 0, 0, pTelco->robot};
+	struct iovec iov[2];
+	size_t size;
+	Frame frame;
+
+	Decoder_init(pDecoder);
+	if(un_socket == -1)
+	{
+		//Its askLogs are counted unanswered.
+		free(burst);
+		free(pDecoder);
+		return NULL;
+	}
+	size = Frame_encodeSubscribe(buffer, pTelco->robot, TELEMETRY_PERIOD_MS, 0, 0);
+	send(un_socket, buffer, size, MSG_NOSIGNAL);
+	for(int round = 0; round < pTelco->nb_rounds; round++)
+	{
+		bool_e answered = FALSE;
+		double sent;
+		size = 0;
+		for(int i = 0; i < pTelco->burst; i++)
+		{
+			donnees.power = (round + i) % 100;
+			size += Frame_encodeDonnees(burst + size, &donnees);
+		}
+		donnees.askLog = 1;
+		size += Frame_encodeDonnees(burst + size, &donnees);
+		donnees.askLog = 0;
+		sent = Bench_now();
+		send(un_socket, burst, size, MSG_NOSIGNAL);
+		while(answered == FALSE)
+		{
+			int nb_iov = Decoder_getSpace(pDecoder, iov);
+			ssize_t received = readv(un_socket, iov, nb_iov);
+			if(received <= 0)
+			{
+				free(burst);
+				free(pDecoder);
+				close(un_socket);
+				return NULL;
+			}
+			Decoder_commit(pDecoder, received);
+			while(Decoder_next(pDecoder, &frame) == DECODER_FRAME)
+			{
+				//The telemetry pushed meanwhile is skipped.
+				if(frame.type == FRAME_DONNEES)
+				{
+					pTelco->latencies[round] = (Bench_now() - sent) * 1e6;
+					answered = TRUE;
+				}
+			}
+		}
+	}
+	free(burst);
+	free(pDecoder);
+	close(un_socket);
+	return NULL;
+}
@@ -0,0 +1,326 @@
+/**
+ * @file  bench_codec.c
+ *
+ * @brief Checks of the frame codec on valid and invalid input, then its throughput
+ *        (encoding, then decoding a stream cut in random chunks).
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "bench_common.h"
+#include "commun/frame.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+#define NB_FRAMES (1000000)
+#define MAX_CHUNK (1500)
+/**
+ * \brief Frames pushed through one Decoder by the wrapping check, the ring is filled several times.
+ */
+#define NB_WRAPPING (200)
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+static int nb_mismatches = 0;
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static void Bench_expect(bool_e condition, const char* what)
+ * \brief Count and print a check which failed.
+ */
+static void Bench_expect(bool_e condition, const char* what);
+/**
+ * \fn static DecoderStatus Bench_decode(Decoder* pDecoder, const uint8_t* bytes, size_t size, Frame* pFrame)
+ * \brief Feed bytes to an empty decoder and extract the first frame.
+ */
+static DecoderStatus Bench_decode(Decoder* pDecoder, const uint8_t* bytes, size_t size, Frame* pFrame);
+/**
+ * \fn static bool_e Bench_isSameDonnees(const DesDonnees* pDecoded, const DesDonnees* pDonnees)
+ * \brief Whether every field of a DesDonnees has been carried.
+ */
+static bool_e Bench_isSameDonnees(const DesDonnees* pDecoded, const DesDonnees* pDonnees);
+/**
+ * \fn static void Bench_checkDonnees(Decoder* pDecoder)
+ * \brief Round trips of DesDonnees and the frames Frame_decodeDonnees must refuse.
+ */
+static void Bench_checkDonnees(Decoder* pDecoder);
+/**
+ * \fn static void Bench_checkDecoder(Decoder* pDecoder)
+ * \brief Frames truncated, oversized, of another version or wrapping around the end of the ring.
+ */
+static void Bench_checkDecoder(Decoder* pDecoder);
+/**
+ * \fn static void Bench_checkTelemetryDelta(Decoder* pDecoder)
+ * \brief Round trip of a delta telemetry stream and the frames Frame_decodeTelemetryDelta must refuse.
+ */
+static void Bench_checkTelemetryDelta(Decoder* pDecoder);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+int main(int argc, char *argv[])
+{
+	long nb_frames = (argc > 1)? atol(argv[1]) : NB_FRAMES;
+	uint8_t* stream = (uint8_t*) malloc(nb_frames * FRAME_MAX_SIZE);
+	Decoder* pDecoder = (Decoder*) malloc(sizeof(Decoder));
+	if(stream == NULL || pDecoder == NULL)
+	{
+		printf("ERROR : not enough memory\n");
+		return 1;
+	}
+
+	Bench_checkDonnees(pDecoder);
+	Bench_checkDecoder(pDecoder);
+	Bench_checkTelemetryDelta(pDecoder);
+
+	//Encoding.
+	DesDonnees donnees = {FORWARD, 100, 0.5f, 0, 0, 0, 0};
+	size_t size = 0;
+	long expected = 0;
+	double start = Bench_now();
+	for(long i = 0; i < nb_frames; i++)
+	{
+		donnees.power = (int) (i % 101);
+		size += Frame_encodeDonnees(stream + size, &donnees);
+	}
+	for(long i = 0; i < nb_frames; i++)
+	{
+		expected += i % 101;
+	}
+	double encode = Bench_now() - start;
+
+	//Decoding, the stream is fed in random chunks as a socket would do.
+	Frame frame;
+	DesDonnees decoded;
+	long nb_decoded = 0;
+	long checksum = 0;
+	size_t offset = 0;
+	srand(42);
+	Decoder_init(pDecoder);
+	start = Bench_now();
+	while(offset < size)
+	{
+		size_t chunk = 1 + rand() % MAX_CHUNK;
+		if(chunk > size - offset)
+		{
+			chunk = size - offset;
+		}
+		offset += Decoder_feed(pDecoder, stream + offset, chunk);
+		while(Decoder_next(pDecoder, &frame) == DECODER_FRAME)
+		{
+			Frame_decodeDonnees(&frame, &decoded);
+			checksum += decoded.power;
+			nb_decoded++;
+		}
+	}
+	double decode = Bench_now() - start;
+	Bench_expect(nb_decoded == nb_frames, "every frame of the stream decoded");
+	Bench_expect(checksum == expected, "checksum of the powers of the stream");
+
+	printf("frames        : %ld (%zu bytes on the wire, %d per frame)\n", nb_decoded, size, FRAME_HEADER_SIZE + FRAME_DONNEES_SIZE);
+	printf("encode        : %.1f Mframes/s, %.1f MB/s\n", nb_frames / encode / 1e6, size / encode / 1e6);
+	printf("decode        : %.1f Mframes/s, %.1f MB/s\n", nb_decoded / decode / 1e6, size / decode / 1e6);
+	printf("checksum      : %ld\n", checksum);
+	printf("checks        : %d mismatch(es)\n", nb_mismatches);
+	free(pDecoder);
+	free(stream);
+	return (nb_mismatches == 0)? 0 : 1;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static void Bench_expect(bool_e condition, const char* what)
+{
+	if(condition == FALSE)
+	{
+		printf("MISMATCH : %s\n", what);
+		nb_mismatches++;
+	}
+}
+
+static DecoderStatus Bench_decode(Decoder* pDecoder, const uint8_t* bytes, size_t size, Frame* pFrame)
+{
+	Decoder_init(pDecoder);
+	Decoder_feed(pDecoder, bytes, size);
+	return Decoder_next(pDecoder, pFrame);
+}
+
+static bool_e Bench_isSameDonnees(const DesDonnees* pDecoded, const DesDonnees* pDonnees)
+{
+	return pDecoded->direction == pDonnees->direction && pDecoded->power == pDonnees->power
+			&& pDecoded->luminosity == pDonnees->luminosity && pDecoded->bump == pDonnees->bump
+			&& pDecoded->askLog == pDonnees->askLog && pDecoded->stop == pDonnees->stop
+			&& pDecoded->robot == pDonnees->robot && pDecoded->request == pDonnees->request
+			&& pDecoded->captured == pDonnees->captured && pDecoded->sent == pDonnees->sent
+			&& pDecoded->sampled == pDonnees->sampled && pDecoded->angular == pDonnees->angular;
+}
+
+static void Bench_checkDonnees(Decoder* pDecoder)
+{
+	const DesDonnees cases[] =
+	{
+		{FORWARD, 100, 0.5f, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+		{BACKWARD, -40, 0.25f, 1, 1, 0, 3, 77, 0, 0, 0, 0},
+		{STOP, 0, 0.0f, 0, 0, 1, 0xFFFF, 0xFFFFFFFFu, 0, 0, 0, 0},
+		{TWIST, 60, 0.75f, 0, 0, 0, 2, 5, 0, 0, 0, -37},
+		{LEFT, 30, 0.1f, 0, 1, 0, 1, 9, 123456789ULL, 123456999ULL, 0, 0},
+		{RIGHT, 30, 0.1f, 1, 1, 0, 1, 10, 1, 2, 987654321987ULL, 0},
+		{TWIST, -100, 1.0f, 0, 1, 0, 4, 11, 5, 6, 7, 100},
+	};
+	uint8_t buffer[FRAME_MAX_SIZE];
+	Frame frame;
+	DesDonnees decoded;
+	size_t size;
+	for(size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+	{
+		size = Frame_encodeDonnees(buffer, &cases[i]);
+		Bench_expect(Bench_decode(pDecoder, buffer, size, &frame) == DECODER_FRAME
+				&& Frame_decodeDonnees(&frame, &decoded) == TRUE && Bench_isSameDonnees(&decoded, &cases[i]),
+				"DesDonnees round trip");
+		//The older telcos write neither the robot nor the request.
+		frame.length = FRAME_DONNEES_SIZE - 8;
+		Bench_expect(cases[i].direction == TWIST || (Frame_decodeDonnees(&frame, &decoded) == TRUE
+				&& decoded.robot == 0 && decoded.request == 0 && decoded.power == cases[i].power),
+				"DesDonnees without robot nor request");
+		frame.length = FRAME_DONNEES_SIZE - 12;
+		Bench_expect(Frame_decodeDonnees(&frame, &decoded) == FALSE, "DesDonnees truncated refused");
+	}
+
+	//A TWIST written by a telco which does not know it carries no angular velocity.
+	size = Frame_encodeDonnees(buffer, &cases[0]);
+	buffer[FRAME_HEADER_SIZE + 3] = TWIST;
+	Bench_expect(Bench_decode(pDecoder, buffer, size, &frame) == DECODER_FRAME
+			&& Frame_decodeDonnees(&frame, &decoded) == FALSE, "TWIST without angular refused");
+	size = Frame_encodeDonnees(buffer, &cases[3]);
+	Bench_expect(Bench_decode(pDecoder, buffer, size, &frame) == DECODER_FRAME, "TWIST decoded");
+	frame.length = FRAME_DONNEES_SIZE;
+	Bench_expect(Frame_decodeDonnees(&frame, &decoded) == FALSE, "TWIST cut before angular refused");
+
+	size = Frame_encodeHeartbeat(buffer, 1);
+	Bench_expect(Bench_decode(pDecoder, buffer, size, &frame) == DECODER_FRAME
+			&& Frame_decodeDonnees(&frame, &decoded) == FALSE, "other type refused as DesDonnees");
+}
+
+static void Bench_checkDecoder(Decoder* pDecoder)
+{
+	DesDonnees donnees = {TWIST, 0, 0.5f, 0, 1, 0, 0, 0, 1, 2, 3, 0};
+	uint8_t buffer[FRAME_MAX_SIZE];
+	uint8_t payload[FRAME_MAX_PAYLOAD] = {0};
+	Frame frame;
+	DesDonnees decoded;
+	size_t size = Frame_encodeDonnees(buffer, &donnees);
+
+	//Truncated : nothing is extracted before the last byte.
+	Decoder_init(pDecoder);
+	for(size_t i = 0; i < size; i++)
+	{
+		Bench_expect(Decoder_next(pDecoder, &frame) == DECODER_NEED_MORE, "truncated frame waits for more");
+		Decoder_feed(pDecoder, buffer + i, 1);
+	}
+	Bench_expect(Decoder_next(pDecoder, &frame) == DECODER_FRAME && Frame_decodeDonnees(&frame, &decoded) == TRUE
+			&& Bench_isSameDonnees(&decoded, &donnees), "frame fed byte by byte");
+	Bench_expect(Decoder_next(pDecoder, &frame) == DECODER_NEED_MORE, "nothing left after the frame");
+
+	//Oversized, another version or another magic : the stream is dropped.
+	size = Frame_encode(buffer, FRAME_DONNEES, payload, FRAME_MAX_PAYLOAD);
+	Bench_expect(Bench_decode(pDecoder, buffer, size, &frame) == DECODER_FRAME, "largest payload decoded");
+	buffer[4] = (uint8_t) ((FRAME_MAX_PAYLOAD + 1) >> 8);
+	buffer[5] = (uint8_t) ((FRAME_MAX_PAYLOAD + 1) & 0xFF);
+	Bench_expect(Bench_decode(pDecoder, buffer, FRAME_HEADER_SIZE, &frame) == DECODER_ERROR, "oversized frame refused");
+	Bench_expect(Frame_parse(buffer, size, &frame) == FALSE, "oversized datagram refused");
+	size = Frame_encodeDonnees(buffer, &donnees);
+	buffer[2] = FRAME_VERSION + 1;
+	Bench_expect(Bench_decode(pDecoder, buffer, size, &frame) == DECODER_ERROR, "other version refused");
+	Bench_expect(Frame_parse(buffer, size, &frame) == FALSE, "datagram of another version refused");
+	buffer[2] = FRAME_VERSION;
+	buffer[0] ^= 0xFF;
+	Bench_expect(Bench_decode(pDecoder, buffer, size, &frame) == DECODER_ERROR, "other magic refused");
+
+	//Wrapping : frames of changing sizes fill the ring several times, some are split by its end.
+	int nb_wrapped = 0;
+	Decoder_init(pDecoder);
+	for(int i = 0; i < NB_WRAPPING; i++)
+	{
+		donnees.direction = (i % 3 == 0)? TWIST : FORWARD;
+		donnees.angular = (donnees.direction == TWIST)? -i : 0;
+		donnees.request = (unsigned int) i;
+		donnees.sampled = (uint64_t) (i % 2);
+		size = Frame_encodeDonnees(buffer, &donnees);
+		Bench_expect(Decoder_feed(pDecoder, buffer, size) == size, "room in the ring");
+		Bench_expect(Decoder_next(pDecoder, &frame) == DECODER_FRAME && Frame_decodeDonnees(&frame, &decoded) == TRUE
+				&& Bench_isSameDonnees(&decoded, &donnees), "frame wrapping around the ring");
+		if(frame.payload == pDecoder->frame + FRAME_HEADER_SIZE)
+		{
+			nb_wrapped++;
+		}
+	}
+	Bench_expect(nb_wrapped > 0, "some frames wrapped around the ring");
+}
+
+static void Bench_checkTelemetryDelta(Decoder* pDecoder)
+{
+	TelemetryCodec encoder;
+	TelemetryCodec decoder;
+	PilotState state = {10, 0, 0.5f, 1000000000ULL, 0.0f, 0.0f, 0.0f};
+	PilotState decoded;
+	uint32_t robot;
+	uint8_t buffer[FRAME_MAX_SIZE];
+	Frame frame;
+	size_t size;
+	Frame_initTelemetryCodec(&encoder);
+	Frame_initTelemetryCodec(&decoder);
+	for(int i = 0; i < 3 * FRAME_KEYFRAME_PERIOD; i++)
+	{
+		state.speed = (i % 10 == 0)? -state.speed : state.speed;
+		state.collision = (i % 25 == 0)? 1 - state.collision : state.collision;
+		state.luminosity += 0.0042f;
+		state.sampled += 10000000ULL;
+		state.x += 3.0f;
+		state.heading += 0.01f;
+		size = Frame_encodeTelemetryDelta(buffer, 2, &state, &encoder);
+		Bench_expect(Bench_decode(pDecoder, buffer, size, &frame) == DECODER_FRAME, "delta telemetry decoded");
+		if(i == 1)
+		{
+			//A delta received before its keyframe cannot be applied.
+			TelemetryCodec fresh;
+			Frame_initTelemetryCodec(&fresh);
+			Bench_expect(Frame_decodeTelemetryDelta(&frame, &robot, &decoded, &fresh) == FALSE, "delta without keyframe refused");
+		}
+		//Truncated, it is refused and the reference is left unchanged.
+		for(uint16_t length = 0; length < frame.length; length++)
+		{
+			Frame truncated = frame;
+			truncated.length = length;
+			Bench_expect(Frame_decodeTelemetryDelta(&truncated, &robot, &decoded, &decoder) == FALSE, "delta telemetry truncated refused");
+		}
+		Bench_expect(Frame_decodeTelemetryDelta(&frame, &robot, &decoded, &decoder) == TRUE && robot == 2
+				&& decoded.speed == state.speed && decoded.collision == state.collision
+				&& fabsf(decoded.luminosity - state.luminosity) <= FRAME_LUMINOSITY_STEP
+				&& decoded.sampled <= state.sampled && state.sampled - decoded.sampled < 1000
+				&& fabsf(decoded.x - state.x) <= FRAME_POSITION_STEP && fabsf(decoded.y - state.y) <= FRAME_POSITION_STEP
+				&& fabsf(decoded.heading - state.heading) <= FRAME_HEADING_STEP, "delta telemetry round trip");
+	}
+	size = Frame_encodeHeartbeat(buffer, 2);
+	Bench_expect(Bench_decode(pDecoder, buffer, size, &frame) == DECODER_FRAME
+			&& Frame_decodeTelemetryDelta(&frame, &robot, &decoded, &decoder) == FALSE, "other type refused as delta telemetry");
+}
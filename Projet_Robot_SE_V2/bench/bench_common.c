@@ -0,0 +1,116 @@
+/**
+ * @file  bench_common.c
+ *
+ * @brief Helpers shared by the benches : clock, order of the latencies, thread of the server and socket of a telco.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "bench_common.h"
+#include "commando/server.h"
+#include "commun/frame.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+#define CONNECT_RETRY_US (10000)
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+double Bench_now()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int Bench_compare(const void* a, const void* b)
+{
+	double da = *(const double*) a;
+	double db = *(const double*) b;
+	return (da > db) - (da < db);
+}
+
+void* Bench_serve(void* pArg)
+{
+	Server* pServer = (Server*) pArg;
+	Server_start(pServer);
+	Server_stop(pServer);
+	return NULL;
+}
+
+int Bench_connect()
+{
+	struct sockaddr_in adresse;
+	double deadline = Bench_now() + BENCH_CONNECT_TIMEOUT;
+	int option = 1;
+	int un_socket;
+	memset(&adresse, 0, sizeof(adresse));
+	adresse.sin_family = AF_INET;
+	adresse.sin_port = htons(PORT_DU_SERVEUR);
+	adresse.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	for(;;)
+	{
+		//The server may not listen yet.
+		un_socket = socket(PF_INET, SOCK_STREAM, 0);
+		if(connect(un_socket, (struct sockaddr *)&adresse, sizeof(adresse)) == 0)
+		{
+			break;
+		}
+		close(un_socket);
+		if(Bench_now() >= deadline)
+		{
+			printf("ERROR : the server does not listen after %.1f s\n", BENCH_CONNECT_TIMEOUT);
+			return -1;
+		}
+		usleep(CONNECT_RETRY_US);
+	}
+	setsockopt(un_socket, IPPROTO_TCP, TCP_NODELAY, &option, sizeof(option));
+	return un_socket;
+}
+
+void Bench_stopRobots(int nb_robots)
+{
+	uint8_t buffer[FRAME_MAX_SIZE];
+	for(int i = 0; i < nb_robots; i++)
+	{
+		DesDonnees donnees = {.stop = 1, .robot = i};
+		int un_socket = Bench_connect();
+		if(un_socket == -1)
+		{
+			return;
+		}
+		//Read by the server before the end of the connection.
+		send(un_socket, buffer, Frame_encodeDonnees(buffer, &donnees), MSG_NOSIGNAL);
+		close(un_socket);
+	}
+}
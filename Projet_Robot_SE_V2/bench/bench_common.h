@@ -0,0 +1,77 @@
+/**
+ * @file  bench_common.h
+ *
+ * @brief Helpers shared by the benches : clock, order of the latencies, thread of the server and socket of a telco.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef BENCH_BENCH_COMMON_H_
+#define BENCH_BENCH_COMMON_H_
+/* ----------------------  INCLUDES ------------------------------------------*/
+/* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/**
+ * \brief Seconds Bench_connect waits for the server to listen before it gives up.
+ */
+#define BENCH_CONNECT_TIMEOUT (5.0)
+/* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
+/* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
+/* ----------------------  PUBLIC VARIBLES -----------------------------------*/
+/* ----------------------  PUBLIC FUNCTIONS PROTOTYPES  ----------------------*/
+/**
+ * \fn extern double Bench_now()
+ * \brief Monotonic time in s.
+ */
+extern double Bench_now();
+/**
+ * \fn extern int Bench_compare(const void* a, const void* b)
+ * \brief Order of two doubles for qsort, to read the percentiles of the latencies.
+ */
+extern int Bench_compare(const void* a, const void* b);
+/**
+ * \fn extern void* Bench_serve(void* pArg)
+ * \brief Thread of the server : start the Server pArg and stop it once its last robot is stopped.
+ */
+extern void* Bench_serve(void* pArg);
+/**
+ * \fn extern int Bench_connect()
+ * \brief Connect a telco to the server of this host, without Nagle.
+ * The server may not listen yet : the connection is retried for BENCH_CONNECT_TIMEOUT s.
+ *
+ * \return int : the socket, -1 if the server does not listen in time.
+ */
+extern int Bench_connect();
+/**
+ * \fn extern void Bench_stopRobots(int nb_robots)
+ * \brief Stop the robots 0 to nb_robots - 1 of the server of this host, so that Bench_serve returns.
+ *        A telco only drives the robot of its session : each stop goes through its own connection.
+ */
+extern void Bench_stopRobots(int nb_robots);
+
+#endif /* BENCH_BENCH_COMMON_H_ */
@@ -0,0 +1,203 @@
+/**
+ * @file  bench_delta.c
+ *
+ * @brief Bytes per telemetry sample of the delta encoding, against the full frames, for typical streams.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "bench_common.h"
+#include "commun/frame.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+#define NB_SAMPLES (1000000)
+#define MAX_CHUNK (1500)
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/**
+ * \struct Scenario
+ * \brief How the samples of a stream change.
+ */
+typedef struct
+{
+	const char* name;
+	int speed_period; //samples between two changes of the speed, 0 for never.
+	int bump_period; //samples between two bumps of 10 samples, 0 for never.
+	float drift; //largest change of the luminosity between two samples.
+	float motion; //largest move of the robot between two samples, in mm and in 10 mrad.
+}Scenario;
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+static const Scenario scenarios[] =
+{
+	{"idle", 0, 0, 0.0f, 0.0f},
+	{"driving", 200, 5000, 0.002f, 0.0f},
+	{"noisy light", 50, 1000, 0.05f, 0.0f},
+	{"odometry", 200, 5000, 0.002f, 5.0f},
+};
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static int Bench_run(const Scenario* pScenario, long nb_samples, uint8_t* stream, Decoder* pDecoder)
+ * \brief Encode and decode a stream of samples, print its figures.
+ *
+ * \return int : number of samples badly decoded.
+ */
+static int Bench_run(const Scenario* pScenario, long nb_samples, uint8_t* stream, Decoder* pDecoder);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+int main(int argc, char *argv[])
+{
+	long nb_samples = (argc > 1)? atol(argv[1]) : NB_SAMPLES;
+	uint8_t* stream = (uint8_t*) malloc(nb_samples * FRAME_MAX_SIZE);
+	Decoder* pDecoder = (Decoder*) malloc(sizeof(Decoder));
+	int nb_errors = 0;
+	if(stream == NULL || pDecoder == NULL)
+	{
+		printf("ERROR : not enough memory\n");
+		return 1;
+	}
+	printf("bytes per sample (header included) : DesDonnees reply %d, FRAME_TELEMETRY %d\n",
+			FRAME_HEADER_SIZE + FRAME_DONNEES_SIZE, FRAME_HEADER_SIZE + FRAME_TELEMETRY_SIZE);
+	printf("%-12s %8s %8s %10s %10s %12s\n", "stream", "delta", "gain", "encode", "decode", "lum. error");
+	for(size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+	{
+		nb_errors += Bench_run(&scenarios[i], nb_samples, stream, pDecoder);
+	}
+	free(pDecoder);
+	free(stream);
+	return (nb_errors == 0)? 0 : 1;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static int Bench_run(const Scenario* pScenario, long nb_samples, uint8_t* stream, Decoder* pDecoder)
+{
+	PilotState* samples = (PilotState*) malloc(nb_samples * sizeof(PilotState));
+	PilotState state = {50, 0, 0.5f};
+	TelemetryCodec encoder;
+	TelemetryCodec decoder;
+	if(samples == NULL)
+	{
+		printf("ERROR : not enough memory\n");
+		return 1;
+	}
+	srand(42);
+	for(long i = 0; i < nb_samples; i++)
+	{
+		if(pScenario->speed_period > 0 && i % pScenario->speed_period == 0)
+		{
+			state.speed = rand() % 101;
+		}
+		state.collision = (pScenario->bump_period > 0 && i % pScenario->bump_period < 10)? 1 : 0;
+		state.luminosity += pScenario->drift * (2.0f * rand() / RAND_MAX - 1.0f);
+		state.x += pScenario->motion * rand() / RAND_MAX;
+		state.y += pScenario->motion * (2.0f * rand() / RAND_MAX - 1.0f);
+		state.heading += pScenario->motion * 0.01f * (2.0f * rand() / RAND_MAX - 1.0f);
+		if(state.heading > 3.14159265f)
+		{
+			state.heading -= 2 * 3.14159265f;
+		}
+		else if(state.heading <= -3.14159265f)
+		{
+			state.heading += 2 * 3.14159265f;
+		}
+		samples[i] = state;
+	}
+
+	//Encoding, as the commando does for a subscriber.
+	size_t size = 0;
+	Frame_initTelemetryCodec(&encoder);
+	double start = Bench_now();
+	for(long i = 0; i < nb_samples; i++)
+	{
+		size += Frame_encodeTelemetryDelta(stream + size, 0, &samples[i], &encoder);
+	}
+	double encode = Bench_now() - start;
+
+	//Decoding, the stream is fed in random chunks as a socket would do.
+	Frame frame;
+	PilotState decoded;
+	uint32_t robot;
+	float error = 0.0f;
+	long nb_decoded = 0;
+	int nb_errors = 0;
+	size_t offset = 0;
+	Decoder_init(pDecoder);
+	Frame_initTelemetryCodec(&decoder);
+	start = Bench_now();
+	while(offset < size)
+	{
+		size_t chunk = 1 + rand() % MAX_CHUNK;
+		if(chunk > size - offset)
+		{
+			chunk = size - offset;
+		}
+		offset += Decoder_feed(pDecoder, stream + offset, chunk);
+		while(Decoder_next(pDecoder, &frame) == DECODER_FRAME)
+		{
+			if(Frame_decodeTelemetryDelta(&frame, &robot, &decoded, &decoder) == FALSE || nb_decoded >= nb_samples)
+			{
+				nb_errors++;
+				continue;
+			}
+			const PilotState* pSample = &samples[nb_decoded++];
+			float difference = decoded.luminosity - pSample->luminosity;
+			if(difference < 0)
+			{
+				difference = -difference;
+			}
+			if(difference > error)
+			{
+				error = difference;
+			}
+			float heading = decoded.heading - pSample->heading;
+			if(heading > 3.14159265f)
+			{
+				heading -= 2 * 3.14159265f;
+			}
+			else if(heading < -3.14159265f)
+			{
+				heading += 2 * 3.14159265f;
+			}
+			if(decoded.speed != pSample->speed || decoded.collision != pSample->collision || difference > FRAME_LUMINOSITY_STEP
+					|| decoded.x - pSample->x > FRAME_POSITION_STEP || pSample->x - decoded.x > FRAME_POSITION_STEP
+					|| decoded.y - pSample->y > FRAME_POSITION_STEP || pSample->y - decoded.y > FRAME_POSITION_STEP
+					|| heading > FRAME_HEADING_STEP || heading < -FRAME_HEADING_STEP)
+			{
+				nb_errors++;
+			}
+		}
+	}
+	double decode = Bench_now() - start;
+	nb_errors += (int) (nb_samples - nb_decoded);
+
+	printf("%-12s %8.2f %7.1fx %7.1f M/s %7.1f M/s %12.6f%s\n", pScenario->name, (double) size / nb_samples,
+			(double) (FRAME_HEADER_SIZE + FRAME_TELEMETRY_SIZE) * nb_samples / size,
+			nb_samples / encode / 1e6, nb_decoded / decode / 1e6, error, (nb_errors > 0)? " ERRORS" : "");
+	free(samples);
+	return nb_errors;
+}
@@ -0,0 +1,348 @@
+/**
+ * @file  bench_load.c
+ *
+ * @brief Load generator: N telcos replaying a mix of commands against the real Server.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/*
+ * The real Server runs in a thread of the bench over the robots simulated by
+ * sim_prose.c, the telco threads connect to it on localhost and speak the
+ * DesDonnees protocol, one robot each. Every telco sends at a fixed rate,
+ * open loop, a random mix of:
+ *  - velocity commands (random direction and power);
+ *  - askLogs, answered by the commando with the id of their request;
+ *  - stops, velocity commands in the direction STOP (stop = 1 would end the
+ *    robot, it is only sent at the end to stop the server).
+ * The round trip of an askLog is measured from the time it was due, so that
+ * a late telco does not hide the latency (coordinated omission).
+ *
+ * usage : bench_load [-c telcos] [-r rate] [-d seconds] [-m velocity:askLog:stop]
+ *                    [-w workers] [-b epoll|uring] [-t telemetry_ms]
+ * The logs of the server go to /dev/null, the results to stdout.
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "bench_common.h"
+#include "commando/server.h"
+#include "commun/frame.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+#define NB_TELCOS (8)
+#define RATE (1000) //messages per second of each telco.
+#define DURATION (5)
+#define NB_WORKERS (2)
+#define MIX_VELOCITY (80)
+#define MIX_ASKLOG (15)
+#define MIX_STOP (5)
+#define WINDOW (4096) //askLogs in flight tracked by a telco, the older ones are counted lost.
+#define DRAIN_MS (1000) //wait for the last answers.
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+typedef struct
+{
+	int robot;
+	int rate;
+	double duration;
+	int mix[3]; //percentages of velocity, askLog and stop.
+	unsigned int telemetry_ms;
+	double* latencies; //round trips of the askLogs, in us.
+	long nb_latencies;
+	long nb_sent[3];
+	long nb_lost; //askLogs not answered.
+	long nb_late; //messages sent after their due time, the telco could not keep the rate.
+}Telco;
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+static int Bench_wait(int un_socket, double delay);
+static void* Bench_telco(void* pArg);
+static void Bench_receive(Telco* pTelco, Decoder* pDecoder, int un_socket, const double* due, uint32_t nb_requests, uint32_t* pAnswered);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+int main(int argc, char *argv[])
+{
+	int nb_telcos = NB_TELCOS;
+	int nb_workers = NB_WORKERS;
+	ServerBackend backend = SERVER_BACKEND_EPOLL;
+	Telco model = {.rate = RATE, .duration = DURATION, .mix = {MIX_VELOCITY, MIX_ASKLOG, MIX_STOP}};
+	int option;
+	while((option = getopt(argc, argv, "c:r:d:m:w:b:t:")) != -1)
+	{
+		switch(option)
+		{
+			case 'c':
+				nb_telcos = atoi(optarg);
+				break;
+			case 'r':
+				model.rate = atoi(optarg);
+				break;
+			case 'd':
+				model.duration = atof(optarg);
+				break;
+			case 'm':
+				if(sscanf(optarg, "%d:%d:%d", &model.mix[0], &model.mix[1], &model.mix[2]) != 3)
+				{
+					printf("mix : velocity:askLog:stop in %%\n");
+					return 1;
+				}
+				break;
+			case 'w':
+				nb_workers = atoi(optarg);
+				break;
+			case 'b':
+				backend = (strcmp(optarg, "uring") == 0)? SERVER_BACKEND_URING : SERVER_BACKEND_EPOLL;
+				break;
+			case 't':
+				model.telemetry_ms = atoi(optarg);
+				break;
+			default:
+				printf("usage : %s [-c telcos] [-r rate] [-d seconds] [-m velocity:askLog:stop] [-w workers] [-b epoll|uring] [-t telemetry_ms]\n", argv[0]);
+				return 1;
+		}
+	}
+	if(nb_telcos < 1 || model.rate < 1 || model.duration <= 0 || nb_workers < 1 || nb_workers > nb_telcos
+			|| model.mix[0] < 0 || model.mix[1] < 0 || model.mix[2] < 0 || model.mix[0] + model.mix[1] + model.mix[2] != 100)
+	{
+		printf("ERROR : invalid load\n");
+		return 1;
+	}
+
+	Server* pServer = Server_new(nb_telcos, nb_workers, NULL);
+	Telco* telcos = (Telco*) calloc(nb_telcos, sizeof(Telco));
+	pthread_t* threads = (pthread_t*) malloc(nb_telcos * sizeof(pthread_t));
+	long capacity = (long) (model.rate * model.duration) + 1;
+	double* latencies = (double*) malloc(nb_telcos * capacity * sizeof(double));
+	long nb_sent[3] = {0, 0, 0};
+	long nb_latencies = 0;
+	long nb_lost = 0;
+	long nb_late = 0;
+	pthread_t server;
+	double start;
+	double elapsed;
+	int stdout_fd;
+	int null_fd;
+
+	printf("%d telcos x %d msg/s for %.1f s, mix %d%% velocity %d%% askLog %d%% stop, %d workers, %s",
+			nb_telcos, model.rate, model.duration, model.mix[0], model.mix[1], model.mix[2], nb_workers,
+			(backend == SERVER_BACKEND_URING)? "io_uring" : "epoll");
+	if(model.telemetry_ms > 0)
+	{
+		printf(", telemetry every %u ms", model.telemetry_ms);
+	}
+	printf("\n");
+	//The server prints its start, its connections and its statistics, they would mix with the results.
+	fflush(stdout);
+	stdout_fd = dup(STDOUT_FILENO);
+	null_fd = open("/dev/null", O_WRONLY);
+	dup2(null_fd, STDOUT_FILENO);
+
+	Server_setBackend(pServer, backend);
+	pthread_create(&server, NULL, Bench_serve, pServer);
+	start = Bench_now();
+	for(int i = 0; i < nb_telcos; i++)
+	{
+		telcos[i] = model;
+		telcos[i].robot = i;
+		telcos[i].latencies = latencies + i * capacity;
+		pthread_create(&threads[i], NULL, Bench_telco, &telcos[i]);
+	}
+	for(int i = 0; i < nb_telcos; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+	elapsed = Bench_now() - start;
+	//The server returns once every robot is stopped.
+	Bench_stopRobots(nb_telcos);
+	pthread_join(server, NULL);
+	ServerStats stats = Server_getStats(pServer);
+	backend = pServer->backend; //epoll if io_uring is not supported.
+	Server_free(pServer);
+
+	fflush(stdout);
+	dup2(stdout_fd, STDOUT_FILENO);
+	close(stdout_fd);
+	close(null_fd);
+
+	for(int i = 0; i < nb_telcos; i++)
+	{
+		for(int type = 0; type < 3; type++)
+		{
+			nb_sent[type] += telcos[i].nb_sent[type];
+		}
+		memmove(latencies + nb_latencies, telcos[i].latencies, telcos[i].nb_latencies * sizeof(double));
+		nb_latencies += telcos[i].nb_latencies;
+		nb_lost += telcos[i].nb_lost;
+		nb_late += telcos[i].nb_late;
+	}
+	qsort(latencies, nb_latencies, sizeof(double), Bench_compare);
+	printf("sent       : %ld velocity, %ld askLog, %ld stop in %.2f s (%.0f msg/s, %ld sent late)\n",
+			nb_sent[0], nb_sent[1], nb_sent[2], elapsed, (nb_sent[0] + nb_sent[1] + nb_sent[2]) / elapsed, nb_late);
+	printf("commando   : %lu frames received (%.0f frames/s), %lu collapsed, %lu telemetry, %.3f syscalls per frame (%s)\n",
+			stats.nb_frames, stats.nb_frames / elapsed, stats.nb_collapsed, stats.nb_telemetry,
+			(stats.nb_frames > 0)? (double) stats.nb_syscalls / stats.nb_frames : 0.0,
+			(backend == SERVER_BACKEND_URING)? "io_uring" : "epoll");
+	printf("askLog     : %ld answered (%.0f answers/s), %ld lost\n", nb_latencies, nb_latencies / elapsed, nb_lost);
+	if(nb_latencies > 0)
+	{
+		printf("round trip : p50 %.1f us  p99 %.1f us  p999 %.1f us  max %.1f us\n", latencies[nb_latencies / 2],
+				latencies[(nb_latencies * 99) / 100], latencies[(nb_latencies * 999) / 1000], latencies[nb_latencies - 1]);
+	}
+	free(latencies);
+	free(threads);
+	free(telcos);
+	return 0;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static void* Bench_telco(void* pArg)
+{
+	Telco* pTelco = (Telco*) pArg;
+	Decoder* pDecoder = (Decoder*) malloc(sizeof(Decoder));
+	double* due = (double*) malloc(WINDOW * sizeof(double)); //due time of the askLogs in flight, by request % WINDOW.
+	uint8_t buffer[FRAME_MAX_SIZE];
+	unsigned int seed = pTelco->robot + 1;
+	int un_socket = Bench_connect();
+	uint32_t nb_requests = 0;
+	uint32_t answered = 0; //requests below are answered or lost.
+	double period = 1.0 / pTelco->rate;
+	double next = Bench_now();
+	double end = next + pTelco->duration;
+	double now;
+	size_t size;
+
+	Decoder_init(pDecoder);
+	if(un_socket == -1)
+	{
+		free(due);
+		free(pDecoder);
+		return NULL;
+	}
+	if(pTelco->telemetry_ms > 0)
+	{
+		size = Frame_encodeSubscribe(buffer, pTelco->robot, pTelco->telemetry_ms, 0, 0);
+		send(un_socket, buffer, size, MSG_NOSIGNAL);
+	}
+	while(next < end)
+	{
+		now = Bench_now();
+		if(now < next)
+		{
+			if(Bench_wait(un_socket, next - now) > 0)
+			{
+				Bench_receive(pTelco, pDecoder, un_socket, due, nb_requests, &answered);
+			}
+			continue;
+		}
+		DesDonnees donnees = {.robot = pTelco->robot};
+		int draw = rand_r(&seed) % 100;
+		int type = (draw < pTelco->mix[0])? 0 : ((draw < pTelco->mix[0] + pTelco->mix[1])? 1 : 2);
+		if(type == 0)
+		{
+			donnees.direction = rand_r(&seed) % STOP;
+			donnees.power = 1 + rand_r(&seed) % 100;
+		}
+		else if(type == 1)
+		{
+			if(nb_requests - answered == WINDOW)
+			{
+				//Too old to be answered, the slot is reused.
+				answered++;
+				pTelco->nb_lost++;
+			}
+			donnees.askLog = 1;
+			donnees.request = ++nb_requests;
+			due[nb_requests % WINDOW] = next;
+		}
+		else
+		{
+			donnees.direction = STOP;
+		}
+		size = Frame_encodeDonnees(buffer, &donnees);
+		if(send(un_socket, buffer, size, MSG_NOSIGNAL) != (ssize_t) size)
+		{
+			break;
+		}
+		pTelco->nb_sent[type]++;
+		if(now - next > period)
+		{
+			pTelco->nb_late++;
+		}
+		next += period;
+	}
+	end = Bench_now() + DRAIN_MS / 1000.0;
+	while(answered < nb_requests && (now = Bench_now()) < end)
+	{
+		if(Bench_wait(un_socket, end - now) > 0)
+		{
+			Bench_receive(pTelco, pDecoder, un_socket, due, nb_requests, &answered);
+		}
+	}
+	pTelco->nb_lost += nb_requests - answered;
+	free(due);
+	free(pDecoder);
+	close(un_socket);
+	return NULL;
+}
+
+static void Bench_receive(Telco* pTelco, Decoder* pDecoder, int un_socket, const double* due, uint32_t nb_requests, uint32_t* pAnswered)
+{
+	struct iovec iov[2];
+	int nb_iov = Decoder_getSpace(pDecoder, iov);
+	ssize_t received = readv(un_socket, iov, nb_iov);
+	DesDonnees donnees;
+	Frame frame;
+	double now = Bench_now();
+	if(received <= 0)
+	{
+		return;
+	}
+	Decoder_commit(pDecoder, received);
+	while(Decoder_next(pDecoder, &frame) == DECODER_FRAME)
+	{
+		//The telemetry pushed meanwhile is skipped.
+		if(Frame_decodeDonnees(&frame, &donnees) == TRUE && donnees.request > *pAnswered && donnees.request <= nb_requests)
+		{
+			//The answers of a robot come in order, the requests skipped have been lost.
+			pTelco->nb_lost += donnees.request - *pAnswered - 1;
+			*pAnswered = donnees.request;
+			pTelco->latencies[pTelco->nb_latencies++] = (now - due[donnees.request % WINDOW]) * 1e6;
+		}
+	}
+}
+
+static int Bench_wait(int un_socket, double delay)
+{
+	//Below the ms of poll, the rate would be kept by spinning.
+	struct pollfd fd = {un_socket, POLLIN, 0};
+	struct timespec timeout = {(time_t) delay, (long) ((delay - (time_t) delay) * 1e9)};
+	return ppoll(&fd, 1, &timeout, NULL);
+}
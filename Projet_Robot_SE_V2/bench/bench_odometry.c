@@ -0,0 +1,113 @@
+/**
+ * @file  bench_odometry.c
+ *
+ * @brief Cost of an update of the odometry at the rate of the coders, and its drift over closed circles.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "bench_common.h"
+#include "commando/odometry.h"
+#include <stdio.h>
+#include <stdlib.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+#define NB_UPDATES (10000000)
+#define WHEEL_DIAMETER (56.0f)
+#define PULSES_PER_TURN (360)
+/**
+ * \brief Track for which a pulse of difference between the wheels turns the robot of 1/1440 turn.
+ */
+#define CIRCLE_TRACK (112.0f)
+#define CIRCLE_UPDATES (1440)
+#define NB_CIRCLES (100)
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static double Bench_run(const int32_t* deltas, long nb_updates, Odometry* pOdometry)
+ * \brief Integrate pairs of left and right pulses.
+ *
+ * \return double : ns per update.
+ */
+static double Bench_run(const int32_t* deltas, long nb_updates, Odometry* pOdometry);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+int main(int argc, char *argv[])
+{
+	long nb_updates = (argc > 1)? atol(argv[1]) : NB_UPDATES;
+	int32_t* deltas = (int32_t*) malloc(2 * nb_updates * sizeof(int32_t));
+	Odometry odometry;
+	double cost;
+	if(deltas == NULL || nb_updates < CIRCLE_UPDATES * NB_CIRCLES)
+	{
+		printf("ERROR : not enough memory or updates\n");
+		return 1;
+	}
+
+	//A robot at full speed moves its wheels of 0 or 1 pulse per ms.
+	srand(42);
+	for(long i = 0; i < 2 * nb_updates; i++)
+	{
+		deltas[i] = rand() % 2;
+	}
+	Odometry_init(&odometry, WHEEL_DIAMETER, 120.0f, PULSES_PER_TURN);
+	cost = Bench_run(deltas, nb_updates, &odometry);
+	printf("driving : %.1f ns per update (%.4f%% of a 1 kHz period)\n", cost, cost / 1e4);
+
+	//The coders sampled between two pulses.
+	for(long i = 0; i < 2 * nb_updates; i++)
+	{
+		deltas[i] = 0;
+	}
+	cost = Bench_run(deltas, nb_updates, &odometry);
+	printf("stopped : %.1f ns per update\n", cost);
+
+	//Circles of 168 mm of radius : the pose comes back to the start after each of them.
+	for(long i = 0; i < CIRCLE_UPDATES * NB_CIRCLES; i++)
+	{
+		deltas[2 * i] = 1;
+		deltas[2 * i + 1] = 2;
+	}
+	Odometry_init(&odometry, WHEEL_DIAMETER, CIRCLE_TRACK, PULSES_PER_TURN);
+	Bench_run(deltas, CIRCLE_UPDATES * NB_CIRCLES, &odometry);
+	printf("%d circles of %.0f mm : closing error x %.3f mm y %.3f mm heading %.6f rad\n", NB_CIRCLES,
+			2 * 3.14159265 * 168, odometry.pose.x, odometry.pose.y, odometry.pose.heading);
+	free(deltas);
+	return 0;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static double Bench_run(const int32_t* deltas, long nb_updates, Odometry* pOdometry)
+{
+	double start = Bench_now();
+	for(long i = 0; i < nb_updates; i++)
+	{
+		Odometry_update(pOdometry, deltas[2 * i], deltas[2 * i + 1]);
+	}
+	return (Bench_now() - start) * 1e9 / nb_updates;
+}
@@ -0,0 +1,182 @@
+/**
+ * @file  bench_pilot.c
+ *
+ * @brief Events per second through the queue and the state machine of a pilot, from one and from several threads.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/*
+ * A Pilot drives a robot simulated by sim_prose.c :
+ *  - transitions = SETVELOCITY_E FORWARD / CHECK_E / SETVELOCITY_E STOP posted
+ *    and dispatched by the thread of the pilot, the motors are given their
+ *    commands (two events run per SETVELOCITY_E, the one raised by its action);
+ *  - queue = CHECK_E of an IDLE pilot, the cost of the queue and of the table;
+ *  - producers = threads posting CHECK_E at once, the thread of the pilot
+ *    dispatching them. A producer finding the queue full retries.
+ * It fails when a nested transition is lost, or when an event is dropped
+ * although the queue is never posted more than it holds.
+ *
+ * usage : bench_pilot [nb_events]
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "bench_common.h"
+#include "commando/pilot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+#define NB_EVENTS (4000000)
+#define MAX_PRODUCERS (4)
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/**
+ * \struct Producer
+ * \brief A thread posting events to the pilot.
+ */
+typedef struct
+{
+	pthread_t thread;
+	Pilot* pPilot;
+	long nb_events;
+	long nb_full;
+}Producer;
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+static void* Bench_produce(void* pArg);
+static double Bench_producers(Pilot* pPilot, int nb_producers, long nb_events, long* pFull);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+int main(int argc, char *argv[])
+{
+	long nb_events = (argc > 1)? atol(argv[1]) : NB_EVENTS;
+	Pilot* pPilot = Pilot_new(NULL);
+	VelocityVector forward = {.dir = FORWARD, .power = 100};
+	VelocityVector stop = {.dir = STOP, .power = 0};
+	double start;
+	double elapsed;
+	long nb_full;
+	long nb_lost = 0;
+	unsigned long nb_dropped;
+
+	Pilot_start(pPilot);
+	//Run to completion : the change raised by the action takes the pilot to RUNNING.
+	Pilot_post(pPilot, SETVELOCITY_E, &forward);
+	Pilot_dispatch(pPilot);
+	printf("IDLE + SETVELOCITY_E FORWARD -> %s\n", (pPilot->state == RUNNING)? "RUNNING" : "IDLE (nested transition lost)");
+	nb_lost += (pPilot->state == RUNNING)? 0 : 1;
+	Pilot_post(pPilot, SETVELOCITY_E, &stop);
+	Pilot_dispatch(pPilot);
+	nb_lost += (pPilot->state == IDLE)? 0 : 1;
+
+	printf("%-20s %12s %10s %12s\n", "run", "events/s", "ns/event", "full retries");
+	start = Bench_now();
+	for(long i = 0; i < nb_events; i += 3)
+	{
+		Pilot_post(pPilot, SETVELOCITY_E, &forward);
+		Pilot_post(pPilot, CHECK_E, NULL);
+		Pilot_post(pPilot, SETVELOCITY_E, &stop);
+		Pilot_dispatch(pPilot);
+		nb_lost += (pPilot->state == IDLE)? 0 : 1;
+	}
+	elapsed = Bench_now() - start;
+	printf("%-20s %12.0f %10.1f %12d\n", "transitions", nb_events / elapsed, elapsed * 1e9 / nb_events, 0);
+
+	start = Bench_now();
+	for(long i = 0; i < nb_events; i += PILOT_QUEUE_CAPACITY)
+	{
+		for(int j = 0; j < PILOT_QUEUE_CAPACITY; j++)
+		{
+			Pilot_post(pPilot, CHECK_E, NULL);
+		}
+		Pilot_dispatch(pPilot);
+	}
+	elapsed = Bench_now() - start;
+	printf("%-20s %12.0f %10.1f %12d\n", "queue", nb_events / elapsed, elapsed * 1e9 / nb_events, 0);
+	//Up to here the queue has never been posted more than it holds.
+	nb_dropped = __atomic_load_n(&pPilot->nb_dropped, __ATOMIC_RELAXED);
+
+	for(int nb_producers = 1; nb_producers <= MAX_PRODUCERS; nb_producers *= 2)
+	{
+		char name[32];
+		elapsed = Bench_producers(pPilot, nb_producers, nb_events, &nb_full);
+		snprintf(name, sizeof(name), "%d producer(s)", nb_producers);
+		printf("%-20s %12.0f %10.1f %12ld\n", name, nb_events / elapsed, elapsed * 1e9 / nb_events, nb_full);
+	}
+	printf("%lu events run to completion, %lu dropped on a full queue\n", pPilot->nb_events, pPilot->nb_dropped);
+	if(nb_lost > 0 || nb_dropped > 0)
+	{
+		printf("ERROR : %ld transition(s) not reaching their state, %lu event(s) dropped by a queue never full\n", nb_lost, nb_dropped);
+	}
+	Pilot_stop(pPilot);
+	Pilot_free(pPilot);
+	return (nb_lost == 0 && nb_dropped == 0)? 0 : 1;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static void* Bench_produce(void* pArg)
+{
+	Producer* pProducer = (Producer*) pArg;
+	for(long i = 0; i < pProducer->nb_events; i++)
+	{
+		while(Pilot_post(pProducer->pPilot, CHECK_E, NULL) == FALSE)
+		{
+			pProducer->nb_full++;
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static double Bench_producers(Pilot* pPilot, int nb_producers, long nb_events, long* pFull)
+{
+	Producer producers[MAX_PRODUCERS];
+	long nb_dispatched = 0;
+	double start = Bench_now();
+	for(int i = 0; i < nb_producers; i++)
+	{
+		producers[i].pPilot = pPilot;
+		producers[i].nb_events = nb_events / nb_producers;
+		producers[i].nb_full = 0;
+		pthread_create(&producers[i].thread, NULL, Bench_produce, &producers[i]);
+	}
+	while(nb_dispatched < (nb_events / nb_producers) * nb_producers)
+	{
+		int nb_ready = Pilot_dispatch(pPilot);
+		if(nb_ready == 0)
+		{
+			//Leaves the processor to the producers if they share one.
+			sched_yield();
+		}
+		nb_dispatched += nb_ready;
+	}
+	*pFull = 0;
+	for(int i = 0; i < nb_producers; i++)
+	{
+		pthread_join(producers[i].thread, NULL);
+		*pFull += producers[i].nb_full;
+	}
+	return Bench_now() - start;
+}
@@ -0,0 +1,200 @@
+/**
+ * @file  bench_profile.c
+ *
+ * @brief Cost of a tick of the speed ramps, against computing them, and the limits they keep.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "bench_common.h"
+#include "commando/profile.h"
+#include "commando/robot.h"
+#include <stdio.h>
+#include <stdlib.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+#define NB_TICKS (10000000)
+#define PERIOD (ROBOT_CODER_PERIOD_US / 1e6f)
+/**
+ * \brief Relative error of the float arithmetic tolerated on the limits measured.
+ */
+#define TOLERANCE (1e-3)
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/**
+ * \struct Limits
+ * \brief Limits of the ramps of a run.
+ */
+typedef struct
+{
+	const char* name;
+	float acceleration;
+	float jerk;
+}Limits;
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+static const Limits runs[] =
+{
+	{"S-curve", ROBOT_ACCELERATION, ROBOT_JERK},
+	{"trapezoid", ROBOT_ACCELERATION, 0.0f},
+	{"gentle", 100.0f, 400.0f},
+};
+/**
+ * \brief Ramps checked against the limits, besides 0->100 and -100->100 which are printed : from, to,
+ *        then for a ramp retargeted before its end the tick of the retarget (0 for none) and the new speed.
+ */
+static const float ramps[][4] =
+{
+	{100, -100, 0, 0}, {0, -100, 0, 0}, {30, 35, 0, 0}, {-20, 20, 0, 0}, {100, 99, 0, 0},
+	//Mid-ramp : the acceleration growing, at its limit, falling, and retargets to the same speed or beyond.
+	{0, 100, 50, -100}, {0, 100, 150, 0}, {0, 100, 300, 30}, {0, 100, 150, 100}, {-100, 0, 100, 100}, {0, 50, 100, 0},
+};
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static int Bench_run(const Limits* pLimits, long nb_ticks)
+ * \brief Follow ramps between random speeds, print their figures.
+ *
+ * \return int : number of ramps beyond the limits or not reaching their speed.
+ */
+static int Bench_run(const Limits* pLimits, long nb_ticks);
+/**
+ * \fn static int Bench_measure(const ProfileTable* pTable, float from, float to, int retarget, float then, float* pAcceleration, float* pJerk)
+ * \brief Follow a whole ramp, retargeted to then after retarget ticks if not 0, and measure its largest
+ *        acceleration and jerk, in absolute value.
+ *
+ * \return int : ticks of the ramp, -1 if it does not end at its speed or goes beyond 100 %.
+ */
+static int Bench_measure(const ProfileTable* pTable, float from, float to, int retarget, float then, float* pAcceleration, float* pJerk);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+int main(int argc, char *argv[])
+{
+	long nb_ticks = (argc > 1)? atol(argv[1]) : NB_TICKS;
+	int nb_errors = 0;
+	printf("%-10s %10s %10s %9s %9s %12s %12s\n", "limits", "tick", "table", "0->100", "-100->100", "accel. max", "jerk max");
+	for(size_t i = 0; i < sizeof(runs) / sizeof(runs[0]); i++)
+	{
+		nb_errors += Bench_run(&runs[i], nb_ticks);
+	}
+	return (nb_errors == 0)? 0 : 1;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static int Bench_run(const Limits* pLimits, long nb_ticks)
+{
+	ProfileTable* pTable = (ProfileTable*) malloc(sizeof(ProfileTable));
+	Profile profile;
+	float sum = 0;
+	float acceleration;
+	float jerk;
+	float acceleration_max = 0;
+	float jerk_max = 0;
+	int up;
+	int across;
+	int nb_errors = 0;
+	if(pTable == NULL)
+	{
+		printf("ERROR : not enough memory\n");
+		return 1;
+	}
+	double start = Bench_now();
+	if(Profile_initTable(pTable, pLimits->acceleration, pLimits->jerk, PERIOD) == FALSE)
+	{
+		printf("%-10s refused\n", pLimits->name);
+		free(pTable);
+		return 1;
+	}
+	double table = Bench_now() - start;
+
+	//Ticks of the control, a new speed being asked whenever the previous one is reached.
+	srand(42);
+	Profile_init(&profile, 0);
+	start = Bench_now();
+	for(long i = 0; i < nb_ticks; i++)
+	{
+		if(Profile_isRunning(&profile) == FALSE)
+		{
+			Profile_start(&profile, pTable, (float) (rand() % 201 - 100));
+		}
+		sum += Profile_next(&profile, pTable);
+	}
+	double tick = Bench_now() - start;
+
+	up = Bench_measure(pTable, 0, 100, 0, 0, &acceleration, &jerk);
+	acceleration_max = acceleration;
+	jerk_max = jerk;
+	across = Bench_measure(pTable, -100, 100, 0, 0, &acceleration, &jerk);
+	acceleration_max = (acceleration > acceleration_max)? acceleration : acceleration_max;
+	jerk_max = (jerk > jerk_max)? jerk : jerk_max;
+	nb_errors += (up < 0 || across < 0 || sum != sum)? 1 : 0;
+	for(size_t i = 0; i < sizeof(ramps) / sizeof(ramps[0]); i++)
+	{
+		nb_errors += (Bench_measure(pTable, ramps[i][0], ramps[i][1], (int) ramps[i][2], ramps[i][3], &acceleration, &jerk) < 0)? 1 : 0;
+		acceleration_max = (acceleration > acceleration_max)? acceleration : acceleration_max;
+		jerk_max = (jerk > jerk_max)? jerk : jerk_max;
+	}
+	//A limit of 0 lets the speed step, without a jerk limit the acceleration steps.
+	bool_e too_fast = (pLimits->acceleration > 0 && acceleration_max > pLimits->acceleration * (1 + TOLERANCE))? TRUE : FALSE;
+	bool_e too_jerky = (pLimits->jerk > 0 && jerk_max > pLimits->jerk * (1 + TOLERANCE))? TRUE : FALSE;
+	nb_errors += (too_fast == TRUE)? 1 : 0;
+	nb_errors += (too_jerky == TRUE)? 1 : 0;
+	printf("%-10s %7.1f ns %7.1f us %6d ms %6d ms %8.0f %%/s %8.0f %%/s2%s\n", pLimits->name, tick * 1e9 / nb_ticks,
+			table * 1e6, up * ROBOT_CODER_PERIOD_US / 1000, across * ROBOT_CODER_PERIOD_US / 1000,
+			acceleration_max, jerk_max, (nb_errors > 0)? " ERROR" : "");
+	free(pTable);
+	return nb_errors;
+}
+
+static int Bench_measure(const ProfileTable* pTable, float from, float to, int retarget, float then, float* pAcceleration, float* pJerk)
+{
+	Profile profile;
+	double speed = from;
+	double acceleration = 0;
+	bool_e beyond = FALSE;
+	int nb_ticks = 0;
+	*pAcceleration = 0;
+	*pJerk = 0;
+	Profile_init(&profile, from);
+	Profile_start(&profile, pTable, to);
+	while(Profile_isRunning(&profile) == TRUE)
+	{
+		if(retarget > 0 && nb_ticks == retarget)
+		{
+			//The acceleration reached is carried into the new ramp, the jerk measured across.
+			Profile_start(&profile, pTable, then);
+			to = then;
+		}
+		double next = Profile_next(&profile, pTable);
+		double change = (next - speed) / PERIOD;
+		double jerk = (change - acceleration) / PERIOD;
+		*pAcceleration = (change > *pAcceleration)? change : ((-change > *pAcceleration)? -change : *pAcceleration);
+		*pJerk = (jerk > *pJerk)? jerk : ((-jerk > *pJerk)? -jerk : *pJerk);
+		acceleration = change;
+		speed = next;
+		beyond = (speed > 100 || speed < -100)? TRUE : beyond;
+		nb_ticks++;
+	}
+	return (speed == to && beyond == FALSE)? nb_ticks : -1;
+}
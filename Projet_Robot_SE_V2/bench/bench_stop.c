@@ -0,0 +1,168 @@
+/**
+ * @file  bench_stop.c
+ *
+ * @brief Stop latency of the Controller under a flood of velocity commands.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/*
+ * A Controller drives a robot simulated by sim_prose.c, the bench is its
+ * network thread. Each round floods it with velocity commands and askLogs
+ * (COMMAND_CHECK), then posts a STOP:
+ *  - stop latency = time between the post of the STOP and the command 0 given
+ *    to the motors, as seen by sim_prose.c;
+ *  - drain = time until the answer to the last askLog of the flood, which is
+ *    what a STOP queued behind the flood would wait for.
+ * It fails when the median STOP is not applied before the median drain,
+ * i.e. when the STOP waits behind the commands queued.
+ *
+ * usage : bench_stop [nb_rounds] [flood]
+ * The logs of the controller go to /dev/null, the results to stdout.
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "bench_common.h"
+#include "commando/controller.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/eventfd.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+#define NB_ROUNDS (2000)
+#define FLOOD (512)
+#define CHECK_EVERY (4) //an askLog every CHECK_EVERY velocity commands.
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+extern void Sim_getLastStop(struct timespec* pTime);
+static double Bench_toSeconds(const struct timespec* pTime);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+int main(int argc, char *argv[])
+{
+	int nb_rounds = (argc > 1)? atoi(argv[1]) : NB_ROUNDS;
+	int flood = (argc > 2)? atoi(argv[2]) : FLOOD;
+	int notify_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	Controller* pController = Controller_new(0, 1, 1, NULL, notify_fd);
+	double* latencies = (double*) malloc(nb_rounds * sizeof(double));
+	double* drains = (double*) malloc(nb_rounds * sizeof(double));
+	Command velocity = {.type = COMMAND_VELOCITY, .robot = 0, .vector = {.dir = FORWARD}};
+	Command check = {.type = COMMAND_CHECK, .robot = 0};
+	Command stop = {.type = COMMAND_VELOCITY, .robot = 0, .vector = {.dir = STOP, .power = 0}};
+	Telemetry telemetry;
+	struct timespec stopped;
+	unsigned long nb_overwritten;
+	int nb_checks;
+	int nb_answers;
+	double posted;
+	int stdout_fd;
+	int null_fd;
+
+	printf("%d rounds of %d velocity commands + %d askLogs, then a STOP\n", nb_rounds, flood, flood / CHECK_EVERY);
+	//The pilot logs every check.
+	fflush(stdout);
+	stdout_fd = dup(STDOUT_FILENO);
+	null_fd = open("/dev/null", O_WRONLY);
+	dup2(null_fd, STDOUT_FILENO);
+
+	//Only the STOP of the bench stops the robot.
+	Controller_setWatchdog(pController, 0);
+	Controller_start(pController);
+	for(int round = 0; round < nb_rounds; round++)
+	{
+		nb_checks = 0;
+		nb_answers = 0;
+		for(int i = 0; i < flood; i++)
+		{
+			velocity.vector.power = 1 + (round + i) % 100;
+			Controller_post(pController, &velocity);
+			if(i % CHECK_EVERY == 0 && Controller_post(pController, &check) == TRUE)
+			{
+				nb_checks++;
+			}
+			if(i % CHECK_EVERY == 0)
+			{
+				//The control thread works on the flood while it is posted.
+				Controller_wake(pController);
+			}
+		}
+		posted = Bench_now();
+		Controller_post(pController, &stop);
+		//As the network thread at the end of its loop.
+		Controller_wake(pController);
+		for(Sim_getLastStop(&stopped); Bench_toSeconds(&stopped) < posted; Sim_getLastStop(&stopped))
+		{
+			//Leaves the processor to the control thread if they share one.
+			sched_yield();
+		}
+		latencies[round] = (Bench_toSeconds(&stopped) - posted) * 1e6;
+		while(nb_answers < nb_checks)
+		{
+			if(Controller_collect(pController, &telemetry) == TRUE)
+			{
+				nb_answers++;
+			}
+			else
+			{
+				sched_yield();
+			}
+		}
+		drains[round] = (Bench_now() - posted) * 1e6;
+	}
+	Controller_stop(pController);
+	nb_overwritten = pController->nb_velocity_overwritten;
+	Controller_free(pController);
+	close(notify_fd);
+
+	fflush(stdout);
+	dup2(stdout_fd, STDOUT_FILENO);
+	close(stdout_fd);
+	close(null_fd);
+
+	qsort(latencies, nb_rounds, sizeof(double), Bench_compare);
+	qsort(drains, nb_rounds, sizeof(double), Bench_compare);
+	printf("stop latency p50 %7.1f us  p99 %7.1f us  max %7.1f us\n", latencies[nb_rounds / 2],
+			latencies[(nb_rounds * 99) / 100], latencies[nb_rounds - 1]);
+	printf("drain        p50 %7.1f us  p99 %7.1f us  max %7.1f us\n", drains[nb_rounds / 2],
+			drains[(nb_rounds * 99) / 100], drains[nb_rounds - 1]);
+	printf("%lu of %lu velocity commands overwritten before being applied\n", nb_overwritten,
+			(unsigned long) nb_rounds * (flood + 1));
+	bool_e overtaken = (latencies[nb_rounds / 2] < drains[nb_rounds / 2])? TRUE : FALSE;
+	if(overtaken == FALSE)
+	{
+		printf("ERROR : the STOP waits behind the commands queued\n");
+	}
+	free(latencies);
+	free(drains);
+	return (overtaken == TRUE)? 0 : 1;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static double Bench_toSeconds(const struct timespec* pTime)
+{
+	return pTime->tv_sec + pTime->tv_nsec / 1e9;
+}
@@ -0,0 +1,272 @@
+/**
+ * @file  bench_udp.c
+ *
+ * @brief Latency of the velocity commands over TCP and over UDP on the loopback, with injected loss.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/*
+ * The loss is injected by the receiver, with the same pattern for both
+ * transports:
+ *  - UDP : a lost datagram is ignored, the next newer one supersedes it.
+ *  - TCP : a lost segment is delivered after the recovery delay, and every
+ *          later command waits behind it (head-of-line blocking). The
+ *          default delay is the Linux minimum RTO (200 ms): the telco traffic
+ *          is too sparse for a fast retransmit.
+ *
+ * The latency of a command is the time between its sending and the moment
+ * it (or a newer command) is in force on the receiver side.
+ * It fails when a TCP command is never applied, or when a UDP command is
+ * not applied although a newer one has been delivered.
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "bench_common.h"
+#include "commun/frame.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+#define LOSS_PERCENT (5)
+#define NB_COMMANDS (250)
+#define PERIOD_US (20000)
+#define RECOVERY_MS (200)
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+typedef struct
+{
+	bool_e datagram;
+	int socket_reception;
+	int nb_commands;
+	const bool_e* lost;
+	double recovery;
+	double* sent;
+	double* applied;
+}Bench;
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+static void* Bench_receive(void* pArg);
+static void Bench_apply(Bench* pBench, uint32_t* pLatest, uint32_t sequence, double when);
+static void Bench_run(Bench* pBench, int period_us);
+static int Bench_report(Bench* pBench);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+int main(int argc, char *argv[])
+{
+	int loss = (argc > 1)? atoi(argv[1]) : LOSS_PERCENT;
+	int nb_commands = (argc > 2)? atoi(argv[2]) : NB_COMMANDS;
+	int period_us = (argc > 3)? atoi(argv[3]) : PERIOD_US;
+	int recovery_ms = (argc > 4)? atoi(argv[4]) : RECOVERY_MS;
+	bool_e* lost = (bool_e*) malloc((nb_commands + 1) * sizeof(bool_e));
+	Bench bench;
+	int nb_errors = 0;
+
+	srand(42);
+	for(int i = 0; i <= nb_commands; i++)
+	{
+		lost[i] = (rand() % 100 < loss)? TRUE : FALSE;
+	}
+	printf("%d commands every %d us, %d%% loss, TCP recovery %d ms\n", nb_commands, period_us, loss, recovery_ms);
+	for(int transport = 0; transport < 2; transport++)
+	{
+		bench.datagram = (transport == 1)? TRUE : FALSE;
+		bench.nb_commands = nb_commands;
+		bench.lost = lost;
+		bench.recovery = recovery_ms / 1e3;
+		bench.sent = (double*) calloc(nb_commands + 1, sizeof(double));
+		bench.applied = (double*) calloc(nb_commands + 1, sizeof(double));
+		Bench_run(&bench, period_us);
+		nb_errors += Bench_report(&bench);
+		free(bench.sent);
+		free(bench.applied);
+	}
+	free(lost);
+	return (nb_errors == 0)? 0 : 1;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static void Bench_run(Bench* pBench, int period_us)
+{
+	struct sockaddr_in adresse;
+	socklen_t size = sizeof(adresse);
+	int socket_ecoute = -1;
+	int un_socket;
+	int option = 1;
+	pthread_t receiver;
+	uint8_t buffer[FRAME_MAX_SIZE];
+	VelocityVector vector = {FORWARD, 0};
+	struct timespec deadline;
+
+	memset(&adresse, 0, sizeof(adresse));
+	adresse.sin_family = AF_INET;
+	adresse.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if(pBench->datagram == TRUE)
+	{
+		pBench->socket_reception = socket(PF_INET, SOCK_DGRAM, 0);
+		bind(pBench->socket_reception, (struct sockaddr *)&adresse, sizeof(adresse));
+		getsockname(pBench->socket_reception, (struct sockaddr *)&adresse, &size);
+		un_socket = socket(PF_INET, SOCK_DGRAM, 0);
+		connect(un_socket, (struct sockaddr *)&adresse, sizeof(adresse));
+	}
+	else
+	{
+		socket_ecoute = socket(PF_INET, SOCK_STREAM, 0);
+		bind(socket_ecoute, (struct sockaddr *)&adresse, sizeof(adresse));
+		listen(socket_ecoute, 1);
+		getsockname(socket_ecoute, (struct sockaddr *)&adresse, &size);
+		un_socket = socket(PF_INET, SOCK_STREAM, 0);
+		connect(un_socket, (struct sockaddr *)&adresse, sizeof(adresse));
+		setsockopt(un_socket, IPPROTO_TCP, TCP_NODELAY, &option, sizeof(option));
+		pBench->socket_reception = accept(socket_ecoute, NULL, 0);
+	}
+	pthread_create(&receiver, NULL, Bench_receive, pBench);
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	for(int i = 1; i <= pBench->nb_commands; i++)
+	{
+		deadline.tv_nsec += period_us * 1000L;
+		deadline.tv_sec += deadline.tv_nsec / 1000000000;
+		deadline.tv_nsec %= 1000000000;
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+		vector.power = i % 100;
+		size_t frame_size = Frame_encodeVelocity(buffer, i, 0, &vector);
+		pBench->sent[i] = Bench_now();
+		send(un_socket, buffer, frame_size, 0);
+	}
+	shutdown(un_socket, SHUT_RDWR);
+	pthread_join(receiver, NULL);
+	close(un_socket);
+	close(pBench->socket_reception);
+	if(socket_ecoute != -1)
+	{
+		close(socket_ecoute);
+	}
+}
+
+static void* Bench_receive(void* pArg)
+{
+	Bench* pBench = (Bench*) pArg;
+	Decoder* pDecoder = (Decoder*) malloc(sizeof(Decoder));
+	struct pollfd fd = {pBench->socket_reception, POLLIN, 0};
+	uint8_t datagram[FRAME_MAX_SIZE];
+	struct iovec iov[2];
+	uint32_t latest = 0;
+	uint32_t sequence;
+	uint32_t robot;
+	VelocityVector vector;
+	double delivered = 0;
+	Frame frame;
+	ssize_t size;
+
+	Decoder_init(pDecoder);
+	//The end of the test is a second without any command.
+	while(latest < (uint32_t) pBench->nb_commands && poll(&fd, 1, 1000) == 1)
+	{
+		double arrival = Bench_now();
+		if(pBench->datagram == TRUE)
+		{
+			size = recv(pBench->socket_reception, datagram, sizeof(datagram), 0);
+			if(size > 0 && Frame_parse(datagram, size, &frame) == TRUE
+					&& Frame_decodeVelocity(&frame, &sequence, &robot, &vector) == TRUE
+					&& pBench->lost[sequence] == FALSE)
+			{
+				Bench_apply(pBench, &latest, sequence, arrival);
+			}
+			continue;
+		}
+		int nb_iov = Decoder_getSpace(pDecoder, iov);
+		size = readv(pBench->socket_reception, iov, nb_iov);
+		if(size <= 0)
+		{
+			break;
+		}
+		Decoder_commit(pDecoder, size);
+		while(Decoder_next(pDecoder, &frame) == DECODER_FRAME)
+		{
+			if(Frame_decodeVelocity(&frame, &sequence, &robot, &vector) == TRUE)
+			{
+				double when = arrival + ((pBench->lost[sequence] == TRUE)? pBench->recovery : 0);
+				delivered = (when > delivered)? when : delivered;
+				Bench_apply(pBench, &latest, sequence, delivered);
+			}
+		}
+	}
+	free(pDecoder);
+	return NULL;
+}
+
+static void Bench_apply(Bench* pBench, uint32_t* pLatest, uint32_t sequence, double when)
+{
+	if(Frame_isNewer(sequence, *pLatest) == FALSE)
+	{
+		return;
+	}
+	//The commands superseded by this one are considered in force now.
+	for(uint32_t i = *pLatest + 1; i <= sequence; i++)
+	{
+		pBench->applied[i] = when;
+	}
+	*pLatest = sequence;
+}
+
+static int Bench_report(Bench* pBench)
+{
+	double* latencies = (double*) malloc(pBench->nb_commands * sizeof(double));
+	int nb = 0;
+	int nb_expected = pBench->nb_commands;
+	for(int i = 1; i <= pBench->nb_commands; i++)
+	{
+		if(pBench->applied[i] > 0)
+		{
+			latencies[nb++] = (pBench->applied[i] - pBench->sent[i]) * 1e6;
+		}
+	}
+	qsort(latencies, nb, sizeof(double), Bench_compare);
+	if(nb > 0)
+	{
+		printf("%s : p50 %8.1f us  p99 %8.1f us  max %8.1f us  (%d commands never applied)\n",
+				(pBench->datagram == TRUE)? "UDP" : "TCP", latencies[nb / 2], latencies[(nb * 99) / 100],
+				latencies[nb - 1], pBench->nb_commands - nb);
+	}
+	free(latencies);
+	//TCP delivers every command, UDP all but the last ones lost, nothing newer supersedes them.
+	for(int i = pBench->nb_commands; pBench->datagram == TRUE && i > 0 && pBench->lost[i] == TRUE; i--)
+	{
+		nb_expected--;
+	}
+	if(nb != nb_expected)
+	{
+		printf("ERROR : %d %s commands applied, %d expected\n", nb, (pBench->datagram == TRUE)? "UDP" : "TCP", nb_expected);
+		return 1;
+	}
+	return 0;
+}
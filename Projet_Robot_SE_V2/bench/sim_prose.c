@@ -0,0 +1,224 @@
+/**
+ * @file  sim_prose.c
+ *
+ * @brief In-memory stand-in for libinfox, so that the benches drive the real commando without the Intox simulator.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/*
+ * Every function of the ProSE API used by the commando is implemented over
+ * plain memory:
+ *  - the motors keep their command, their incremental coder advances with
+ *    the command and the time elapsed (SIM_PULSES_PER_SECOND at 100 %);
+ *  - the contact sensors are released, the light sensor returns a constant;
+ *  - the time of the last command 0 given to a motor is kept for the benches
+ *    (Sim_getLastStop).
+ *
+ * Linked in place of -linfox, a call never blocks nor fails.
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "prose.h"
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+#define SIM_CODER_MODULO (360)
+#define SIM_PULSES_PER_SECOND (720)
+#define SIM_LIGHT_LEVEL (1200)
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+struct Motor_t
+{
+	LegoMotor port;
+	Cmd cmd;
+	double position; //pulses, the coder value is its integer part.
+	struct timespec updated; //time the position has been computed for.
+};
+
+struct ContactSensor_t
+{
+	LegoSensor port;
+	ContactStatus status;
+};
+
+struct LightSensor_t
+{
+	LegoSensor port;
+	bool_e light;
+};
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+static pthread_mutex_t sim_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct timespec sim_stopped; //time of the last command 0.
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static void Sim_advance(Motor* motor)
+ * \brief Move the coder of a motor for the time elapsed at its current command.
+ */
+static void Sim_advance(Motor* motor);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+int ProSE_Intox_init(const char* adresse, const int port)
+{
+	(void) adresse;
+	(void) port;
+	return 0;
+}
+
+void ProSE_Intox_close()
+{
+}
+
+char const* PProseError(char* msg)
+{
+	return msg;
+}
+
+Motor* Motor_open(LegoMotor port)
+{
+	Motor* motor = (Motor*) calloc(1, sizeof(Motor));
+	if(motor != NULL)
+	{
+		motor->port = port;
+		clock_gettime(CLOCK_MONOTONIC, &motor->updated);
+	}
+	return motor;
+}
+
+int Motor_close(Motor* motor)
+{
+	free(motor);
+	return 0;
+}
+
+int Motor_setCmd(Motor* motor, Cmd cmd)
+{
+	pthread_mutex_lock(&sim_lock);
+	Sim_advance(motor);
+	motor->cmd = (cmd > 100)? 100 : ((cmd < -100)? -100 : cmd);
+	if(cmd == 0)
+	{
+		sim_stopped = motor->updated;
+	}
+	pthread_mutex_unlock(&sim_lock);
+	return 0;
+}
+
+Cmd Motor_getCmd(Motor* motor)
+{
+	return motor->cmd;
+}
+
+int Motor_setIncrementalCoderValue(Motor* motor, IncrementalValue position)
+{
+	pthread_mutex_lock(&sim_lock);
+	Sim_advance(motor);
+	motor->position = position;
+	pthread_mutex_unlock(&sim_lock);
+	return 0;
+}
+
+IncrementalValue Motor_getIncrementalCoderValue(Motor* motor)
+{
+	IncrementalValue value;
+	pthread_mutex_lock(&sim_lock);
+	Sim_advance(motor);
+	//Wraps around like the 32 bits counter of the real coder.
+	value = (IncrementalValue) (uint32_t) (int64_t) motor->position;
+	pthread_mutex_unlock(&sim_lock);
+	return value;
+}
+
+int Motor_getIncrementalCoderModulo()
+{
+	return SIM_CODER_MODULO;
+}
+
+ContactSensor* ContactSensor_open(LegoSensor port)
+{
+	ContactSensor* contactSensor = (ContactSensor*) calloc(1, sizeof(ContactSensor));
+	if(contactSensor != NULL)
+	{
+		contactSensor->port = port;
+		contactSensor->status = RELEASED;
+	}
+	return contactSensor;
+}
+
+int ContactSensor_close(ContactSensor* contactSensor)
+{
+	free(contactSensor);
+	return 0;
+}
+
+ContactStatus ContactSensor_getStatus(ContactSensor* contactSensor)
+{
+	return contactSensor->status;
+}
+
+LightSensor* LightSensor_open(LegoSensor port)
+{
+	LightSensor* lightSensor = (LightSensor*) calloc(1, sizeof(LightSensor));
+	if(lightSensor != NULL)
+	{
+		lightSensor->port = port;
+	}
+	return lightSensor;
+}
+
+int LightSensor_close(LightSensor* lightSensor)
+{
+	free(lightSensor);
+	return 0;
+}
+
+int LightSensor_setLight(LightSensor* lightSensor, bool_e status)
+{
+	lightSensor->light = status;
+	return 0;
+}
+
+LightLevel LightSensor_getStatus(LightSensor* lightSensor)
+{
+	(void) lightSensor;
+	return SIM_LIGHT_LEVEL;
+}
+void Sim_getLastStop(struct timespec* pTime)
+{
+	pthread_mutex_lock(&sim_lock);
+	*pTime = sim_stopped;
+	pthread_mutex_unlock(&sim_lock);
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static void Sim_advance(Motor* motor)
+{
+	struct timespec now;
+	double elapsed;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	elapsed = (now.tv_sec - motor->updated.tv_sec) + (now.tv_nsec - motor->updated.tv_nsec) / 1e9;
+	motor->position += motor->cmd / 100.0 * SIM_PULSES_PER_SECOND * elapsed;
+	motor->updated = now;
+}
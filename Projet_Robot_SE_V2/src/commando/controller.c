@@ -0,0 +1,1148 @@
+/**
+ * @file  controller.c
+ *
+ * @brief Control thread driving the pilot, fed by the network thread through lock-free rings.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "controller.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+/**
+ * \brief Empty velocity slot, no VelocityVector is packed to it.
+ */
+#define CONTROLLER_NO_VELOCITY (UINT64_MAX)
+/**
+ * \brief SCHED_FIFO priority of a real-time control thread, above the network thread.
+ */
+#define CONTROLLER_PRIORITY (50)
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+static Controller* process_controller = NULL; //driven by this control process, stopped by Controller_onTerm.
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static size_t Controller_align(size_t size)
+ * \brief Size rounded up to a cache line, each part of the shared mapping starts on its own.
+ */
+static size_t Controller_align(size_t size);
+/**
+ * \fn static void* Controller_carve(uint8_t** ppNext, size_t size)
+ * \brief Take the next part of the shared mapping.
+ */
+static void* Controller_carve(uint8_t** ppNext, size_t size);
+/**
+ * \fn static void Controller_fork(Controller* pController)
+ * \brief Run the pilots and the control loop in a child process, which opens its own Intox session.
+ */
+static void Controller_fork(Controller* pController);
+/**
+ * \fn static void Controller_onTerm(int signum)
+ * \brief Stop the control process on SIGTERM, sent when the commando is gone : its pilots are stopped
+ *        and its Intox session closed before it exits.
+ */
+static void Controller_onTerm(int signum);
+/**
+ * \fn static void Controller_setRealtime(Controller* pController, pthread_t thread)
+ * \brief Run the control thread with SCHED_FIFO if asked, it keeps the default policy if not allowed.
+ */
+static void Controller_setRealtime(Controller* pController, pthread_t thread);
+/**
+ * \fn static void Controller_report(Controller* pController)
+ * \brief Print the statistics of the control loop once it is over (control side).
+ */
+static void Controller_report(Controller* pController);
+/**
+ * \fn static void* Controller_run(void* pArg)
+ * \brief Body of the control thread : executes the commands until stopped.
+ */
+static void* Controller_run(void* pArg);
+/**
+ * \fn static void Controller_runPeriodic(Controller* pController)
+ * \brief Body of the control thread with a rate : ticks on absolute deadlines until stopped.
+ */
+static void Controller_runPeriodic(Controller* pController);
+/**
+ * \fn static void Controller_sample(Controller* pController)
+ * \brief Sample the sensors of the pilots, forget the motion of a robot the pilot has stopped (control thread).
+ */
+static void Controller_sample(Controller* pController);
+/**
+ * \fn static void Controller_stopPilots(Controller* pController)
+ * \brief Stop the pilots whose stop has been requested (control thread).
+ */
+static void Controller_stopPilots(Controller* pController);
+/**
+ * \fn static void Controller_onBump(void* pContext, int pilot)
+ * \brief RobotBumpHandler : the motors of a pilot are stopped, its state machine is told by the control thread.
+ */
+static void Controller_onBump(void* pContext, int pilot);
+/**
+ * \fn static void Controller_runBumps(Controller* pController)
+ * \brief Stop the pilots whose robot bumped (control thread).
+ */
+static void Controller_runBumps(Controller* pController);
+/**
+ * \fn static void Controller_runUrgent(Controller* pController)
+ * \brief Apply the stops and the latest velocities posted, before any command queued (control thread).
+ */
+static void Controller_runUrgent(Controller* pController);
+/**
+ * \fn static uint64_t Controller_pack(const VelocityVector* pVector)
+ * \brief Pack a VelocityVector into a velocity slot, written atomically.
+ *
+ * The power and the angular velocity are kept on 16 bits, the wheels saturate far below.
+ */
+static uint64_t Controller_pack(const VelocityVector* pVector);
+/**
+ * \fn static VelocityVector Controller_unpack(uint64_t slot)
+ * \brief VelocityVector packed by Controller_pack.
+ */
+static VelocityVector Controller_unpack(uint64_t slot);
+/**
+ * \fn static void Controller_writeTrace(ControllerTrace* pSlot, const Trace* pTrace)
+ * \brief Publish the trace of a velocity before its slot (network thread).
+ */
+static void Controller_writeTrace(ControllerTrace* pSlot, const Trace* pTrace);
+/**
+ * \fn static void Controller_readTrace(ControllerTrace* pSlot, Trace* pTrace)
+ * \brief Get the trace of the velocity taken from its slot, zeroed if it is being rewritten or already read (control thread).
+ */
+static void Controller_readTrace(ControllerTrace* pSlot, Trace* pTrace);
+/**
+ * \fn static void Controller_execute(Controller* pController, const Command* pCommand)
+ * \brief Give a command to the pilot (control thread).
+ */
+static void Controller_execute(Controller* pController, const Command* pCommand);
+/**
+ * \fn static void Controller_signal(int fd)
+ * \brief Increment an eventfd.
+ */
+static void Controller_signal(int fd);
+/**
+ * \fn static void Controller_armWatchdog(Controller* pController)
+ * \brief Arm the timerfd at the earliest deadline of the moving pilots, if it is not already (control thread).
+ */
+static void Controller_armWatchdog(Controller* pController);
+/**
+ * \fn static void Controller_checkWatchdog(Controller* pController)
+ * \brief Stop the moving pilots whose deadline is over (control thread).
+ */
+static void Controller_checkWatchdog(Controller* pController);
+/**
+ * \fn static struct timespec Controller_getDeadline(Controller* pController, int pilot)
+ * \brief Time at which a moving pilot is stopped if no command arrives meanwhile.
+ */
+static struct timespec Controller_getDeadline(Controller* pController, int pilot);
+/**
+ * \fn static void Controller_drive(Controller* pController, int pilot, const VelocityVector* pVector)
+ * \brief Apply a velocity through the state machine of a pilot (control thread).
+ */
+static void Controller_drive(Controller* pController, int pilot, const VelocityVector* pVector);
+/**
+ * \fn static void Controller_addSegment(Controller* pController, const Command* pCommand)
+ * \brief Buffer the segment of a COMMAND_TRAJECTORY, or cancel the trajectory (control thread).
+ */
+static void Controller_addSegment(Controller* pController, const Command* pCommand);
+/**
+ * \fn static void Controller_runTrajectories(Controller* pController)
+ * \brief Apply the segments due and arm trajectory_fd at the next one (control thread).
+ */
+static void Controller_runTrajectories(Controller* pController);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+Controller* Controller_new(int worker, int nb_workers, int nb_robots, const RobotConfig* pConfigs, int notify_fd)
+{
+	int nb_pilots = (nb_robots - worker + nb_workers - 1) / nb_workers;
+	//What the network thread and the control thread both write is shared, the control loop may be a child process.
+	size_t shared_size = Controller_align(sizeof(Controller)) + Controller_align(nb_pilots * sizeof(bool_e))
+			+ Controller_align(nb_pilots * sizeof(uint64_t)) + Controller_align(nb_pilots * sizeof(ControllerTrace))
+			+ Controller_align(nb_pilots * sizeof(unsigned long))
+			+ Controller_align(Ring_getSize(CONTROLLER_COMMANDS, sizeof(Command)))
+			+ Controller_align(Ring_getSize(CONTROLLER_TELEMETRY, sizeof(Telemetry)));
+	uint8_t* shared = (uint8_t*) mmap(NULL, shared_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(shared == MAP_FAILED)
+	{
+		printf("ERROR : pController is NULL \n");
+		while(1);
+	}
+	//The mapping is zeroed.
+	Controller* pController = (Controller*) Controller_carve(&shared, sizeof(Controller));
+	pController->shared_size = shared_size;
+	pController->stop_requested = (bool_e*) Controller_carve(&shared, nb_pilots * sizeof(bool_e));
+	pController->velocity = (uint64_t*) Controller_carve(&shared, nb_pilots * sizeof(uint64_t));
+	pController->traces = (ControllerTrace*) Controller_carve(&shared, nb_pilots * sizeof(ControllerTrace));
+	pController->velocity_epochs = (unsigned long*) Controller_carve(&shared, nb_pilots * sizeof(unsigned long));
+	pController->commands = Ring_init(Controller_carve(&shared, Ring_getSize(CONTROLLER_COMMANDS, sizeof(Command))),
+			CONTROLLER_COMMANDS, sizeof(Command));
+	pController->telemetry = Ring_init(Controller_carve(&shared, Ring_getSize(CONTROLLER_TELEMETRY, sizeof(Telemetry))),
+			CONTROLLER_TELEMETRY, sizeof(Telemetry));
+	pController->worker = worker;
+	pController->nb_workers = nb_workers;
+	pController->nb_pilots = nb_pilots;
+	pController->pilots = (Pilot**) malloc(pController->nb_pilots * sizeof(Pilot*));
+	pController->stopped = (bool_e*) malloc(pController->nb_pilots * sizeof(bool_e));
+	pController->moving = (bool_e*) malloc(pController->nb_pilots * sizeof(bool_e));
+	pController->last_command = (struct timespec*) malloc(pController->nb_pilots * sizeof(struct timespec));
+	pController->trajectories = (Trajectory*) malloc(pController->nb_pilots * sizeof(Trajectory));
+	pController->applied_epochs = (unsigned long*) calloc(pController->nb_pilots, sizeof(unsigned long));
+	pController->bumped = (bool_e*) malloc(pController->nb_pilots * sizeof(bool_e));
+	pController->poller = Robot_newPoller();
+	if(pController->pilots == NULL || pController->stopped == NULL || pController->moving == NULL
+			|| pController->last_command == NULL || pController->trajectories == NULL
+			|| pController->applied_epochs == NULL || pController->bumped == NULL)
+	{
+		printf("ERROR : pController->pilots is NULL \n");
+		while(1);
+	}
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		int robot = worker + i * nb_workers;
+		pController->pilots[i] = Pilot_new((pConfigs != NULL)? &pConfigs[robot] : NULL);
+		pController->stopped[i] = FALSE;
+		pController->stop_requested[i] = FALSE;
+		pController->moving[i] = FALSE;
+		pController->velocity[i] = CONTROLLER_NO_VELOCITY;
+		Trajectory_init(&pController->trajectories[i]);
+		pController->bumped[i] = FALSE;
+		Robot_setBumpHandler(pController->pilots[i]->robot, Controller_onBump, pController, i);
+		//Sharded as the pilots, the workers do not poll the robots of each other.
+		Robot_setPoller(pController->pilots[i]->robot, pController->poller);
+	}
+	pController->wake_fd = eventfd(0, EFD_CLOEXEC);
+	pController->notify_fd = notify_fd;
+	pController->posted = FALSE;
+	pController->running = FALSE;
+	pController->stop_pending = FALSE;
+	pController->velocity_pending = FALSE;
+	pController->nb_velocity_overwritten = 0;
+	pController->nb_commands_dropped = 0;
+	pController->nb_telemetry_dropped = 0;
+	pController->watchdog_ms = CONTROLLER_WATCHDOG_MS;
+	pController->watchdog_fd = -1;
+	pController->watchdog_armed = FALSE;
+	pController->nb_watchdog_trips = 0;
+	pController->watchdog_reaction_max_ns = 0;
+	pController->watchdog_reaction_total_ns = 0;
+	pController->trajectories_pending = FALSE;
+	pController->trajectory_fd = -1;
+	pController->trajectory_armed = FALSE;
+	pController->nb_trajectories_discarded = 0;
+	pController->rate_hz = 0;
+	pController->realtime = FALSE;
+	pController->process = FALSE;
+	pController->pid = -1;
+	pController->nb_ticks = 0;
+	pController->nb_missed = 0;
+	pController->jitter_max_ns = 0;
+	pController->jitter_total_ns = 0;
+	pController->bump_pending = FALSE;
+	return pController;
+}
+
+void Controller_setWatchdog(Controller* pController, unsigned int deadline_ms)
+{
+	pController->watchdog_ms = deadline_ms;
+}
+
+void Controller_setRate(Controller* pController, unsigned int rate_hz, bool_e realtime)
+{
+	pController->rate_hz = rate_hz;
+	pController->realtime = realtime;
+}
+
+void Controller_setProcess(Controller* pController, bool_e process)
+{
+	pController->process = process;
+}
+
+void Controller_setMotionProfile(Controller* pController, float acceleration, float jerk)
+{
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		Robot_setMotionProfile(pController->pilots[i]->robot, acceleration, jerk);
+	}
+}
+
+void Controller_start(Controller* pController)
+{
+	for(int i = 0; pController->process == FALSE && i < pController->nb_pilots; i++)
+	{
+		Pilot_start(pController->pilots[i]);
+	}
+	//Created before the fork, both processes see them under the same numbers. With a rate, the deadlines are checked at every tick instead.
+	if(pController->watchdog_ms > 0 && pController->rate_hz == 0)
+	{
+		pController->watchdog_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+		if(pController->watchdog_fd == -1)
+		{
+			perror("ERROR : watchdog");
+		}
+	}
+	if(pController->rate_hz == 0)
+	{
+		pController->trajectory_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+		if(pController->trajectory_fd == -1)
+		{
+			perror("ERROR : trajectory");
+		}
+	}
+	pController->running = TRUE;
+	if(pController->process == TRUE)
+	{
+		Controller_fork(pController);
+		return;
+	}
+	if(pthread_create(&pController->thread, NULL, Controller_run, pController) != 0)
+	{
+		printf("ERROR : the control thread could not be created \n");
+		pController->running = FALSE;
+		return;
+	}
+	Controller_setRealtime(pController, pController->thread);
+}
+
+void Controller_stop(Controller* pController)
+{
+	if(pController->running == FALSE)
+	{
+		return;
+	}
+	//No robot is left moving once the control thread is gone.
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		__atomic_store_n(&pController->stop_requested[i], TRUE, __ATOMIC_RELAXED);
+	}
+	__atomic_store_n(&pController->stop_pending, TRUE, __ATOMIC_RELEASE);
+	__atomic_store_n(&pController->running, FALSE, __ATOMIC_RELEASE);
+	Controller_signal(pController->wake_fd);
+	if(pController->process == TRUE)
+	{
+		//The child has reported its statistics and closed its Intox session.
+		if(waitpid(pController->pid, NULL, 0) == -1)
+		{
+			perror("ERROR : control process");
+		}
+		return;
+	}
+	pthread_join(pController->thread, NULL);
+	Controller_report(pController);
+}
+
+void Controller_free(Controller* pController)
+{
+	close(pController->wake_fd);
+	if(pController->watchdog_fd != -1)
+	{
+		close(pController->watchdog_fd);
+	}
+	if(pController->trajectory_fd != -1)
+	{
+		close(pController->trajectory_fd);
+	}
+	Ring_free(pController->commands);
+	Ring_free(pController->telemetry);
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		Pilot_free(pController->pilots[i]);
+	}
+	Robot_freePoller(pController->poller);
+	free(pController->pilots);
+	free(pController->stopped);
+	free(pController->moving);
+	free(pController->last_command);
+	free(pController->trajectories);
+	free(pController->applied_epochs);
+	free(pController->bumped);
+	munmap(pController, pController->shared_size);
+}
+
+bool_e Controller_post(Controller* pController, const Command* pCommand)
+{
+	int pilot = pCommand->robot / pController->nb_workers;
+	if(pCommand->type == COMMAND_VELOCITY)
+	{
+		//A velocity not applied yet is stale, the latest one wins.
+		uint64_t* pSlot = &pController->velocity[pilot];
+		if(Trace_isEnabled() == TRUE)
+		{
+			//Written even when zeroed, an older trace is not given to this velocity.
+			Controller_writeTrace(&pController->traces[pilot], &pCommand->trace);
+		}
+		//Counted before the slot is written, the control thread reads it once the velocity is taken.
+		__atomic_store_n(&pController->velocity_epochs[pilot], pController->velocity_epochs[pilot] + 1, __ATOMIC_RELEASE);
+		if(__atomic_exchange_n(pSlot, Controller_pack(&pCommand->vector), __ATOMIC_RELEASE) != CONTROLLER_NO_VELOCITY)
+		{
+			pController->nb_velocity_overwritten++;
+		}
+		__atomic_store_n(&pController->velocity_pending, TRUE, __ATOMIC_RELEASE);
+		pController->posted = TRUE;
+		if(Pilot_isStill(&pCommand->vector) == TRUE)
+		{
+			//Does not wait for the end of the loop of the network thread.
+			Controller_signal(pController->wake_fd);
+		}
+		return TRUE;
+	}
+	if(pCommand->type == COMMAND_TRAJECTORY)
+	{
+		Command command = *pCommand;
+		command.epoch = pController->velocity_epochs[pilot];
+		if(Ring_push(pController->commands, &command) == FALSE)
+		{
+			pController->nb_commands_dropped++;
+			return FALSE;
+		}
+		pController->posted = TRUE;
+		return TRUE;
+	}
+	if(Ring_push(pController->commands, pCommand) == FALSE)
+	{
+		pController->nb_commands_dropped++;
+		return FALSE;
+	}
+	pController->posted = TRUE;
+	return TRUE;
+}
+
+bool_e Controller_wake(Controller* pController)
+{
+	if(Controller_takeWake(pController) == TRUE)
+	{
+		Controller_signal(pController->wake_fd);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+bool_e Controller_takeWake(Controller* pController)
+{
+	bool_e posted = pController->posted;
+	pController->posted = FALSE;
+	return posted;
+}
+
+void Controller_requestStop(Controller* pController, int robot)
+{
+	__atomic_store_n(&pController->stop_requested[robot / pController->nb_workers], TRUE, __ATOMIC_RELAXED);
+	__atomic_store_n(&pController->stop_pending, TRUE, __ATOMIC_RELEASE);
+	Controller_signal(pController->wake_fd);
+}
+
+bool_e Controller_collect(Controller* pController, Telemetry* pTelemetry)
+{
+	return Ring_pop(pController->telemetry, pTelemetry);
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static size_t Controller_align(size_t size)
+{
+	return (size + RING_CACHE_LINE - 1) / RING_CACHE_LINE * RING_CACHE_LINE;
+}
+
+static void* Controller_carve(uint8_t** ppNext, size_t size)
+{
+	void* part = *ppNext;
+	*ppNext += Controller_align(size);
+	return part;
+}
+
+static void Controller_fork(Controller* pController)
+{
+	struct sigaction action;
+	sigset_t signals;
+	pid_t parent = getpid();
+	//Written once by each process otherwise.
+	fflush(stdout);
+	pController->pid = fork();
+	if(pController->pid == -1)
+	{
+		perror("ERROR : the control process could not be created");
+		pController->running = FALSE;
+		return;
+	}
+	if(pController->pid > 0)
+	{
+		return;
+	}
+	//No robot is left driven once the commando which routes its commands is gone : SIGTERM, not SIGKILL,
+	//the motors are stopped by the pilots before the process exits.
+	process_controller = pController;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = Controller_onTerm;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGTERM, &action, NULL);
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_UNBLOCK, &signals, NULL);
+	prctl(PR_SET_PDEATHSIG, SIGTERM);
+	if(getppid() != parent)
+	{
+		//Gone before the prctl.
+		Controller_onTerm(SIGTERM);
+	}
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		Pilot_start(pController->pilots[i]);
+	}
+	Controller_setRealtime(pController, pthread_self());
+	Controller_run(pController);
+	//Every pilot, also those of a loop left while a stop was still pending.
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		__atomic_store_n(&pController->stop_requested[i], TRUE, __ATOMIC_RELAXED);
+	}
+	Controller_stopPilots(pController);
+	Controller_report(pController);
+	fflush(stdout);
+	_exit(0);
+}
+
+static void Controller_onTerm(int signum)
+{
+	uint64_t value = 1;
+	(void) signum;
+	//As Controller_stop, with what is safe in a signal handler only.
+	for(int i = 0; i < process_controller->nb_pilots; i++)
+	{
+		__atomic_store_n(&process_controller->stop_requested[i], TRUE, __ATOMIC_RELAXED);
+	}
+	__atomic_store_n(&process_controller->stop_pending, TRUE, __ATOMIC_RELEASE);
+	__atomic_store_n(&process_controller->running, FALSE, __ATOMIC_RELEASE);
+	if(write(process_controller->wake_fd, &value, sizeof(value)) == -1)
+	{
+		//Already signaled.
+	}
+}
+
+static void Controller_setRealtime(Controller* pController, pthread_t thread)
+{
+	if(pController->realtime == TRUE)
+	{
+		struct sched_param param = {.sched_priority = CONTROLLER_PRIORITY};
+		int error = pthread_setschedparam(thread, SCHED_FIFO, &param);
+		if(error != 0)
+		{
+			printf("ERROR : the control thread is not real-time : %s\n", strerror(error));
+		}
+	}
+}
+
+static void Controller_report(Controller* pController)
+{
+	if(pController->nb_commands_dropped > 0 || pController->nb_telemetry_dropped > 0)
+	{
+		printf("LOG_STATS : %lu commands and %lu telemetry samples dropped between the threads\n",
+				pController->nb_commands_dropped, pController->nb_telemetry_dropped);
+	}
+	if(pController->nb_velocity_overwritten > 0)
+	{
+		printf("LOG_STATS : %lu stale velocity commands overwritten before being applied\n", pController->nb_velocity_overwritten);
+	}
+	if(pController->nb_watchdog_trips > 0)
+	{
+		printf("LOG_WATCHDOG : %lu robot(s) stopped, reaction after the deadline %.3f ms mean, %.3f ms max\n",
+				pController->nb_watchdog_trips,
+				pController->watchdog_reaction_total_ns / 1e6 / pController->nb_watchdog_trips,
+				pController->watchdog_reaction_max_ns / 1e6);
+	}
+	unsigned long nb_applied = 0;
+	unsigned long nb_rejected = 0;
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		nb_applied += pController->trajectories[i].nb_applied;
+		nb_rejected += pController->trajectories[i].nb_rejected;
+	}
+	if(nb_applied > 0 || nb_rejected > 0 || pController->nb_trajectories_discarded > 0)
+	{
+		printf("LOG_TRAJECTORY : %lu segments applied, %lu rejected, %lu overtaken by a velocity\n",
+				nb_applied, nb_rejected, pController->nb_trajectories_discarded);
+	}
+	unsigned long nb_events = 0;
+	unsigned long nb_dropped = 0;
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		nb_events += pController->pilots[i]->nb_events;
+		nb_dropped += __atomic_load_n(&pController->pilots[i]->nb_dropped, __ATOMIC_RELAXED);
+	}
+	if(nb_events > 0)
+	{
+		printf("LOG_PILOT : %lu events run to completion, %lu dropped on a full queue\n", nb_events, nb_dropped);
+	}
+	RobotBumpStats bumps = {0, 0, 0};
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		RobotBumpStats stats = Robot_getBumpStats(pController->pilots[i]->robot);
+		bumps.nb_bumps += stats.nb_bumps;
+		bumps.latency_total_ns += stats.latency_total_ns;
+		if(stats.latency_max_ns > bumps.latency_max_ns)
+		{
+			bumps.latency_max_ns = stats.latency_max_ns;
+		}
+	}
+	if(bumps.nb_bumps > 0)
+	{
+		printf("LOG_BUMP : %lu bump(s), motors stopped %.3f ms mean, %.3f ms max after the last sample released\n",
+				bumps.nb_bumps, bumps.latency_total_ns / 1e6 / bumps.nb_bumps, bumps.latency_max_ns / 1e6);
+	}
+	RobotPollStats poll = Robot_getPollStats(pController->poller);
+	if(poll.nb_overruns > 0)
+	{
+		printf("LOG_POLL : %lu ticks every %d us, %lu overran by %.3f us max, %lu deadlines missed\n",
+				poll.nb_ticks, ROBOT_CODER_PERIOD_US, poll.nb_overruns, poll.overrun_max_ns / 1e3, poll.nb_missed);
+	}
+	if(pController->nb_ticks > 0)
+	{
+		printf("LOG_CONTROL : %lu ticks at %u Hz, wake up late by %.3f us mean, %.3f us max, %lu deadlines missed\n",
+				pController->nb_ticks, pController->rate_hz, pController->jitter_total_ns / 1e3 / pController->nb_ticks,
+				pController->jitter_max_ns / 1e3, pController->nb_missed);
+	}
+}
+
+static void* Controller_run(void* pArg)
+{
+	Controller* pController = (Controller*) pArg;
+	Command command;
+	uint64_t value;
+	struct pollfd fds[3] = {{pController->wake_fd, POLLIN, 0}, {pController->watchdog_fd, POLLIN, 0},
+			{pController->trajectory_fd, POLLIN, 0}};
+	if(pController->rate_hz > 0)
+	{
+		Controller_runPeriodic(pController);
+		return NULL;
+	}
+	for(;;)
+	{
+		//The stops and the velocities posted meanwhile overtake the commands still queued.
+		Controller_runUrgent(pController);
+		while(Ring_pop(pController->commands, &command) == TRUE)
+		{
+			//Also the velocities posted before the command popped, a trajectory must not be cancelled by an older one.
+			Controller_runUrgent(pController);
+			if(pController->stopped[command.robot / pController->nb_workers] == FALSE)
+			{
+				Controller_execute(pController, &command);
+			}
+		}
+		Controller_runTrajectories(pController);
+		if(__atomic_load_n(&pController->running, __ATOMIC_ACQUIRE) == FALSE && Ring_isEmpty(pController->commands) == TRUE)
+		{
+			break;
+		}
+		if(pController->watchdog_fd != -1 || pController->trajectory_fd != -1)
+		{
+			if(pController->watchdog_fd != -1)
+			{
+				//Without a watchdog, only the segments due wake the thread up.
+				Controller_armWatchdog(pController);
+			}
+			//Blocks until the network thread posts something, a deadline is over or a segment is due.
+			if(poll(fds, 3, -1) == -1)
+			{
+				if(errno != EINTR)
+				{
+					perror("ERROR : control thread wake up");
+				}
+				continue;
+			}
+			if(fds[2].revents & POLLIN)
+			{
+				//The segments due are applied at the top of the loop.
+				pController->trajectory_armed = FALSE;
+				if(read(pController->trajectory_fd, &value, sizeof(value)) == -1)
+				{
+					perror("ERROR : trajectory");
+				}
+			}
+			if(fds[1].revents & POLLIN)
+			{
+				pController->watchdog_armed = FALSE;
+				if(read(pController->watchdog_fd, &value, sizeof(value)) == -1)
+				{
+					perror("ERROR : watchdog");
+				}
+				Controller_checkWatchdog(pController);
+			}
+			if((fds[0].revents & POLLIN) == 0)
+			{
+				continue;
+			}
+		}
+		//Blocks until the network thread posts something, the counter is reset by the read.
+		if(read(pController->wake_fd, &value, sizeof(value)) == -1 && errno != EINTR)
+		{
+			perror("ERROR : control thread wake up");
+		}
+	}
+	return NULL;
+}
+
+static void Controller_runPeriodic(Controller* pController)
+{
+	Command command;
+	struct timespec deadline;
+	struct timespec now;
+	long period_ns = 1000000000L / pController->rate_hz;
+	long late;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	for(;;)
+	{
+		Controller_runUrgent(pController);
+		while(Ring_pop(pController->commands, &command) == TRUE)
+		{
+			Controller_runUrgent(pController);
+			if(pController->stopped[command.robot / pController->nb_workers] == FALSE)
+			{
+				Controller_execute(pController, &command);
+			}
+		}
+		Controller_runTrajectories(pController);
+		if(pController->watchdog_ms > 0)
+		{
+			Controller_checkWatchdog(pController);
+		}
+		Controller_sample(pController);
+		if(__atomic_load_n(&pController->running, __ATOMIC_ACQUIRE) == FALSE && Ring_isEmpty(pController->commands) == TRUE)
+		{
+			break;
+		}
+		//Absolute deadlines, the time spent in the tick does not shift the next ones.
+		deadline.tv_nsec += period_ns;
+		deadline.tv_sec += deadline.tv_nsec / 1000000000;
+		deadline.tv_nsec %= 1000000000;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		late = (now.tv_sec - deadline.tv_sec) * 1000000000L + (now.tv_nsec - deadline.tv_nsec);
+		if(late >= 0)
+		{
+			//The tick overran : the deadlines already over are skipped, the phase is kept.
+			long nb_missed = late / period_ns + 1;
+			pController->nb_missed += nb_missed;
+			deadline.tv_nsec += (nb_missed * period_ns) % 1000000000;
+			deadline.tv_sec += (nb_missed * period_ns) / 1000000000 + deadline.tv_nsec / 1000000000;
+			deadline.tv_nsec %= 1000000000;
+		}
+		while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR);
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		late = (now.tv_sec - deadline.tv_sec) * 1000000000L + (now.tv_nsec - deadline.tv_nsec);
+		pController->nb_ticks++;
+		pController->jitter_total_ns += late;
+		if(late > pController->jitter_max_ns)
+		{
+			pController->jitter_max_ns = late;
+		}
+	}
+}
+
+static void Controller_sample(Controller* pController)
+{
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		if(pController->stopped[i] == TRUE)
+		{
+			continue;
+		}
+		Pilot_check(pController->pilots[i]);
+		if(pController->moving[i] == TRUE && Pilot_isStill(&pController->pilots[i]->vector) == TRUE)
+		{
+			//Stopped by a bump, the next segments would drive it into the obstacle.
+			pController->moving[i] = FALSE;
+			Trajectory_cancel(&pController->trajectories[i]);
+		}
+	}
+}
+
+static void Controller_stopPilots(Controller* pController)
+{
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		if(pController->stopped[i] == FALSE && __atomic_load_n(&pController->stop_requested[i], __ATOMIC_RELAXED) == TRUE)
+		{
+			Pilot_stop(pController->pilots[i]);
+			Trajectory_cancel(&pController->trajectories[i]);
+			pController->stopped[i] = TRUE;
+			pController->moving[i] = FALSE;
+		}
+	}
+}
+
+static void Controller_onBump(void* pContext, int pilot)
+{
+	Controller* pController = (Controller*) pContext;
+	//Posted right from the polling thread, the state machine runs it on the control thread.
+	Pilot_post(pController->pilots[pilot], CHECKED_E, NULL);
+	__atomic_store_n(&pController->bumped[pilot], TRUE, __ATOMIC_RELAXED);
+	__atomic_store_n(&pController->bump_pending, TRUE, __ATOMIC_RELEASE);
+	Controller_signal(pController->wake_fd);
+}
+
+static void Controller_runBumps(Controller* pController)
+{
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		if(__atomic_load_n(&pController->bumped[i], __ATOMIC_RELAXED) == FALSE
+				|| __atomic_exchange_n(&pController->bumped[i], FALSE, __ATOMIC_RELAXED) == FALSE)
+		{
+			continue;
+		}
+		if(pController->stopped[i] == FALSE)
+		{
+			//The motors are stopped already, the state machine and the trajectory follow.
+			Pilot_dispatch(pController->pilots[i]);
+			Trajectory_cancel(&pController->trajectories[i]);
+			pController->moving[i] = FALSE;
+			printf("LOG_BUMP : robot %d stopped\n", pController->worker + i * pController->nb_workers);
+		}
+	}
+}
+
+static void Controller_runUrgent(Controller* pController)
+{
+	Command command = {.type = COMMAND_VELOCITY};
+	uint64_t slot;
+	//Loaded before being exchanged, the cache line is written only when something is posted.
+	if(__atomic_load_n(&pController->stop_pending, __ATOMIC_RELAXED) == TRUE
+			&& __atomic_exchange_n(&pController->stop_pending, FALSE, __ATOMIC_ACQUIRE) == TRUE)
+	{
+		Controller_stopPilots(pController);
+	}
+	if(__atomic_load_n(&pController->bump_pending, __ATOMIC_RELAXED) == TRUE
+			&& __atomic_exchange_n(&pController->bump_pending, FALSE, __ATOMIC_ACQUIRE) == TRUE)
+	{
+		Controller_runBumps(pController);
+	}
+	if(__atomic_load_n(&pController->velocity_pending, __ATOMIC_RELAXED) == FALSE
+			|| __atomic_exchange_n(&pController->velocity_pending, FALSE, __ATOMIC_ACQUIRE) == FALSE)
+	{
+		return;
+	}
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		if(__atomic_load_n(&pController->velocity[i], __ATOMIC_RELAXED) == CONTROLLER_NO_VELOCITY)
+		{
+			continue;
+		}
+		slot = __atomic_exchange_n(&pController->velocity[i], CONTROLLER_NO_VELOCITY, __ATOMIC_ACQUIRE);
+		//At least the epoch of the velocity taken, a newer one is applied next anyway.
+		pController->applied_epochs[i] = __atomic_load_n(&pController->velocity_epochs[i], __ATOMIC_ACQUIRE);
+		if(pController->stopped[i] == FALSE)
+		{
+			command.robot = pController->worker + i * pController->nb_workers;
+			command.vector = Controller_unpack(slot);
+			if(Trace_isEnabled() == TRUE)
+			{
+				Controller_readTrace(&pController->traces[i], &command.trace);
+			}
+			Controller_execute(pController, &command);
+		}
+	}
+}
+
+static uint64_t Controller_pack(const VelocityVector* pVector)
+{
+	int power = (pVector->power > INT16_MAX)? INT16_MAX : ((pVector->power < -INT16_MAX)? -INT16_MAX : pVector->power);
+	int angular = (pVector->angular > INT16_MAX)? INT16_MAX : ((pVector->angular < -INT16_MAX)? -INT16_MAX : pVector->angular);
+	return ((uint64_t) (uint32_t) pVector->dir << 32) | ((uint64_t) (uint16_t) power << 16) | (uint16_t) angular;
+}
+
+static VelocityVector Controller_unpack(uint64_t slot)
+{
+	VelocityVector vector = {.dir = (Direction) (uint32_t) (slot >> 32), .power = (int16_t) (uint16_t) (slot >> 16),
+			.angular = (int16_t) (uint16_t) slot};
+	return vector;
+}
+
+static void Controller_writeTrace(ControllerTrace* pSlot, const Trace* pTrace)
+{
+	unsigned long sequence = pSlot->sequence;
+	__atomic_store_n(&pSlot->sequence, sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	for(int stage = 0; stage < TRACE_NB_STAGES; stage++)
+	{
+		__atomic_store_n(&pSlot->trace.stamps[stage], pTrace->stamps[stage], __ATOMIC_RELAXED);
+	}
+	__atomic_store_n(&pSlot->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+static void Controller_readTrace(ControllerTrace* pSlot, Trace* pTrace)
+{
+	unsigned long sequence = __atomic_load_n(&pSlot->sequence, __ATOMIC_ACQUIRE);
+	memset(pTrace, 0, sizeof(Trace));
+	if((sequence & 1) != 0 || sequence == pSlot->seen)
+	{
+		return;
+	}
+	for(int stage = 0; stage < TRACE_NB_STAGES; stage++)
+	{
+		pTrace->stamps[stage] = __atomic_load_n(&pSlot->trace.stamps[stage], __ATOMIC_RELAXED);
+	}
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if(__atomic_load_n(&pSlot->sequence, __ATOMIC_RELAXED) != sequence)
+	{
+		//Rewritten by a newer velocity meanwhile, which is applied next.
+		memset(pTrace, 0, sizeof(Trace));
+		return;
+	}
+	pSlot->seen = sequence;
+}
+
+static void Controller_execute(Controller* pController, const Command* pCommand)
+{
+	int pilot = pCommand->robot / pController->nb_workers;
+	Pilot* pPilot = pController->pilots[pilot];
+	Telemetry telemetry;
+	Trace trace;
+	if(pCommand->type != COMMAND_SAMPLE && pController->watchdog_ms > 0)
+	{
+		//The samples are asked by the commando itself, they do not tell the telco is alive.
+		clock_gettime(CLOCK_MONOTONIC, &pController->last_command[pilot]);
+	}
+	switch(pCommand->type)
+	{
+		case COMMAND_VELOCITY:
+			trace = pCommand->trace;
+			if(trace.stamps[TRACE_CAPTURE] != 0)
+			{
+				trace.stamps[TRACE_DISPATCH] = Trace_now();
+			}
+			//Driven by hand from now on.
+			Trajectory_cancel(&pController->trajectories[pilot]);
+			Controller_drive(pController, pilot, &pCommand->vector);
+			if(trace.stamps[TRACE_CAPTURE] != 0)
+			{
+				//Both Motor_setCmd have returned.
+				trace.stamps[TRACE_MOTOR] = Trace_now();
+				Trace_record(&trace);
+			}
+			break;
+		case COMMAND_TRAJECTORY:
+			Controller_addSegment(pController, pCommand);
+			break;
+		case COMMAND_CHECK:
+		case COMMAND_SAMPLE:
+			Pilot_check(pPilot);
+			telemetry.type = pCommand->type;
+			telemetry.robot = pCommand->robot;
+			telemetry.connection = pCommand->connection;
+			telemetry.generation = pCommand->generation;
+			telemetry.request = pCommand->request;
+			telemetry.state = Pilot_getState(pPilot);
+			//In the timebase of the commando, the telco gets the age of the sample with its clock offset.
+			telemetry.state.sampled = Trace_now();
+			if(Ring_push(pController->telemetry, &telemetry) == TRUE)
+			{
+				Controller_signal(pController->notify_fd);
+			}
+			else
+			{
+				pController->nb_telemetry_dropped++;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+static void Controller_armWatchdog(Controller* pController)
+{
+	struct itimerspec timer = {{0, 0}, {0, 0}};
+	bool_e moving = FALSE;
+	if(pController->watchdog_armed == TRUE)
+	{
+		//Fed since it was armed, it expires early and is armed again at the new deadline.
+		return;
+	}
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		if(pController->moving[i] == TRUE)
+		{
+			struct timespec deadline = Controller_getDeadline(pController, i);
+			if(moving == FALSE || deadline.tv_sec < timer.it_value.tv_sec
+					|| (deadline.tv_sec == timer.it_value.tv_sec && deadline.tv_nsec < timer.it_value.tv_nsec))
+			{
+				timer.it_value = deadline;
+			}
+			moving = TRUE;
+		}
+	}
+	if(moving == TRUE)
+	{
+		if(timerfd_settime(pController->watchdog_fd, TFD_TIMER_ABSTIME, &timer, NULL) == -1)
+		{
+			perror("ERROR : watchdog");
+			return;
+		}
+		pController->watchdog_armed = TRUE;
+	}
+}
+
+static void Controller_checkWatchdog(Controller* pController)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		struct timespec deadline = Controller_getDeadline(pController, i);
+		if(pController->moving[i] == FALSE || pController->stopped[i] == TRUE
+				|| now.tv_sec < deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec < deadline.tv_nsec))
+		{
+			continue;
+		}
+		//Through the state machine, as a STOP from the telco would be, the trajectory is over too.
+		VelocityVector stop = {.dir = STOP, .power = 0};
+		Trajectory_cancel(&pController->trajectories[i]);
+		Controller_drive(pController, i, &stop);
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		long reaction = (now.tv_sec - deadline.tv_sec) * 1000000000L + (now.tv_nsec - deadline.tv_nsec);
+		pController->nb_watchdog_trips++;
+		pController->watchdog_reaction_total_ns += reaction;
+		if(reaction > pController->watchdog_reaction_max_ns)
+		{
+			pController->watchdog_reaction_max_ns = reaction;
+		}
+		printf("LOG_WATCHDOG : robot %d stopped, no command for %u ms (reaction %.3f ms)\n",
+				pController->worker + i * pController->nb_workers, pController->watchdog_ms, reaction / 1e6);
+	}
+}
+
+static struct timespec Controller_getDeadline(Controller* pController, int pilot)
+{
+	struct timespec deadline = pController->last_command[pilot];
+	deadline.tv_nsec += (long) (pController->watchdog_ms % 1000) * 1000000;
+	deadline.tv_sec += pController->watchdog_ms / 1000 + deadline.tv_nsec / 1000000000;
+	deadline.tv_nsec %= 1000000000;
+	return deadline;
+}
+
+static void Controller_drive(Controller* pController, int pilot, const VelocityVector* pVector)
+{
+	pController->pilots[pilot]->vector = *pVector;
+	Pilot_setVelocity(pController->pilots[pilot]);
+	pController->moving[pilot] = (Pilot_isStill(pVector) == TRUE)? FALSE : TRUE;
+}
+
+static void Controller_addSegment(Controller* pController, const Command* pCommand)
+{
+	int pilot = pCommand->robot / pController->nb_workers;
+	Trajectory* pTrajectory = &pController->trajectories[pilot];
+	struct timespec now;
+	if(pCommand->epoch < pController->applied_epochs[pilot])
+	{
+		//A velocity posted after it has been applied already, the telco drives by hand.
+		pController->nb_trajectories_discarded++;
+		return;
+	}
+	if(pCommand->flags & TRAJECTORY_CANCEL)
+	{
+		VelocityVector stop = {.dir = STOP, .power = 0};
+		Trajectory_cancel(pTrajectory);
+		Controller_drive(pController, pilot, &stop);
+		return;
+	}
+	if((pCommand->flags & TRAJECTORY_APPEND) == 0)
+	{
+		Trajectory_cancel(pTrajectory);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if(Trajectory_append(pTrajectory, &pCommand->segment, &now) == TRUE)
+	{
+		pController->trajectories_pending = TRUE;
+	}
+}
+
+static void Controller_runTrajectories(Controller* pController)
+{
+	struct itimerspec timer = {{0, 0}, {0, 0}};
+	struct timespec now;
+	struct timespec deadline;
+	VelocityVector vector;
+	bool_e pending = FALSE;
+	if(pController->trajectories_pending == FALSE)
+	{
+		return;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	for(int i = 0; i < pController->nb_pilots; i++)
+	{
+		if(pController->stopped[i] == FALSE && Trajectory_next(&pController->trajectories[i], &now, &vector) == TRUE)
+		{
+			Controller_drive(pController, i, &vector);
+		}
+		if(Trajectory_getDeadline(&pController->trajectories[i], &deadline) == TRUE)
+		{
+			if(pending == FALSE || deadline.tv_sec < timer.it_value.tv_sec
+					|| (deadline.tv_sec == timer.it_value.tv_sec && deadline.tv_nsec < timer.it_value.tv_nsec))
+			{
+				timer.it_value = deadline;
+			}
+			pending = TRUE;
+		}
+	}
+	pController->trajectories_pending = pending;
+	if(pending == FALSE || pController->trajectory_fd == -1)
+	{
+		//A timer still armed expires for nothing.
+		return;
+	}
+	if(pController->trajectory_armed == TRUE && (pController->trajectory_deadline.tv_sec < timer.it_value.tv_sec
+			|| (pController->trajectory_deadline.tv_sec == timer.it_value.tv_sec
+			&& pController->trajectory_deadline.tv_nsec <= timer.it_value.tv_nsec)))
+	{
+		//Expires first, the loop comes back here then.
+		return;
+	}
+	if(timerfd_settime(pController->trajectory_fd, TFD_TIMER_ABSTIME, &timer, NULL) == -1)
+	{
+		perror("ERROR : trajectory");
+		return;
+	}
+	pController->trajectory_armed = TRUE;
+	pController->trajectory_deadline = timer.it_value;
+}
+
+static void Controller_signal(int fd)
+{
+	uint64_t value = 1;
+	if(write(fd, &value, sizeof(value)) == -1)
+	{
+		perror("ERROR : eventfd");
+	}
+}
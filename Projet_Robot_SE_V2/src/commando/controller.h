@@ -0,0 +1,262 @@
+/**
+ * @file  controller.h
+ *
+ * @brief Control thread driving the pilot, fed by the network thread through lock-free rings.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+#ifndef SRC_COMMANDO_CONTROLLER_H_
+#define SRC_COMMANDO_CONTROLLER_H_
+/* ----------------------  INCLUDES ------------------------------------------*/
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+#include "../commun.h"
+#include "../commun/ring.h"
+#include "../commun/trace.h"
+#include "pilot.h"
+#include "trajectory.h"
+/* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/**
+ * \brief Number of commands waiting for the control thread.
+ */
+#define CONTROLLER_COMMANDS (256)
+/**
+ * \brief Number of telemetry samples waiting for the network thread.
+ */
+#define CONTROLLER_TELEMETRY (256)
+/**
+ * \brief Default deadline of the dead-man watchdog: a moving robot without command for that long is stopped.
+ */
+#define CONTROLLER_WATCHDOG_MS (500)
+/**
+ * \struct Controller
+ * \brief Controller object.
+ */
+typedef struct Controller_t Controller;
+/* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
+/**
+ * \enum CommandType
+ * \brief What the network thread asks to the control thread.
+ */
+typedef enum
+{
+	COMMAND_VELOCITY = 0, /**< apply vector */
+	COMMAND_CHECK,        /**< check the sensors and answer to the connection */
+	COMMAND_SAMPLE,       /**< check the sensors for the telemetry subscribers */
+	COMMAND_HEARTBEAT,    /**< the telco of the robot is alive, only feeds the watchdog */
+	COMMAND_TRAJECTORY    /**< buffer a segment of the trajectory of the robot, or cancel it */
+}CommandType;
+/* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
+/**
+ * \struct Command
+ * \brief Element of the ring from the network thread to the control thread.
+ */
+typedef struct
+{
+	CommandType type;
+	int robot; //id of the robot in the fleet.
+	int connection; //socket of the telco to answer to (COMMAND_CHECK).
+	unsigned int generation; //generation of that connection, in case the socket is reused.
+	unsigned int request; //id of the request of the telco, echoed in the answer (COMMAND_CHECK).
+	VelocityVector vector; //COMMAND_VELOCITY.
+	Trace trace; //stages of a traced COMMAND_VELOCITY before the control thread, zeroed otherwise.
+	uint32_t flags; //TrajectoryFlag of a COMMAND_TRAJECTORY.
+	TrajectorySegment segment; //COMMAND_TRAJECTORY, unused with TRAJECTORY_CANCEL.
+	unsigned long epoch; //velocities posted before the COMMAND_TRAJECTORY, set by Controller_post.
+}Command;
+/**
+ * \struct Telemetry
+ * \brief Element of the ring from the control thread to the network thread.
+ */
+typedef struct
+{
+	CommandType type; //COMMAND_CHECK for an answer, COMMAND_SAMPLE for the subscribers.
+	int robot;
+	int connection;
+	unsigned int generation;
+	unsigned int request;
+	PilotState state;
+}Telemetry;
+/**
+ * \struct ControllerTrace
+ * \brief Trace of the velocity in a slot, a seqlock written by the network thread when Trace_isEnabled.
+ */
+typedef struct
+{
+	unsigned long sequence; //odd while the trace is written.
+	Trace trace;
+	unsigned long seen; //sequence of the last trace read (control thread only).
+}ControllerTrace;
+/**
+ * \struct Controller_t
+ * \brief The control thread may run in a child process (Controller_setProcess) : the object, what the network
+ *        thread writes and the memory of the rings are in a shared mapping, the arrays of the control thread are copied.
+ */
+struct Controller_t
+{
+	Pilot** pilots; //robots of this worker : the robot r is pilots[r / nb_workers].
+	RobotPoller* poller; //polls the robots of this worker only.
+	int nb_pilots;
+	int worker; //index of this worker.
+	int nb_workers;
+	bool_e* stopped; //pilots stopped (control thread only).
+	bool_e* stop_requested; //pilots to stop, set by the network thread.
+	pthread_t thread;
+	Ring* commands; //network thread -> control thread.
+	Ring* telemetry; //control thread -> network thread.
+	int wake_fd; //eventfd waking the control thread up.
+	int notify_fd; //eventfd telling the network thread telemetry is available, shared by the workers.
+	bool_e posted; //commands posted since the last wake up (network thread only).
+	bool_e running;
+	bool_e stop_pending; //some stop_requested have been set.
+	uint64_t* velocity; //latest velocity of each pilot not applied yet (packed VelocityVector), set by the network thread.
+	bool_e velocity_pending; //some velocity slots are set.
+	unsigned long nb_velocity_overwritten; //velocity commands replaced by a newer one before being applied.
+	ControllerTrace* traces; //trace of the velocity of each slot.
+	unsigned long nb_commands_dropped; //commands lost because the control thread is late.
+	unsigned long nb_telemetry_dropped; //samples lost because the network thread is late.
+	unsigned int watchdog_ms; //deadline of the watchdog, 0 to disable it.
+	int watchdog_fd; //timerfd expiring at the earliest deadline of the moving robots (control thread only).
+	bool_e watchdog_armed;
+	bool_e* moving; //pilots whose last velocity is not a STOP (control thread only).
+	struct timespec* last_command; //time of the last command from the telco of each pilot (control thread only).
+	unsigned long nb_watchdog_trips; //robots stopped by the watchdog.
+	long watchdog_reaction_max_ns; //longest time between a deadline and the STOP of the wheels.
+	long long watchdog_reaction_total_ns;
+	Trajectory* trajectories; //segments buffered for each pilot (control thread only).
+	bool_e trajectories_pending; //some trajectories have segments left (control thread only).
+	int trajectory_fd; //timerfd expiring when the earliest segment is due (control thread only).
+	bool_e trajectory_armed;
+	struct timespec trajectory_deadline; //expiry of trajectory_fd when armed.
+	unsigned long* velocity_epochs; //velocities posted for each pilot (network thread, read by the control thread).
+	unsigned long* applied_epochs; //velocity_epochs seen when a velocity is applied, a trajectory posted before is stale.
+	unsigned long nb_trajectories_discarded; //segments overtaken by a velocity posted after them.
+	unsigned int rate_hz; //rate of the periodic control loop, 0 to act on the commands only.
+	bool_e realtime; //the control thread runs with SCHED_FIFO.
+	bool_e process; //the control loop runs in a child process, with its own Intox session.
+	pid_t pid; //of that child process.
+	size_t shared_size; //of the mapping starting with the object.
+	unsigned long nb_ticks;
+	unsigned long nb_missed; //deadlines skipped because a tick overran its period.
+	long jitter_max_ns; //longest time between a deadline and the wake up of the control thread.
+	long long jitter_total_ns;
+	bool_e* bumped; //pilots whose robot bumped, set by the polling thread of the worker.
+	bool_e bump_pending; //some bumped have been set.
+};
+/* ----------------------  PUBLIC VARIBLES -----------------------------------*/
+/* ----------------------  PUBLIC FUNCTIONS PROTOTYPES  ----------------------*/
+/**
+ * \fn extern Controller* Controller_new(int worker, int nb_workers, int nb_robots, const RobotConfig* pConfigs, int notify_fd)
+ * \brief Initialize in memory the object Controller and the pilots of its robots.
+ *
+ * \param int worker : index of this worker, it drives the robots r such that r % nb_workers == worker.
+ * \param const RobotConfig* pConfigs : nb_robots configurations, NULL for the default ones.
+ * \param int notify_fd : eventfd signaled when telemetry is available, not closed by the Controller.
+ */
+extern Controller* Controller_new(int worker, int nb_workers, int nb_robots, const RobotConfig* pConfigs, int notify_fd);
+/**
+ * \fn extern void Controller_setWatchdog(Controller* pController, unsigned int deadline_ms)
+ * \brief Set the deadline of the dead-man watchdog before Controller_start, 0 to disable it.
+ */
+extern void Controller_setWatchdog(Controller* pController, unsigned int deadline_ms);
+/**
+ * \fn extern void Controller_setRate(Controller* pController, unsigned int rate_hz, bool_e realtime)
+ * \brief Before Controller_start, run the control thread every 1/rate_hz s (0 to act on the commands only) :
+ *        each tick applies the commands posted, samples the sensors and stops a robot which has bumped.
+ *
+ * \param bool_e realtime : run the control thread with SCHED_FIFO, it keeps the default policy if not allowed.
+ */
+extern void Controller_setRate(Controller* pController, unsigned int rate_hz, bool_e realtime);
+/**
+ * \fn extern void Controller_setProcess(Controller* pController, bool_e process)
+ * \brief Before Controller_start, run the pilots and the control loop in a child process instead of a thread :
+ *        libinfox holds a single Intox session per process, a worker on another simulator needs its own.
+ */
+extern void Controller_setProcess(Controller* pController, bool_e process);
+/**
+ * \fn extern void Controller_setMotionProfile(Controller* pController, float acceleration, float jerk)
+ * \brief Set the limits of the ramps of the wheels of the robots of the Controller, see Robot_setMotionProfile.
+ */
+extern void Controller_setMotionProfile(Controller* pController, float acceleration, float jerk);
+/**
+ * \fn extern void Controller_start(Controller* pController)
+ * \brief Start the pilots and the control thread, or the control process.
+ */
+extern void Controller_start(Controller* pController);
+/**
+ * \fn extern void Controller_stop(Controller* pController)
+ * \brief Let the control thread execute the commands already posted, stop every pilot and join it (or wait for its process).
+ */
+extern void Controller_stop(Controller* pController);
+/**
+ * \fn extern void Controller_free(Controller* pController)
+ * \brief Destruct the object Controller and its pilots from memory.
+ */
+extern void Controller_free(Controller* pController);
+/**
+ * \fn extern bool_e Controller_post(Controller* pController, const Command* pCommand)
+ * \brief Give a command to the control thread, never blocks (network thread).
+ *        A COMMAND_VELOCITY replaces the one of its robot not applied yet (the latest wins) and
+ *        overtakes the commands queued; a STOP also wakes the control thread up at once.
+ *        The other commands are queued in order, the control thread is woken up by Controller_wake.
+ *        A COMMAND_VELOCITY cancels the trajectory of its robot, even one posted before it and still queued.
+ *
+ * \return bool_e : FALSE if the command has been dropped because the ring is full.
+ */
+extern bool_e Controller_post(Controller* pController, const Command* pCommand);
+/**
+ * \fn extern bool_e Controller_wake(Controller* pController)
+ * \brief Wake the control thread up if commands have been posted (network thread).
+ *
+ * \return bool_e : TRUE if wake_fd has been signaled.
+ */
+extern bool_e Controller_wake(Controller* pController);
+/**
+ * \fn extern bool_e Controller_takeWake(Controller* pController)
+ * \brief Consume the need of a wake up, for a caller which signals wake_fd itself (network thread).
+ *
+ * \return bool_e : TRUE if commands have been posted since the last wake up.
+ */
+extern bool_e Controller_takeWake(Controller* pController);
+/**
+ * \fn extern void Controller_requestStop(Controller* pController, int robot)
+ * \brief Ask the control thread to stop the pilot of a robot, never blocks nor fails (network thread).
+ */
+extern void Controller_requestStop(Controller* pController, int robot);
+/**
+ * \fn extern bool_e Controller_collect(Controller* pController, Telemetry* pTelemetry)
+ * \brief Get a telemetry sample produced by the control thread (network thread).
+ *
+ * \return bool_e : FALSE if there is nothing left.
+ */
+extern bool_e Controller_collect(Controller* pController, Telemetry* pTelemetry);
+
+#endif /* SRC_COMMANDO_CONTROLLER_H_ */
@@ -0,0 +1,142 @@
+/**
+ * @file  odometry.c
+ *
+ * @brief Pose of a differential drive robot integrated from the pulses of its wheel coders.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "odometry.h"
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+#define ODOMETRY_PI (3.14159265358979323846)
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static void Odometry_integrate(Odometry* pOdometry, float distance, float rotation)
+ * \brief Move the pose along an arc of distance mm turning of rotation rad.
+ */
+static void Odometry_integrate(Odometry* pOdometry, float distance, float rotation);
+/**
+ * \fn static void Odometry_turn(float* pCos, float* pSin, float angle)
+ * \brief Turn a unit vector of a small angle (ODOMETRY_MAX_STEP / 2 at most), with its Taylor series.
+ */
+static void Odometry_turn(float* pCos, float* pSin, float angle);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+void Odometry_init(Odometry* pOdometry, float wheel_diameter_mm, float track_mm, int pulses_per_turn)
+{
+	float mm_per_pulse = ODOMETRY_PI * wheel_diameter_mm / pulses_per_turn;
+	pOdometry->pose.x = 0;
+	pOdometry->pose.y = 0;
+	pOdometry->pose.heading = 0;
+	pOdometry->cos_heading = 1;
+	pOdometry->sin_heading = 0;
+	pOdometry->heading = 0;
+	pOdometry->half_mm_per_pulse = mm_per_pulse / 2;
+	pOdometry->rad_per_pulse = mm_per_pulse / track_mm;
+	pOdometry->nb_updates = 0;
+}
+
+void Odometry_update(Odometry* pOdometry, int32_t left, int32_t right)
+{
+	pOdometry->nb_updates++;
+	if(left == 0 && right == 0)
+	{
+		//Most of the samples of the coders at a high rate.
+		return;
+	}
+	Odometry_integrate(pOdometry, (float) (left + right) * pOdometry->half_mm_per_pulse,
+			(float) (right - left) * pOdometry->rad_per_pulse);
+}
+
+int32_t Odometry_getDelta(int32_t coder, int32_t previous, int modulo)
+{
+	//The 32 bits counter wraps around.
+	int32_t delta = (int32_t) ((uint32_t) coder - (uint32_t) previous);
+	if(modulo > 0)
+	{
+		//A coder counting modulo a turn jumps by modulo when it wraps around.
+		delta %= modulo;
+		if(delta >= (modulo + 1) / 2)
+		{
+			delta -= modulo;
+		}
+		else if(delta < -(modulo / 2))
+		{
+			delta += modulo;
+		}
+	}
+	return delta;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static void Odometry_integrate(Odometry* pOdometry, float distance, float rotation)
+{
+	float half = rotation / 2;
+	float norm;
+	if(rotation > ODOMETRY_MAX_STEP || rotation < -ODOMETRY_MAX_STEP)
+	{
+		//Samples missed : the arc is integrated in halves, within the precision of the series.
+		Odometry_integrate(pOdometry, distance / 2, half);
+		Odometry_integrate(pOdometry, distance / 2, half);
+		return;
+	}
+	//Along the chord of the arc, in the middle of the headings : 2.R.sin(half) = distance.sin(half) / half.
+	Odometry_turn(&pOdometry->cos_heading, &pOdometry->sin_heading, half);
+	distance *= 1 - half * half / 6;
+	pOdometry->pose.x += distance * pOdometry->cos_heading;
+	pOdometry->pose.y += distance * pOdometry->sin_heading;
+	Odometry_turn(&pOdometry->cos_heading, &pOdometry->sin_heading, half);
+	//The rounding errors would change the length of the vector : one Newton step back to 1.
+	norm = pOdometry->cos_heading * pOdometry->cos_heading + pOdometry->sin_heading * pOdometry->sin_heading;
+	pOdometry->cos_heading *= (3 - norm) / 2;
+	pOdometry->sin_heading *= (3 - norm) / 2;
+	pOdometry->heading += rotation;
+	if(pOdometry->heading > ODOMETRY_PI)
+	{
+		pOdometry->heading -= 2 * ODOMETRY_PI;
+	}
+	else if(pOdometry->heading <= -ODOMETRY_PI)
+	{
+		pOdometry->heading += 2 * ODOMETRY_PI;
+	}
+	pOdometry->pose.heading = (float) pOdometry->heading;
+}
+
+static void Odometry_turn(float* pCos, float* pSin, float angle)
+{
+	float square = angle * angle;
+	float cos_angle = 1 - square / 2 * (1 - square / 12);
+	float sin_angle = angle * (1 - square / 6 * (1 - square / 20));
+	float cos_heading = *pCos;
+	*pCos = cos_heading * cos_angle - *pSin * sin_angle;
+	*pSin = cos_heading * sin_angle + *pSin * cos_angle;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file  odometry.h
+ *
+ * @brief Pose of a differential drive robot integrated from the pulses of its wheel coders.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef SRC_COMMANDO_ODOMETRY_H_
+#define SRC_COMMANDO_ODOMETRY_H_
+/* ----------------------  INCLUDES ------------------------------------------*/
+#include <stdint.h>
+/* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/**
+ * \brief Rotation (rad) integrated in one step, a larger one is split : the kernel is exact up to it.
+ */
+#define ODOMETRY_MAX_STEP (0.5f)
+/* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
+/* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
+/**
+ * \struct OdometryPose
+ * \brief Position of the robot since the start of its odometry : the robot starts at (0, 0) heading along x.
+ */
+typedef struct
+{
+	float x; //mm.
+	float y; //mm.
+	float heading; //rad, between -pi and pi, counterclockwise.
+}OdometryPose;
+/**
+ * \struct Odometry
+ * \brief Pose and the geometry of the robot folded into the constants of the kernel.
+ */
+typedef struct
+{
+	OdometryPose pose;
+	float cos_heading; //unit vector of the heading, turned without trigonometric function.
+	float sin_heading;
+	double heading; //summed in double, the rounding errors of a float drift along the turns.
+	float half_mm_per_pulse; //advance of the robot per pulse of a wheel.
+	float rad_per_pulse; //rotation of the robot per pulse of difference between the wheels.
+	unsigned long nb_updates;
+}Odometry;
+/* ----------------------  PUBLIC VARIBLES -----------------------------------*/
+/* ----------------------  PUBLIC FUNCTIONS PROTOTYPES  ----------------------*/
+/**
+ * \fn extern void Odometry_init(Odometry* pOdometry, float wheel_diameter_mm, float track_mm, int pulses_per_turn)
+ * \brief Initialize the odometry of a robot at the pose (0, 0, 0).
+ *
+ * \param float track_mm : distance between the contact points of the wheels.
+ * \param int pulses_per_turn : pulses of a coder for a turn of its wheel (Motor_getIncrementalCoderModulo).
+ */
+extern void Odometry_init(Odometry* pOdometry, float wheel_diameter_mm, float track_mm, int pulses_per_turn);
+/**
+ * \fn extern void Odometry_update(Odometry* pOdometry, int32_t left, int32_t right)
+ * \brief Integrate the pulses of the wheels since the last update, along an arc of circle.
+ *
+ * A few multiplications without trigonometric function nor division : it runs at the rate of the coders.
+ *
+ * \param int32_t left : signed pulses of the left wheel, positive forward.
+ * \param int32_t right : signed pulses of the right wheel.
+ */
+extern void Odometry_update(Odometry* pOdometry, int32_t left, int32_t right);
+/**
+ * \fn extern int32_t Odometry_getDelta(int32_t coder, int32_t previous, int modulo)
+ * \brief Pulses between two values of a coder, whether it wraps around on 32 bits or every modulo pulses.
+ *
+ * \param int modulo : value at which the coder wraps around, 0 or less if it only wraps on 32 bits.
+ * \return int32_t : the shortest signed difference, the wheel must turn less than modulo / 2 between the values.
+ */
+extern int32_t Odometry_getDelta(int32_t coder, int32_t previous, int modulo);
+
+#endif /* SRC_COMMANDO_ODOMETRY_H_ */
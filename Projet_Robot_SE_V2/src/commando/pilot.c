@@ -39,22 +39,12 @@
 #include <stdio.h>
 #include <assert.h>
 /* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
-/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
 /**
- * \enum event_e
- * \brief event for the state machine.
+ * \def PILOT_FULL_POWER
+ * \brief Power of a wheel at full speed, the mixed commands are scaled down to it.
  */
-typedef enum
-{
-	SETVELOCITY_E,
-	SETVELOCITY_CHANGE_E,
-	SETVELOCITY_STOP_E,
-	CHECK_E,
-	CHECKED_E,
-	STOP_E,
-	NB_E
-}event_e;
-
+#define PILOT_FULL_POWER (100)
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
 typedef struct
 {
 	State_e stateDestination;
@@ -66,20 +56,57 @@ typedef void (*ActionPtr)();
 /* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
 /* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
 /**
- * \fn static void Pilot_run(Pilot* pPilot, event ev, VelocityVector vel)
- * \brief State machine of the Pilot, run from different events.
+ * \fn static void Pilot_run(Pilot* pPilot, event ev)
+ * \brief State machine of the Pilot, one transition : the state is set before the action runs.
  *
  * \param event ev: Gives the event to call.
- * \param VelocityVector vel: Data with the velocity vector -> speed and direction.
  */
 static void Pilot_run(Pilot* pPilot, event_e ev);
+/**
+ * \fn static void Pilot_raise(Pilot* pPilot, event_e ev)
+ * \brief Raise an event from an action, it runs once the current transition is complete.
+ */
+static void Pilot_raise(Pilot* pPilot, event_e ev);
+/**
+ * \fn static bool_e Pilot_pop(Pilot* pPilot, PilotEvent* pEvent)
+ * \brief Take the oldest posted event out of the queue.
+ *
+ * \return bool_e : FALSE if no event is ready.
+ */
+static bool_e Pilot_pop(Pilot* pPilot, PilotEvent* pEvent);
+/**
+ * \fn static void Pilot_process(Pilot* pPilot, const PilotEvent* pEvent)
+ * \brief Run an event to completion, with the events raised by its actions.
+ */
+static void Pilot_process(Pilot* pPilot, const PilotEvent* pEvent);
+/**
+ * \fn static void Pilot_handle(Pilot* pPilot, event_e ev, const VelocityVector* pVector)
+ * \brief Run an event from the thread of the pilot, after the events posted by the others.
+ */
+static void Pilot_handle(Pilot* pPilot, event_e ev, const VelocityVector* pVector);
 /**
  * \fn static void Pilot_sendMvt(VelocityVector vel)
- * \brief Sends the movement order to Robot_setWheelsVelocity.
+ * \brief Sends the movement order to Robot_setWheelsVelocity, mixed from the linear and angular velocity of the vector.
  *
  * \param VelocityVector vel: Data with the velocity vector -> speed and direction.
  */
 static void Pilot_sendMvt(Pilot* pPilot);
+/**
+ * \fn static bool_e Pilot_toTwist(const VelocityVector* pVector, int* pLinear, int* pAngular)
+ * \brief Linear and angular velocity of a vector : a direction is a straight line or a spin in place at its power.
+ *
+ * \return bool_e : FALSE for an unknown direction.
+ */
+static bool_e Pilot_toTwist(const VelocityVector* pVector, int* pLinear, int* pAngular);
+/**
+ * \fn static void Pilot_mix(int linear, int angular, int* pLeft, int* pRight)
+ * \brief Mix a linear and an angular velocity into the powers of the wheels of a differential drive,
+ *        in the order the directions have always given them to Robot_setWheelsVelocity.
+ *
+ * Beyond the full power, both wheels are scaled down by the same factor : the curvature of the
+ * path is kept and the fastest wheel runs at full power.
+ */
+static void Pilot_mix(int linear, int angular, int* pLeft, int* pRight);
 /**
  * \fn static bool_e Pilot_hasBumped(Pilot* pPilot)
  * \brief check if the robot's collision sensors has bumped of not.
@@ -89,7 +116,7 @@ static void Pilot_sendMvt(Pilot* pPilot);
 static bool_e Pilot_hasBumped(Pilot* pPilot);
 /**
  * \fn static void Pilot_Bump_Check(Pilot* pPilot)
- * \brief Action to check a bump, calls run if it has.
+ * \brief Action to check a bump, raises CHECKED_E if it has.
  */
 static void Pilot_Bump_Check(Pilot* pPilot);
 /**
@@ -107,8 +134,13 @@ static void Pilot_actionNop(Pilot* pPilot);
  * \brief Action to verify any changment into the direction of the vector.
  */
 static void Pilot_action_Vel_Change(Pilot* pPilot);
+/**
+ * \fn static void Pilot_readPose(Pilot* pPilot)
+ * \brief Put the pose integrated by the odometry of the robot into the PilotState.
+ */
+static void Pilot_readPose(Pilot* pPilot);
 /* ----------------------  PRIVATE VARIABLES  ------------------------------- */
-static Transition_s stateMachine[NB_S][NB_E]=
+static const Transition_s stateMachine[NB_S][NB_E]=
 {
 		[IDLE][SETVELOCITY_E] = {IDLE,VELOCITY_CHANGE_A},
 		[IDLE][SETVELOCITY_CHANGE_E] = {RUNNING,SEND_MVT_A},
@@ -122,18 +154,46 @@ static Transition_s stateMachine[NB_S][NB_E]=
 		[RUNNING][CHECKED_E] = {IDLE,SEND_MVT_STOP_A}
 };
 
+/**
+ * \brief Linear and angular velocity of each direction at a power of 1.
+ */
+static const int twists[TWIST][2] =
+{
+		[LEFT] = {0, 1},
+		[RIGHT] = {0, -1},
+		[FORWARD] = {1, 0},
+		[BACKWARD] = {-1, 0},
+		[STOP] = {0, 0}
+};
+
 static const ActionPtr actionsTab[NB_ACTION] = {&Pilot_actionNop,&Pilot_action_Vel_Change, &Pilot_sendMVT_Stop,&Pilot_sendMvt,&Pilot_Bump_Check};
 /* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
-Pilot* Pilot_new(void)
+Pilot* Pilot_new(const RobotConfig* pConfig)
 {
-	Pilot* pPilot = (Pilot*) malloc(sizeof(Pilot));
-	pPilot->state = IDLE;
-	pPilot->robot = Robot_new();
-	if(pPilot == NULL)
+	void* memory = NULL;
+	//Aligned, so that head, tail and the slots stay on their own cache lines.
+	if(posix_memalign(&memory, RING_CACHE_LINE, sizeof(Pilot)) != 0)
 	{
 		printf("ERROR : pPilot is NULL /n");
 		while(1);
 	}
+	Pilot* pPilot = (Pilot*) memory;
+	pPilot->state = IDLE;
+	pPilot->vector.dir = STOP;
+	pPilot->vector.power = 0;
+	pPilot->vector.angular = 0;
+	pPilot->robot = Robot_new(pConfig);
+	pPilot->head = 0;
+	pPilot->tail = 0;
+	pPilot->nb_dropped = 0;
+	pPilot->nb_events = 0;
+	pPilot->nb_ignored = 0;
+	pPilot->first_internal = 0;
+	pPilot->nb_internal = 0;
+	for(size_t i = 0; i < PILOT_QUEUE_CAPACITY; i++)
+	{
+		pPilot->slots[i].sequence = i;
+	}
 	return pPilot;
 }
 
@@ -144,7 +204,7 @@ void Pilot_start(Pilot* pPilot)
 
 void Pilot_setVelocity(Pilot* pPilot)
 {
-	Pilot_run(pPilot, SETVELOCITY_E);
+	Pilot_handle(pPilot, SETVELOCITY_E, &pPilot->vector);
 }
 
 PilotState Pilot_getState(Pilot* pPilot)
@@ -154,25 +214,74 @@ PilotState Pilot_getState(Pilot* pPilot)
 
 void Pilot_check(Pilot* pPilot)
 {
-	VelocityVector vel;
-	pPilot->vector = vel;
-	pPilot->PState.collision = Robot_getSensorState(pPilot->robot).collision;
-	pPilot->PState.luminosity = Robot_getSensorState(pPilot->robot).luminosity;
+	//Read once : each read takes the lock of the robot for a round trip to it.
+	SensorState sensors = Robot_getSensorState(pPilot->robot);
+	pPilot->PState.collision = sensors.collision;
+	pPilot->PState.luminosity = sensors.luminosity;
 	pPilot->PState.speed = Robot_getRobotSpeed(pPilot->robot);
-	printf("check\n");
-	if(pPilot->state == IDLE && pPilot->vector.dir != STOP)
+	Pilot_readPose(pPilot);
+	Pilot_handle(pPilot, CHECK_E, NULL);
+}
+
+bool_e Pilot_post(Pilot* pPilot, event_e event, const VelocityVector* pVector)
+{
+	PilotSlot* pSlot;
+	size_t head = __atomic_load_n(&pPilot->head, __ATOMIC_RELAXED);
+	for(;;)
 	{
-		pPilot->state = RUNNING;
+		pSlot = &pPilot->slots[head & (PILOT_QUEUE_CAPACITY - 1)];
+		size_t sequence = __atomic_load_n(&pSlot->sequence, __ATOMIC_ACQUIRE);
+		//Free when its sequence is head, still holding the event of the previous lap when it is behind.
+		long difference = (long) (sequence - head);
+		if(difference == 0)
+		{
+			//On failure, head is reloaded with the one claimed by another producer.
+			if(__atomic_compare_exchange_n(&pPilot->head, &head, head + 1, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			{
+				break;
+			}
+		}
+		else if(difference < 0)
+		{
+			__atomic_add_fetch(&pPilot->nb_dropped, 1, __ATOMIC_RELAXED);
+			return FALSE;
+		}
+		else
+		{
+			head = __atomic_load_n(&pPilot->head, __ATOMIC_RELAXED);
+		}
 	}
-	Pilot_run(pPilot,CHECK_E);
+	pSlot->content.event = event;
+	if(pVector != NULL)
+	{
+		pSlot->content.vector = *pVector;
+	}
+	__atomic_store_n(&pSlot->sequence, head + 1, __ATOMIC_RELEASE);
+	return TRUE;
 }
 
+int Pilot_dispatch(Pilot* pPilot)
+{
+	PilotEvent event;
+	int nb_events = 0;
+	while(Pilot_pop(pPilot, &event) == TRUE)
+	{
+		nb_events++;
+		Pilot_process(pPilot, &event);
+	}
+	return nb_events;
+}
+
+bool_e Pilot_isStill(const VelocityVector* pVector)
+{
+	return (pVector->dir == STOP || (pVector->dir == TWIST && pVector->power == 0 && pVector->angular == 0))? TRUE : FALSE;
+}
 
 void Pilot_stop(Pilot* pPilot)
 {
-	VelocityVector vel;
-	pPilot->vector = vel;
-	Pilot_run(pPilot,STOP_E);
+	VelocityVector stop = {STOP, 0, 0};
+	pPilot->vector = stop;
+	Pilot_handle(pPilot, STOP_E, NULL);
 	Robot_stop(pPilot->robot);
 }
 
@@ -190,49 +299,135 @@ static void Pilot_run(Pilot* pPilot,event_e ev)
 	tempState = stateMachine[pPilot->state][ev].stateDestination;
 	if(tempState != FORGET_S)
 	{
-		actionsTab[pPilot->action](pPilot);
 		pPilot->state = tempState;
+		actionsTab[pPilot->action](pPilot);
+	}
+}
+
+static void Pilot_raise(Pilot* pPilot, event_e ev)
+{
+	assert(pPilot->nb_internal < PILOT_INTERNAL_CAPACITY);
+	pPilot->internal[(pPilot->first_internal + pPilot->nb_internal) % PILOT_INTERNAL_CAPACITY] = ev;
+	pPilot->nb_internal++;
+}
+
+static bool_e Pilot_pop(Pilot* pPilot, PilotEvent* pEvent)
+{
+	PilotSlot* pSlot = &pPilot->slots[pPilot->tail & (PILOT_QUEUE_CAPACITY - 1)];
+	//A claimed slot whose event is not written yet stops the reading, the order of the events is kept.
+	if(__atomic_load_n(&pSlot->sequence, __ATOMIC_ACQUIRE) != pPilot->tail + 1)
+	{
+		return FALSE;
+	}
+	*pEvent = pSlot->content;
+	__atomic_store_n(&pSlot->sequence, pPilot->tail + PILOT_QUEUE_CAPACITY, __ATOMIC_RELEASE);
+	pPilot->tail++;
+	return TRUE;
+}
+
+static void Pilot_process(Pilot* pPilot, const PilotEvent* pEvent)
+{
+	if(pPilot->state == DEATH_S)
+	{
+		//Stopped for good, what is left is read out to keep the queue free.
+		pPilot->nb_ignored++;
+		return;
+	}
+	if(pEvent->event == SETVELOCITY_E)
+	{
+		pPilot->vector = pEvent->vector;
+	}
+	else if(pEvent->event == CHECKED_E)
+	{
+		pPilot->PState.collision = BUMPED;
+	}
+	Pilot_run(pPilot, pEvent->event);
+	//Run to completion : the events raised by the actions come before the next posted one.
+	while(pPilot->nb_internal > 0 && pPilot->state != DEATH_S)
+	{
+		event_e ev = pPilot->internal[pPilot->first_internal];
+		pPilot->first_internal = (pPilot->first_internal + 1) % PILOT_INTERNAL_CAPACITY;
+		pPilot->nb_internal--;
+		Pilot_run(pPilot, ev);
 	}
+	pPilot->first_internal = 0;
+	pPilot->nb_internal = 0;
+	pPilot->nb_events++;
+}
+
+static void Pilot_handle(Pilot* pPilot, event_e ev, const VelocityVector* pVector)
+{
+	PilotEvent event;
+	event.event = ev;
+	event.vector = (pVector != NULL)? *pVector : pPilot->vector;
+	//The events posted before are run first. This one is not posted : the thread of the pilot is the only one
+	//to dispatch, it runs it at once, and a queue filled by the other threads cannot drop it.
+	Pilot_dispatch(pPilot);
+	Pilot_process(pPilot, &event);
 }
 
 static void Pilot_sendMvt(Pilot* pPilot)
 {
-	switch(pPilot->vector.dir)
-	{
-		case LEFT:
-			Robot_setWheelsVelocity(pPilot->robot, -(pPilot->vector.power), (pPilot->vector.power));
-			break;
-		case RIGHT:
-			Robot_setWheelsVelocity(pPilot->robot, (pPilot->vector.power),-(pPilot->vector.power));
-			break;
-		case FORWARD:
-			Robot_setWheelsVelocity(pPilot->robot, (pPilot->vector.power), (pPilot->vector.power));
-			break;
-		case BACKWARD:
-			Robot_setWheelsVelocity(pPilot->robot, -(pPilot->vector.power), -(pPilot->vector.power));
-			break;
-		case STOP:
-			Robot_setWheelsVelocity(pPilot->robot, 0, 0);
-			break;
-		default:
-			break;
+	int linear;
+	int angular;
+	int left;
+	int right;
+	if(Pilot_toTwist(&pPilot->vector, &linear, &angular) == TRUE)
+	{
+		Pilot_mix(linear, angular, &left, &right);
+		Robot_setWheelsVelocity(pPilot->robot, left, right);
 	}
 }
+
+static bool_e Pilot_toTwist(const VelocityVector* pVector, int* pLinear, int* pAngular)
+{
+	if(pVector->dir == TWIST)
+	{
+		*pLinear = pVector->power;
+		*pAngular = pVector->angular;
+		return TRUE;
+	}
+	//Cast, a direction from the network may be anything.
+	if((unsigned int) pVector->dir >= TWIST)
+	{
+		return FALSE;
+	}
+	*pLinear = twists[pVector->dir][0] * pVector->power;
+	*pAngular = twists[pVector->dir][1] * pVector->power;
+	return TRUE;
+}
+
+static void Pilot_mix(int linear, int angular, int* pLeft, int* pRight)
+{
+	//On 64 bits, the sum of two velocities from the network may not fit in an int.
+	long long left = (long long) linear - angular;
+	long long right = (long long) linear + angular;
+	long long highest = (llabs(left) > llabs(right))? llabs(left) : llabs(right);
+	if(highest > PILOT_FULL_POWER)
+	{
+		//Rounded to the nearest power.
+		left = (2 * PILOT_FULL_POWER * left + ((left < 0)? -highest : highest)) / (2 * highest);
+		right = (2 * PILOT_FULL_POWER * right + ((right < 0)? -highest : highest)) / (2 * highest);
+	}
+	*pLeft = (int) left;
+	*pRight = (int) right;
+}
+
 static void Pilot_Bump_Check(Pilot* pPilot)
 {
 	if(Pilot_hasBumped(pPilot))
 	{
-		Pilot_run(pPilot, CHECKED_E);
+		Pilot_raise(pPilot, CHECKED_E);
 	}
 }
 static void Pilot_action_Vel_Change(Pilot* pPilot)
 {
 	event_e tempEvent = SETVELOCITY_CHANGE_E;
-	if(pPilot->vector.dir == STOP)
+	if(Pilot_isStill(&pPilot->vector) == TRUE)
 	{
 		tempEvent = SETVELOCITY_STOP_E;;
 	}
-	Pilot_run(pPilot, tempEvent);
+	Pilot_raise(pPilot, tempEvent);
 }
 
 static void Pilot_sendMVT_Stop(Pilot* pPilot)
@@ -245,3 +440,11 @@ static bool_e Pilot_hasBumped(Pilot* pPilot)
 	return (pPilot->PState.collision == BUMPED)? TRUE : FALSE;
 }
 static void Pilot_actionNop(Pilot* pPilot){}
+
+static void Pilot_readPose(Pilot* pPilot)
+{
+	OdometryPose pose = Robot_getPose(pPilot->robot);
+	pPilot->PState.x = pose.x;
+	pPilot->PState.y = pose.y;
+	pPilot->PState.heading = pose.heading;
+}
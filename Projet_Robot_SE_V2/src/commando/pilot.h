@@ -39,7 +39,19 @@
 #include "robot.h"
 #include "prose.h"
 #include "../commun.h"
+#include "../commun/ring.h"
 /* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/**
+ * \def PILOT_QUEUE_CAPACITY
+ * \brief Number of events the queue of a pilot holds, a power of 2.
+ */
+#define PILOT_QUEUE_CAPACITY (64)
+/**
+ * \def PILOT_INTERNAL_CAPACITY
+ * \brief Number of events the actions of one transition may raise.
+ */
+#define PILOT_INTERNAL_CAPACITY (4)
+
 typedef struct Pilot_t Pilot;
 
 typedef enum
@@ -64,8 +76,43 @@ typedef enum
 	DEATH_S,
 	NB_S
 }State_e;
+
+/**
+ * \enum event_e
+ * \brief event for the state machine.
+ */
+typedef enum
+{
+	SETVELOCITY_E,
+	SETVELOCITY_CHANGE_E,
+	SETVELOCITY_STOP_E,
+	CHECK_E,
+	CHECKED_E,
+	STOP_E,
+	NB_E
+}event_e;
 /* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
 /* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
+/**
+ * \struct PilotEvent
+ * \brief An event posted to a pilot, with the velocity vector of a SETVELOCITY_E.
+ */
+typedef struct
+{
+	event_e event;
+	VelocityVector vector;
+}PilotEvent;
+
+/**
+ * \struct PilotSlot
+ * \brief A slot of the queue, its sequence tells whether it is free or holds an event.
+ */
+typedef struct
+{
+	size_t sequence;
+	PilotEvent content;
+}PilotSlot;
+
 struct Pilot_t
 {
 	State_e state;
@@ -73,16 +120,29 @@ struct Pilot_t
 	VelocityVector vector;
 	PilotState PState;
 	Robot* robot;
+	//Events posted by any thread, claimed with a compare and swap on head.
+	size_t head __attribute__((aligned(RING_CACHE_LINE)));
+	unsigned long nb_dropped;
+	//Read by the thread of the pilot only.
+	size_t tail __attribute__((aligned(RING_CACHE_LINE)));
+	unsigned long nb_events;
+	unsigned long nb_ignored;
+	//Raised by the actions, run before the next posted event.
+	event_e internal[PILOT_INTERNAL_CAPACITY];
+	int first_internal;
+	int nb_internal;
+	PilotSlot slots[PILOT_QUEUE_CAPACITY] __attribute__((aligned(RING_CACHE_LINE)));
 };
 /* ----------------------  PUBLIC VARIBLES -----------------------------------*/
 /* ----------------------  PUBLIC FUNCTIONS PROTOTYPES  ----------------------*/
 /**
- * \fn extern Pilot$* Pilot_new()
+ * \fn extern Pilot$* Pilot_new(const RobotConfig* pConfig)
  * \brief Initialize in memory the object Pilot.
  *
+ * \param const RobotConfig* pConfig : simulator and ports of its robot, NULL for the default ones.
  * \return Pilot*
  */
-extern Pilot* Pilot_new();
+extern Pilot* Pilot_new(const RobotConfig* pConfig);
 /**
  * \fn extern void Pilot_start(Pilot* pPilot)
  * \brief Start Pilot.
@@ -114,8 +174,29 @@ extern void Pilot_setVelocity(Pilot* pPilot);
 extern PilotState Pilot_getState(Pilot* pPilot);
 /**
  * \fn extern void Pilot_check(Pilot* pPilot)
- * \brief gets the sensors state of the robot and put it into the Pilot object.
+ * \brief gets the sensors state of the robot and put it into the Pilot object, a running robot which has bumped is stopped.
  */
 extern void Pilot_check(Pilot* pPilot);
+/**
+ * \fn extern bool_e Pilot_post(Pilot* pPilot, event_e event, const VelocityVector* pVector)
+ * \brief Post an event to the pilot from any thread, without lock. It runs at the next Pilot_dispatch.
+ *
+ * \param event_e event : CHECKED_E when a bumper got pressed (the pilot stops), SETVELOCITY_E...
+ * \param const VelocityVector* pVector : vector of a SETVELOCITY_E, NULL for the other events.
+ * \return bool_e : FALSE if the queue is full, the event is dropped.
+ */
+extern bool_e Pilot_post(Pilot* pPilot, event_e event, const VelocityVector* pVector);
+/**
+ * \fn extern int Pilot_dispatch(Pilot* pPilot)
+ * \brief Run the posted events in order on the thread of the pilot, each one to completion.
+ *
+ * \return int : number of events run.
+ */
+extern int Pilot_dispatch(Pilot* pPilot);
+/**
+ * \fn extern bool_e Pilot_isStill(const VelocityVector* pVector)
+ * \brief Whether a vector leaves the robot still, a STOP or a TWIST without velocity.
+ */
+extern bool_e Pilot_isStill(const VelocityVector* pVector);
 
 #endif /* SRC_COMMANDO_PILOT_H */
@@ -0,0 +1,238 @@
+/**
+ * @file  profile.c
+ *
+ * @brief Speed ramps limited in acceleration and jerk, precomputed for a lookup per tick.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "profile.h"
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static double Profile_rise(double acceleration, double jerk, double time)
+ * \brief Change of speed time s after a start at rest, the acceleration growing at the jerk up to its limit.
+ */
+static double Profile_rise(double acceleration, double jerk, double time);
+/**
+ * \fn static int Profile_getLast(float acceleration, float jerk, float period)
+ * \brief First tick at which the acceleration has reached its limit, PROFILE_CAPACITY if it is not within the table.
+ */
+static int Profile_getLast(float acceleration, float jerk, float period);
+/**
+ * \fn static void Profile_plan(Profile* pProfile, const ProfileTable* pTable)
+ * \brief Ramp from rest at the current speed of the profile to its target.
+ */
+static void Profile_plan(Profile* pProfile, const ProfileTable* pTable);
+/**
+ * \fn static double Profile_lookup(const ProfileTable* pTable, int tick)
+ * \brief Change of speed tick ticks after a start at rest : from the table, then at the limit of acceleration.
+ */
+static double Profile_lookup(const ProfileTable* pTable, int tick);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+bool_e Profile_initTable(ProfileTable* pTable, float acceleration, float jerk, float period)
+{
+	int tick = 0;
+	int last = Profile_getLast(acceleration, jerk, period);
+	if(last >= PROFILE_CAPACITY)
+	{
+		//The limits are kept as they are asked, never raised to fit in the table.
+		return FALSE;
+	}
+	pTable->enabled = (acceleration > 0)? TRUE : FALSE;
+	pTable->acceleration = (acceleration > 0)? acceleration : 0;
+	pTable->jerk = (jerk > 0 && acceleration > 0)? jerk : 0;
+	pTable->last = last;
+	pTable->step = pTable->acceleration * (double) period;
+	pTable->jerk_step = pTable->jerk * (double) period * period;
+	for(int change = 0; change <= PROFILE_MAX_CHANGE; change++)
+	{
+		pTable->half[change] = 0;
+	}
+	if(pTable->enabled == FALSE)
+	{
+		return TRUE;
+	}
+	for(int k = 0; k <= last; k++)
+	{
+		pTable->rise[k] = Profile_rise(pTable->acceleration, pTable->jerk, k * (double) period);
+	}
+	for(int change = 0; change <= PROFILE_MAX_CHANGE; change++)
+	{
+		double middle = change / 2.0;
+		if(tick >= last)
+		{
+			//At the limit of acceleration the tick is computed, the loop only corrects its rounding.
+			int skip = last + (int) ((middle - pTable->rise[last]) / pTable->step);
+			tick = (skip > tick)? skip : tick;
+		}
+		while(Profile_lookup(pTable, tick) < middle)
+		{
+			tick++;
+		}
+		pTable->half[change] = tick;
+	}
+	return TRUE;
+}
+
+bool_e Profile_fits(float acceleration, float jerk, float period)
+{
+	return (Profile_getLast(acceleration, jerk, period) < PROFILE_CAPACITY)? TRUE : FALSE;
+}
+
+void Profile_init(Profile* pProfile, float speed)
+{
+	pProfile->start = speed;
+	pProfile->target = speed;
+	pProfile->sign = 1;
+	pProfile->scale = 0;
+	pProfile->half = 0;
+	pProfile->tick = 0;
+	pProfile->speed = speed;
+	pProfile->delta = 0;
+	pProfile->unwinding = FALSE;
+}
+
+void Profile_start(Profile* pProfile, const ProfileTable* pTable, float target)
+{
+	pProfile->target = target;
+	//The first tick of a ramp changes the speed by at most jerk_step / 2 : after a change as small, the acceleration stays within the jerk.
+	if(pTable->enabled == TRUE && pTable->jerk_step > 0 && Profile_isRunning(pProfile) == TRUE
+			&& (pProfile->delta > pTable->jerk_step / 2 || pProfile->delta < -pTable->jerk_step / 2))
+	{
+		//Mid-ramp : the ramp to target is planned once the acceleration is back to 0, from the speed reached then.
+		pProfile->unwinding = TRUE;
+		pProfile->half = 0;
+		pProfile->tick = 0;
+		return;
+	}
+	pProfile->unwinding = FALSE;
+	Profile_plan(pProfile, pTable);
+}
+
+double Profile_next(Profile* pProfile, const ProfileTable* pTable)
+{
+	double previous = pProfile->speed;
+	if(pProfile->unwinding == TRUE)
+	{
+		if(pProfile->delta > pTable->jerk_step || pProfile->delta < -pTable->jerk_step)
+		{
+			pProfile->delta -= (pProfile->delta > 0)? pTable->jerk_step : -pTable->jerk_step;
+			pProfile->speed += pProfile->delta;
+			return pProfile->speed;
+		}
+		//The last tick of the unwinding keeps the speed, the ramp starts from rest on the next one.
+		pProfile->unwinding = FALSE;
+		pProfile->delta = 0;
+		Profile_plan(pProfile, pTable);
+		return pProfile->speed;
+	}
+	if(pProfile->tick >= 2 * pProfile->half)
+	{
+		pProfile->speed = pProfile->target;
+	}
+	else
+	{
+		pProfile->tick++;
+		if(pProfile->tick <= pProfile->half)
+		{
+			pProfile->speed = pProfile->start + pProfile->sign * pProfile->scale * Profile_lookup(pTable, pProfile->tick);
+		}
+		else
+		{
+			pProfile->speed = pProfile->target - pProfile->sign * pProfile->scale * Profile_lookup(pTable, 2 * pProfile->half - pProfile->tick);
+		}
+	}
+	pProfile->delta = pProfile->speed - previous;
+	return pProfile->speed;
+}
+
+bool_e Profile_isRunning(const Profile* pProfile)
+{
+	return (pProfile->unwinding == TRUE || pProfile->tick < 2 * pProfile->half)? TRUE : FALSE;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static double Profile_rise(double acceleration, double jerk, double time)
+{
+	double ramp;
+	if(jerk <= 0)
+	{
+		return acceleration * time;
+	}
+	//Time for the acceleration to reach its limit.
+	ramp = acceleration / jerk;
+	if(time < ramp)
+	{
+		return jerk * time * time / 2;
+	}
+	return acceleration * ramp / 2 + acceleration * (time - ramp);
+}
+
+static int Profile_getLast(float acceleration, float jerk, float period)
+{
+	int last = 0;
+	if(acceleration <= 0 || jerk <= 0)
+	{
+		return 0;
+	}
+	while(last < PROFILE_CAPACITY && last * period < acceleration / jerk)
+	{
+		last++;
+	}
+	return last;
+}
+
+static void Profile_plan(Profile* pProfile, const ProfileTable* pTable)
+{
+	double change = pProfile->target - pProfile->speed;
+	int steps;
+	pProfile->sign = (change >= 0)? 1 : -1;
+	change *= pProfile->sign;
+	//Rounded up : the ramp is shrunk to the change, a ramp stretched would go beyond the limits.
+	steps = (int) change;
+	steps = (steps < change)? steps + 1 : steps;
+	pProfile->start = pProfile->speed;
+	pProfile->half = (pTable->enabled == TRUE)? pTable->half[(steps > PROFILE_MAX_CHANGE)? PROFILE_MAX_CHANGE : steps] : 0;
+	pProfile->scale = (pProfile->half > 0)? change / 2 / Profile_lookup(pTable, pProfile->half) : 0;
+	pProfile->tick = 0;
+}
+
+static double Profile_lookup(const ProfileTable* pTable, int tick)
+{
+	if(tick <= pTable->last)
+	{
+		return pTable->rise[tick];
+	}
+	return pTable->rise[pTable->last] + pTable->step * (tick - pTable->last);
+}
@@ -0,0 +1,126 @@
+/**
+ * @file  profile.h
+ *
+ * @brief Speed ramps limited in acceleration and jerk, precomputed for a lookup per tick.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef SRC_COMMANDO_PROFILE_H_
+#define SRC_COMMANDO_PROFILE_H_
+/* ----------------------  INCLUDES ------------------------------------------*/
+#include "prose.h"
+/* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/**
+ * \brief Ticks held by a table while the acceleration grows at the jerk : limits that need more are rejected.
+ */
+#define PROFILE_CAPACITY (1024)
+/**
+ * \brief Largest change of speed of a ramp, in percent.
+ */
+#define PROFILE_MAX_CHANGE (200)
+/* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
+/* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
+/**
+ * \struct ProfileTable
+ * \brief Ramps for given limits and period of tick.
+ *
+ * A ramp of change C is symmetric : its first half follows the rise from rest shrunk to reach C / 2
+ * after half[C] ticks, its second half is the first one mirrored against its end.
+ */
+typedef struct
+{
+	bool_e enabled; //FALSE without acceleration limit, the speed steps to its target.
+	float acceleration; //limits of the table, in percent/s and percent/s2 (0 for a trapezoidal ramp).
+	float jerk;
+	int last; //first tick at which the acceleration has reached its limit.
+	double step; //change of speed per tick after last.
+	double jerk_step; //largest change of the change of speed from a tick to the next one, 0 without jerk limit.
+	double rise[PROFILE_CAPACITY]; //change of speed after k ticks from rest, up to last.
+	int half[PROFILE_MAX_CHANGE + 1]; //ticks of the first half of a ramp, by change of speed.
+}ProfileTable;
+/**
+ * \struct Profile
+ * \brief Ramp followed by a speed.
+ */
+typedef struct
+{
+	double start;
+	double target;
+	double sign; //1 when the speed increases, -1 when it decreases.
+	double scale; //of the rise, so that the halves meet at the middle of the change.
+	int half;
+	int tick; //ticks since the start, the ramp ends at 2 * half.
+	double speed; //speed at the last tick, in double : the jerk of a tick is far below the precision of a float.
+	double delta; //change of speed of the last tick.
+	bool_e unwinding; //delta of a ramp abandoned is brought back to 0 before the ramp to target starts.
+}Profile;
+/* ----------------------  PUBLIC VARIBLES -----------------------------------*/
+/* ----------------------  PUBLIC FUNCTIONS PROTOTYPES  ----------------------*/
+/**
+ * \fn extern bool_e Profile_initTable(ProfileTable* pTable, float acceleration, float jerk, float period)
+ * \brief Precompute the ramps for the limits, followed every period s.
+ *
+ * \param float acceleration : largest acceleration in percent/s, 0 or less for no ramp at all.
+ * \param float jerk : largest change of the acceleration in percent/s2, 0 or less for a trapezoidal ramp.
+ * \return bool_e : FALSE if the acceleration takes more than PROFILE_CAPACITY ticks to reach its limit,
+ *         the table is left as it was.
+ */
+extern bool_e Profile_initTable(ProfileTable* pTable, float acceleration, float jerk, float period);
+/**
+ * \fn extern bool_e Profile_fits(float acceleration, float jerk, float period)
+ * \brief Whether Profile_initTable accepts the limits.
+ */
+extern bool_e Profile_fits(float acceleration, float jerk, float period);
+/**
+ * \fn extern void Profile_init(Profile* pProfile, float speed)
+ * \brief Initialize a profile at rest at speed.
+ */
+extern void Profile_init(Profile* pProfile, float speed);
+/**
+ * \fn extern void Profile_start(Profile* pProfile, const ProfileTable* pTable, float target)
+ * \brief Ramp from the current speed of the profile to target, the ramp in progress is abandoned.
+ * Its acceleration does not step : with a jerk limit it is first brought back to 0 at the jerk,
+ * the ramp to target starts from the speed reached then.
+ */
+extern void Profile_start(Profile* pProfile, const ProfileTable* pTable, float target);
+/**
+ * \fn extern double Profile_next(Profile* pProfile, const ProfileTable* pTable)
+ * \brief Speed of the next tick of the ramp : a lookup in the table.
+ *
+ * \return double : the speed, the target once the ramp has ended.
+ */
+extern double Profile_next(Profile* pProfile, const ProfileTable* pTable);
+/**
+ * \fn extern bool_e Profile_isRunning(const Profile* pProfile)
+ * \brief Whether the speed has not reached its target yet.
+ */
+extern bool_e Profile_isRunning(const Profile* pProfile);
+
+#endif /* SRC_COMMANDO_PROFILE_H_ */
@@ -38,68 +38,301 @@
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
 /* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
 #define LEFT_MOTOR MD
 #define RIGHT_MOTOR MA
 #define LIGHT_SENSOR S1
 #define FRONT_BUMPER S3
 #define FLOOR_SENSOR S2
+#define WHEEL_DIAMETER (56.0f)
+#define WHEEL_TRACK (120.0f)
+/**
+ * \brief Pulses per turn of a wheel when Motor_getIncrementalCoderModulo cannot tell it.
+ */
+#define CODER_MODULO (360)
+/**
+ * \brief Gains of the speed control of a wheel : power added per percent of speed missing,
+ *        per percent.second of speed missing accumulated, and removed per percent/second the measured speed gains.
+ *        The derivative is taken on the filtered measure, not on the error : a new goal gives no kick, and one pulse
+ *        of quantization (about 14 percent at 10 ms) moves the command by less than one percent of power.
+ */
+#define ROBOT_SPEED_KP (0.5f)
+#define ROBOT_SPEED_KI (2.0f)
+#define ROBOT_SPEED_KD (0.002f)
+/**
+ * \brief Bound of the accumulated error (percent.second), the integral does not wind up on a saturated wheel.
+ */
+#define ROBOT_SPEED_INTEGRAL_MAX (25.0f)
+/**
+ * \brief Weight of a new measure in the speed of a wheel, which is filtered against the quantization of the coder.
+ */
+#define ROBOT_SPEED_FILTER (0.25f)
+/**
+ * \brief Percent of speed corrected per pulse one wheel is ahead of the other, when both have the same speed to keep straight.
+ */
+#define ROBOT_SPEED_SYNC (0.2f)
 /* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
 /* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/**
+ * \struct RobotWheel
+ * \brief Speed control of a wheel (lock of the robot held).
+ */
+typedef struct
+{
+	int goal; //speed asked, percent of ROBOT_NOMINAL_SPEED.
+	Profile ramp; //from the previous goal to the new one.
+	int target; //speed of the ramp at the last tick.
+	int cmd; //power given to the motor.
+	float correction; //power added to the target by the speed control.
+	bool_e measured; //coder holds a valid value of the coder.
+	IncrementalValue coder;
+	long pending; //pulses since the last speed control.
+	float speed; //filtered speed measured, percent of ROBOT_NOMINAL_SPEED.
+	float rate; //derivative of the filtered speed, percent per second.
+	float integral; //error accumulated since the goal has been set.
+	long traveled; //pulses since the goal has been set.
+}RobotWheel;
+
+struct RobotPoller_t
+{
+	pthread_mutex_t lock; //list of its robots and stats, taken before the lock of a robot.
+	Robot* robots; //robots started, linked by next_polled.
+	pthread_t thread;
+	bool_e polling; //its thread runs.
+	RobotPollStats stats;
+};
+
 struct Robot_t
 {
+	pthread_mutex_t lock; //state of the robot and its calls to libinfox.
+	RobotConfig config;
 	Motor * rightMotor;
 	Motor * leftMotor;
 	ContactSensor * FloorSensor;
 	ContactSensor * FrontSensor;
 	LightSensor * lightSensor;
+	RobotBumpHandler bump_handler; //NULL if the bumpers are not polled.
+	void* bump_context;
+	int bump_id;
+	bool_e pressed; //a bumper was pressed at the last sample (polling thread).
+	struct timespec released; //time of the last sample with the bumpers released (polling thread).
+	RobotBumpStats bump_stats; //written by the polling thread with the lock held.
+	RobotWheel right;
+	RobotWheel left;
+	int coder_modulo; //pulses per turn, at which the coders wrap around.
+	Odometry odometry; //written by the polling thread with the lock held.
+	ProfileTable profile; //ramps of the wheels.
+	RobotPoller* poller; //thread which polls the robot once started.
+	Robot* next_polled; //next robot in the list of that thread.
 };
 /* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
 /* ----------------------  PRIVATE VARIABLES  ------------------------------- */
 static const char adresse_infox[] = "127.0.0.1";
 static const int port = 12345;
+/*
+ * libinfox holds a single Intox session per process : it is opened by the first robot started and
+ * closed by the last one stopped. The lock only guards the opening and the closing, each robot calls
+ * its own motors and sensors under its own lock.
+ */
+static pthread_mutex_t session_lock = PTHREAD_MUTEX_INITIALIZER;
+static int nb_intox_users = 0;
+static RobotConfig intox_session;
+/*
+ * The robots without a poller of their own (Robot_setPoller) share this one.
+ */
+static RobotPoller shared_poller = {PTHREAD_MUTEX_INITIALIZER, NULL, 0, FALSE, {0, 0, 0, 0}};
 /* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static void* Robot_poll(void* pArg)
+ * \brief Body of a polling thread : samples the coders and the bumpers, steps the ramps and controls the wheels
+ *        of its robots on absolute deadlines, one robot locked at a time.
+ */
+static void* Robot_poll(void* pArg);
+/**
+ * \fn static void Robot_controlSpeed(Robot* pRobot, float period)
+ * \brief Adjust the power of the wheels of a robot to the speed measured by the coders (lock of the robot held).
+ *
+ * \param float period : time in s since the last control.
+ */
+static void Robot_controlSpeed(Robot* pRobot, float period);
+/**
+ * \fn static void Robot_controlWheel(RobotWheel* pWheel, Motor* pMotor, float correction, float period)
+ * \brief PID control of the power of a wheel, measured by Robot_measureWheel (lock of the robot held).
+ *
+ * \param float correction : percent of speed added to the target, to keep the wheels synchronized.
+ */
+static void Robot_controlWheel(RobotWheel* pWheel, Motor* pMotor, float correction, float period);
+/**
+ * \fn static void Robot_measureWheel(RobotWheel* pWheel, float period)
+ * \brief Update the speed of a wheel with the pulses read since the last control (lock of the robot held).
+ */
+static void Robot_measureWheel(RobotWheel* pWheel, float period);
+/**
+ * \fn static void Robot_sampleCoders(Robot* pRobot)
+ * \brief Read the coders of a robot and integrate their pulses into its odometry (lock of the robot held).
+ */
+static void Robot_sampleCoders(Robot* pRobot);
+/**
+ * \fn static int32_t Robot_readWheel(RobotWheel* pWheel, Motor* pMotor, int modulo)
+ * \brief Read the coder of a wheel (lock of the robot held).
+ *
+ * \return int32_t : pulses since the last read, 0 if the coder cannot be read or was not.
+ */
+static int32_t Robot_readWheel(RobotWheel* pWheel, Motor* pMotor, int modulo);
+/**
+ * \fn static bool_e Robot_setWheel(RobotWheel* pWheel, Motor* pMotor, int goal)
+ * \brief Set the speed of a wheel and give it as a power at once, without ramp (lock of the robot held).
+ *
+ * \return bool_e : FALSE if the motor has not taken the command.
+ */
+static bool_e Robot_setWheel(RobotWheel* pWheel, Motor* pMotor, int goal);
+/**
+ * \fn static bool_e Robot_driveWheel(RobotWheel* pWheel, Motor* pMotor, const ProfileTable* pTable, int goal)
+ * \brief Start the ramp of a wheel to a new speed and apply its first step (lock of the robot held).
+ *
+ * \return bool_e : FALSE if the motor has not taken the command.
+ */
+static bool_e Robot_driveWheel(RobotWheel* pWheel, Motor* pMotor, const ProfileTable* pTable, int goal);
+/**
+ * \fn static bool_e Robot_stepWheel(RobotWheel* pWheel, Motor* pMotor, const ProfileTable* pTable)
+ * \brief Give to the motor of a wheel the power of the next step of its ramp (lock of the robot held).
+ *
+ * \return bool_e : FALSE if the motor has not taken the command.
+ */
+static bool_e Robot_stepWheel(RobotWheel* pWheel, Motor* pMotor, const ProfileTable* pTable);
+/**
+ * \fn static int Robot_round(float value)
+ * \brief Nearest integer of a speed or a power.
+ */
+static int Robot_round(float value);
+/**
+ * \fn static float Robot_abs(float value)
+ * \brief Absolute value of a speed.
+ */
+static float Robot_abs(float value);
+/**
+ * \fn static void Robot_checkBumpers(Robot* pRobot, const struct timespec* pNow)
+ * \brief Stop the motors of a robot on the rising edge of a bumper (lock of the robot held).
+ */
+static void Robot_checkBumpers(Robot* pRobot, const struct timespec* pNow);
 /* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
 void Robot_start(Robot* pRobot)
 {
-	if(ProSE_Intox_init(adresse_infox,port) == -1)
+	RobotPoller* pPoller = pRobot->poller;
+	pthread_mutex_lock(&session_lock);
+	if(nb_intox_users == 0)
+	{
+		if(ProSE_Intox_init(pRobot->config.intox_address, pRobot->config.intox_port) == -1)
+		{
+			PProseError("The communication with Intox could not had been initialised.");
+		}
+		intox_session = pRobot->config;
+	}
+	else if(intox_session.intox_port != pRobot->config.intox_port
+			|| strcmp(intox_session.intox_address, pRobot->config.intox_address) != 0)
 	{
-		PProseError("The communication with Intox could not had been initialised.");
+		printf("ERROR : only one Intox session per process, %s:%d is used instead of %s:%d\n",
+				intox_session.intox_address, intox_session.intox_port,
+				pRobot->config.intox_address, pRobot->config.intox_port);
 	}
+	nb_intox_users++;
 
 	//Open the ports of the Sensors
-	pRobot->FloorSensor = ContactSensor_open(FLOOR_SENSOR); //floor sensor
+	pRobot->FloorSensor = ContactSensor_open(pRobot->config.floor_sensor); //floor sensor
 	if(pRobot->FloorSensor == NULL)
 	{
 		PProseError("Error with the instance floor sensor.");
 	}
-	pRobot->FrontSensor = ContactSensor_open(FRONT_BUMPER); //front bumper
+	pRobot->FrontSensor = ContactSensor_open(pRobot->config.front_bumper); //front bumper
 	if(pRobot->FrontSensor == NULL)
 	{
 		PProseError("Error with the instance front bumper.");
 	}
-	pRobot->lightSensor = LightSensor_open(LIGHT_SENSOR); //light sensor
+	pRobot->lightSensor = LightSensor_open(pRobot->config.light_sensor); //light sensor
 	if(pRobot->lightSensor == NULL)
 	{
 		PProseError("Error with the instance light sensor.");
 	}
 
 	//Open the ports of the motors
-	pRobot->leftMotor = Motor_open(LEFT_MOTOR); //left motor
+	pRobot->leftMotor = Motor_open(pRobot->config.left_motor); //left motor
 	if(pRobot->leftMotor == NULL)
 	{
 		PProseError("Error with the instance left motor.");
 	}
-	pRobot->rightMotor = Motor_open(RIGHT_MOTOR); //right motor
+	pRobot->rightMotor = Motor_open(pRobot->config.right_motor); //right motor
 	if(pRobot->rightMotor == NULL)
 	{
 		PProseError("Error with the instance right motor.");
 	}
+
+	//Poll the bumpers and the coders
+	memset(&pRobot->right, 0, sizeof(RobotWheel));
+	memset(&pRobot->left, 0, sizeof(RobotWheel));
+	Profile_init(&pRobot->right.ramp, 0);
+	Profile_init(&pRobot->left.ramp, 0);
+	pRobot->coder_modulo = Motor_getIncrementalCoderModulo();
+	Odometry_init(&pRobot->odometry, pRobot->config.wheel_diameter_mm, pRobot->config.track_mm,
+			(pRobot->coder_modulo > 0)? pRobot->coder_modulo : CODER_MODULO);
+	pRobot->pressed = FALSE;
+	clock_gettime(CLOCK_MONOTONIC, &pRobot->released);
+	pthread_mutex_unlock(&session_lock);
+
+	pthread_mutex_lock(&pPoller->lock);
+	pRobot->next_polled = pPoller->robots;
+	pPoller->robots = pRobot;
+	if(pPoller->polling == FALSE)
+	{
+		pPoller->polling = TRUE;
+		if(pthread_create(&pPoller->thread, NULL, Robot_poll, pPoller) != 0)
+		{
+			printf("ERROR : the robots could not be polled \n");
+			pPoller->polling = FALSE;
+		}
+	}
+	pthread_mutex_unlock(&pPoller->lock);
 }
 
 void Robot_stop(Robot* pRobot)
 {
-	ProSE_Intox_close();
+	RobotPoller* pPoller = pRobot->poller;
+	bool_e last_polled = FALSE;
+	pthread_mutex_lock(&pPoller->lock);
+	for(Robot** ppPolled = &pPoller->robots; *ppPolled != NULL; ppPolled = &(*ppPolled)->next_polled)
+	{
+		if(*ppPolled == pRobot)
+		{
+			*ppPolled = pRobot->next_polled;
+			last_polled = (pPoller->robots == NULL && pPoller->polling == TRUE)? TRUE : FALSE;
+			break;
+		}
+	}
+	if(last_polled == TRUE)
+	{
+		//Sees the list empty at its next sample.
+		pPoller->polling = FALSE;
+	}
+	pthread_mutex_unlock(&pPoller->lock);
+	if(last_polled == TRUE)
+	{
+		pthread_join(pPoller->thread, NULL);
+	}
+	pthread_mutex_lock(&pRobot->lock);
+	//The ramps are not stepped any more : cut short.
+	Robot_setWheel(&pRobot->left, pRobot->leftMotor, pRobot->left.goal);
+	Robot_setWheel(&pRobot->right, pRobot->rightMotor, pRobot->right.goal);
+	pthread_mutex_unlock(&pRobot->lock);
+
+	pthread_mutex_lock(&session_lock);
+	if(--nb_intox_users == 0)
+	{
+		ProSE_Intox_close();
+	}
 
 	//Closing the motors
 	if(Motor_close(pRobot->leftMotor) == -1)
@@ -124,9 +357,10 @@ void Robot_stop(Robot* pRobot)
 	{
 		PProseError("Error while closing light sensor.");
 	}
+	pthread_mutex_unlock(&session_lock);
 }
 
-Robot* Robot_new(void)
+Robot* Robot_new(const RobotConfig* pConfig)
 {
 	Robot* pRobot = (Robot*) malloc(sizeof(Robot));
 	if(pRobot == NULL)
@@ -134,38 +368,549 @@ Robot* Robot_new(void)
 		printf("ERROR : pRobot is NULL /n");
 		while(1);
 	}
+	pthread_mutex_init(&pRobot->lock, NULL);
+	pRobot->config = (pConfig != NULL)? *pConfig : Robot_getDefaultConfig();
+	pRobot->bump_handler = NULL;
+	pRobot->bump_stats.nb_bumps = 0;
+	pRobot->bump_stats.latency_max_ns = 0;
+	pRobot->bump_stats.latency_total_ns = 0;
+	pRobot->poller = &shared_poller;
+	pRobot->next_polled = NULL;
+	if(Profile_initTable(&pRobot->profile, pRobot->config.acceleration, pRobot->config.jerk, ROBOT_CODER_PERIOD_US / 1e6f) == FALSE)
+	{
+		printf("ERROR : ramps of %g %%/s at %g %%/s2 refused, default ones used\n", pRobot->config.acceleration, pRobot->config.jerk);
+		pRobot->config.acceleration = ROBOT_ACCELERATION;
+		pRobot->config.jerk = ROBOT_JERK;
+		Profile_initTable(&pRobot->profile, ROBOT_ACCELERATION, ROBOT_JERK, ROBOT_CODER_PERIOD_US / 1e6f);
+	}
 	return pRobot;
 }
 
+RobotConfig Robot_getDefaultConfig()
+{
+	RobotConfig config =
+	{
+		.intox_address = adresse_infox,
+		.intox_port = port,
+		.left_motor = LEFT_MOTOR,
+		.right_motor = RIGHT_MOTOR,
+		.light_sensor = LIGHT_SENSOR,
+		.front_bumper = FRONT_BUMPER,
+		.floor_sensor = FLOOR_SENSOR,
+		.wheel_diameter_mm = WHEEL_DIAMETER,
+		.track_mm = WHEEL_TRACK,
+		.acceleration = ROBOT_ACCELERATION,
+		.jerk = ROBOT_JERK
+	};
+	return config;
+}
+
+bool_e Robot_parseConfig(const char* line, RobotConfig* pConfig)
+{
+	char address[64];
+	char ports[5][4];
+	int intox_port;
+	*pConfig = Robot_getDefaultConfig();
+	if(sscanf(line, "%63s %d %3s %3s %3s %3s %3s", address, &intox_port, ports[0], ports[1], ports[2], ports[3], ports[4]) != 7)
+	{
+		return FALSE;
+	}
+	for(int i = 0; i < 5; i++)
+	{
+		//The motors on MA to MD, the sensors on S1 to S4.
+		if((i < 2 && (ports[i][0] != 'M' || ports[i][1] < 'A' || ports[i][1] > 'D'))
+				|| (i >= 2 && (ports[i][0] != 'S' || ports[i][1] < '1' || ports[i][1] > '4')) || ports[i][2] != '\0')
+		{
+			return FALSE;
+		}
+	}
+	pConfig->intox_address = strdup(address);
+	if(pConfig->intox_address == NULL)
+	{
+		printf("ERROR : intox_address is NULL \n");
+		while(1);
+	}
+	pConfig->intox_port = intox_port;
+	pConfig->left_motor = (LegoMotor) (MA + ports[0][1] - 'A');
+	pConfig->right_motor = (LegoMotor) (MA + ports[1][1] - 'A');
+	pConfig->light_sensor = (LegoSensor) (S1 + ports[2][1] - '1');
+	pConfig->front_bumper = (LegoSensor) (S1 + ports[3][1] - '1');
+	pConfig->floor_sensor = (LegoSensor) (S1 + ports[4][1] - '1');
+	return TRUE;
+}
+
+bool_e Robot_isSameSession(const RobotConfig* pConfig, const RobotConfig* pOther)
+{
+	return pConfig->intox_port == pOther->intox_port && strcmp(pConfig->intox_address, pOther->intox_address) == 0;
+}
+
+bool_e Robot_checkConfigs(const RobotConfig* pConfigs, int nb_robots, int nb_workers)
+{
+	bool_e valid = TRUE;
+	bool_e several_sessions = FALSE;
+	for(int i = 1; i < nb_robots; i++)
+	{
+		if(Robot_isSameSession(&pConfigs[i], &pConfigs[0]) == FALSE)
+		{
+			several_sessions = TRUE;
+		}
+	}
+	for(int i = 0; i < nb_robots; i++)
+	{
+		const RobotConfig* pConfig = &pConfigs[i];
+		const RobotConfig* pFirst = &pConfigs[i % nb_workers]; //the first robot of its worker.
+		unsigned int motors = (1u << pConfig->left_motor) | (1u << pConfig->right_motor);
+		unsigned int sensors = (1u << pConfig->light_sensor) | (1u << pConfig->front_bumper) | (1u << pConfig->floor_sensor);
+		if(several_sessions == TRUE && Robot_isSameSession(pConfig, pFirst) == FALSE)
+		{
+			printf("ERROR : robot %d on %s:%d, its worker %d is on %s:%d, one Intox session per worker process\n", i,
+					pConfig->intox_address, pConfig->intox_port, i % nb_workers, pFirst->intox_address, pFirst->intox_port);
+			valid = FALSE;
+		}
+		if(pConfig->left_motor == pConfig->right_motor || pConfig->light_sensor == pConfig->front_bumper
+				|| pConfig->light_sensor == pConfig->floor_sensor || pConfig->front_bumper == pConfig->floor_sensor)
+		{
+			printf("ERROR : robot %d uses a port twice\n", i);
+			valid = FALSE;
+		}
+		for(int j = 0; j < i; j++)
+		{
+			if(Robot_isSameSession(pConfig, &pConfigs[j]) == FALSE)
+			{
+				continue;
+			}
+			if(several_sessions == TRUE && j % nb_workers != i % nb_workers)
+			{
+				printf("ERROR : robots %d and %d on %s:%d are driven by two worker processes\n", j, i,
+						pConfig->intox_address, pConfig->intox_port);
+				valid = FALSE;
+			}
+			unsigned int other_motors = (1u << pConfigs[j].left_motor) | (1u << pConfigs[j].right_motor);
+			unsigned int other_sensors = (1u << pConfigs[j].light_sensor) | (1u << pConfigs[j].front_bumper)
+					| (1u << pConfigs[j].floor_sensor);
+			if((motors & other_motors) != 0 || (sensors & other_sensors) != 0)
+			{
+				printf("ERROR : robots %d and %d share a motor or a sensor\n", j, i);
+				valid = FALSE;
+			}
+		}
+	}
+	return valid;
+}
+
+bool_e Robot_checkMotionProfile(float acceleration, float jerk)
+{
+	if(Profile_fits(acceleration, jerk, ROBOT_CODER_PERIOD_US / 1e6f) == FALSE)
+	{
+		printf("ERROR : an acceleration of %g %%/s takes more than %d ms to reach at %g %%/s2\n", acceleration,
+				PROFILE_CAPACITY * ROBOT_CODER_PERIOD_US / 1000, jerk);
+		return FALSE;
+	}
+	return TRUE;
+}
+
 void Robot_free(Robot* pRobot)
 {
 	printf("Destruction pRobot");
+	pthread_mutex_destroy(&pRobot->lock);
 	free(pRobot);
 }
 
 void Robot_setWheelsVelocity(Robot* pRobot,int mr,int ml)
 {
-	if(Motor_setCmd(pRobot->leftMotor,ml) == -1)
+	pthread_mutex_lock(&pRobot->lock);
+	if(mr == 0 && ml == 0)
 	{
-		PProseError("The command has not been given to the left motor.");
+		//A stop is not ramped : the watchdog and the STOP of the telco rely on it being at once.
+		if(Robot_setWheel(&pRobot->left, pRobot->leftMotor, 0) == FALSE || Robot_setWheel(&pRobot->right, pRobot->rightMotor, 0) == FALSE)
+		{
+			PProseError("The motors have not been stopped.");
+		}
 	}
-	if(Motor_setCmd(pRobot->rightMotor,mr) == -1)
+	else
 	{
-		PProseError("The command has not been given to the right motor.");
+		if(Robot_driveWheel(&pRobot->left, pRobot->leftMotor, &pRobot->profile, ml) == FALSE)
+		{
+			PProseError("The command has not been given to the left motor.");
+		}
+		if(Robot_driveWheel(&pRobot->right, pRobot->rightMotor, &pRobot->profile, mr) == FALSE)
+		{
+			PProseError("The command has not been given to the right motor.");
+		}
 	}
+	pthread_mutex_unlock(&pRobot->lock);
 }
 
 int Robot_getRobotSpeed(Robot* pRobot)
 {
-	return ((abs(Motor_getCmd(pRobot->leftMotor)) + abs(Motor_getCmd(pRobot->rightMotor))) / 2);
+	int speed;
+	pthread_mutex_lock(&pRobot->lock);
+	if(pRobot->left.measured == TRUE && pRobot->right.measured == TRUE)
+	{
+		speed = Robot_round((Robot_abs(pRobot->left.speed) + Robot_abs(pRobot->right.speed)) / 2);
+	}
+	else
+	{
+		speed = (abs(Motor_getCmd(pRobot->leftMotor)) + abs(Motor_getCmd(pRobot->rightMotor))) / 2;
+	}
+	pthread_mutex_unlock(&pRobot->lock);
+	return speed;
+}
+
+bool_e Robot_getWheelsSpeed(Robot* pRobot, int* pRight, int* pLeft)
+{
+	bool_e measured = FALSE;
+	pthread_mutex_lock(&pRobot->lock);
+	if(pRobot->left.measured == TRUE && pRobot->right.measured == TRUE)
+	{
+		*pRight = Robot_round(pRobot->right.speed);
+		*pLeft = Robot_round(pRobot->left.speed);
+		measured = TRUE;
+	}
+	pthread_mutex_unlock(&pRobot->lock);
+	return measured;
 }
 
 SensorState Robot_getSensorState(Robot* pRobot)
 {
 	SensorState sensorStatus;
-	sensorStatus.collision = (ContactSensor_getStatus(pRobot->FloorSensor) || ContactSensor_getStatus(pRobot->FrontSensor))? BUMPED : NO_BUMP;
+	pthread_mutex_lock(&pRobot->lock);
+	sensorStatus.collision = (ContactSensor_getStatus(pRobot->FloorSensor) == PRESSED
+			|| ContactSensor_getStatus(pRobot->FrontSensor) == PRESSED)? BUMPED : NO_BUMP;
 	sensorStatus.luminosity = LightSensor_getStatus(pRobot->lightSensor);
+	pthread_mutex_unlock(&pRobot->lock);
 
 	return sensorStatus;
 }
+RobotPoller* Robot_newPoller()
+{
+	RobotPoller* pPoller = (RobotPoller*) malloc(sizeof(RobotPoller));
+	if(pPoller == NULL)
+	{
+		printf("ERROR : pPoller is NULL \n");
+		while(1);
+	}
+	pthread_mutex_init(&pPoller->lock, NULL);
+	pPoller->robots = NULL;
+	pPoller->polling = FALSE;
+	memset(&pPoller->stats, 0, sizeof(pPoller->stats));
+	return pPoller;
+}
+
+void Robot_freePoller(RobotPoller* pPoller)
+{
+	pthread_mutex_destroy(&pPoller->lock);
+	free(pPoller);
+}
+
+void Robot_setPoller(Robot* pRobot, RobotPoller* pPoller)
+{
+	pRobot->poller = (pPoller != NULL)? pPoller : &shared_poller;
+}
+
+RobotPollStats Robot_getPollStats(RobotPoller* pPoller)
+{
+	RobotPollStats stats;
+	pthread_mutex_lock(&pPoller->lock);
+	stats = pPoller->stats;
+	pthread_mutex_unlock(&pPoller->lock);
+	return stats;
+}
+
+void Robot_setBumpHandler(Robot* pRobot, RobotBumpHandler handler, void* pContext, int id)
+{
+	pRobot->bump_handler = handler;
+	pRobot->bump_context = pContext;
+	pRobot->bump_id = id;
+}
+
+RobotBumpStats Robot_getBumpStats(Robot* pRobot)
+{
+	RobotBumpStats stats;
+	pthread_mutex_lock(&pRobot->lock);
+	stats = pRobot->bump_stats;
+	pthread_mutex_unlock(&pRobot->lock);
+	return stats;
+}
+
+void Robot_setMotionProfile(Robot* pRobot, float acceleration, float jerk)
+{
+	pthread_mutex_lock(&pRobot->lock);
+	if(Profile_initTable(&pRobot->profile, acceleration, jerk, ROBOT_CODER_PERIOD_US / 1e6f) == TRUE)
+	{
+		pRobot->config.acceleration = acceleration;
+		pRobot->config.jerk = jerk;
+	}
+	pthread_mutex_unlock(&pRobot->lock);
+}
+
+OdometryPose Robot_getPose(Robot* pRobot)
+{
+	OdometryPose pose;
+	pthread_mutex_lock(&pRobot->lock);
+	pose = pRobot->odometry.pose;
+	pthread_mutex_unlock(&pRobot->lock);
+	return pose;
+}
 /* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static void* Robot_poll(void* pArg)
+{
+	RobotPoller* pPoller = (RobotPoller*) pArg;
+	struct timespec deadline;
+	struct timespec now;
+	struct timespec controlled;
+	long period_ns = ROBOT_CODER_PERIOD_US * 1000L;
+	long late;
+	bool_e control;
+	float period = 0;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	controlled = deadline;
+	for(unsigned long tick = 1; ; tick++)
+	{
+		//Held for the list only, a robot called by its worker waits for its own sample at most.
+		pthread_mutex_lock(&pPoller->lock);
+		if(pPoller->polling == FALSE)
+		{
+			pthread_mutex_unlock(&pPoller->lock);
+			break;
+		}
+		control = (tick % (ROBOT_SPEED_PERIOD_US / ROBOT_CODER_PERIOD_US) == 0)? TRUE : FALSE;
+		if(control == TRUE)
+		{
+			//The time elapsed is measured, a late tick does not distort the speeds.
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			period = (now.tv_sec - controlled.tv_sec) + (now.tv_nsec - controlled.tv_nsec) / 1e9f;
+			controlled = now;
+		}
+		for(Robot* pRobot = pPoller->robots; pRobot != NULL; pRobot = pRobot->next_polled)
+		{
+			pthread_mutex_lock(&pRobot->lock);
+			Robot_sampleCoders(pRobot);
+			if(Profile_isRunning(&pRobot->left.ramp) == TRUE)
+			{
+				Robot_stepWheel(&pRobot->left, pRobot->leftMotor, &pRobot->profile);
+			}
+			if(Profile_isRunning(&pRobot->right.ramp) == TRUE)
+			{
+				Robot_stepWheel(&pRobot->right, pRobot->rightMotor, &pRobot->profile);
+			}
+			if(pRobot->bump_handler != NULL && tick % (ROBOT_BUMP_PERIOD_US / ROBOT_CODER_PERIOD_US) == 0)
+			{
+				clock_gettime(CLOCK_MONOTONIC, &now);
+				Robot_checkBumpers(pRobot, &now);
+			}
+			if(control == TRUE)
+			{
+				Robot_controlSpeed(pRobot, period);
+			}
+			pthread_mutex_unlock(&pRobot->lock);
+		}
+		//Absolute deadlines, the time spent in the tick does not shift the next ones.
+		deadline.tv_nsec += period_ns;
+		deadline.tv_sec += deadline.tv_nsec / 1000000000;
+		deadline.tv_nsec %= 1000000000;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		late = (now.tv_sec - deadline.tv_sec) * 1000000000L + (now.tv_nsec - deadline.tv_nsec);
+		pPoller->stats.nb_ticks++;
+		if(late >= 0)
+		{
+			//Too many robots for the period : the deadlines already over are skipped, the phase is kept.
+			long nb_missed = late / period_ns + 1;
+			pPoller->stats.nb_overruns++;
+			pPoller->stats.nb_missed += nb_missed;
+			if(late > pPoller->stats.overrun_max_ns)
+			{
+				pPoller->stats.overrun_max_ns = late;
+			}
+			deadline.tv_nsec += (nb_missed * period_ns) % 1000000000;
+			deadline.tv_sec += (nb_missed * period_ns) / 1000000000 + deadline.tv_nsec / 1000000000;
+			deadline.tv_nsec %= 1000000000;
+		}
+		pthread_mutex_unlock(&pPoller->lock);
+		while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR);
+	}
+	return NULL;
+}
+
+static void Robot_checkBumpers(Robot* pRobot, const struct timespec* pNow)
+{
+	struct timespec stopped;
+	//A sensor in error is not a bump, it would stop the robot at every sample.
+	bool_e pressed = (ContactSensor_getStatus(pRobot->FrontSensor) == PRESSED
+			|| ContactSensor_getStatus(pRobot->FloorSensor) == PRESSED)? TRUE : FALSE;
+	if(pressed == FALSE)
+	{
+		pRobot->pressed = FALSE;
+		pRobot->released = *pNow;
+		return;
+	}
+	if(pRobot->pressed == TRUE)
+	{
+		//Still pressed, the telco may drive the robot out of the obstacle.
+		return;
+	}
+	pRobot->pressed = TRUE;
+	//At once, and the speed control does not start them again.
+	if(Robot_setWheel(&pRobot->left, pRobot->leftMotor, 0) == FALSE || Robot_setWheel(&pRobot->right, pRobot->rightMotor, 0) == FALSE)
+	{
+		PProseError("The motors have not been stopped after a bump.");
+	}
+	clock_gettime(CLOCK_MONOTONIC, &stopped);
+	long latency = (stopped.tv_sec - pRobot->released.tv_sec) * 1000000000L + (stopped.tv_nsec - pRobot->released.tv_nsec);
+	pRobot->bump_stats.nb_bumps++;
+	pRobot->bump_stats.latency_total_ns += latency;
+	if(latency > pRobot->bump_stats.latency_max_ns)
+	{
+		pRobot->bump_stats.latency_max_ns = latency;
+	}
+	pRobot->bump_handler(pRobot->bump_context, pRobot->bump_id);
+}
+
+static void Robot_controlSpeed(Robot* pRobot, float period)
+{
+	float correction = 0;
+	Robot_measureWheel(&pRobot->left, period);
+	Robot_measureWheel(&pRobot->right, period);
+	if(pRobot->left.goal != 0 && abs(pRobot->left.goal) == abs(pRobot->right.goal))
+	{
+		//Same speed on both wheels (straight or spinning) : the one ahead waits for the other.
+		long ahead = ((pRobot->left.goal > 0)? pRobot->left.traveled : -pRobot->left.traveled)
+				- ((pRobot->right.goal > 0)? pRobot->right.traveled : -pRobot->right.traveled);
+		correction = ROBOT_SPEED_SYNC * ahead;
+	}
+	Robot_controlWheel(&pRobot->left, pRobot->leftMotor, (pRobot->left.goal > 0)? -correction : correction, period);
+	Robot_controlWheel(&pRobot->right, pRobot->rightMotor, (pRobot->right.goal > 0)? correction : -correction, period);
+}
+
+static void Robot_controlWheel(RobotWheel* pWheel, Motor* pMotor, float correction, float period)
+{
+	float error;
+	float power;
+	int cmd;
+	if(pWheel->measured == FALSE || pWheel->target == 0)
+	{
+		//Open loop without coder, and a stopped wheel is not held.
+		return;
+	}
+	error = pWheel->target + correction - pWheel->speed;
+	if(Profile_isRunning(&pWheel->ramp) == FALSE)
+	{
+		//The filtered speed lags behind a ramp, that error would wind the integral up.
+		pWheel->integral += error * period;
+	}
+	if(pWheel->integral > ROBOT_SPEED_INTEGRAL_MAX)
+	{
+		pWheel->integral = ROBOT_SPEED_INTEGRAL_MAX;
+	}
+	else if(pWheel->integral < -ROBOT_SPEED_INTEGRAL_MAX)
+	{
+		pWheel->integral = -ROBOT_SPEED_INTEGRAL_MAX;
+	}
+	//The target is the power expected for that speed, the gains correct what the wheel really does.
+	pWheel->correction = ROBOT_SPEED_KP * error + ROBOT_SPEED_KI * pWheel->integral - ROBOT_SPEED_KD * pWheel->rate;
+	power = pWheel->target + pWheel->correction;
+	cmd = (power > 100)? 100 : ((power < -100)? -100 : Robot_round(power));
+	if(cmd != pWheel->cmd && Motor_setCmd(pMotor, cmd) != -1)
+	{
+		pWheel->cmd = cmd;
+	}
+}
+
+static void Robot_measureWheel(RobotWheel* pWheel, float period)
+{
+	if(pWheel->measured == TRUE && period > 0)
+	{
+		float speed = pWheel->speed + ROBOT_SPEED_FILTER * (pWheel->pending * 100.0f / ROBOT_NOMINAL_SPEED / period - pWheel->speed);
+		pWheel->rate = (speed - pWheel->speed) / period;
+		pWheel->speed = speed;
+		pWheel->traveled += pWheel->pending;
+	}
+	pWheel->pending = 0;
+}
+
+static void Robot_sampleCoders(Robot* pRobot)
+{
+	int32_t left = Robot_readWheel(&pRobot->left, pRobot->leftMotor, pRobot->coder_modulo);
+	int32_t right = Robot_readWheel(&pRobot->right, pRobot->rightMotor, pRobot->coder_modulo);
+	Odometry_update(&pRobot->odometry, left, right);
+}
+
+static int32_t Robot_readWheel(RobotWheel* pWheel, Motor* pMotor, int modulo)
+{
+	IncrementalValue coder = Motor_getIncrementalCoderValue(pMotor);
+	int32_t delta = 0;
+	if(coder == E_GCODER)
+	{
+		pWheel->measured = FALSE;
+		pWheel->pending = 0;
+		return 0;
+	}
+	if(pWheel->measured == TRUE)
+	{
+		//Sampled often enough for a wheel to turn less than half a turn in between.
+		delta = Odometry_getDelta(coder, pWheel->coder, modulo);
+		pWheel->pending += delta;
+	}
+	pWheel->coder = coder;
+	pWheel->measured = TRUE;
+	return delta;
+}
+
+static bool_e Robot_setWheel(RobotWheel* pWheel, Motor* pMotor, int goal)
+{
+	if(goal != pWheel->goal)
+	{
+		pWheel->goal = goal;
+		pWheel->integral = 0;
+		pWheel->traveled = 0;
+	}
+	Profile_init(&pWheel->ramp, goal);
+	pWheel->target = goal;
+	pWheel->correction = 0;
+	pWheel->cmd = goal;
+	return (Motor_setCmd(pMotor, goal) == -1)? FALSE : TRUE;
+}
+
+static bool_e Robot_driveWheel(RobotWheel* pWheel, Motor* pMotor, const ProfileTable* pTable, int goal)
+{
+	if(goal == pWheel->goal)
+	{
+		return TRUE;
+	}
+	pWheel->goal = goal;
+	pWheel->integral = 0;
+	pWheel->traveled = 0;
+	pWheel->correction = 0;
+	Profile_start(&pWheel->ramp, pTable, goal);
+	return Robot_stepWheel(pWheel, pMotor, pTable);
+}
+
+static bool_e Robot_stepWheel(RobotWheel* pWheel, Motor* pMotor, const ProfileTable* pTable)
+{
+	float power;
+	int cmd;
+	pWheel->target = Robot_round(Profile_next(&pWheel->ramp, pTable));
+	//The correction of the speed control follows the ramp, a stopped wheel is not held.
+	power = (pWheel->target != 0)? pWheel->target + pWheel->correction : 0;
+	cmd = (power > 100)? 100 : ((power < -100)? -100 : Robot_round(power));
+	if(cmd == pWheel->cmd)
+	{
+		return TRUE;
+	}
+	if(Motor_setCmd(pMotor, cmd) == -1)
+	{
+		return FALSE;
+	}
+	pWheel->cmd = cmd;
+	return TRUE;
+}
+
+static int Robot_round(float value)
+{
+	return (int) ((value >= 0)? value + 0.5f : value - 0.5f);
+}
+
+static float Robot_abs(float value)
+{
+	return (value >= 0)? value : -value;
+}
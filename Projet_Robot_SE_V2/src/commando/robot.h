@@ -37,7 +37,30 @@
 #define SRC_COMMANDO_ROBOT_H
 /* ----------------------  INCLUDES ------------------------------------------*/
 #include "prose.h"
+#include "odometry.h"
+#include "profile.h"
 /* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/**
+ * \brief Period of the sampling of the coders, integrated by the odometry of the robots started.
+ */
+#define ROBOT_CODER_PERIOD_US (1000)
+/**
+ * \brief Period of the polling of the bumpers of the robots with a bump handler, a multiple of ROBOT_CODER_PERIOD_US.
+ */
+#define ROBOT_BUMP_PERIOD_US (1000)
+/**
+ * \brief Period of the speed control of the wheels, a multiple of ROBOT_CODER_PERIOD_US.
+ */
+#define ROBOT_SPEED_PERIOD_US (10000)
+/**
+ * \brief Coder pulses per second of a wheel at the power 100, the speed 100 of the speed control.
+ */
+#define ROBOT_NOMINAL_SPEED (720)
+/**
+ * \brief Default limits of the ramps of the speed of the wheels : 0 to 100 in 0.35 s.
+ */
+#define ROBOT_ACCELERATION (400.0f)
+#define ROBOT_JERK (4000.0f)
 /**
  * \enum Collision
  * \brief Constant for collisions.
@@ -53,11 +76,65 @@ typedef struct
     float luminosity;
 } SensorState;
 
+/**
+ * \struct RobotConfig
+ * \brief Intox simulator and ports of the motors and sensors of one robot.
+ */
+typedef struct
+{
+    const char* intox_address;
+    int intox_port;
+    LegoMotor left_motor;
+    LegoMotor right_motor;
+    LegoSensor light_sensor;
+    LegoSensor front_bumper;
+    LegoSensor floor_sensor;
+    float wheel_diameter_mm; //geometry of the robot for its odometry.
+    float track_mm; //distance between the wheels.
+    float acceleration; //limits of the ramps of the wheels in percent/s and percent/s2, see Robot_setMotionProfile.
+    float jerk;
+} RobotConfig;
+
+/**
+ * \struct RobotBumpStats
+ * \brief Bumps detected by the polling and the time taken to stop the motors.
+ */
+typedef struct
+{
+    unsigned long nb_bumps;
+    long latency_max_ns; //from the last sample with the bumpers released to both motors stopped.
+    long long latency_total_ns;
+} RobotBumpStats;
+
+/**
+ * \struct RobotPollStats
+ * \brief Ticks of a polling thread and those which ended after the deadline of the next one.
+ */
+typedef struct
+{
+    unsigned long nb_ticks;
+    unsigned long nb_overruns; //ticks which ended late, the deadlines already over are skipped.
+    unsigned long nb_missed; //deadlines skipped.
+    long overrun_max_ns; //from the deadline to the end of the tick, the longest one.
+} RobotPollStats;
+
+/**
+ * \brief Called by the polling thread once the motors of a robot which bumped are stopped,
+ *        with the lock of the robot held : it must not call the Robot.
+ */
+typedef void (*RobotBumpHandler)(void* pContext, int id);
+
 /**
  * \struct Robot
  * \brief Robot object.
  */
 typedef struct Robot_t Robot;
+
+/**
+ * \struct RobotPoller
+ * \brief Thread polling a shard of the robots started (those of a worker) every ROBOT_CODER_PERIOD_US.
+ */
+typedef struct RobotPoller_t RobotPoller;
 /* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
 /* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
 /* ----------------------  PUBLIC VARIBLES -----------------------------------*/
@@ -73,10 +150,46 @@ extern void Robot_start(Robot* pRobot);
  */
 extern void Robot_stop(Robot* pRobot);
 /**
- * \fn extern void Robot_new()
+ * \fn extern Robot* Robot_new(const RobotConfig* pConfig)
  * \brief Initialize in memory the object Robot.
+ *
+ * \param const RobotConfig* pConfig : simulator and ports of the robot, NULL for the default ones.
  */
-extern Robot* Robot_new();
+extern Robot* Robot_new(const RobotConfig* pConfig);
+/**
+ * \fn extern RobotConfig Robot_getDefaultConfig()
+ * \brief Get the simulator and ports of the robot when there is only one.
+ */
+extern RobotConfig Robot_getDefaultConfig();
+/**
+ * \fn extern bool_e Robot_parseConfig(const char* line, RobotConfig* pConfig)
+ * \brief Read the simulator and ports of a robot from a line of a fleet configuration :
+ *        "address port left_motor right_motor light_sensor front_bumper floor_sensor", e.g.
+ *        "127.0.0.1 12345 MD MA S1 S3 S2". The other fields keep their default value.
+ *
+ * \param RobotConfig* pConfig : its address is allocated, freed with free().
+ * \return bool_e : FALSE if the line is not a valid configuration.
+ */
+extern bool_e Robot_parseConfig(const char* line, RobotConfig* pConfig);
+/**
+ * \fn extern bool_e Robot_isSameSession(const RobotConfig* pConfig, const RobotConfig* pOther)
+ * \brief Whether two robots are on the same Intox simulator, hence in the same libinfox session.
+ */
+extern bool_e Robot_isSameSession(const RobotConfig* pConfig, const RobotConfig* pOther);
+/**
+ * \fn extern bool_e Robot_checkConfigs(const RobotConfig* pConfigs, int nb_robots, int nb_workers)
+ * \brief Whether robots can be driven by nb_workers workers, robot r by the worker r % nb_workers :
+ *        no motor or sensor may be shared by two robots of a simulator, and libinfox holds a single
+ *        Intox session per process, so a fleet on several simulators needs one simulator per worker.
+ *        The conflicts are printed.
+ */
+extern bool_e Robot_checkConfigs(const RobotConfig* pConfigs, int nb_robots, int nb_workers);
+/**
+ * \fn extern bool_e Robot_checkMotionProfile(float acceleration, float jerk)
+ * \brief Whether the limits of the ramps can be followed : the acceleration must reach its limit at the jerk
+ *        within PROFILE_CAPACITY ticks of ROBOT_CODER_PERIOD_US. The reason of a refusal is printed.
+ */
+extern bool_e Robot_checkMotionProfile(float acceleration, float jerk);
 /**
  *  \fn extern void Robot_free()
  *  \brief Destruct the object Robot from memory.
@@ -84,9 +197,10 @@ extern Robot* Robot_new();
 extern void Robot_free(Robot* pRobot);
 /**
  * \fn extern int Robot_getRobotSpeed()
- * \brief Get the speed of the robot (positive average of the right's and left's current wheel power).
+ * \brief Get the speed of the robot (positive average of the right's and left's wheel speed measured by
+ *        the coders, the current wheel power if they cannot be read).
  * 
- * \return Speed of the robot (between 0 and 100).
+ * \return Speed of the robot (between 0 and 100, in percent of ROBOT_NOMINAL_SPEED).
  */
 extern int Robot_getRobotSpeed(Robot* pRobot);
 /**
@@ -98,12 +212,66 @@ extern int Robot_getRobotSpeed(Robot* pRobot);
 extern SensorState Robot_getSensorState(Robot* pRobot);
 /**
  * \fn extern void Robot_setWheelsVelocity()
- * \brief Set the power on the wheels of the robot.
+ * \brief Set the speed of the wheels of the robot : reached along a ramp stepped every ROBOT_CODER_PERIOD_US
+ *         (its first step is applied at once), then the speed control adjusts the power every
+ *         ROBOT_SPEED_PERIOD_US so that the coders measure that speed. Both speeds at 0 stop the motors at once.
  * 
- * \param int mr : right's wheel power, value between -10O and 100.
- * \param int ml : left's wheel power, value between -100 and 100.
+ * \param int mr : right's wheel speed, value between -10O and 100 (percent of ROBOT_NOMINAL_SPEED).
+ * \param int ml : left's wheel speed, value between -100 and 100.
  */
 extern void Robot_setWheelsVelocity(Robot* pRobot,int mr,int ml);
+/**
+ * \fn extern bool_e Robot_getWheelsSpeed(Robot* pRobot, int* pRight, int* pLeft)
+ * \brief Get the speed of each wheel measured by its coder, in percent of ROBOT_NOMINAL_SPEED (signed).
+ *
+ * \return bool_e : FALSE if the coders cannot be read, the speeds are left as is.
+ */
+extern bool_e Robot_getWheelsSpeed(Robot* pRobot, int* pRight, int* pLeft);
+/**
+ * \fn extern RobotPoller* Robot_newPoller()
+ * \brief Initialize in memory a polling thread, started with the first of its robots and joined with the last one.
+ */
+extern RobotPoller* Robot_newPoller();
+/**
+ * \fn extern void Robot_freePoller(RobotPoller* pPoller)
+ * \brief Destruct a polling thread from memory, once its robots are stopped.
+ */
+extern void Robot_freePoller(RobotPoller* pPoller);
+/**
+ * \fn extern void Robot_setPoller(Robot* pRobot, RobotPoller* pPoller)
+ * \brief Before Robot_start, poll the robot from pPoller. The robots without one share a thread of the process.
+ */
+extern void Robot_setPoller(Robot* pRobot, RobotPoller* pPoller);
+/**
+ * \fn extern RobotPollStats Robot_getPollStats(RobotPoller* pPoller)
+ * \brief Get the ticks of a polling thread and its overruns.
+ */
+extern RobotPollStats Robot_getPollStats(RobotPoller* pPoller);
+/**
+ * \fn extern void Robot_setBumpHandler(Robot* pRobot, RobotBumpHandler handler, void* pContext, int id)
+ * \brief Before Robot_start, poll the bumpers of the robot every ROBOT_BUMP_PERIOD_US while it is started :
+ *        when one of them gets pressed, the motors are stopped at once and handler(pContext, id) is called.
+ */
+extern void Robot_setBumpHandler(Robot* pRobot, RobotBumpHandler handler, void* pContext, int id);
+/**
+ * \fn extern RobotBumpStats Robot_getBumpStats(Robot* pRobot)
+ * \brief Get the bumps detected by the polling of the robot.
+ */
+extern RobotBumpStats Robot_getBumpStats(Robot* pRobot);
+/**
+ * \fn extern OdometryPose Robot_getPose(Robot* pRobot)
+ * \brief Get the pose of the robot integrated from its coders every ROBOT_CODER_PERIOD_US since it is started.
+ */
+extern OdometryPose Robot_getPose(Robot* pRobot);
+/**
+ * \fn extern void Robot_setMotionProfile(Robot* pRobot, float acceleration, float jerk)
+ * \brief Set the limits of the ramps followed by the speed of the wheels (a ramp in progress keeps its length).
+ *        Limits refused by Robot_checkMotionProfile are not set, the robot keeps its previous ones.
+ *
+ * \param float acceleration : percent/s, 0 for speeds applied at once.
+ * \param float jerk : percent/s2, 0 for trapezoidal ramps.
+ */
+extern void Robot_setMotionProfile(Robot* pRobot, float acceleration, float jerk);
 
 #endif /* SRC_COMMANDO_ROBOT_H */
 
@@ -33,6 +33,8 @@
  */
 /* ----------------------  INCLUDES  ---------------------------------------- */
 #include "server.h"
+#include "server_epoll.h"
+#include "server_uring.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -41,115 +43,1338 @@
 #include <netdb.h>
 #include <sys/types.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <sys/un.h>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <time.h>
+#include <signal.h>
 /* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
-#define MAX_PENDING_CONNECTIONS 5
+#define MAX_PENDING_CONNECTIONS 128
+/**
+ * \brief Time to wait for a telemetry sample asked to the control thread before asking again.
+ */
+#define SERVER_SAMPLE_TIMEOUT_MS 100
 /* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
 /* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
 /* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
 /* ----------------------  PRIVATE VARIABLES  ------------------------------- */
-bool_e shut_down = TRUE; //Used to get out or stay into the while loop.
+static int server_notify_fd = -1; //notify_fd of the traced server, written by Server_onSignal.
 /* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
-static void Server_sendMsg(Server* pServer);
-
-static void Server_readMsg(Server* pServer);
-
-static void Server_run(Server* pServer);
+/**
+ * \fn static void Server_onSignal(int signum)
+ * \brief Ask for the histograms of the traces on SIGUSR1, printed by the network thread.
+ */
+static void Server_onSignal(int signum);
+/**
+ * \fn static void Server_sendMsg(Server* pServer, Connection* pConnection)
+ * \brief Send back the donnees of a connection to its telco.
+ */
+static void Server_sendMsg(Server* pServer, Connection* pConnection);
+/**
+ * \fn static void Server_subscribe(Server* pServer, Connection* pConnection, unsigned int period_ms, uint16_t port)
+ * \brief Start (or stop when period_ms is 0) pushing the telemetry to a telco, over UDP to port if not 0.
+ */
+static void Server_subscribe(Server* pServer, Connection* pConnection, unsigned int period_ms, uint16_t port);
+/**
+ * \fn static void Server_bindDatagram(Server* pServer, Connection* pConnection, uint16_t port)
+ * \brief Bind the UDP socket of a telco, on the host of its TCP connection, to its session (or unbind it when port is 0).
+ */
+static void Server_bindDatagram(Server* pServer, Connection* pConnection, uint16_t port);
+/**
+ * \fn static Connection* Server_getPeer(Server* pServer, const struct sockaddr_in* pAddress)
+ * \brief Find the connection which has bound a UDP address.
+ *
+ * \return Connection* : NULL if no connected telco sends from that address.
+ */
+static Connection* Server_getPeer(Server* pServer, const struct sockaddr_in* pAddress);
+/**
+ * \fn static void Server_applyVelocity(Server* pServer, int robot, const VelocityVector* pVector, const Trace* pTrace)
+ * \brief Give a velocity command to the pilot of a robot.
+ *
+ * \param const Trace* pTrace : stages of the command already timestamped, NULL when it is not traced.
+ */
+static void Server_applyVelocity(Server* pServer, int robot, const VelocityVector* pVector, const Trace* pTrace);
+/**
+ * \fn static void Server_pong(Server* pServer, Connection* pConnection, uint64_t originate)
+ * \brief Send a ping back to its telco with the time it was received and the time it is sent.
+ */
+static void Server_pong(Server* pServer, Connection* pConnection, uint64_t originate);
+/**
+ * \fn static void Server_measure(Server* pServer, const DesDonnees* pDonnees)
+ * \brief Count the one-way delay of a command stamped in the timebase of the commando.
+ */
+static void Server_measure(Server* pServer, const DesDonnees* pDonnees);
+/**
+ * \fn static void Server_postTrajectory(Server* pServer, int robot, uint32_t flags, const TrajectorySegment* pSegments, int nb_segments)
+ * \brief Give the segments of a trajectory to the worker of the robot, one command each.
+ */
+static void Server_postTrajectory(Server* pServer, int robot, uint32_t flags, const TrajectorySegment* pSegments, int nb_segments);
+/**
+ * \fn static bool_e Server_bind(Server* pServer, Connection* pConnection, int robot)
+ * \brief Bind a connection to the robot named by its first frame, as its UDP source is :
+ *        a telco only drives the robot of its session.
+ *
+ * \return bool_e : FALSE if the frame addresses another robot, it is dropped and counted in nb_refused.
+ */
+static bool_e Server_bind(Server* pServer, Connection* pConnection, int robot);
+/**
+ * \fn static void Server_heartbeat(Server* pServer, int robot)
+ * \brief Feed the watchdog of a robot whose telco is alive but has nothing to command.
+ */
+static void Server_heartbeat(Server* pServer, int robot);
+/**
+ * \fn static RobotRoute* Server_route(Server* pServer, int robot)
+ * \brief Find where the commands of a robot go.
+ *
+ * \return RobotRoute* : NULL if the robot is unknown or stopped.
+ */
+static RobotRoute* Server_route(Server* pServer, int robot);
+/**
+ * \fn static void Server_publish(Server* pServer, int robot, const PilotState* pState)
+ * \brief Push a sample of a robot to every subscriber of this robot whose period is elapsed.
+ */
+static void Server_publish(Server* pServer, int robot, const PilotState* pState);
+/**
+ * \fn static void Server_deliver(Server* pServer, const Telemetry* pTelemetry)
+ * \brief Push a sample to the subscribers of its robot, or an answer to the telco which asked for it.
+ */
+static void Server_deliver(Server* pServer, const Telemetry* pTelemetry);
+/**
+ * \fn static bool_e Server_register(Server* pServer, Connection* pConnection)
+ * \brief Index a connection by its socket.
+ *
+ * \return bool_e : FALSE if the table could not grow.
+ */
+static bool_e Server_register(Server* pServer, Connection* pConnection);
+/**
+ * \fn static void Server_addMs(struct timespec* pTime, unsigned int ms)
+ * \brief Add ms milliseconds to a time.
+ */
+static void Server_addMs(struct timespec* pTime, unsigned int ms);
+/**
+ * \fn static void Server_dispatchBatch(Server* pServer, Connection* pConnection, int nb_frames)
+ * \brief Dispatch the frames of pServer->batch, a burst of velocity commands only applies the latest.
+ */
+static void Server_dispatchBatch(Server* pServer, Connection* pConnection, int nb_frames);
+/**
+ * \fn static void Server_dispatch(Server* pServer, Connection* pConnection)
+ * \brief Apply a complete message received from a telco.
+ */
+static void Server_dispatch(Server* pServer, Connection* pConnection);
+/**
+ * \fn static void Server_raiseFileLimit()
+ * \brief Raise the limit of file descriptors to its maximum, each telco takes one (three with a shared memory).
+ */
+static void Server_raiseFileLimit();
+/**
+ * \fn static void Server_listenLocal(Server* pServer)
+ * \brief Open the unix socket of the telcos of this host, they are served through a shared memory.
+ */
+static void Server_listenLocal(Server* pServer);
+/**
+ * \fn static bool_e Server_push(Server* pServer, Connection* pConnection, const ShmMessage* pMessage)
+ * \brief Push a reply or a sample to a local telco.
+ *
+ * \return bool_e : FALSE if it has been dropped because the telco does not read fast enough.
+ */
+static bool_e Server_push(Server* pServer, Connection* pConnection, const ShmMessage* pMessage);
 
-static void Server_logs(Server* pServer);
+static void Server_logs(Connection* pConnection);
 /* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
-Server* Server_new()
+Server* Server_new(int nb_robots, int nb_workers, const RobotConfig* pConfigs)
 {
 	Server* pServer = (Server*) malloc(sizeof(Server));
-	pServer->pilot = Pilot_new();
 	if(pServer == NULL)
 	{
-		printf("ERROR : pRobot is NULL /n");
+		printf("ERROR : pServer is NULL \n");
+		while(1);
+	}
+	pServer->nb_robots = (nb_robots > 0)? nb_robots : 1;
+	pServer->nb_workers = (nb_workers > 0 && nb_workers <= pServer->nb_robots)? nb_workers : 1;
+	pServer->notify_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	pServer->workers = (Controller**) malloc(pServer->nb_workers * sizeof(Controller*));
+	pServer->robots = (RobotRoute*) malloc(pServer->nb_robots * sizeof(RobotRoute));
+	if(pServer->workers == NULL || pServer->robots == NULL)
+	{
+		printf("ERROR : pServer->robots is NULL \n");
 		while(1);
 	}
+	bool_e several_sessions = FALSE;
+	for(int i = 1; pConfigs != NULL && i < pServer->nb_robots; i++)
+	{
+		if(Robot_isSameSession(&pConfigs[i], &pConfigs[0]) == FALSE)
+		{
+			several_sessions = TRUE;
+		}
+	}
+	for(int i = 0; i < pServer->nb_workers; i++)
+	{
+		pServer->workers[i] = Controller_new(i, pServer->nb_workers, pServer->nb_robots, pConfigs, pServer->notify_fd);
+		//libinfox holds a single Intox session per process, each worker then drives its simulator from a child process.
+		Controller_setProcess(pServer->workers[i], several_sessions);
+	}
+	for(int i = 0; i < pServer->nb_robots; i++)
+	{
+		//Sharded round robin, robot i is driven by the worker i % nb_workers.
+		pServer->robots[i].worker = pServer->workers[i % pServer->nb_workers];
+		pServer->robots[i].sample_pending = FALSE;
+		pServer->robots[i].stopped = FALSE;
+	}
+	pServer->nb_running = pServer->nb_robots;
+	pServer->nb_samples_pending = 0;
+	pServer->running = TRUE;
+	pServer->verbose = FALSE;
+	pServer->socket_ecoute = -1;
+	pServer->socket_datagramme = -1;
+	pServer->socket_locale = -1;
+	pServer->spare_fd = -1;
+	pServer->backend = SERVER_BACKEND_EPOLL;
+	pServer->loop = NULL;
+	pServer->loop_state = NULL;
+	pServer->connections = NULL;
+	pServer->nb_connections = 0;
+	pServer->subscribers = NULL;
+	pServer->peers = NULL;
+	pServer->sockets = NULL;
+	pServer->nb_sockets = 0;
+	pServer->nb_generations = 0;
+	memset(&pServer->stats, 0, sizeof(pServer->stats));
 	return pServer;
 }
 
+void Server_setBackend(Server* pServer, ServerBackend backend)
+{
+	pServer->backend = backend;
+}
+
+void Server_setVerbose(Server* pServer, bool_e verbose)
+{
+	pServer->verbose = verbose;
+}
+
+void Server_setWatchdog(Server* pServer, unsigned int deadline_ms)
+{
+	for(int i = 0; i < pServer->nb_workers; i++)
+	{
+		Controller_setWatchdog(pServer->workers[i], deadline_ms);
+	}
+}
+
+void Server_setControlRate(Server* pServer, unsigned int rate_hz, bool_e realtime)
+{
+	for(int i = 0; i < pServer->nb_workers; i++)
+	{
+		Controller_setRate(pServer->workers[i], rate_hz, realtime);
+	}
+}
+
+void Server_setMotionProfile(Server* pServer, float acceleration, float jerk)
+{
+	for(int i = 0; i < pServer->nb_workers; i++)
+	{
+		Controller_setMotionProfile(pServer->workers[i], acceleration, jerk);
+	}
+}
+
 void Server_start(Server* pServer)
 {
-	Pilot_start(pServer->pilot);
-	pServer->socket_ecoute = socket (PF_INET, SOCK_STREAM, 0);
+	int option = 1;
+
+	//First : the control processes (Controller_setProcess) are forked while the commando has no other thread
+	//and no Intox session, which they would inherit.
+	for(int i = 0; i < pServer->nb_workers; i++)
+	{
+		Controller_start(pServer->workers[i]);
+	}
+	Server_raiseFileLimit();
+	pServer->spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+	pServer->socket_ecoute = socket (PF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	setsockopt(pServer->socket_ecoute, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option));
 	pServer->mon_adresse.sin_family = AF_INET;
 	pServer->mon_adresse.sin_port = htons(PORT_DU_SERVEUR);
 
 	pServer->mon_adresse.sin_addr.s_addr = htonl(INADDR_ANY);
 
-	bind(pServer->socket_ecoute, (struct sockaddr *)&pServer->mon_adresse, sizeof(pServer->mon_adresse));
+	if(bind(pServer->socket_ecoute, (struct sockaddr *)&pServer->mon_adresse, sizeof(pServer->mon_adresse)) == -1)
+	{
+		perror("ERROR : bind");
+		return;
+	}
 
 	listen(pServer->socket_ecoute, MAX_PENDING_CONNECTIONS);
 
-	pServer->socket_donnees = accept(pServer->socket_ecoute, NULL, 0);
+	//Optional UDP channel on the same port, for the latest-value-wins traffic.
+	pServer->socket_datagramme = socket(PF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(bind(pServer->socket_datagramme, (struct sockaddr *)&pServer->mon_adresse, sizeof(pServer->mon_adresse)) == -1)
+	{
+		perror("ERROR : bind of the UDP channel");
+		close(pServer->socket_datagramme);
+		pServer->socket_datagramme = -1;
+	}
+
+	Server_listenLocal(pServer);
+
+	if(Trace_isEnabled() == TRUE)
+	{
+		struct sigaction action;
+		memset(&action, 0, sizeof(action));
+		action.sa_handler = Server_onSignal;
+		sigemptyset(&action.sa_mask);
+		server_notify_fd = pServer->notify_fd;
+		sigaction(SIGUSR1, &action, NULL);
+		printf("LOG_TRACE : kill -USR1 %d to print the latencies\n", (int) getpid());
+	}
 
-	while(shut_down)
+	if(pServer->backend == SERVER_BACKEND_URING && ServerUring_open(pServer) == FALSE)
 	{
-		Server_run(pServer);
+		printf("ERROR : io_uring not supported by this kernel, epoll is used\n");
+		pServer->backend = SERVER_BACKEND_EPOLL;
 	}
+	if(pServer->backend == SERVER_BACKEND_EPOLL && ServerEpoll_open(pServer) == FALSE)
+	{
+		perror("ERROR : epoll");
+		return;
+	}
+	printf("LOG_BACKEND : %s\n", (pServer->backend == SERVER_BACKEND_URING)? "io_uring" : "epoll");
+	while(pServer->running)
+	{
+		pServer->loop->run(pServer);
+	}
+}
+
+ServerStats Server_getStats(Server* pServer)
+{
+	return pServer->stats;
 }
 
 void Server_stop(Server* pServer)
 {
-	close(pServer->socket_donnees);
+	//The commands already posted are executed before the pilots are stopped.
+	for(int i = 0; i < pServer->nb_workers; i++)
+	{
+		Controller_stop(pServer->workers[i]);
+	}
+	if(pServer->stats.nb_reads > 0)
+	{
+		printf("LOG_STATS : %lu frames in %lu reads (%.2f frames per syscall), %lu velocity commands collapsed\n",
+				pServer->stats.nb_frames, pServer->stats.nb_reads,
+				(double) pServer->stats.nb_frames / pServer->stats.nb_reads, pServer->stats.nb_collapsed);
+	}
+	if(pServer->stats.nb_telemetry > 0)
+	{
+		printf("LOG_STATS : %lu telemetry samples pushed, %lu dropped\n",
+				pServer->stats.nb_telemetry, pServer->stats.nb_dropped);
+	}
+	if(pServer->stats.nb_datagrams > 0)
+	{
+		printf("LOG_STATS : %lu velocity datagrams, %lu stale ones dropped\n",
+				pServer->stats.nb_datagrams, pServer->stats.nb_stale);
+	}
+	if(pServer->stats.nb_refused > 0)
+	{
+		printf("LOG_STATS : %lu frames and velocity datagrams refused, for another robot than the one of their telco or from an unbound source\n",
+				pServer->stats.nb_refused);
+	}
+	if(pServer->stats.nb_unrouted > 0)
+	{
+		printf("LOG_STATS : %lu frames for an unknown or stopped robot dropped\n", pServer->stats.nb_unrouted);
+	}
+	if(pServer->stats.nb_rejected > 0)
+	{
+		printf("LOG_STATS : %lu telcos rejected, out of file descriptors\n", pServer->stats.nb_rejected);
+	}
+	if(pServer->stats.nb_one_way > 0)
+	{
+		printf("LOG_STATS : one-way command delay mean %.1f us, max %.1f us over %lu commands\n",
+				pServer->stats.one_way_total_ns / 1e3 / pServer->stats.nb_one_way, pServer->stats.one_way_max_ns / 1e3,
+				pServer->stats.nb_one_way);
+	}
+	if(Trace_isEnabled() == TRUE)
+	{
+		Trace_dump();
+	}
+	if(pServer->stats.nb_frames + pServer->stats.nb_datagrams > 0)
+	{
+		printf("LOG_STATS : %lu syscalls with %s (%.2f per frame)\n", pServer->stats.nb_syscalls,
+				(pServer->backend == SERVER_BACKEND_URING)? "io_uring" : "epoll",
+				(double) pServer->stats.nb_syscalls / (pServer->stats.nb_frames + pServer->stats.nb_datagrams));
+	}
+	while(pServer->connections != NULL)
+	{
+		Server_closeConnection(pServer, pServer->connections);
+	}
+	if(pServer->loop != NULL)
+	{
+		pServer->loop->close(pServer);
+		pServer->loop = NULL;
+	}
+	if(pServer->socket_ecoute != -1)
+	{
+		close(pServer->socket_ecoute);
+		pServer->socket_ecoute = -1;
+	}
+	if(pServer->socket_datagramme != -1)
+	{
+		close(pServer->socket_datagramme);
+		pServer->socket_datagramme = -1;
+	}
+	if(pServer->socket_locale != -1)
+	{
+		close(pServer->socket_locale);
+		pServer->socket_locale = -1;
+	}
+	if(pServer->spare_fd != -1)
+	{
+		close(pServer->spare_fd);
+		pServer->spare_fd = -1;
+	}
 }
 
 void Server_free(Server* pServer)
 {
-	Pilot_free(pServer->pilot);
+	for(int i = 0; i < pServer->nb_workers; i++)
+	{
+		Controller_free(pServer->workers[i]);
+	}
+	close(pServer->notify_fd);
+	free(pServer->workers);
+	free(pServer->robots);
+	free(pServer->sockets);
 	free(pServer);
 }
+
+void Server_newConnection(Server* pServer, int socket_donnees, bool_e local)
+{
+	struct ucred credentials;
+	socklen_t size = sizeof(credentials);
+	int option = 1;
+	Connection* pConnection = (Connection*) calloc(1, pServer->loop->connection_size);
+	if(pConnection == NULL)
+	{
+		printf("ERROR : pConnection is NULL \n");
+		close(socket_donnees);
+		return;
+	}
+	if(local == TRUE)
+	{
+		//Only a telco of the same user gets access to the rings.
+		if(getsockopt(socket_donnees, SOL_SOCKET, SO_PEERCRED, &credentials, &size) == -1 || credentials.uid != geteuid()
+				|| (pConnection->shm = Shm_new()) == NULL || Shm_send(pConnection->shm, socket_donnees) == FALSE)
+		{
+			printf("ERROR : shared memory refused to a local telco\n");
+			close(socket_donnees);
+			Server_freeConnection(pConnection);
+			return;
+		}
+	}
+	else
+	{
+		//An answer must not wait for the acknowledgement of the telemetry sent before it.
+		setsockopt(socket_donnees, IPPROTO_TCP, TCP_NODELAY, &option, sizeof(option));
+	}
+	pConnection->socket_donnees = socket_donnees;
+	pConnection->robot = -1;
+	pConnection->generation = ++pServer->nb_generations;
+	Decoder_init(&pConnection->decoder);
+	if(Server_register(pServer, pConnection) == FALSE)
+	{
+		close(socket_donnees);
+		Server_freeConnection(pConnection);
+		return;
+	}
+	if(pServer->loop->add(pServer, pConnection) == FALSE)
+	{
+		pServer->sockets[socket_donnees] = NULL;
+		close(socket_donnees);
+		Server_freeConnection(pConnection);
+		return;
+	}
+	pConnection->next = pServer->connections;
+	if(pServer->connections != NULL)
+	{
+		pServer->connections->prev = pConnection;
+	}
+	pServer->connections = pConnection;
+	pServer->nb_connections++;
+	printf("LOG_CONNECTION : %d telco(s)%s\n", pServer->nb_connections, (pConnection->shm != NULL)? " (shared memory)" : "");
+}
+
+bool_e Server_reject(Server* pServer, int socket_ecoute)
+{
+	int socket_donnees;
+	if(pServer->spare_fd == -1)
+	{
+		return FALSE;
+	}
+	close(pServer->spare_fd);
+	socket_donnees = accept4(socket_ecoute, NULL, 0, SOCK_CLOEXEC);
+	if(socket_donnees != -1)
+	{
+		close(socket_donnees);
+		pServer->stats.nb_rejected++;
+	}
+	pServer->spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+	pServer->stats.nb_syscalls += 4;
+	return (socket_donnees != -1)? TRUE : FALSE;
+}
+
+void Server_closeConnection(Server* pServer, Connection* pConnection)
+{
+	Server_subscribe(pServer, pConnection, 0, 0);
+	pServer->loop->remove(pServer, pConnection);
+	pServer->sockets[pConnection->socket_donnees] = NULL;
+	close(pConnection->socket_donnees);
+	if(pConnection->prev != NULL)
+	{
+		pConnection->prev->next = pConnection->next;
+	}
+	else
+	{
+		pServer->connections = pConnection->next;
+	}
+	if(pConnection->next != NULL)
+	{
+		pConnection->next->prev = pConnection->prev;
+	}
+	pServer->nb_connections--;
+	printf("LOG_DISCONNECTION : %d telco(s)\n", pServer->nb_connections);
+}
+
+void Server_freeConnection(Connection* pConnection)
+{
+	if(pConnection->shm != NULL)
+	{
+		Shm_free(pConnection->shm);
+	}
+	free(pConnection);
+}
+
+bool_e Server_readBatch(Server* pServer, Connection* pConnection)
+{
+	Frame frame;
+	DecoderStatus status = DECODER_NEED_MORE;
+	int nb_frames;
+	uint32_t robot;
+	uint32_t period_ms;
+	uint16_t port;
+	uint32_t flags;
+	uint64_t originate;
+	uint64_t receive;
+	uint64_t transmit;
+	TrajectorySegment segments[FRAME_TRAJECTORY_MAX_SEGMENTS];
+	int nb_segments;
+	pServer->received = Trace_now();
+	do
+	{
+		nb_frames = 0;
+		while(nb_frames < SERVER_BATCH_SIZE && (status = Decoder_next(&pConnection->decoder, &frame)) == DECODER_FRAME)
+		{
+			//Unknown frame types are skipped so that newer telcos stay compatible.
+			if(Frame_decodeDonnees(&frame, &pServer->batch[nb_frames]) == TRUE)
+			{
+				nb_frames++;
+			}
+			else if(Frame_decodeSubscribe(&frame, &robot, &period_ms, &port, &flags) == TRUE)
+			{
+				if(robot >= (uint32_t) pServer->nb_robots || (period_ms > 0 && pServer->robots[robot].stopped == TRUE))
+				{
+					pServer->stats.nb_unrouted++;
+					continue;
+				}
+				if(Server_bind(pServer, pConnection, (int) robot) == FALSE)
+				{
+					continue;
+				}
+				pConnection->telemetry_robot = (int) robot;
+				pConnection->telemetry_delta = (flags & FRAME_SUBSCRIBE_DELTA)? TRUE : FALSE;
+				Server_subscribe(pServer, pConnection, period_ms, port);
+			}
+			else if(Frame_decodeHeartbeat(&frame, &robot) == TRUE)
+			{
+				if(Server_bind(pServer, pConnection, (int) robot) == TRUE)
+				{
+					Server_heartbeat(pServer, (int) robot);
+				}
+			}
+			else if(Frame_decodePing(&frame, &originate, &receive, &transmit) == TRUE)
+			{
+				Server_pong(pServer, pConnection, originate);
+			}
+			else if(Frame_decodeTrajectory(&frame, &robot, &flags, segments, &nb_segments) == TRUE)
+			{
+				//After the velocity commands received before it, which would cancel it otherwise.
+				Server_dispatchBatch(pServer, pConnection, nb_frames);
+				nb_frames = 0;
+				if(Server_bind(pServer, pConnection, (int) robot) == TRUE)
+				{
+					Server_postTrajectory(pServer, (int) robot, flags, segments, nb_segments);
+				}
+			}
+		}
+		Server_dispatchBatch(pServer, pConnection, nb_frames);
+	}while(nb_frames == SERVER_BATCH_SIZE && pServer->running);
+	return (nb_frames < SERVER_BATCH_SIZE && status == DECODER_ERROR)? FALSE : TRUE;
+}
+
+bool_e Server_readShm(Server* pServer, Connection* pConnection)
+{
+	ShmMessage message;
+	int nb_frames = 0;
+	int nb_messages = 0;
+	//Reset first, a command pushed meanwhile signals it again.
+	Shm_clear(pConnection->shm->to_commando);
+	pServer->received = Trace_now();
+	pServer->stats.nb_syscalls++;
+	pServer->stats.nb_reads++;
+	while(pServer->running && nb_messages < SHM_RING_CAPACITY && Ring_pop(pConnection->shm->commands, &message) == TRUE)
+	{
+		nb_messages++;
+		if(message.type == FRAME_DONNEES)
+		{
+			pServer->batch[nb_frames++] = message.donnees;
+			if(nb_frames == SERVER_BATCH_SIZE)
+			{
+				Server_dispatchBatch(pServer, pConnection, nb_frames);
+				nb_frames = 0;
+			}
+		}
+		else if(message.type == FRAME_SUBSCRIBE && message.robot < (uint32_t) pServer->nb_robots
+				&& (message.period_ms == 0 || pServer->robots[message.robot].stopped == FALSE))
+		{
+			if(Server_bind(pServer, pConnection, (int) message.robot) == TRUE)
+			{
+				pConnection->telemetry_robot = (int) message.robot;
+				Server_subscribe(pServer, pConnection, message.period_ms, 0);
+			}
+		}
+		else if(message.type == FRAME_HEARTBEAT)
+		{
+			if(Server_bind(pServer, pConnection, (int) message.robot) == TRUE)
+			{
+				Server_heartbeat(pServer, (int) message.robot);
+			}
+		}
+		else if(message.type == FRAME_PING)
+		{
+			Server_pong(pServer, pConnection, message.ping[0]);
+		}
+		else if(message.type == FRAME_TRAJECTORY)
+		{
+			//After the velocity commands pushed before it, which would cancel it otherwise.
+			Server_dispatchBatch(pServer, pConnection, nb_frames);
+			nb_frames = 0;
+			if(Server_bind(pServer, pConnection, (int) message.robot) == TRUE)
+			{
+				Server_postTrajectory(pServer, (int) message.robot, message.trajectory.flags, &message.trajectory.segment,
+						(message.trajectory.flags & TRAJECTORY_CANCEL)? 0 : 1);
+			}
+		}
+		else
+		{
+			pServer->stats.nb_unrouted++;
+		}
+	}
+	Server_dispatchBatch(pServer, pConnection, nb_frames);
+	if(nb_messages == SHM_RING_CAPACITY && Ring_isEmpty(pConnection->shm->commands) == FALSE)
+	{
+		//A telco refilling its ring as fast as it is drained would starve the others, the rest waits for the next loop.
+		Shm_notify(pConnection->shm->to_commando);
+		pServer->stats.nb_syscalls++;
+	}
+	if(Ring_isCorrupted(pConnection->shm->commands) == TRUE || Ring_isCorrupted(pConnection->shm->replies) == TRUE)
+	{
+		printf("ERROR : corrupted shared memory, telco dropped\n");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+void Server_readDatagrams(Server* pServer)
+{
+	struct mmsghdr messages[SERVER_BATCH_SIZE];
+	struct iovec iov[SERVER_BATCH_SIZE];
+	struct sockaddr_in addresses[SERVER_BATCH_SIZE];
+	VelocityVector vector;
+	VelocityVector latest;
+	bool_e received = FALSE;
+	uint32_t sequence;
+	uint32_t robot;
+	uint32_t latest_robot = 0;
+	Frame frame;
+	int nb_messages;
+	for(int i = 0; i < SERVER_BATCH_SIZE; i++)
+	{
+		iov[i].iov_base = pServer->datagrams[i];
+		iov[i].iov_len = FRAME_MAX_SIZE;
+		memset(&messages[i].msg_hdr, 0, sizeof(messages[i].msg_hdr));
+		messages[i].msg_hdr.msg_iov = &iov[i];
+		messages[i].msg_hdr.msg_iovlen = 1;
+		messages[i].msg_hdr.msg_name = &addresses[i];
+	}
+	do
+	{
+		for(int i = 0; i < SERVER_BATCH_SIZE; i++)
+		{
+			messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+		}
+		nb_messages = recvmmsg(pServer->socket_datagramme, messages, SERVER_BATCH_SIZE, MSG_DONTWAIT, NULL);
+		pServer->stats.nb_syscalls++;
+		if(nb_messages <= 0)
+		{
+			break;
+		}
+		pServer->stats.nb_reads++;
+		for(int i = 0; i < nb_messages; i++)
+		{
+			if(Frame_parse(pServer->datagrams[i], messages[i].msg_len, &frame) == FALSE
+					|| Frame_decodeVelocity(&frame, &sequence, &robot, &vector) == FALSE)
+			{
+				//Only the velocity commands are accepted over UDP, the stop goes through TCP.
+				continue;
+			}
+			Connection* pPeer = Server_getPeer(pServer, &addresses[i]);
+			if(pPeer == NULL || robot != (uint32_t) pPeer->robot)
+			{
+				//Only a connected telco drives its robot over UDP, and only the robot of its session.
+				pServer->stats.nb_refused++;
+				continue;
+			}
+			pServer->stats.nb_datagrams++;
+			if(Frame_isNewer(sequence, pPeer->datagram_sequence) == FALSE)
+			{
+				pServer->stats.nb_stale++;
+				continue;
+			}
+			if(received == TRUE && robot == latest_robot)
+			{
+				pServer->stats.nb_collapsed++;
+			}
+			else if(received == TRUE)
+			{
+				//Only the commands of the same robot collapse.
+				Server_applyVelocity(pServer, latest_robot, &latest, NULL);
+			}
+			pPeer->datagram_sequence = sequence;
+			latest = vector;
+			latest_robot = robot;
+			received = TRUE;
+		}
+	}while(nb_messages == SERVER_BATCH_SIZE);
+	if(received == TRUE)
+	{
+		Server_applyVelocity(pServer, latest_robot, &latest, NULL);
+	}
+}
+
+void Server_collect(Server* pServer)
+{
+	Telemetry telemetry;
+	for(int i = 0; i < pServer->nb_workers; i++)
+	{
+		while(Controller_collect(pServer->workers[i], &telemetry) == TRUE)
+		{
+			Server_deliver(pServer, &telemetry);
+		}
+	}
+}
+
+int Server_getTelemetryTimeout(Server* pServer)
+{
+	struct timespec now;
+	long timeout = -1;
+	long remaining;
+	if(pServer->subscribers == NULL)
+	{
+		return -1;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	for(Connection* pConnection = pServer->subscribers; pConnection != NULL; pConnection = pConnection->nextSubscriber)
+	{
+		RobotRoute* pRoute = &pServer->robots[pConnection->telemetry_robot];
+		const struct timespec* pDue = &pConnection->next_telemetry;
+		if(pRoute->stopped == TRUE)
+		{
+			//Never sampled again, its next_telemetry stays in the past.
+			continue;
+		}
+		if(pRoute->sample_pending == TRUE)
+		{
+			//Served when the sample arrives on notify_fd, or asked again once it is lost.
+			pDue = &pRoute->sample_deadline;
+		}
+		//Rounded up, so that an early wake up does not spin.
+		remaining = (pDue->tv_sec - now.tv_sec) * 1000 + (pDue->tv_nsec - now.tv_nsec + 999999) / 1000000;
+		if(remaining < 0)
+		{
+			remaining = 0;
+		}
+		if(timeout == -1 || remaining < timeout)
+		{
+			timeout = remaining;
+		}
+	}
+	return (int) timeout;
+}
+
+void Server_forgetSamples(Server* pServer)
+{
+	struct timespec now;
+	if(pServer->nb_samples_pending == 0)
+	{
+		return;
+	}
+	//Whatever the traffic : under a steady flow of frames the loop never goes idle.
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	for(int i = 0; i < pServer->nb_robots; i++)
+	{
+		struct timespec* pDeadline = &pServer->robots[i].sample_deadline;
+		if(pServer->robots[i].sample_pending == TRUE
+				&& (pDeadline->tv_sec < now.tv_sec || (pDeadline->tv_sec == now.tv_sec && pDeadline->tv_nsec <= now.tv_nsec)))
+		{
+			pServer->robots[i].sample_pending = FALSE;
+			pServer->nb_samples_pending--;
+		}
+	}
+}
+
+void Server_pushTelemetry(Server* pServer)
+{
+	struct timespec now;
+	if(pServer->subscribers == NULL)
+	{
+		return;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	for(Connection* pConnection = pServer->subscribers; pConnection != NULL; pConnection = pConnection->nextSubscriber)
+	{
+		struct timespec* pNext = &pConnection->next_telemetry;
+		RobotRoute* pRoute = &pServer->robots[pConnection->telemetry_robot];
+		if(pRoute->sample_pending == FALSE && pRoute->stopped == FALSE
+				&& (pNext->tv_sec < now.tv_sec || (pNext->tv_sec == now.tv_sec && pNext->tv_nsec <= now.tv_nsec)))
+		{
+			//Sampled once for all the subscribers of the robot due when it arrives.
+			Command command = {.type = COMMAND_SAMPLE, .robot = pConnection->telemetry_robot};
+			if(Controller_post(pRoute->worker, &command) == TRUE)
+			{
+				pRoute->sample_pending = TRUE;
+				pRoute->sample_deadline = now;
+				Server_addMs(&pRoute->sample_deadline, SERVER_SAMPLE_TIMEOUT_MS);
+				pServer->nb_samples_pending++;
+			}
+		}
+	}
+}
 /* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
-static void Server_run(Server* pServer)
-{
-	printf("here\n");
-	Server_readMsg(pServer);
-	Server_logs(pServer);
-	if(pServer->donnees.askLog == 1)
-	{
-		Pilot_check(pServer->pilot);
-		PilotState p_state = Pilot_getState(pServer->pilot);
-		pServer->donnees.bump = p_state.collision;
-		pServer->donnees.luminosity = p_state.luminosity;
-		pServer->donnees.power = p_state.speed;
-		pServer->donnees.askLog = 0;
-		printf("here2\n");
-		Server_sendMsg(pServer);
-		printf("LOG_MSG_SENT\n");
+
+static void Server_raiseFileLimit()
+{
+	struct rlimit limit;
+	if(getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+	{
+		limit.rlim_cur = limit.rlim_max;
+		if(setrlimit(RLIMIT_NOFILE, &limit) == -1)
+		{
+			perror("ERROR : RLIMIT_NOFILE");
+		}
+	}
+}
+
+static void Server_listenLocal(Server* pServer)
+{
+	struct sockaddr_un address;
+	socklen_t size = Shm_getAddress(&address);
+	pServer->socket_locale = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(bind(pServer->socket_locale, (struct sockaddr *)&address, size) == -1
+			|| listen(pServer->socket_locale, MAX_PENDING_CONNECTIONS) == -1)
+	{
+		//Another commando of this host has it, its local telcos go through TCP.
+		perror("ERROR : bind of the local socket");
+		close(pServer->socket_locale);
+		pServer->socket_locale = -1;
+	}
+}
+
+static bool_e Server_push(Server* pServer, Connection* pConnection, const ShmMessage* pMessage)
+{
+	if(Shm_push(pConnection->shm->replies, pConnection->shm->to_telco, pMessage) == FALSE)
+	{
+		pServer->stats.nb_dropped++;
+		return FALSE;
+	}
+	pServer->stats.nb_syscalls++;
+	return TRUE;
+}
+
+static void Server_dispatch(Server* pServer, Connection* pConnection)
+{
+	int robot = pConnection->donnees.robot;
+	RobotRoute* pRoute = Server_route(pServer, robot);
+	if(pServer->verbose == TRUE)
+	{
+		Server_logs(pConnection);
+	}
+	if(pRoute == NULL)
+	{
+		pServer->stats.nb_unrouted++;
+	}
+	else if(pConnection->donnees.askLog == 1)
+	{
+		//Answered by Server_collect once the worker has checked the sensors.
+		Command command = {.type = COMMAND_CHECK, .robot = robot, .connection = pConnection->socket_donnees,
+				.generation = pConnection->generation, .request = pConnection->donnees.request};
+		if(Controller_post(pRoute->worker, &command) == FALSE)
+		{
+			printf("ERROR : LOG_MSG_NOT_SENT\n");
+		}
 	}
-	else if(pServer->donnees.stop == 1)
+	else if(pConnection->donnees.stop == 1)
 	{
-		Pilot_stop(pServer->pilot);
-		pServer->donnees.stop = 0;
-		Server_stop(pServer);
-		//shut_down = TRUE;
+		Controller_requestStop(pRoute->worker, robot);
+		pConnection->donnees.stop = 0;
+		pRoute->stopped = TRUE;
+		if(--pServer->nb_running == 0)
+		{
+			pServer->running = FALSE;
+		}
 	}
 	else
 	{
-		pServer->pilot->vector.dir = (Direction) pServer->donnees.direction;
-		pServer->pilot->vector.power = pServer->donnees.power;
-		Pilot_setVelocity(pServer->pilot);
+		Trace trace = {.stamps = {[TRACE_CAPTURE] = pConnection->donnees.captured, [TRACE_SEND] = pConnection->donnees.sent,
+				[TRACE_RECEIVE] = pServer->received}};
+		VelocityVector vector = {(Direction) pConnection->donnees.direction, pConnection->donnees.power, pConnection->donnees.angular};
+		Server_applyVelocity(pServer, robot, &vector, (pConnection->donnees.captured != 0)? &trace : NULL);
 	}
 }
-static void Server_readMsg(Server* pServer)
+
+static void Server_applyVelocity(Server* pServer, int robot, const VelocityVector* pVector, const Trace* pTrace)
+{
+	RobotRoute* pRoute = Server_route(pServer, robot);
+	Command command = {.type = COMMAND_VELOCITY, .robot = robot, .vector = *pVector};
+	if(pRoute == NULL)
+	{
+		pServer->stats.nb_unrouted++;
+		return;
+	}
+	if(pTrace != NULL)
+	{
+		command.trace = *pTrace;
+	}
+	Controller_post(pRoute->worker, &command);
+}
+
+static void Server_pong(Server* pServer, Connection* pConnection, uint64_t originate)
+{
+	uint8_t buffer[FRAME_MAX_SIZE];
+	if(pConnection->shm != NULL)
+	{
+		ShmMessage message = {.type = FRAME_PING, .ping = {originate, pServer->received, Trace_now()}};
+		Server_push(pServer, pConnection, &message);
+		return;
+	}
+	pServer->loop->write(pServer, pConnection, buffer, Frame_encodePing(buffer, originate, pServer->received, Trace_now()));
+}
+
+static void Server_measure(Server* pServer, const DesDonnees* pDonnees)
 {
-	read(pServer->socket_donnees, &pServer->donnees, sizeof(pServer->donnees));
+	//Slightly negative when the estimation of the offset errs by more than the delay.
+	long long delay = (long long) (pServer->received - pDonnees->sent);
+	pServer->stats.nb_one_way++;
+	pServer->stats.one_way_total_ns += delay;
+	if(delay > pServer->stats.one_way_max_ns)
+	{
+		pServer->stats.one_way_max_ns = delay;
+	}
 }
 
-static void Server_sendMsg(Server* pServer)
+static void Server_postTrajectory(Server* pServer, int robot, uint32_t flags, const TrajectorySegment* pSegments, int nb_segments)
 {
-	int quantite_envoyee;
-	quantite_envoyee = write(pServer->socket_donnees, &pServer->donnees, sizeof(pServer->donnees));
+	RobotRoute* pRoute = Server_route(pServer, robot);
+	Command command = {.type = COMMAND_TRAJECTORY, .robot = robot, .flags = flags};
+	if(pRoute == NULL)
+	{
+		pServer->stats.nb_unrouted++;
+		return;
+	}
+	if(flags & TRAJECTORY_CANCEL)
+	{
+		Controller_post(pRoute->worker, &command);
+		return;
+	}
+	for(int i = 0; i < nb_segments; i++)
+	{
+		command.segment = pSegments[i];
+		if(Controller_post(pRoute->worker, &command) == FALSE)
+		{
+			printf("ERROR : LOG_TRAJECTORY_NOT_POSTED\n");
+			return;
+		}
+		//The segments which follow go on the trajectory the first one replaced.
+		command.flags = TRAJECTORY_APPEND;
+	}
 }
-static void Server_logs(Server* pServer)
+
+static bool_e Server_bind(Server* pServer, Connection* pConnection, int robot)
+{
+	if(pConnection->robot == -1 && robot >= 0 && robot < pServer->nb_robots)
+	{
+		pConnection->robot = robot;
+	}
+	if(pConnection->robot != -1 && robot != pConnection->robot)
+	{
+		pServer->stats.nb_refused++;
+		return FALSE;
+	}
+	//An unknown robot does not bind the connection, it is counted in nb_unrouted.
+	return TRUE;
+}
+
+static void Server_heartbeat(Server* pServer, int robot)
+{
+	RobotRoute* pRoute = Server_route(pServer, robot);
+	Command command = {.type = COMMAND_HEARTBEAT, .robot = robot};
+	if(pRoute == NULL)
+	{
+		pServer->stats.nb_unrouted++;
+		return;
+	}
+	Controller_post(pRoute->worker, &command);
+}
+
+static RobotRoute* Server_route(Server* pServer, int robot)
+{
+	if(robot < 0 || robot >= pServer->nb_robots || pServer->robots[robot].stopped == TRUE)
+	{
+		return NULL;
+	}
+	return &pServer->robots[robot];
+}
+
+static Connection* Server_getPeer(Server* pServer, const struct sockaddr_in* pAddress)
+{
+	for(Connection* pConnection = pServer->peers; pConnection != NULL; pConnection = pConnection->nextPeer)
+	{
+		if(pConnection->telemetry_address.sin_addr.s_addr == pAddress->sin_addr.s_addr
+				&& pConnection->telemetry_address.sin_port == pAddress->sin_port)
+		{
+			return pConnection;
+		}
+	}
+	return NULL;
+}
+
+static void Server_dispatchBatch(Server* pServer, Connection* pConnection, int nb_frames)
+{
+	int velocity = -1; //latest velocity command of the batch not applied yet, for its robot.
+	pServer->stats.nb_frames += nb_frames;
+	for(int i = 0; i < nb_frames && pServer->running; i++)
+	{
+		if(Server_bind(pServer, pConnection, pServer->batch[i].robot) == FALSE)
+		{
+			//Neither a velocity nor a stop of a robot another telco drives.
+			continue;
+		}
+		if(pServer->batch[i].sent != 0)
+		{
+			Server_measure(pServer, &pServer->batch[i]);
+		}
+		if(pServer->batch[i].askLog == 1 || pServer->batch[i].stop == 1)
+		{
+			//The order with the velocity commands is kept.
+			if(velocity != -1)
+			{
+				pConnection->donnees = pServer->batch[velocity];
+				Server_dispatch(pServer, pConnection);
+				velocity = -1;
+			}
+			pConnection->donnees = pServer->batch[i];
+			Server_dispatch(pServer, pConnection);
+		}
+		else
+		{
+			if(velocity != -1 && pServer->batch[velocity].robot == pServer->batch[i].robot)
+			{
+				pServer->stats.nb_collapsed++;
+			}
+			else if(velocity != -1)
+			{
+				//Only the commands of the same robot collapse.
+				pConnection->donnees = pServer->batch[velocity];
+				Server_dispatch(pServer, pConnection);
+			}
+			velocity = i;
+		}
+	}
+	if(velocity != -1 && pServer->running)
+	{
+		pConnection->donnees = pServer->batch[velocity];
+		Server_dispatch(pServer, pConnection);
+	}
+}
+
+static void Server_sendMsg(Server* pServer, Connection* pConnection)
+{
+	uint8_t buffer[FRAME_MAX_SIZE];
+	size_t size;
+	bool_e sent;
+	if(pConnection->shm != NULL)
+	{
+		ShmMessage message = {.type = FRAME_DONNEES, .robot = pConnection->donnees.robot, .donnees = pConnection->donnees};
+		sent = Server_push(pServer, pConnection, &message);
+	}
+	else
+	{
+		size = Frame_encodeDonnees(buffer, &pConnection->donnees);
+		sent = pServer->loop->write(pServer, pConnection, buffer, size);
+	}
+	if(sent == FALSE)
+	{
+		printf("ERROR : LOG_MSG_NOT_SENT\n");
+	}
+	else if(pServer->verbose == TRUE)
+	{
+		printf("LOG_MSG_SENT\n");
+	}
+}
+
+static void Server_subscribe(Server* pServer, Connection* pConnection, unsigned int period_ms, uint16_t port)
+{
+	Server_bindDatagram(pServer, pConnection, port);
+	bool_e subscribed = (pConnection->telemetry_period_ms > 0)? TRUE : FALSE;
+	if(period_ms > 0 && subscribed == FALSE)
+	{
+		pConnection->prevSubscriber = NULL;
+		pConnection->nextSubscriber = pServer->subscribers;
+		if(pServer->subscribers != NULL)
+		{
+			pServer->subscribers->prevSubscriber = pConnection;
+		}
+		pServer->subscribers = pConnection;
+	}
+	else if(period_ms == 0 && subscribed == TRUE)
+	{
+		if(pConnection->prevSubscriber != NULL)
+		{
+			pConnection->prevSubscriber->nextSubscriber = pConnection->nextSubscriber;
+		}
+		else
+		{
+			pServer->subscribers = pConnection->nextSubscriber;
+		}
+		if(pConnection->nextSubscriber != NULL)
+		{
+			pConnection->nextSubscriber->prevSubscriber = pConnection->prevSubscriber;
+		}
+	}
+	pConnection->telemetry_period_ms = period_ms;
+	//The first sample is sent right away, as a keyframe.
+	Frame_initTelemetryCodec(&pConnection->telemetry_codec);
+	clock_gettime(CLOCK_MONOTONIC, &pConnection->next_telemetry);
+}
+
+static void Server_bindDatagram(Server* pServer, Connection* pConnection, uint16_t port)
+{
+	struct sockaddr_in address;
+	socklen_t size = sizeof(address);
+	bool_e bound = pConnection->telemetry_datagram;
+	pConnection->telemetry_datagram = FALSE;
+	if(port != 0 && pServer->socket_datagramme != -1 && pConnection->shm == NULL
+			&& getpeername(pConnection->socket_donnees, (struct sockaddr *)&address, &size) == 0)
+	{
+		//Same host as the TCP connection, on the UDP port given by the telco.
+		address.sin_port = htons(port);
+		if(bound == FALSE || address.sin_addr.s_addr != pConnection->telemetry_address.sin_addr.s_addr
+				|| address.sin_port != pConnection->telemetry_address.sin_port)
+		{
+			pConnection->datagram_sequence = 0; //the sequence numbers of a telco start at 1.
+		}
+		pConnection->telemetry_address = address;
+		pConnection->telemetry_datagram = TRUE;
+	}
+	if(pConnection->telemetry_datagram == TRUE && bound == FALSE)
+	{
+		pConnection->prevPeer = NULL;
+		pConnection->nextPeer = pServer->peers;
+		if(pServer->peers != NULL)
+		{
+			pServer->peers->prevPeer = pConnection;
+		}
+		pServer->peers = pConnection;
+	}
+	else if(pConnection->telemetry_datagram == FALSE && bound == TRUE)
+	{
+		if(pConnection->prevPeer != NULL)
+		{
+			pConnection->prevPeer->nextPeer = pConnection->nextPeer;
+		}
+		else
+		{
+			pServer->peers = pConnection->nextPeer;
+		}
+		if(pConnection->nextPeer != NULL)
+		{
+			pConnection->nextPeer->prevPeer = pConnection->prevPeer;
+		}
+	}
+}
+
+static void Server_publish(Server* pServer, int robot, const PilotState* pState)
+{
+	uint8_t buffer[FRAME_MAX_SIZE];
+	size_t size = Frame_encodeTelemetry(buffer, robot, pState);
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	for(Connection* pConnection = pServer->subscribers; pConnection != NULL; pConnection = pConnection->nextSubscriber)
+	{
+		struct timespec* pNext = &pConnection->next_telemetry;
+		if(pConnection->telemetry_robot != robot
+				|| pNext->tv_sec > now.tv_sec || (pNext->tv_sec == now.tv_sec && pNext->tv_nsec > now.tv_nsec))
+		{
+			continue;
+		}
+		if(pConnection->telemetry_datagram == TRUE)
+		{
+			uint8_t datagram[FRAME_MAX_SIZE];
+			size_t datagram_size = Frame_encodeTelemetryDatagram(datagram, ++pConnection->telemetry_sequence, robot, pState);
+			if(sendto(pServer->socket_datagramme, datagram, datagram_size, MSG_DONTWAIT,
+					(struct sockaddr *)&pConnection->telemetry_address, sizeof(pConnection->telemetry_address)) == (ssize_t) datagram_size)
+			{
+				pServer->stats.nb_telemetry++;
+			}
+			else
+			{
+				pServer->stats.nb_dropped++;
+			}
+			pServer->stats.nb_syscalls++;
+		}
+		else if(pConnection->shm != NULL)
+		{
+			ShmMessage message = {.type = FRAME_TELEMETRY, .robot = robot, .state = *pState};
+			if(Server_push(pServer, pConnection, &message) == TRUE)
+			{
+				pServer->stats.nb_telemetry++;
+			}
+		}
+		else if(pConnection->telemetry_delta == TRUE)
+		{
+			uint8_t delta[FRAME_MAX_SIZE];
+			size_t delta_size = Frame_encodeTelemetryDelta(delta, robot, pState, &pConnection->telemetry_codec);
+			if(pServer->loop->write(pServer, pConnection, delta, delta_size) == TRUE)
+			{
+				pServer->stats.nb_telemetry++;
+			}
+			else
+			{
+				//The telco missed the reference of the next delta.
+				Frame_initTelemetryCodec(&pConnection->telemetry_codec);
+			}
+		}
+		else if(pServer->loop->write(pServer, pConnection, buffer, size) == TRUE)
+		{
+			pServer->stats.nb_telemetry++;
+		}
+		Server_addMs(pNext, pConnection->telemetry_period_ms);
+		if(pNext->tv_sec < now.tv_sec || (pNext->tv_sec == now.tv_sec && pNext->tv_nsec <= now.tv_nsec))
+		{
+			//Too late, skip the missed samples rather than bursting them.
+			*pNext = now;
+			Server_addMs(pNext, pConnection->telemetry_period_ms);
+		}
+	}
+}
+
+static void Server_deliver(Server* pServer, const Telemetry* pTelemetry)
+{
+	Connection* pConnection;
+	if(pTelemetry->type == COMMAND_SAMPLE)
+	{
+		if(pServer->robots[pTelemetry->robot].sample_pending == TRUE)
+		{
+			pServer->robots[pTelemetry->robot].sample_pending = FALSE;
+			pServer->nb_samples_pending--;
+		}
+		Server_publish(pServer, pTelemetry->robot, &pTelemetry->state);
+		return;
+	}
+	if(pTelemetry->connection >= pServer->nb_sockets)
+	{
+		return;
+	}
+	pConnection = pServer->sockets[pTelemetry->connection];
+	if(pConnection == NULL || pConnection->generation != pTelemetry->generation)
+	{
+		//The telco has left before the answer.
+		return;
+	}
+	pConnection->donnees.bump = pTelemetry->state.collision;
+	pConnection->donnees.luminosity = pTelemetry->state.luminosity;
+	pConnection->donnees.power = pTelemetry->state.speed;
+	pConnection->donnees.robot = pTelemetry->robot;
+	pConnection->donnees.askLog = 0;
+	pConnection->donnees.request = pTelemetry->request;
+	pConnection->donnees.captured = 0; //the answer carries no trace.
+	pConnection->donnees.sent = 0;
+	pConnection->donnees.sampled = pTelemetry->state.sampled;
+	Server_sendMsg(pServer, pConnection);
+}
+
+static bool_e Server_register(Server* pServer, Connection* pConnection)
+{
+	int socket_donnees = pConnection->socket_donnees;
+	if(socket_donnees >= pServer->nb_sockets)
+	{
+		int nb_sockets = (pServer->nb_sockets == 0)? 64 : pServer->nb_sockets;
+		while(nb_sockets <= socket_donnees)
+		{
+			nb_sockets *= 2;
+		}
+		Connection** sockets = (Connection**) realloc(pServer->sockets, nb_sockets * sizeof(Connection*));
+		if(sockets == NULL)
+		{
+			printf("ERROR : sockets is NULL \n");
+			return FALSE;
+		}
+		memset(sockets + pServer->nb_sockets, 0, (nb_sockets - pServer->nb_sockets) * sizeof(Connection*));
+		pServer->sockets = sockets;
+		pServer->nb_sockets = nb_sockets;
+	}
+	pServer->sockets[socket_donnees] = pConnection;
+	return TRUE;
+}
+
+static void Server_addMs(struct timespec* pTime, unsigned int ms)
+{
+	pTime->tv_nsec += (long) (ms % 1000) * 1000000;
+	pTime->tv_sec += ms / 1000 + pTime->tv_nsec / 1000000000;
+	pTime->tv_nsec %= 1000000000;
+}
+
+static void Server_logs(Connection* pConnection)
 {
 	printf("LOG_MSG_RCV : \n");
-	printf("- asklog : %d\n", pServer->donnees.askLog);
-	printf("- power : %d\n", pServer->donnees.power);
-	printf("- direction : %d\n", pServer->donnees.direction);
-	printf("- bump : %d\n", pServer->donnees.bump);
-	printf("- luminosity : %f\n", pServer->donnees.luminosity);
-	printf("- stop : %d\n", pServer->donnees.stop);
+	printf("- asklog : %d\n", pConnection->donnees.askLog);
+	printf("- power : %d\n", pConnection->donnees.power);
+	printf("- direction : %d\n", pConnection->donnees.direction);
+	if(pConnection->donnees.direction == TWIST)
+	{
+		printf("- angular : %d\n", pConnection->donnees.angular);
+	}
+	printf("- bump : %d\n", pConnection->donnees.bump);
+	printf("- luminosity : %f\n", pConnection->donnees.luminosity);
+	printf("- stop : %d\n", pConnection->donnees.stop);
+	printf("- robot : %d\n", pConnection->donnees.robot);
+}
+
+static void Server_onSignal(int signum)
+{
+	uint64_t value = 1;
+	(void) signum;
+	Trace_requestDump();
+	//Wake the network thread up if the signal has been delivered to another thread.
+	if(write(server_notify_fd, &value, sizeof(value)) == -1)
+	{
+		//Already signaled.
+	}
 }
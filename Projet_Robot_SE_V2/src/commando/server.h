@@ -35,31 +35,275 @@
 #define SRC_COMMANDO_SERVER_H_
 /* ----------------------  INCLUDES ------------------------------------------*/
 #include "../commun.h"
-#include "pilot.h"
+#include "../commun/frame.h"
+#include "../commun/shm.h"
+#include "controller.h"
 /* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/**
+ * \brief Maximum number of frames handed to the pilot at once.
+ */
+#define SERVER_BATCH_SIZE (64)
+/**
+ * \brief Bytes kept for a telco which does not read fast enough, beyond that frames are dropped.
+ */
+#define SERVER_TX_SIZE (8 * FRAME_MAX_SIZE)
 /**
  * \struct Server
  * \brief Server object.
  */
 typedef struct Server_t Server;
+/**
+ * \struct Connection
+ * \brief One telco connected to the server, with its own receive state.
+ */
+typedef struct Connection_t Connection;
 /* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
+/**
+ * \enum ServerBackend
+ * \brief How the network thread waits for the sockets.
+ */
+typedef enum
+{
+	SERVER_BACKEND_EPOLL = 0, //readiness with epoll, then one syscall per read or write.
+	SERVER_BACKEND_URING //completions with io_uring, multishot receives and batched writes.
+}ServerBackend;
 /* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
+/**
+ * \struct ServerStats
+ * \brief Counters of the reception path, nb_frames / nb_reads is the number of frames per syscall.
+ */
+typedef struct
+{
+	unsigned long nb_reads; //receive syscalls which returned data.
+	unsigned long nb_frames; //frames received.
+	unsigned long nb_collapsed; //velocity commands overwritten by a newer one of the same batch.
+	unsigned long nb_telemetry; //telemetry samples pushed to the subscribers.
+	unsigned long nb_dropped; //frames dropped because a telco does not read fast enough.
+	unsigned long nb_datagrams; //velocity datagrams received.
+	unsigned long nb_stale; //velocity datagrams dropped because a newer one was already received.
+	unsigned long nb_refused; //frames and velocity datagrams dropped because they address another robot than the one
+	                          //of the session of their telco, or come from a UDP source no telco has bound.
+	unsigned long nb_unrouted; //frames dropped because they address an unknown or stopped robot.
+	unsigned long nb_rejected; //telcos closed as soon as accepted because the commando is out of file descriptors.
+	unsigned long nb_syscalls; //system calls of the network thread on the path of the frames.
+	unsigned long nb_one_way; //commands stamped by a telco whose clock is synchronized.
+	long long one_way_total_ns; //one-way delays of those commands, from their sending to their receive.
+	long long one_way_max_ns;
+}ServerStats;
+
+/**
+ * \struct RobotRoute
+ * \brief Where the commands of a robot go, seen from the network thread.
+ */
+typedef struct
+{
+	Controller* worker; //worker thread driving the robot.
+	bool_e sample_pending; //a telemetry sample has been asked to the worker.
+	struct timespec sample_deadline; //the sample pending is considered lost after it, and asked again.
+	bool_e stopped;
+}RobotRoute;
+
+/**
+ * \struct ServerLoop
+ * \brief Backend of the network thread : how it waits for the sockets and writes to the telcos.
+ *
+ * server.c holds the protocol and the routing, server_epoll.c and server_uring.c the event loops,
+ * which call it back with the functions for the backends declared below.
+ */
+typedef struct
+{
+	size_t connection_size; //a backend allocates its own state of a connection after the Connection.
+	void (*run)(Server* pServer); //wait for activity once and handle it.
+	bool_e (*add)(Server* pServer, Connection* pConnection); //start watching a telco, FALSE if it cannot be.
+	bool_e (*write)(Server* pServer, Connection* pConnection, const uint8_t* buffer, size_t size); //FALSE if the frame is dropped.
+	void (*remove)(Server* pServer, Connection* pConnection); //stop watching a telco, freed once no event refers to it.
+	void (*close)(Server* pServer); //after the last connection is removed, free what the backend opened.
+}ServerLoop;
+
+struct Connection_t
+{
+	int socket_donnees;
+	unsigned int generation; //copied in the commands, to check the answer is for this connection.
+	Decoder decoder; //reassembles the frames received from this telco.
+	DesDonnees donnees; //last message received from this telco.
+	uint8_t tx[SERVER_TX_SIZE]; //bytes which could not be written yet.
+	size_t tx_len;
+	unsigned int telemetry_period_ms; //0 when the telco is not subscribed.
+	int robot; //robot of the session, bound by the first frame which names one (-1 before) : the others are refused.
+	int telemetry_robot; //robot whose telemetry is pushed.
+	struct timespec next_telemetry;
+	bool_e telemetry_datagram; //TRUE when the telco has bound its UDP socket : the telemetry is pushed over UDP
+	                           //and the velocity datagrams from telemetry_address are applied.
+	struct sockaddr_in telemetry_address; //UDP address of the telco.
+	uint32_t telemetry_sequence;
+	uint32_t datagram_sequence; //sequence number of the latest velocity datagram applied.
+	bool_e telemetry_delta; //TRUE when the telemetry is pushed as FRAME_TELEMETRY_DELTA.
+	TelemetryCodec telemetry_codec;
+	Connection* prev;
+	Connection* next;
+	Connection* prevSubscriber;
+	Connection* nextSubscriber;
+	Connection* prevPeer;
+	Connection* nextPeer;
+	Shm* shm; //rings shared with a telco of this host, NULL for a TCP telco.
+};
+
 struct Server_t
 {
-	Pilot* pilot;
+	Controller** workers; //threads owning the pilots, the network thread never calls them directly.
+	int nb_workers;
+	RobotRoute* robots; //indexed by the robot id of the frames.
+	int nb_robots;
+	int nb_running; //robots not stopped yet, the server stops with the last one.
+	int nb_samples_pending;
+	int notify_fd; //eventfd signaled by the workers when telemetry is available.
+	bool_e running; //Used to get out or stay into the while loop.
+	bool_e verbose; //prints every frame received and every answer sent, a slow console would stall the network thread.
 	int socket_ecoute;
-	int socket_donnees;
+	int socket_datagramme; //UDP socket for the velocity commands and the telemetry.
+	int socket_locale; //unix socket handing a shared memory out to the telcos of this host.
+	int spare_fd; //given up to accept, and close, a telco when the commando is out of file descriptors.
+	ServerBackend backend;
+	const ServerLoop* loop; //NULL until Server_start has opened the backend.
+	void* loop_state; //owned by the backend.
 	struct sockaddr_in mon_adresse;
-	DesDonnees donnees;
+	Connection* connections; //list of the connected telcos.
+	int nb_connections;
+	Connection* subscribers; //list of the telcos the telemetry is pushed to.
+	Connection* peers; //list of the telcos which have bound their UDP socket, the only sources of velocity datagrams.
+	Connection** sockets; //connections indexed by socket, to route the answers of the control thread.
+	int nb_sockets;
+	unsigned int nb_generations; //tells apart two connections which got the same socket.
+	DesDonnees batch[SERVER_BATCH_SIZE]; //frames decoded by the last receive.
+	uint64_t received; //Trace_now of the last receive.
+	uint8_t datagrams[SERVER_BATCH_SIZE][FRAME_MAX_SIZE]; //datagrams received by the last recvmmsg.
+	ServerStats stats;
 };
 /* ----------------------  PUBLIC VARIBLES -----------------------------------*/
 /* ----------------------  PUBLIC FUNCTIONS PROTOTYPES  ----------------------*/
-extern Server* Server_new();
-
+/**
+ * \fn extern Server* Server_new(int nb_robots, int nb_workers, const RobotConfig* pConfigs)
+ * \brief Initialize in memory the object Server and the pilots of its fleet.
+ *
+ * \param int nb_robots : number of robots, addressed by the ids 0 to nb_robots - 1.
+ * \param int nb_workers : number of threads the robots are sharded across, of processes when the robots
+ *        are on several Intox simulators : one per worker, see Robot_checkConfigs.
+ * \param const RobotConfig* pConfigs : nb_robots configurations, NULL for the default ones.
+ */
+extern Server* Server_new(int nb_robots, int nb_workers, const RobotConfig* pConfigs);
+/**
+ * \fn extern void Server_setBackend(Server* pServer, ServerBackend backend)
+ * \brief Choose the backend before Server_start, epoll is used if io_uring is not supported.
+ */
+extern void Server_setBackend(Server* pServer, ServerBackend backend);
+/**
+ * \fn extern void Server_setVerbose(Server* pServer, bool_e verbose)
+ * \brief Print every frame received and every answer sent, off by default : for debugging only.
+ */
+extern void Server_setVerbose(Server* pServer, bool_e verbose);
+/**
+ * \fn extern void Server_setWatchdog(Server* pServer, unsigned int deadline_ms)
+ * \brief Before Server_start, stop a moving robot whose telco sends nothing for deadline_ms (0 to never).
+ */
+extern void Server_setWatchdog(Server* pServer, unsigned int deadline_ms);
+/**
+ * \fn extern void Server_setControlRate(Server* pServer, unsigned int rate_hz, bool_e realtime)
+ * \brief Before Server_start, run the control threads periodically at rate_hz (0 to act on the commands only),
+ *        with SCHED_FIFO if realtime.
+ */
+extern void Server_setControlRate(Server* pServer, unsigned int rate_hz, bool_e realtime);
+/**
+ * \fn extern void Server_setMotionProfile(Server* pServer, float acceleration, float jerk)
+ * \brief Ramp the speed of the wheels of every robot with those limits in percent/s and percent/s2
+ *        (0 for steps, 0 jerk for trapezoidal ramps).
+ */
+extern void Server_setMotionProfile(Server* pServer, float acceleration, float jerk);
+/**
+ * \fn extern void Server_start(Server* pServer)
+ * \brief Start the pilots, open the listening socket and serve every telco until every robot is stopped.
+ */
 extern void Server_start(Server* pServer);
-
+/**
+ * \fn extern ServerStats Server_getStats(Server* pServer)
+ * \brief Get the counters of the reception path.
+ */
+extern ServerStats Server_getStats(Server* pServer);
+/**
+ * \fn extern void Server_stop(Server* pServer)
+ * \brief Close every telco connection and the listening socket.
+ */
 extern void Server_stop(Server* pServer);
-
+/**
+ * \fn extern void Server_free(Server* pServer)
+ * \brief Destruct the object Server from memory.
+ */
 extern void Server_free(Server* pServer);
+/* The functions below are for the backends of the network thread only. */
+/**
+ * \fn extern void Server_newConnection(Server* pServer, int socket_donnees, bool_e local)
+ * \brief Start serving a telco accepted by the backend, a local one is handed a shared memory.
+ */
+extern void Server_newConnection(Server* pServer, int socket_donnees, bool_e local);
+/**
+ * \fn extern bool_e Server_reject(Server* pServer, int socket_ecoute)
+ * \brief Out of file descriptors : accept the oldest pending telco with the spare one and close it at once,
+ *        otherwise it would stay pending and the listening socket readable forever.
+ *
+ * \return bool_e : FALSE if nothing has been accepted.
+ */
+extern bool_e Server_reject(Server* pServer, int socket_ecoute);
+/**
+ * \fn extern void Server_closeConnection(Server* pServer, Connection* pConnection)
+ * \brief Close the socket of a telco and forget it, the backend frees it with Server_freeConnection.
+ */
+extern void Server_closeConnection(Server* pServer, Connection* pConnection);
+/**
+ * \fn extern void Server_freeConnection(Connection* pConnection)
+ * \brief Free a connection and its shared memory.
+ */
+extern void Server_freeConnection(Connection* pConnection);
+/**
+ * \fn extern bool_e Server_readBatch(Server* pServer, Connection* pConnection)
+ * \brief Decode every complete frame received on a connection and dispatch them by batches.
+ *
+ * \return bool_e : FALSE if the stream is corrupted.
+ */
+extern bool_e Server_readBatch(Server* pServer, Connection* pConnection);
+/**
+ * \fn extern bool_e Server_readShm(Server* pServer, Connection* pConnection)
+ * \brief Dispatch the commands a local telco pushed into its ring, by batches, at most
+ *        SHM_RING_CAPACITY of them before the other connections are served.
+ *
+ * \return bool_e : FALSE if the telco has corrupted the rings and the connection must be closed.
+ */
+extern bool_e Server_readShm(Server* pServer, Connection* pConnection);
+/**
+ * \fn extern void Server_readDatagrams(Server* pServer)
+ * \brief Receive every pending velocity datagram with recvmmsg and apply the newest one.
+ */
+extern void Server_readDatagrams(Server* pServer);
+/**
+ * \fn extern void Server_collect(Server* pServer)
+ * \brief Route the answers and the samples produced by the workers.
+ */
+extern void Server_collect(Server* pServer);
+/**
+ * \fn extern int Server_getTelemetryTimeout(Server* pServer)
+ * \brief Time to wait before the next telemetry is due.
+ *
+ * \return int : timeout in ms, -1 when nobody is subscribed to a running robot.
+ */
+extern int Server_getTelemetryTimeout(Server* pServer);
+/**
+ * \fn extern void Server_forgetSamples(Server* pServer)
+ * \brief Forget the samples asked to the workers for more than SERVER_SAMPLE_TIMEOUT_MS, they have been lost
+ *        on a full telemetry ring and are asked again.
+ */
+extern void Server_forgetSamples(Server* pServer);
+/**
+ * \fn extern void Server_pushTelemetry(Server* pServer)
+ * \brief Ask the worker of a robot for a sample when the period of one of its subscribers is elapsed.
+ */
+extern void Server_pushTelemetry(Server* pServer);
 
 #endif /* SRC_COMMANDO_SERVER_H_ */
@@ -0,0 +1,436 @@
+/**
+ * @file  server_epoll.c
+ *
+ * @brief Event loop of the network thread with epoll : readiness, then one syscall per read or write.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "server_epoll.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+#define MAX_EVENTS 64
+/**
+ * \brief Low bit of the epoll data of a connection, set for its doorbell instead of its socket.
+ */
+#define SERVER_DOORBELL_TAG (1)
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
+/**
+ * \struct EpollConnection
+ * \brief A connection with the state of the epoll backend.
+ */
+typedef struct EpollConnection_t EpollConnection;
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+struct EpollConnection_t
+{
+	Connection connection; //first, a Connection* of this backend is an EpollConnection*.
+	bool_e closing; //closed by the current loop, freed at its end.
+	EpollConnection* nextClosed;
+};
+/**
+ * \struct ServerEpoll
+ * \brief State of the epoll backend, loop_state of the server.
+ */
+typedef struct
+{
+	int epoll_fd;
+	EpollConnection* closed; //connections closed by the current loop, freed at its end.
+}ServerEpoll;
+/* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static void ServerEpoll_run(Server* pServer)
+ * \brief Wait for activity on the sockets and handle it.
+ */
+static void ServerEpoll_run(Server* pServer);
+/**
+ * \fn static bool_e ServerEpoll_add(Server* pServer, Connection* pConnection)
+ * \brief Watch the socket of a telco, and the doorbell of a local one.
+ */
+static bool_e ServerEpoll_add(Server* pServer, Connection* pConnection);
+/**
+ * \fn static bool_e ServerEpoll_write(Server* pServer, Connection* pConnection, const uint8_t* buffer, size_t size)
+ * \brief Write a frame without blocking, what the socket does not take is kept until it is writable.
+ *
+ * \return bool_e : FALSE if the frame has been dropped.
+ */
+static bool_e ServerEpoll_write(Server* pServer, Connection* pConnection, const uint8_t* buffer, size_t size);
+/**
+ * \fn static void ServerEpoll_remove(Server* pServer, Connection* pConnection)
+ * \brief Stop watching a telco, it is freed at the end of the loop which may still report it.
+ */
+static void ServerEpoll_remove(Server* pServer, Connection* pConnection);
+/**
+ * \fn static void ServerEpoll_close(Server* pServer)
+ * \brief Free the connections closed and the epoll instance.
+ */
+static void ServerEpoll_close(Server* pServer);
+/**
+ * \fn static void ServerEpoll_watch(ServerEpoll* pEpoll, int* pSocket)
+ * \brief Watch a socket of the server opened by Server_start, if it has been opened.
+ */
+static void ServerEpoll_watch(ServerEpoll* pEpoll, int* pSocket);
+/**
+ * \fn static void ServerEpoll_accept(Server* pServer, int socket_ecoute)
+ * \brief Accept every pending telco on a listening socket.
+ */
+static void ServerEpoll_accept(Server* pServer, int socket_ecoute);
+/**
+ * \fn static bool_e ServerEpoll_readMsg(Server* pServer, Connection* pConnection)
+ * \brief Read everything available on a connection and dispatch each complete message.
+ *
+ * \return bool_e : FALSE if the telco has left and the connection must be closed.
+ */
+static bool_e ServerEpoll_readMsg(Server* pServer, Connection* pConnection);
+/**
+ * \fn static bool_e ServerEpoll_flush(Server* pServer, Connection* pConnection)
+ * \brief Write the bytes kept for a telco now that its socket is writable.
+ *
+ * \return bool_e : FALSE if the telco has left and the connection must be closed.
+ */
+static bool_e ServerEpoll_flush(Server* pServer, Connection* pConnection);
+/**
+ * \fn static void ServerEpoll_sweep(ServerEpoll* pEpoll)
+ * \brief Free the connections closed by the loop, no event of the loop refers to them anymore.
+ */
+static void ServerEpoll_sweep(ServerEpoll* pEpoll);
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+static const ServerLoop server_epoll_loop =
+{
+	.connection_size = sizeof(EpollConnection),
+	.run = ServerEpoll_run,
+	.add = ServerEpoll_add,
+	.write = ServerEpoll_write,
+	.remove = ServerEpoll_remove,
+	.close = ServerEpoll_close
+};
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+bool_e ServerEpoll_open(Server* pServer)
+{
+	ServerEpoll* pEpoll = (ServerEpoll*) malloc(sizeof(ServerEpoll));
+	if(pEpoll == NULL)
+	{
+		printf("ERROR : pEpoll is NULL \n");
+		while(1);
+	}
+	pEpoll->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	pEpoll->closed = NULL;
+	if(pEpoll->epoll_fd == -1)
+	{
+		free(pEpoll);
+		return FALSE;
+	}
+	ServerEpoll_watch(pEpoll, &pServer->socket_ecoute);
+	ServerEpoll_watch(pEpoll, &pServer->notify_fd);
+	ServerEpoll_watch(pEpoll, &pServer->socket_datagramme);
+	ServerEpoll_watch(pEpoll, &pServer->socket_locale);
+	pServer->loop_state = pEpoll;
+	pServer->loop = &server_epoll_loop;
+	return TRUE;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static void ServerEpoll_run(Server* pServer)
+{
+	ServerEpoll* pEpoll = (ServerEpoll*) pServer->loop_state;
+	struct epoll_event events[MAX_EVENTS];
+	uint64_t value;
+	int nb_events = epoll_wait(pEpoll->epoll_fd, events, MAX_EVENTS, Server_getTelemetryTimeout(pServer));
+	pServer->stats.nb_syscalls++;
+	if(Trace_takeDump() == TRUE)
+	{
+		Trace_dump();
+	}
+	Server_forgetSamples(pServer);
+	for(int i = 0; i < nb_events && pServer->running; i++)
+	{
+		EpollConnection* pConnection = (EpollConnection*) ((uintptr_t) events[i].data.ptr & ~(uintptr_t) SERVER_DOORBELL_TAG);
+		bool_e alive = TRUE;
+		if(events[i].data.ptr == &pServer->socket_ecoute || events[i].data.ptr == &pServer->socket_locale)
+		{
+			ServerEpoll_accept(pServer, *(int*) events[i].data.ptr);
+			continue;
+		}
+		if(events[i].data.ptr == &pServer->socket_datagramme)
+		{
+			Server_readDatagrams(pServer);
+			continue;
+		}
+		if(events[i].data.ptr == &pServer->notify_fd)
+		{
+			//Reset the counter first, a sample pushed meanwhile signals it again.
+			if(read(pServer->notify_fd, &value, sizeof(value)) == -1 && errno != EAGAIN)
+			{
+				perror("ERROR : notify_fd");
+			}
+			pServer->stats.nb_syscalls++;
+			Server_collect(pServer);
+			continue;
+		}
+		if(pConnection->closing == TRUE)
+		{
+			//Closed by an event of its socket or of its doorbell earlier in this loop.
+			continue;
+		}
+		if((uintptr_t) events[i].data.ptr & SERVER_DOORBELL_TAG)
+		{
+			if(Server_readShm(pServer, &pConnection->connection) == FALSE)
+			{
+				Server_closeConnection(pServer, &pConnection->connection);
+			}
+			continue;
+		}
+		if(events[i].events & EPOLLOUT)
+		{
+			alive = ServerEpoll_flush(pServer, &pConnection->connection);
+		}
+		if(alive && (events[i].events & ~EPOLLOUT))
+		{
+			alive = ServerEpoll_readMsg(pServer, &pConnection->connection);
+		}
+		if(alive == FALSE)
+		{
+			Server_closeConnection(pServer, &pConnection->connection);
+		}
+	}
+	ServerEpoll_sweep(pEpoll);
+	if(pServer->running)
+	{
+		Server_pushTelemetry(pServer);
+	}
+	//One wake up of each worker for everything posted by this loop.
+	for(int i = 0; i < pServer->nb_workers; i++)
+	{
+		if(Controller_wake(pServer->workers[i]) == TRUE)
+		{
+			pServer->stats.nb_syscalls++;
+		}
+	}
+}
+
+static bool_e ServerEpoll_add(Server* pServer, Connection* pConnection)
+{
+	ServerEpoll* pEpoll = (ServerEpoll*) pServer->loop_state;
+	struct epoll_event event;
+	event.events = EPOLLIN | EPOLLRDHUP;
+	event.data.ptr = pConnection;
+	if(epoll_ctl(pEpoll->epoll_fd, EPOLL_CTL_ADD, pConnection->socket_donnees, &event) == -1)
+	{
+		perror("ERROR : epoll_ctl");
+		return FALSE;
+	}
+	if(pConnection->shm != NULL)
+	{
+		//The doorbell is the eventfd a local telco signals when it pushes a command.
+		event.events = EPOLLIN;
+		event.data.ptr = (void*) ((uintptr_t) pConnection | SERVER_DOORBELL_TAG);
+		if(epoll_ctl(pEpoll->epoll_fd, EPOLL_CTL_ADD, pConnection->shm->to_commando, &event) == -1)
+		{
+			perror("ERROR : epoll_ctl");
+			epoll_ctl(pEpoll->epoll_fd, EPOLL_CTL_DEL, pConnection->socket_donnees, NULL);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static bool_e ServerEpoll_write(Server* pServer, Connection* pConnection, const uint8_t* buffer, size_t size)
+{
+	ServerEpoll* pEpoll = (ServerEpoll*) pServer->loop_state;
+	ssize_t quantite_envoyee = 0;
+	struct epoll_event event;
+	if(pConnection->tx_len == 0)
+	{
+		quantite_envoyee = send(pConnection->socket_donnees, buffer, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+		pServer->stats.nb_syscalls++;
+		if(quantite_envoyee == (ssize_t) size)
+		{
+			return TRUE;
+		}
+		if(quantite_envoyee == -1)
+		{
+			if(errno != EAGAIN && errno != EWOULDBLOCK)
+			{
+				//The telco has left, the connection is closed when epoll reports it.
+				return FALSE;
+			}
+			quantite_envoyee = 0;
+		}
+	}
+	if(pConnection->tx_len + size - quantite_envoyee > SERVER_TX_SIZE)
+	{
+		pServer->stats.nb_dropped++;
+		return FALSE;
+	}
+	if(pConnection->tx_len == 0)
+	{
+		event.events = EPOLLIN | EPOLLRDHUP | EPOLLOUT;
+		event.data.ptr = pConnection;
+		epoll_ctl(pEpoll->epoll_fd, EPOLL_CTL_MOD, pConnection->socket_donnees, &event);
+		pServer->stats.nb_syscalls++;
+	}
+	memcpy(pConnection->tx + pConnection->tx_len, buffer + quantite_envoyee, size - quantite_envoyee);
+	pConnection->tx_len += size - quantite_envoyee;
+	return TRUE;
+}
+
+static void ServerEpoll_remove(Server* pServer, Connection* pConnection)
+{
+	ServerEpoll* pEpoll = (ServerEpoll*) pServer->loop_state;
+	EpollConnection* pEpollConnection = (EpollConnection*) pConnection;
+	epoll_ctl(pEpoll->epoll_fd, EPOLL_CTL_DEL, pConnection->socket_donnees, NULL);
+	if(pConnection->shm != NULL)
+	{
+		epoll_ctl(pEpoll->epoll_fd, EPOLL_CTL_DEL, pConnection->shm->to_commando, NULL);
+	}
+	//Its doorbell may still be reported by the current loop.
+	pEpollConnection->closing = TRUE;
+	pEpollConnection->nextClosed = pEpoll->closed;
+	pEpoll->closed = pEpollConnection;
+}
+
+static void ServerEpoll_close(Server* pServer)
+{
+	ServerEpoll* pEpoll = (ServerEpoll*) pServer->loop_state;
+	ServerEpoll_sweep(pEpoll);
+	close(pEpoll->epoll_fd);
+	free(pEpoll);
+	pServer->loop_state = NULL;
+}
+
+static void ServerEpoll_watch(ServerEpoll* pEpoll, int* pSocket)
+{
+	struct epoll_event event;
+	if(*pSocket != -1)
+	{
+		event.events = EPOLLIN;
+		event.data.ptr = pSocket;
+		epoll_ctl(pEpoll->epoll_fd, EPOLL_CTL_ADD, *pSocket, &event);
+	}
+}
+
+static void ServerEpoll_accept(Server* pServer, int socket_ecoute)
+{
+	int socket_donnees;
+	while(TRUE)
+	{
+		socket_donnees = accept4(socket_ecoute, NULL, 0, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		pServer->stats.nb_syscalls++;
+		if(socket_donnees != -1)
+		{
+			Server_newConnection(pServer, socket_donnees, (socket_ecoute == pServer->socket_locale)? TRUE : FALSE);
+		}
+		else if((errno != EMFILE && errno != ENFILE) || Server_reject(pServer, socket_ecoute) == FALSE)
+		{
+			break;
+		}
+	}
+	if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+	{
+		perror("ERROR : accept");
+	}
+}
+
+static bool_e ServerEpoll_readMsg(Server* pServer, Connection* pConnection)
+{
+	struct iovec iov[2];
+	int nb_iov;
+	size_t space;
+	ssize_t quantite_lue;
+	while(pServer->running)
+	{
+		nb_iov = Decoder_getSpace(&pConnection->decoder, iov);
+		space = iov[0].iov_len + ((nb_iov == 2)? iov[1].iov_len : 0);
+		quantite_lue = readv(pConnection->socket_donnees, iov, nb_iov);
+		pServer->stats.nb_syscalls++;
+		if(quantite_lue > 0)
+		{
+			pServer->stats.nb_reads++;
+			Decoder_commit(&pConnection->decoder, quantite_lue);
+			if(Server_readBatch(pServer, pConnection) == FALSE)
+			{
+				printf("ERROR : corrupted stream, telco dropped\n");
+				return FALSE;
+			}
+			if((size_t) quantite_lue < space)
+			{
+				//Everything available has been read, epoll tells when more arrives.
+				return TRUE;
+			}
+		}
+		else if(quantite_lue == -1 && errno == EINTR)
+		{
+			continue;
+		}
+		else
+		{
+			//0 is the telco leaving, EAGAIN is nothing left to read.
+			return (quantite_lue == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))? TRUE : FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static bool_e ServerEpoll_flush(Server* pServer, Connection* pConnection)
+{
+	ServerEpoll* pEpoll = (ServerEpoll*) pServer->loop_state;
+	struct epoll_event event;
+	ssize_t quantite_envoyee = send(pConnection->socket_donnees, pConnection->tx, pConnection->tx_len, MSG_NOSIGNAL | MSG_DONTWAIT);
+	pServer->stats.nb_syscalls++;
+	if(quantite_envoyee == -1)
+	{
+		return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)? TRUE : FALSE;
+	}
+	memmove(pConnection->tx, pConnection->tx + quantite_envoyee, pConnection->tx_len - quantite_envoyee);
+	pConnection->tx_len -= quantite_envoyee;
+	if(pConnection->tx_len == 0)
+	{
+		event.events = EPOLLIN | EPOLLRDHUP;
+		event.data.ptr = pConnection;
+		epoll_ctl(pEpoll->epoll_fd, EPOLL_CTL_MOD, pConnection->socket_donnees, &event);
+		pServer->stats.nb_syscalls++;
+	}
+	return TRUE;
+}
+
+static void ServerEpoll_sweep(ServerEpoll* pEpoll)
+{
+	while(pEpoll->closed != NULL)
+	{
+		EpollConnection* pConnection = pEpoll->closed;
+		pEpoll->closed = pConnection->nextClosed;
+		Server_freeConnection(&pConnection->connection);
+	}
+}
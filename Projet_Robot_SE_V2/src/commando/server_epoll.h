@@ -0,0 +1,51 @@
+/**
+ * @file  server_epoll.h
+ *
+ * @brief Event loop of the network thread with epoll : readiness, then one syscall per read or write.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+#ifndef SRC_COMMANDO_SERVER_EPOLL_H_
+#define SRC_COMMANDO_SERVER_EPOLL_H_
+/* ----------------------  INCLUDES ------------------------------------------*/
+#include "server.h"
+/* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
+/* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
+/* ----------------------  PUBLIC VARIBLES -----------------------------------*/
+/* ----------------------  PUBLIC FUNCTIONS PROTOTYPES  ----------------------*/
+/**
+ * \fn extern bool_e ServerEpoll_open(Server* pServer)
+ * \brief Watch the listening sockets, notify_fd and the UDP socket with epoll, and make it the loop of the server.
+ *
+ * \return bool_e : FALSE if the epoll instance could not be created.
+ */
+extern bool_e ServerEpoll_open(Server* pServer);
+
+#endif /* SRC_COMMANDO_SERVER_EPOLL_H_ */
@@ -0,0 +1,572 @@
+/**
+ * @file  server_uring.c
+ *
+ * @brief Event loop of the network thread with io_uring : multishot receives and batched writes.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "server_uring.h"
+#include "uring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+/**
+ * \brief Size of the io_uring submission queue.
+ */
+#define SERVER_URING_ENTRIES (256)
+/**
+ * \brief Receive buffers shared by the multishot receives of every telco (power of 2).
+ */
+#define SERVER_URING_BUFFERS (256)
+#define SERVER_URING_BUFFER_SIZE (DECODER_CAPACITY)
+/**
+ * \brief Bits of the io_uring user data holding the ServerEvent, the rest is the UringConnection.
+ */
+#define SERVER_EVENT_MASK (15)
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
+/**
+ * \struct UringConnection
+ * \brief A connection with the state of the io_uring backend.
+ */
+typedef struct UringConnection_t UringConnection;
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+struct UringConnection_t
+{
+	Connection connection; //first, a Connection* of this backend is a UringConnection*.
+	bool_e sending; //a send of tx is in flight.
+	bool_e unsent; //in the list of the connections to send.
+	UringConnection* nextUnsent;
+	bool_e closing; //closed, freed once its operations in flight are over.
+	int nb_inflight; //operations whose completion refers to this connection.
+};
+/**
+ * \struct ServerUring
+ * \brief State of the io_uring backend, loop_state of the server.
+ */
+typedef struct
+{
+	Uring* uring;
+	UringConnection* unsent; //connections with bytes to send at the next submission.
+	int nb_closing; //connections waiting for their operations to be cancelled.
+	int nb_inflight; //operations which are not for a connection.
+	uint64_t notify_value; //read from notify_fd.
+	uint64_t wake_value; //written to the wake_fd of the workers.
+}ServerUring;
+/* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
+/**
+ * \enum ServerEvent
+ * \brief Operation an io_uring completion is for, in the low bits of its user data.
+ */
+typedef enum
+{
+	SERVER_EVENT_ACCEPT = 1,
+	SERVER_EVENT_NOTIFY,
+	SERVER_EVENT_DATAGRAM,
+	SERVER_EVENT_WAKE,
+	SERVER_EVENT_RECV,
+	SERVER_EVENT_SEND,
+	SERVER_EVENT_CANCEL,
+	SERVER_EVENT_ACCEPT_LOCAL,
+	SERVER_EVENT_DOORBELL,
+	SERVER_EVENT_LISTEN, //a telco is pending while out of file descriptors, SERVER_EVENT_ACCEPT is posted again.
+	SERVER_EVENT_LISTEN_LOCAL
+}ServerEvent;
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static void ServerUring_run(Server* pServer)
+ * \brief Submit what the last loop prepared, wait for completions and handle them.
+ */
+static void ServerUring_run(Server* pServer);
+/**
+ * \fn static bool_e ServerUring_add(Server* pServer, Connection* pConnection)
+ * \brief Post the multishot receive of a telco, and the poll of the doorbell of a local one.
+ */
+static bool_e ServerUring_add(Server* pServer, Connection* pConnection);
+/**
+ * \fn static bool_e ServerUring_write(Server* pServer, Connection* pConnection, const uint8_t* buffer, size_t size)
+ * \brief Queue a frame, everything written in a loop is sent by the next submission.
+ *
+ * \return bool_e : FALSE if the frame has been dropped.
+ */
+static bool_e ServerUring_write(Server* pServer, Connection* pConnection, const uint8_t* buffer, size_t size);
+/**
+ * \fn static void ServerUring_remove(Server* pServer, Connection* pConnection)
+ * \brief Cancel the operations of a telco, it is freed once they are over.
+ */
+static void ServerUring_remove(Server* pServer, Connection* pConnection);
+/**
+ * \fn static void ServerUring_close(Server* pServer)
+ * \brief Cancel the operations of the server and wait for every operation in flight before freeing the io_uring.
+ */
+static void ServerUring_close(Server* pServer);
+/**
+ * \fn static void ServerUring_complete(Server* pServer, const struct io_uring_cqe* pCqe)
+ * \brief Handle an io_uring completion.
+ */
+static void ServerUring_complete(Server* pServer, const struct io_uring_cqe* pCqe);
+/**
+ * \fn static void ServerUring_receive(Server* pServer, UringConnection* pConnection, const struct io_uring_cqe* pCqe)
+ * \brief Decode the bytes of a multishot receive and post it again when the kernel ended it.
+ */
+static void ServerUring_receive(Server* pServer, UringConnection* pConnection, const struct io_uring_cqe* pCqe);
+/**
+ * \fn static void ServerUring_sent(Server* pServer, UringConnection* pConnection, int result)
+ * \brief Account for a send completed, what is left is sent with the next submission.
+ */
+static void ServerUring_sent(Server* pServer, UringConnection* pConnection, int result);
+/**
+ * \fn static void ServerUring_queueSend(ServerUring* pUring, UringConnection* pConnection)
+ * \brief Remember a connection has bytes to send at the next submission.
+ */
+static void ServerUring_queueSend(ServerUring* pUring, UringConnection* pConnection);
+/**
+ * \fn static void ServerUring_submitSends(ServerUring* pUring)
+ * \brief Prepare a single send per connection for everything written since the last submission.
+ */
+static void ServerUring_submitSends(ServerUring* pUring);
+/**
+ * \fn static void ServerUring_release(ServerUring* pUring, UringConnection* pConnection)
+ * \brief Free a closed connection once no io_uring operation refers to it anymore.
+ */
+static void ServerUring_release(ServerUring* pUring, UringConnection* pConnection);
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+static const ServerLoop server_uring_loop =
+{
+	.connection_size = sizeof(UringConnection),
+	.run = ServerUring_run,
+	.add = ServerUring_add,
+	.write = ServerUring_write,
+	.remove = ServerUring_remove,
+	.close = ServerUring_close
+};
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+bool_e ServerUring_open(Server* pServer)
+{
+	ServerUring* pUring;
+	int flags;
+	Uring* uring = Uring_new(SERVER_URING_ENTRIES, SERVER_URING_BUFFERS, SERVER_URING_BUFFER_SIZE);
+	if(uring == NULL)
+	{
+		return FALSE;
+	}
+	pUring = (ServerUring*) malloc(sizeof(ServerUring));
+	if(pUring == NULL)
+	{
+		printf("ERROR : pUring is NULL \n");
+		while(1);
+	}
+	pUring->uring = uring;
+	pUring->unsent = NULL;
+	pUring->nb_closing = 0;
+	pUring->nb_inflight = 0;
+	pUring->notify_value = 0;
+	pUring->wake_value = 1;
+	flags = fcntl(pServer->notify_fd, F_GETFL);
+	//A read of a non-blocking eventfd would complete at once with EAGAIN instead of waiting for the workers.
+	fcntl(pServer->notify_fd, F_SETFL, flags & ~O_NONBLOCK);
+	Uring_prepareAccept(uring, pServer->socket_ecoute, SERVER_EVENT_ACCEPT);
+	Uring_prepareRead(uring, pServer->notify_fd, &pUring->notify_value, sizeof(pUring->notify_value), SERVER_EVENT_NOTIFY);
+	pUring->nb_inflight += 2;
+	if(pServer->socket_datagramme != -1)
+	{
+		Uring_preparePoll(uring, pServer->socket_datagramme, SERVER_EVENT_DATAGRAM);
+		pUring->nb_inflight++;
+	}
+	if(pServer->socket_locale != -1)
+	{
+		Uring_prepareAccept(uring, pServer->socket_locale, SERVER_EVENT_ACCEPT_LOCAL);
+		pUring->nb_inflight++;
+	}
+	pServer->loop_state = pUring;
+	pServer->loop = &server_uring_loop;
+	return TRUE;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static void ServerUring_run(Server* pServer)
+{
+	ServerUring* pUring = (ServerUring*) pServer->loop_state;
+	unsigned long nb_enters = pUring->uring->nb_enters;
+	struct io_uring_cqe* pCqe;
+	int timeout = Server_getTelemetryTimeout(pServer);
+	//A single io_uring_enter submits the sends and the wake ups of the last loop and waits.
+	ServerUring_submitSends(pUring);
+	if(Uring_wait(pUring->uring, timeout) == -1 && errno != ETIME && errno != EINTR)
+	{
+		perror("ERROR : io_uring_enter");
+	}
+	if(Trace_takeDump() == TRUE)
+	{
+		Trace_dump();
+	}
+	Server_forgetSamples(pServer);
+	while(pServer->running && (pCqe = Uring_peek(pUring->uring)) != NULL)
+	{
+		//Copied, so that the slot is given back before the handler prepares new entries.
+		struct io_uring_cqe cqe = *pCqe;
+		Uring_seen(pUring->uring);
+		ServerUring_complete(pServer, &cqe);
+	}
+	if(pServer->running)
+	{
+		Server_pushTelemetry(pServer);
+	}
+	for(int i = 0; i < pServer->nb_workers; i++)
+	{
+		if(Controller_takeWake(pServer->workers[i]) == TRUE)
+		{
+			Uring_prepareWrite(pUring->uring, pServer->workers[i]->wake_fd, &pUring->wake_value, sizeof(pUring->wake_value), SERVER_EVENT_WAKE);
+			pUring->nb_inflight++;
+		}
+	}
+	pServer->stats.nb_syscalls += pUring->uring->nb_enters - nb_enters;
+}
+
+static bool_e ServerUring_add(Server* pServer, Connection* pConnection)
+{
+	ServerUring* pUring = (ServerUring*) pServer->loop_state;
+	UringConnection* pUringConnection = (UringConnection*) pConnection;
+	//Posted once, the kernel keeps receiving into the shared buffers until the telco leaves.
+	Uring_prepareRecv(pUring->uring, pConnection->socket_donnees, (uintptr_t) pConnection | SERVER_EVENT_RECV);
+	pUringConnection->nb_inflight = 1;
+	if(pConnection->shm != NULL)
+	{
+		Uring_preparePoll(pUring->uring, pConnection->shm->to_commando, (uintptr_t) pConnection | SERVER_EVENT_DOORBELL);
+		pUringConnection->nb_inflight++;
+	}
+	return TRUE;
+}
+
+static bool_e ServerUring_write(Server* pServer, Connection* pConnection, const uint8_t* buffer, size_t size)
+{
+	if(pConnection->tx_len + size > SERVER_TX_SIZE)
+	{
+		pServer->stats.nb_dropped++;
+		return FALSE;
+	}
+	memcpy(pConnection->tx + pConnection->tx_len, buffer, size);
+	pConnection->tx_len += size;
+	ServerUring_queueSend((ServerUring*) pServer->loop_state, (UringConnection*) pConnection);
+	return TRUE;
+}
+
+static void ServerUring_remove(Server* pServer, Connection* pConnection)
+{
+	ServerUring* pUring = (ServerUring*) pServer->loop_state;
+	UringConnection* pUringConnection = (UringConnection*) pConnection;
+	//The receive and the send in flight still refer to the connection.
+	Uring_prepareCancel(pUring->uring, (uintptr_t) pConnection | SERVER_EVENT_RECV, (uintptr_t) pConnection | SERVER_EVENT_CANCEL);
+	Uring_prepareCancel(pUring->uring, (uintptr_t) pConnection | SERVER_EVENT_SEND, (uintptr_t) pConnection | SERVER_EVENT_CANCEL);
+	pUringConnection->nb_inflight += 2;
+	if(pConnection->shm != NULL)
+	{
+		Uring_prepareCancel(pUring->uring, (uintptr_t) pConnection | SERVER_EVENT_DOORBELL, (uintptr_t) pConnection | SERVER_EVENT_CANCEL);
+		pUringConnection->nb_inflight++;
+	}
+	pUringConnection->closing = TRUE;
+	pUring->nb_closing++;
+}
+
+static void ServerUring_close(Server* pServer)
+{
+	ServerUring* pUring = (ServerUring*) pServer->loop_state;
+	uint64_t value = 1;
+	//Every operation in flight must complete before its socket is reused and its memory is freed.
+	Uring_prepareCancel(pUring->uring, SERVER_EVENT_ACCEPT, SERVER_EVENT_CANCEL);
+	Uring_prepareCancel(pUring->uring, SERVER_EVENT_LISTEN, SERVER_EVENT_CANCEL);
+	pUring->nb_inflight += 2;
+	if(pServer->socket_datagramme != -1)
+	{
+		Uring_prepareCancel(pUring->uring, SERVER_EVENT_DATAGRAM, SERVER_EVENT_CANCEL);
+		pUring->nb_inflight++;
+	}
+	if(pServer->socket_locale != -1)
+	{
+		Uring_prepareCancel(pUring->uring, SERVER_EVENT_ACCEPT_LOCAL, SERVER_EVENT_CANCEL);
+		Uring_prepareCancel(pUring->uring, SERVER_EVENT_LISTEN_LOCAL, SERVER_EVENT_CANCEL);
+		pUring->nb_inflight += 2;
+	}
+	//The read of notify_fd completes once it is signaled.
+	if(write(pServer->notify_fd, &value, sizeof(value)) == -1)
+	{
+		perror("ERROR : notify_fd");
+	}
+	for(int i = 0; i < 10 && (pUring->nb_closing > 0 || pUring->nb_inflight > 0); i++)
+	{
+		struct io_uring_cqe* pCqe;
+		ServerUring_submitSends(pUring);
+		Uring_wait(pUring->uring, 100);
+		while((pCqe = Uring_peek(pUring->uring)) != NULL)
+		{
+			struct io_uring_cqe cqe = *pCqe;
+			Uring_seen(pUring->uring);
+			ServerUring_complete(pServer, &cqe);
+		}
+	}
+	Uring_free(pUring->uring);
+	free(pUring);
+	pServer->loop_state = NULL;
+}
+
+static void ServerUring_complete(Server* pServer, const struct io_uring_cqe* pCqe)
+{
+	ServerUring* pUring = (ServerUring*) pServer->loop_state;
+	UringConnection* pConnection = (UringConnection*) (uintptr_t) (pCqe->user_data & ~(uint64_t) SERVER_EVENT_MASK);
+	bool_e more = (pCqe->flags & IORING_CQE_F_MORE)? TRUE : FALSE;
+	ServerEvent type = (ServerEvent) (pCqe->user_data & SERVER_EVENT_MASK);
+	int socket_ecoute;
+	switch(type)
+	{
+		case SERVER_EVENT_ACCEPT:
+		case SERVER_EVENT_ACCEPT_LOCAL:
+			socket_ecoute = (type == SERVER_EVENT_ACCEPT_LOCAL)? pServer->socket_locale : pServer->socket_ecoute;
+			if(pCqe->res >= 0 && pServer->running)
+			{
+				Server_newConnection(pServer, pCqe->res, (type == SERVER_EVENT_ACCEPT_LOCAL)? TRUE : FALSE);
+			}
+			else if(pCqe->res >= 0)
+			{
+				close(pCqe->res);
+			}
+			else if(pCqe->res == -EMFILE || pCqe->res == -ENFILE)
+			{
+				while(Server_reject(pServer, socket_ecoute) == TRUE);
+			}
+			else if(pCqe->res != -ECANCELED)
+			{
+				printf("ERROR : accept : %s\n", strerror(-pCqe->res));
+			}
+			if(more == FALSE && pServer->running && (pCqe->res == -EMFILE || pCqe->res == -ENFILE))
+			{
+				//The accept of io_uring takes a file descriptor before it looks for a telco, posted again it would
+				//fail again at once : it waits for the next telco.
+				Uring_preparePollOnce(pUring->uring, socket_ecoute, (type == SERVER_EVENT_ACCEPT_LOCAL)? SERVER_EVENT_LISTEN_LOCAL : SERVER_EVENT_LISTEN);
+			}
+			else if(more == FALSE && pServer->running)
+			{
+				Uring_prepareAccept(pUring->uring, socket_ecoute, type);
+			}
+			else if(more == FALSE)
+			{
+				pUring->nb_inflight--;
+			}
+			break;
+		case SERVER_EVENT_LISTEN:
+		case SERVER_EVENT_LISTEN_LOCAL:
+			if(pServer->running)
+			{
+				Uring_prepareAccept(pUring->uring, (type == SERVER_EVENT_LISTEN_LOCAL)? pServer->socket_locale : pServer->socket_ecoute,
+						(type == SERVER_EVENT_LISTEN_LOCAL)? SERVER_EVENT_ACCEPT_LOCAL : SERVER_EVENT_ACCEPT);
+			}
+			else
+			{
+				pUring->nb_inflight--;
+			}
+			break;
+		case SERVER_EVENT_NOTIFY:
+			pUring->nb_inflight--;
+			if(pServer->running)
+			{
+				Server_collect(pServer);
+				Uring_prepareRead(pUring->uring, pServer->notify_fd, &pUring->notify_value, sizeof(pUring->notify_value), SERVER_EVENT_NOTIFY);
+				pUring->nb_inflight++;
+			}
+			break;
+		case SERVER_EVENT_DATAGRAM:
+			if(pServer->running)
+			{
+				Server_readDatagrams(pServer);
+			}
+			if(more == FALSE)
+			{
+				pUring->nb_inflight--;
+				if(pServer->running)
+				{
+					Uring_preparePoll(pUring->uring, pServer->socket_datagramme, SERVER_EVENT_DATAGRAM);
+					pUring->nb_inflight++;
+				}
+			}
+			break;
+		case SERVER_EVENT_WAKE:
+			pUring->nb_inflight--;
+			if(pCqe->res < 0)
+			{
+				printf("ERROR : wake_fd : %s\n", strerror(-pCqe->res));
+			}
+			break;
+		case SERVER_EVENT_RECV:
+			ServerUring_receive(pServer, pConnection, pCqe);
+			break;
+		case SERVER_EVENT_SEND:
+			ServerUring_sent(pServer, pConnection, pCqe->res);
+			break;
+		case SERVER_EVENT_DOORBELL:
+			if(pConnection->closing == FALSE && pServer->running && pCqe->res >= 0
+					&& Server_readShm(pServer, &pConnection->connection) == FALSE)
+			{
+				Server_closeConnection(pServer, &pConnection->connection);
+			}
+			if(more == FALSE)
+			{
+				pConnection->nb_inflight--;
+				if(pConnection->closing == FALSE && pCqe->res >= 0)
+				{
+					Uring_preparePoll(pUring->uring, pConnection->connection.shm->to_commando, (uintptr_t) pConnection | SERVER_EVENT_DOORBELL);
+					pConnection->nb_inflight++;
+				}
+			}
+			ServerUring_release(pUring, pConnection);
+			break;
+		case SERVER_EVENT_CANCEL:
+			if(pConnection == NULL)
+			{
+				pUring->nb_inflight--;
+				break;
+			}
+			pConnection->nb_inflight--;
+			ServerUring_release(pUring, pConnection);
+			break;
+		default:
+			break;
+	}
+}
+
+static void ServerUring_receive(Server* pServer, UringConnection* pConnection, const struct io_uring_cqe* pCqe)
+{
+	ServerUring* pUring = (ServerUring*) pServer->loop_state;
+	bool_e alive = TRUE;
+	uint16_t id = (uint16_t) (pCqe->flags >> IORING_CQE_BUFFER_SHIFT);
+	if(pConnection->closing == FALSE && pCqe->res > 0)
+	{
+		const uint8_t* data = Uring_getBuffer(pUring->uring, id);
+		size_t offset = 0;
+		pServer->stats.nb_reads++;
+		while(offset < (size_t) pCqe->res && alive == TRUE && pServer->running)
+		{
+			offset += Decoder_feed(&pConnection->connection.decoder, data + offset, pCqe->res - offset);
+			if(Server_readBatch(pServer, &pConnection->connection) == FALSE)
+			{
+				printf("ERROR : corrupted stream, telco dropped\n");
+				alive = FALSE;
+			}
+		}
+	}
+	else if(pCqe->res != -ENOBUFS)
+	{
+		//0 is the telco leaving, ENOBUFS is every receive buffer in use.
+		alive = FALSE;
+	}
+	if(pCqe->flags & IORING_CQE_F_BUFFER)
+	{
+		Uring_recycleBuffer(pUring->uring, id);
+	}
+	if((pCqe->flags & IORING_CQE_F_MORE) == 0)
+	{
+		pConnection->nb_inflight--;
+		if(alive == TRUE && pConnection->closing == FALSE)
+		{
+			Uring_prepareRecv(pUring->uring, pConnection->connection.socket_donnees, (uintptr_t) pConnection | SERVER_EVENT_RECV);
+			pConnection->nb_inflight++;
+		}
+	}
+	if(pConnection->closing == TRUE)
+	{
+		ServerUring_release(pUring, pConnection);
+	}
+	else if(alive == FALSE)
+	{
+		Server_closeConnection(pServer, &pConnection->connection);
+	}
+}
+
+static void ServerUring_sent(Server* pServer, UringConnection* pConnection, int result)
+{
+	ServerUring* pUring = (ServerUring*) pServer->loop_state;
+	pConnection->sending = FALSE;
+	pConnection->nb_inflight--;
+	if(pConnection->closing == TRUE)
+	{
+		ServerUring_release(pUring, pConnection);
+	}
+	else if(result < 0)
+	{
+		//The telco has left.
+		Server_closeConnection(pServer, &pConnection->connection);
+	}
+	else
+	{
+		//Frames written while the send was in flight are after tx_len of the send, they are kept.
+		memmove(pConnection->connection.tx, pConnection->connection.tx + result, pConnection->connection.tx_len - result);
+		pConnection->connection.tx_len -= result;
+		if(pConnection->connection.tx_len > 0)
+		{
+			ServerUring_queueSend(pUring, pConnection);
+		}
+	}
+}
+
+static void ServerUring_queueSend(ServerUring* pUring, UringConnection* pConnection)
+{
+	if(pConnection->unsent == FALSE)
+	{
+		pConnection->unsent = TRUE;
+		pConnection->nextUnsent = pUring->unsent;
+		pUring->unsent = pConnection;
+	}
+}
+
+static void ServerUring_submitSends(ServerUring* pUring)
+{
+	while(pUring->unsent != NULL)
+	{
+		UringConnection* pConnection = pUring->unsent;
+		pUring->unsent = pConnection->nextUnsent;
+		pConnection->unsent = FALSE;
+		if(pConnection->closing == FALSE && pConnection->sending == FALSE && pConnection->connection.tx_len > 0)
+		{
+			Uring_prepareSend(pUring->uring, pConnection->connection.socket_donnees, pConnection->connection.tx, pConnection->connection.tx_len,
+					(uintptr_t) pConnection | SERVER_EVENT_SEND);
+			pConnection->sending = TRUE;
+			pConnection->nb_inflight++;
+		}
+	}
+}
+
+static void ServerUring_release(ServerUring* pUring, UringConnection* pConnection)
+{
+	if(pConnection->closing == TRUE && pConnection->nb_inflight == 0)
+	{
+		Server_freeConnection(&pConnection->connection);
+		pUring->nb_closing--;
+	}
+}
@@ -0,0 +1,114 @@
+/**
+ * @file  trajectory.c
+ *
+ * @brief Timed segments of velocity executed by a pilot on the clock of the commando.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "trajectory.h"
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static struct timespec Trajectory_getTime(const Trajectory* pTrajectory, uint32_t offset_ms)
+ * \brief CLOCK_MONOTONIC time of an offset of the trajectory.
+ */
+static struct timespec Trajectory_getTime(const Trajectory* pTrajectory, uint32_t offset_ms);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+void Trajectory_init(Trajectory* pTrajectory)
+{
+	pTrajectory->nb_applied = 0;
+	pTrajectory->nb_rejected = 0;
+	Trajectory_cancel(pTrajectory);
+}
+
+void Trajectory_cancel(Trajectory* pTrajectory)
+{
+	pTrajectory->first = 0;
+	pTrajectory->nb_segments = 0;
+	pTrajectory->started = FALSE;
+	pTrajectory->last_offset_ms = 0;
+}
+
+bool_e Trajectory_append(Trajectory* pTrajectory, const TrajectorySegment* pSegment, const struct timespec* pNow)
+{
+	if(pTrajectory->nb_segments == TRAJECTORY_CAPACITY || pSegment->offset_ms < pTrajectory->last_offset_ms)
+	{
+		pTrajectory->nb_rejected++;
+		return FALSE;
+	}
+	if(pTrajectory->started == FALSE)
+	{
+		pTrajectory->start = *pNow;
+		pTrajectory->started = TRUE;
+	}
+	pTrajectory->segments[(pTrajectory->first + pTrajectory->nb_segments) % TRAJECTORY_CAPACITY] = *pSegment;
+	pTrajectory->nb_segments++;
+	pTrajectory->last_offset_ms = pSegment->offset_ms;
+	return TRUE;
+}
+
+bool_e Trajectory_getDeadline(const Trajectory* pTrajectory, struct timespec* pDeadline)
+{
+	if(pTrajectory->nb_segments == 0)
+	{
+		return FALSE;
+	}
+	*pDeadline = Trajectory_getTime(pTrajectory, pTrajectory->segments[pTrajectory->first].offset_ms);
+	return TRUE;
+}
+
+bool_e Trajectory_next(Trajectory* pTrajectory, const struct timespec* pNow, VelocityVector* pVector)
+{
+	struct timespec deadline;
+	bool_e due = FALSE;
+	while(Trajectory_getDeadline(pTrajectory, &deadline) == TRUE
+			&& (deadline.tv_sec < pNow->tv_sec || (deadline.tv_sec == pNow->tv_sec && deadline.tv_nsec <= pNow->tv_nsec)))
+	{
+		*pVector = pTrajectory->segments[pTrajectory->first].vector;
+		pTrajectory->first = (pTrajectory->first + 1) % TRAJECTORY_CAPACITY;
+		pTrajectory->nb_segments--;
+		pTrajectory->nb_applied++;
+		due = TRUE;
+	}
+	return due;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static struct timespec Trajectory_getTime(const Trajectory* pTrajectory, uint32_t offset_ms)
+{
+	struct timespec time = pTrajectory->start;
+	time.tv_nsec += (long) (offset_ms % 1000) * 1000000;
+	time.tv_sec += offset_ms / 1000 + time.tv_nsec / 1000000000;
+	time.tv_nsec %= 1000000000;
+	return time;
+}
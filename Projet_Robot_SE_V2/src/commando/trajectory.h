@@ -0,0 +1,96 @@
+/**
+ * @file  trajectory.h
+ *
+ * @brief Timed segments of velocity executed by a pilot on the clock of the commando.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+#ifndef SRC_COMMANDO_TRAJECTORY_H_
+#define SRC_COMMANDO_TRAJECTORY_H_
+/* ----------------------  INCLUDES ------------------------------------------*/
+#include <time.h>
+#include "../commun.h"
+#include "prose.h"
+/* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/**
+ * \brief Segments buffered for a robot, the telco streams the next ones as they are consumed.
+ */
+#define TRAJECTORY_CAPACITY (64)
+/* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
+/* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
+/**
+ * \struct Trajectory
+ * \brief Segments not applied yet, in the order of their offsets.
+ */
+typedef struct
+{
+	TrajectorySegment segments[TRAJECTORY_CAPACITY]; //circular, segments[first] is the next one.
+	int first;
+	int nb_segments;
+	bool_e started; //start is valid until the trajectory is cancelled, even once every segment is applied.
+	struct timespec start; //CLOCK_MONOTONIC time of the offset 0.
+	uint32_t last_offset_ms; //offset of the last segment appended, the next ones cannot be earlier.
+	unsigned long nb_applied;
+	unsigned long nb_rejected; //segments not appended, the buffer being full or them earlier than the last one.
+}Trajectory;
+/* ----------------------  PUBLIC VARIBLES -----------------------------------*/
+/* ----------------------  PUBLIC FUNCTIONS PROTOTYPES  ----------------------*/
+/**
+ * \fn extern void Trajectory_init(Trajectory* pTrajectory)
+ * \brief Initialize an empty trajectory, not started.
+ */
+extern void Trajectory_init(Trajectory* pTrajectory);
+/**
+ * \fn extern void Trajectory_cancel(Trajectory* pTrajectory)
+ * \brief Forget the segments not applied yet, the next segment appended starts a new trajectory.
+ */
+extern void Trajectory_cancel(Trajectory* pTrajectory);
+/**
+ * \fn extern bool_e Trajectory_append(Trajectory* pTrajectory, const TrajectorySegment* pSegment, const struct timespec* pNow)
+ * \brief Buffer a segment, the trajectory starts at pNow if it is not started yet.
+ *
+ * \return bool_e : FALSE if the buffer is full or the segment is earlier than the last one.
+ */
+extern bool_e Trajectory_append(Trajectory* pTrajectory, const TrajectorySegment* pSegment, const struct timespec* pNow);
+/**
+ * \fn extern bool_e Trajectory_getDeadline(const Trajectory* pTrajectory, struct timespec* pDeadline)
+ * \brief Time at which the next segment is due.
+ *
+ * \return bool_e : FALSE if no segment is left.
+ */
+extern bool_e Trajectory_getDeadline(const Trajectory* pTrajectory, struct timespec* pDeadline);
+/**
+ * \fn extern bool_e Trajectory_next(Trajectory* pTrajectory, const struct timespec* pNow, VelocityVector* pVector)
+ * \brief Consume the segments due at pNow, the latest one wins when several are late.
+ *
+ * \return bool_e : FALSE if no segment is due, pVector is left as is.
+ */
+extern bool_e Trajectory_next(Trajectory* pTrajectory, const struct timespec* pNow, VelocityVector* pVector);
+
+#endif /* SRC_COMMANDO_TRAJECTORY_H_ */
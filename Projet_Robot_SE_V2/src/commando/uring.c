@@ -0,0 +1,364 @@
+/**
+ * @file  uring.c
+ *
+ * @brief Minimal io_uring ring driven by the raw system calls, with a ring of provided receive buffers.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "uring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <poll.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static int Uring_enter(Uring* pUring, unsigned nb_submit, unsigned nb_wait, unsigned flags, void* arg, size_t arg_size)
+ * \brief io_uring_enter(2), which has no wrapper in the C library.
+ */
+static int Uring_enter(Uring* pUring, unsigned nb_submit, unsigned nb_wait, unsigned flags, void* arg, size_t arg_size);
+/**
+ * \fn static void Uring_publish(Uring* pUring)
+ * \brief Make the entries written visible to the kernel.
+ */
+static void Uring_publish(Uring* pUring);
+/**
+ * \fn static bool_e Uring_registerBuffers(Uring* pUring)
+ * \brief Allocate the receive buffers and register them as a provided buffer ring.
+ */
+static bool_e Uring_registerBuffers(Uring* pUring);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+Uring* Uring_new(unsigned nb_entries, unsigned nb_buffers, size_t buffer_size)
+{
+	struct io_uring_params params;
+	Uring* pUring = (Uring*) calloc(1, sizeof(Uring));
+	if(pUring == NULL)
+	{
+		printf("ERROR : pUring is NULL \n");
+		while(1);
+	}
+	pUring->nb_buffers = nb_buffers;
+	pUring->buffer_size = buffer_size;
+	//The completions are run when the thread enters the kernel anyway, instead of interrupting it.
+	memset(&params, 0, sizeof(params));
+	params.flags = IORING_SETUP_COOP_TASKRUN;
+	pUring->fd = (int) syscall(__NR_io_uring_setup, nb_entries, &params);
+	if(pUring->fd == -1 && errno == EINVAL)
+	{
+		//Kernel older than 5.19.
+		memset(&params, 0, sizeof(params));
+		pUring->fd = (int) syscall(__NR_io_uring_setup, nb_entries, &params);
+	}
+	if(pUring->fd == -1)
+	{
+		free(pUring);
+		return NULL;
+	}
+	if((params.features & IORING_FEAT_EXT_ARG) == 0)
+	{
+		close(pUring->fd);
+		free(pUring);
+		return NULL;
+	}
+	pUring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	pUring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	if(params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		if(pUring->cq_ring_size > pUring->sq_ring_size)
+		{
+			pUring->sq_ring_size = pUring->cq_ring_size;
+		}
+		pUring->cq_ring_size = pUring->sq_ring_size;
+	}
+	pUring->sq_ring = mmap(NULL, pUring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pUring->fd, IORING_OFF_SQ_RING);
+	if(params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		pUring->cq_ring = pUring->sq_ring;
+	}
+	else
+	{
+		pUring->cq_ring = mmap(NULL, pUring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pUring->fd, IORING_OFF_CQ_RING);
+	}
+	pUring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	pUring->sqes = (struct io_uring_sqe*) mmap(NULL, pUring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pUring->fd, IORING_OFF_SQES);
+	if(pUring->sq_ring == MAP_FAILED || pUring->cq_ring == MAP_FAILED || pUring->sqes == MAP_FAILED)
+	{
+		perror("ERROR : mmap of the io_uring");
+		close(pUring->fd);
+		free(pUring);
+		return NULL;
+	}
+	pUring->sq_head = (unsigned*) ((uint8_t*) pUring->sq_ring + params.sq_off.head);
+	pUring->sq_tail = (unsigned*) ((uint8_t*) pUring->sq_ring + params.sq_off.tail);
+	pUring->sq_array = (unsigned*) ((uint8_t*) pUring->sq_ring + params.sq_off.array);
+	pUring->sq_mask = *(unsigned*) ((uint8_t*) pUring->sq_ring + params.sq_off.ring_mask);
+	pUring->sq_entries = params.sq_entries;
+	pUring->cq_head = (unsigned*) ((uint8_t*) pUring->cq_ring + params.cq_off.head);
+	pUring->cq_tail = (unsigned*) ((uint8_t*) pUring->cq_ring + params.cq_off.tail);
+	pUring->cq_mask = *(unsigned*) ((uint8_t*) pUring->cq_ring + params.cq_off.ring_mask);
+	pUring->cqes = (struct io_uring_cqe*) ((uint8_t*) pUring->cq_ring + params.cq_off.cqes);
+	if(Uring_registerBuffers(pUring) == FALSE)
+	{
+		Uring_free(pUring);
+		return NULL;
+	}
+	return pUring;
+}
+
+void Uring_free(Uring* pUring)
+{
+	close(pUring->fd);
+	if(pUring->buffer_ring != NULL)
+	{
+		munmap(pUring->buffer_ring, pUring->buffer_ring_size);
+	}
+	free(pUring->buffers);
+	munmap(pUring->sqes, pUring->sqes_size);
+	if(pUring->cq_ring != pUring->sq_ring)
+	{
+		munmap(pUring->cq_ring, pUring->cq_ring_size);
+	}
+	munmap(pUring->sq_ring, pUring->sq_ring_size);
+	free(pUring);
+}
+
+struct io_uring_sqe* Uring_getSqe(Uring* pUring)
+{
+	struct io_uring_sqe* pSqe;
+	unsigned index;
+	if(pUring->sq_local_tail - __atomic_load_n(pUring->sq_head, __ATOMIC_ACQUIRE) >= pUring->sq_entries)
+	{
+		//Full, the pending entries are submitted without waiting.
+		Uring_wait(pUring, 0);
+	}
+	index = pUring->sq_local_tail & pUring->sq_mask;
+	pSqe = &pUring->sqes[index];
+	memset(pSqe, 0, sizeof(*pSqe));
+	pUring->sq_array[index] = index;
+	pUring->sq_local_tail++;
+	return pSqe;
+}
+
+int Uring_wait(Uring* pUring, int timeout_ms)
+{
+	struct __kernel_timespec timeout;
+	struct io_uring_getevents_arg arg;
+	unsigned nb_submit;
+	unsigned flags = 0;
+	int result;
+	Uring_publish(pUring);
+	nb_submit = pUring->sq_local_tail - __atomic_load_n(pUring->sq_head, __ATOMIC_ACQUIRE);
+	if(timeout_ms != 0)
+	{
+		flags = IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+		memset(&arg, 0, sizeof(arg));
+		if(timeout_ms > 0)
+		{
+			timeout.tv_sec = timeout_ms / 1000;
+			timeout.tv_nsec = (long long) (timeout_ms % 1000) * 1000000;
+			arg.ts = (uint64_t) (uintptr_t) &timeout;
+		}
+	}
+	else if(nb_submit == 0)
+	{
+		return 0;
+	}
+	do
+	{
+		result = Uring_enter(pUring, nb_submit, (timeout_ms != 0)? 1 : 0, flags, (flags != 0)? &arg : NULL, sizeof(arg));
+	}while(result == -1 && errno == EINTR);
+	return result;
+}
+
+struct io_uring_cqe* Uring_peek(Uring* pUring)
+{
+	unsigned head = *pUring->cq_head;
+	if(head == __atomic_load_n(pUring->cq_tail, __ATOMIC_ACQUIRE))
+	{
+		return NULL;
+	}
+	return &pUring->cqes[head & pUring->cq_mask];
+}
+
+void Uring_seen(Uring* pUring)
+{
+	__atomic_store_n(pUring->cq_head, *pUring->cq_head + 1, __ATOMIC_RELEASE);
+}
+
+uint8_t* Uring_getBuffer(Uring* pUring, uint16_t id)
+{
+	return pUring->buffers + (size_t) id * pUring->buffer_size;
+}
+
+void Uring_recycleBuffer(Uring* pUring, uint16_t id)
+{
+	unsigned short tail = pUring->buffer_ring->tail;
+	struct io_uring_buf* pBuffer = &pUring->buffer_ring->bufs[tail & (pUring->nb_buffers - 1)];
+	pBuffer->addr = (uint64_t) (uintptr_t) Uring_getBuffer(pUring, id);
+	pBuffer->len = (uint32_t) pUring->buffer_size;
+	pBuffer->bid = id;
+	__atomic_store_n(&pUring->buffer_ring->tail, (unsigned short) (tail + 1), __ATOMIC_RELEASE);
+}
+
+void Uring_prepareRecv(Uring* pUring, int fd, uint64_t user_data)
+{
+	struct io_uring_sqe* pSqe = Uring_getSqe(pUring);
+	pSqe->opcode = IORING_OP_RECV;
+	pSqe->fd = fd;
+	pSqe->ioprio = IORING_RECV_MULTISHOT;
+	pSqe->flags = IOSQE_BUFFER_SELECT;
+	pSqe->buf_group = URING_BUFFER_GROUP;
+	pSqe->user_data = user_data;
+}
+
+void Uring_prepareAccept(Uring* pUring, int fd, uint64_t user_data)
+{
+	struct io_uring_sqe* pSqe = Uring_getSqe(pUring);
+	pSqe->opcode = IORING_OP_ACCEPT;
+	pSqe->fd = fd;
+	pSqe->ioprio = IORING_ACCEPT_MULTISHOT;
+	pSqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+	pSqe->user_data = user_data;
+}
+
+void Uring_preparePoll(Uring* pUring, int fd, uint64_t user_data)
+{
+	struct io_uring_sqe* pSqe = Uring_getSqe(pUring);
+	pSqe->opcode = IORING_OP_POLL_ADD;
+	pSqe->fd = fd;
+	pSqe->len = IORING_POLL_ADD_MULTI;
+	pSqe->poll32_events = POLLIN;
+	pSqe->user_data = user_data;
+}
+
+void Uring_preparePollOnce(Uring* pUring, int fd, uint64_t user_data)
+{
+	struct io_uring_sqe* pSqe = Uring_getSqe(pUring);
+	pSqe->opcode = IORING_OP_POLL_ADD;
+	pSqe->fd = fd;
+	pSqe->poll32_events = POLLIN;
+	pSqe->user_data = user_data;
+}
+
+void Uring_prepareRead(Uring* pUring, int fd, void* buffer, size_t size, uint64_t user_data)
+{
+	struct io_uring_sqe* pSqe = Uring_getSqe(pUring);
+	pSqe->opcode = IORING_OP_READ;
+	pSqe->fd = fd;
+	pSqe->addr = (uint64_t) (uintptr_t) buffer;
+	pSqe->len = (uint32_t) size;
+	pSqe->off = (uint64_t) -1; //current position, required for the eventfd and the pipes.
+	pSqe->user_data = user_data;
+}
+
+void Uring_prepareWrite(Uring* pUring, int fd, const void* buffer, size_t size, uint64_t user_data)
+{
+	struct io_uring_sqe* pSqe = Uring_getSqe(pUring);
+	pSqe->opcode = IORING_OP_WRITE;
+	pSqe->fd = fd;
+	pSqe->addr = (uint64_t) (uintptr_t) buffer;
+	pSqe->len = (uint32_t) size;
+	pSqe->off = (uint64_t) -1;
+	pSqe->user_data = user_data;
+}
+
+void Uring_prepareSend(Uring* pUring, int fd, const void* buffer, size_t size, uint64_t user_data)
+{
+	struct io_uring_sqe* pSqe = Uring_getSqe(pUring);
+	pSqe->opcode = IORING_OP_SEND;
+	pSqe->fd = fd;
+	pSqe->addr = (uint64_t) (uintptr_t) buffer;
+	pSqe->len = (uint32_t) size;
+	pSqe->msg_flags = MSG_NOSIGNAL;
+	pSqe->user_data = user_data;
+}
+
+void Uring_prepareCancel(Uring* pUring, uint64_t target, uint64_t user_data)
+{
+	struct io_uring_sqe* pSqe = Uring_getSqe(pUring);
+	pSqe->opcode = IORING_OP_ASYNC_CANCEL;
+	pSqe->fd = -1;
+	pSqe->addr = target;
+	pSqe->cancel_flags = IORING_ASYNC_CANCEL_ALL;
+	pSqe->user_data = user_data;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static int Uring_enter(Uring* pUring, unsigned nb_submit, unsigned nb_wait, unsigned flags, void* arg, size_t arg_size)
+{
+	pUring->nb_enters++;
+	return (int) syscall(__NR_io_uring_enter, pUring->fd, nb_submit, nb_wait, flags, arg, arg_size);
+}
+
+static void Uring_publish(Uring* pUring)
+{
+	__atomic_store_n(pUring->sq_tail, pUring->sq_local_tail, __ATOMIC_RELEASE);
+}
+
+static bool_e Uring_registerBuffers(Uring* pUring)
+{
+	struct io_uring_buf_reg registration;
+	pUring->buffer_ring_size = pUring->nb_buffers * sizeof(struct io_uring_buf);
+	pUring->buffer_ring = (struct io_uring_buf_ring*) mmap(NULL, pUring->buffer_ring_size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(pUring->buffer_ring == MAP_FAILED)
+	{
+		pUring->buffer_ring = NULL;
+		return FALSE;
+	}
+	pUring->buffers = (uint8_t*) malloc(pUring->nb_buffers * pUring->buffer_size);
+	if(pUring->buffers == NULL)
+	{
+		printf("ERROR : pUring->buffers is NULL \n");
+		while(1);
+	}
+	memset(&registration, 0, sizeof(registration));
+	registration.ring_addr = (uint64_t) (uintptr_t) pUring->buffer_ring;
+	registration.ring_entries = pUring->nb_buffers;
+	registration.bgid = URING_BUFFER_GROUP;
+	if(syscall(__NR_io_uring_register, pUring->fd, IORING_REGISTER_PBUF_RING, &registration, 1) == -1)
+	{
+		return FALSE;
+	}
+	pUring->buffer_ring->tail = 0;
+	for(unsigned i = 0; i < pUring->nb_buffers; i++)
+	{
+		Uring_recycleBuffer(pUring, (uint16_t) i);
+	}
+	return TRUE;
+}
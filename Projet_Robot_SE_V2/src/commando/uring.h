@@ -0,0 +1,170 @@
+/**
+ * @file  uring.h
+ *
+ * @brief Minimal io_uring ring driven by the raw system calls, with a ring of provided receive buffers.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+#ifndef SRC_COMMANDO_URING_H_
+#define SRC_COMMANDO_URING_H_
+/* ----------------------  INCLUDES ------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/io_uring.h>
+#include "prose.h"
+/* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/**
+ * \brief Buffer group of the provided receive buffers.
+ */
+#define URING_BUFFER_GROUP (0)
+/**
+ * \struct Uring
+ * \brief Uring object.
+ */
+typedef struct Uring_t Uring;
+/* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
+/* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
+struct Uring_t
+{
+	int fd;
+	void* sq_ring;
+	size_t sq_ring_size;
+	void* cq_ring;
+	size_t cq_ring_size;
+	struct io_uring_sqe* sqes;
+	size_t sqes_size;
+	unsigned* sq_head;
+	unsigned* sq_tail;
+	unsigned* sq_array;
+	unsigned sq_mask;
+	unsigned sq_entries;
+	unsigned* cq_head;
+	unsigned* cq_tail;
+	unsigned cq_mask;
+	struct io_uring_cqe* cqes;
+	unsigned sq_local_tail; //tail including the entries not published to the kernel yet.
+	struct io_uring_buf_ring* buffer_ring; //buffers the kernel picks from for the multishot receives.
+	size_t buffer_ring_size;
+	uint8_t* buffers;
+	unsigned nb_buffers;
+	size_t buffer_size;
+	unsigned long nb_enters; //io_uring_enter calls.
+};
+/* ----------------------  PUBLIC VARIBLES -----------------------------------*/
+/* ----------------------  PUBLIC FUNCTIONS PROTOTYPES  ----------------------*/
+/**
+ * \fn extern Uring* Uring_new(unsigned nb_entries, unsigned nb_buffers, size_t buffer_size)
+ * \brief Set up a ring and register nb_buffers receive buffers of buffer_size bytes (nb_buffers power of 2).
+ *
+ * \return Uring* : NULL if io_uring, the extended wait or the provided buffer rings are not supported.
+ */
+extern Uring* Uring_new(unsigned nb_entries, unsigned nb_buffers, size_t buffer_size);
+/**
+ * \fn extern void Uring_free(Uring* pUring)
+ * \brief Destruct the ring, the operations in flight are cancelled by the kernel.
+ */
+extern void Uring_free(Uring* pUring);
+/**
+ * \fn extern struct io_uring_sqe* Uring_getSqe(Uring* pUring)
+ * \brief Get a cleared submission entry, submitted with the next Uring_wait.
+ *        The pending entries are submitted first when the submission queue is full.
+ */
+extern struct io_uring_sqe* Uring_getSqe(Uring* pUring);
+/**
+ * \fn extern int Uring_wait(Uring* pUring, int timeout_ms)
+ * \brief Submit the pending entries and wait for a completion, in a single system call.
+ *
+ * \param int timeout_ms : -1 to wait forever, 0 to only submit.
+ * \return int : number of entries submitted, -1 on error (errno set, ETIME on timeout).
+ */
+extern int Uring_wait(Uring* pUring, int timeout_ms);
+/**
+ * \fn extern struct io_uring_cqe* Uring_peek(Uring* pUring)
+ * \brief Get the next completion, without any system call.
+ *
+ * \return struct io_uring_cqe* : NULL when there is none, else to be released by Uring_seen.
+ */
+extern struct io_uring_cqe* Uring_peek(Uring* pUring);
+/**
+ * \fn extern void Uring_seen(Uring* pUring)
+ * \brief Release the completion given by Uring_peek.
+ */
+extern void Uring_seen(Uring* pUring);
+/**
+ * \fn extern uint8_t* Uring_getBuffer(Uring* pUring, uint16_t id)
+ * \brief Get the receive buffer picked by the kernel for a completion (id = cqe->flags >> IORING_CQE_BUFFER_SHIFT).
+ */
+extern uint8_t* Uring_getBuffer(Uring* pUring, uint16_t id);
+/**
+ * \fn extern void Uring_recycleBuffer(Uring* pUring, uint16_t id)
+ * \brief Give a receive buffer back to the kernel once its content has been used.
+ */
+extern void Uring_recycleBuffer(Uring* pUring, uint16_t id);
+/**
+ * \fn extern void Uring_prepareRecv(Uring* pUring, int fd, uint64_t user_data)
+ * \brief Post a multishot receive on a socket, each completion carries a provided buffer.
+ */
+extern void Uring_prepareRecv(Uring* pUring, int fd, uint64_t user_data);
+/**
+ * \fn extern void Uring_prepareAccept(Uring* pUring, int fd, uint64_t user_data)
+ * \brief Post a multishot accept on a listening socket, the sockets accepted are non-blocking.
+ */
+extern void Uring_prepareAccept(Uring* pUring, int fd, uint64_t user_data);
+/**
+ * \fn extern void Uring_preparePoll(Uring* pUring, int fd, uint64_t user_data)
+ * \brief Post a multishot poll for input on a file descriptor.
+ */
+extern void Uring_preparePoll(Uring* pUring, int fd, uint64_t user_data);
+/**
+ * \fn extern void Uring_preparePollOnce(Uring* pUring, int fd, uint64_t user_data)
+ * \brief Post a poll for input on a file descriptor, which completes once.
+ */
+extern void Uring_preparePollOnce(Uring* pUring, int fd, uint64_t user_data);
+/**
+ * \fn extern void Uring_prepareRead(Uring* pUring, int fd, void* buffer, size_t size, uint64_t user_data)
+ * \brief Post a read.
+ */
+extern void Uring_prepareRead(Uring* pUring, int fd, void* buffer, size_t size, uint64_t user_data);
+/**
+ * \fn extern void Uring_prepareWrite(Uring* pUring, int fd, const void* buffer, size_t size, uint64_t user_data)
+ * \brief Post a write, buffer must stay valid until its completion.
+ */
+extern void Uring_prepareWrite(Uring* pUring, int fd, const void* buffer, size_t size, uint64_t user_data);
+/**
+ * \fn extern void Uring_prepareSend(Uring* pUring, int fd, const void* buffer, size_t size, uint64_t user_data)
+ * \brief Post a send on a socket, buffer must stay valid until its completion.
+ */
+extern void Uring_prepareSend(Uring* pUring, int fd, const void* buffer, size_t size, uint64_t user_data);
+/**
+ * \fn extern void Uring_prepareCancel(Uring* pUring, uint64_t target, uint64_t user_data)
+ * \brief Cancel every operation posted with the user data target.
+ */
+extern void Uring_prepareCancel(Uring* pUring, uint64_t target, uint64_t user_data);
+
+#endif /* SRC_COMMANDO_URING_H_ */
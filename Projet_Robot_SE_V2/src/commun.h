@@ -34,24 +34,52 @@
 #ifndef SRC_COMMUN_H_
 #define SRC_COMMUN_H_
 #include <arpa/inet.h>
+#include <stdint.h>
 #define PORT_DU_SERVEUR (12346)
 
 
 /**
  * \enum Direction
- * \brief Constant for directions.
+ * \brief Constant for directions, TWIST for a continuous linear and angular velocity.
  */
-typedef enum {LEFT=0, RIGHT, FORWARD, BACKWARD, STOP} Direction;
+typedef enum {LEFT=0, RIGHT, FORWARD, BACKWARD, STOP, TWIST} Direction;
 /**
  * \struct VelocityVector
  * \brief Constants for velocity vector.
+ *
+ * For a TWIST, power is the linear velocity in % of the full speed of the wheels (negative backward)
+ * and angular the angular velocity, in % of the full speed the wheels turn in opposite ways at
+ * (positive to the side LEFT spins to, 100 spins in place at full power).
  */
 typedef struct
 {
     Direction dir;
     int power;
+    int angular; //TWIST only, 0 for the other directions.
 } VelocityVector;
 
+/**
+ * \struct TrajectorySegment
+ * \brief Velocity applied by the pilot from offset_ms after the start of its trajectory.
+ */
+typedef struct
+{
+    uint32_t offset_ms;
+    VelocityVector vector;
+} TrajectorySegment;
+
+/**
+ * \enum TrajectoryFlag
+ * \brief How uploaded segments are combined with the trajectory of the robot.
+ */
+typedef enum
+{
+    TRAJECTORY_REPLACE = 0x00, /**< the trajectory is cancelled, the segments start now */
+    TRAJECTORY_APPEND = 0x01,  /**< the segments go on the trajectory (started now if there is none) */
+    TRAJECTORY_CANCEL = 0x02,  /**< the trajectory is cancelled and the robot stopped, without segment */
+    TRAJECTORY_TWIST = 0x04    /**< set in a FRAME_TRAJECTORY whose segments carry an angular velocity */
+} TrajectoryFlag;
+
 /**
  * \struct PilotState
  * \brief Constants for pilot state.
@@ -61,6 +89,10 @@ typedef struct
     int speed;
     int collision;
     float luminosity;
+    uint64_t sampled; //CLOCK_MONOTONIC time in ns of the commando when the sensors were read, 0 if unknown.
+    float x; //pose of the robot integrated by its odometry : mm from where it started,
+    float y; //the x axis along its heading at the start.
+    float heading; //rad, between -pi and pi, counterclockwise.
 } PilotState;
 
 /**
@@ -76,6 +108,12 @@ typedef struct{
     int bump;
     int askLog; //0 no, 1 yes.
     int stop; //0 no stop, 1 stop.
+    int robot; //id of the robot addressed, 0 when the commando drives only one.
+    unsigned int request; //id of an askLog, echoed in its answer (0 for none).
+    uint64_t captured; //Trace_now of the key pressed in the timebase of the commando, 0 when the command is not traced.
+    uint64_t sent; //Trace_now when the Client sends the command in the timebase of the commando, 0 if not synchronized yet.
+    uint64_t sampled; //for an answer, PilotState.sampled of the sensors read.
+    int angular; //angular velocity of a TWIST direction, see VelocityVector.
 }DesDonnees;
 
 
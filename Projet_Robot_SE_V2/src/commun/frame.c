@@ -0,0 +1,951 @@
+/**
+ * @file  frame.c
+ *
+ * @brief Encoding and streaming decoding of the frames exchanged between telco and commando.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "frame.h"
+#include <string.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+/**
+ * \brief Longest time between two samples of a delta telemetry stream sent as a varint of us.
+ */
+#define FRAME_SAMPLED_MAX_DELTA_NS ((uint64_t) UINT32_MAX * 1000)
+#define FRAME_PI (3.14159265f)
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static uint8_t* Frame_putU32(uint8_t* buffer, uint32_t value)
+ * \brief Write a 32 bits value in network byte order.
+ *
+ * \return uint8_t* : first byte after the value.
+ */
+static uint8_t* Frame_putU32(uint8_t* buffer, uint32_t value);
+/**
+ * \fn static const uint8_t* Frame_getU32(const uint8_t* buffer, uint32_t* pValue)
+ * \brief Read a 32 bits value in network byte order.
+ *
+ * \return const uint8_t* : first byte after the value.
+ */
+static const uint8_t* Frame_getU32(const uint8_t* buffer, uint32_t* pValue);
+/**
+ * \fn static uint8_t* Frame_putU64(uint8_t* buffer, uint64_t value)
+ * \brief Write a 64 bits value in network byte order.
+ *
+ * \return uint8_t* : first byte after the value.
+ */
+static uint8_t* Frame_putU64(uint8_t* buffer, uint64_t value);
+/**
+ * \fn static const uint8_t* Frame_getU64(const uint8_t* buffer, uint64_t* pValue)
+ * \brief Read a 64 bits value in network byte order.
+ *
+ * \return const uint8_t* : first byte after the value.
+ */
+static const uint8_t* Frame_getU64(const uint8_t* buffer, uint64_t* pValue);
+/**
+ * \fn static bool_e Frame_parseHeader(const uint8_t* header, Frame* pFrame)
+ * \brief Check and read a frame header.
+ *
+ * \return bool_e : FALSE if it is not a valid header.
+ */
+static bool_e Frame_parseHeader(const uint8_t* header, Frame* pFrame);
+/**
+ * \fn static uint8_t* Frame_putVarint(uint8_t* buffer, uint32_t value)
+ * \brief Write a value 7 bits per byte, the high bit set on every byte but the last.
+ *
+ * \return uint8_t* : first byte after the value.
+ */
+static uint8_t* Frame_putVarint(uint8_t* buffer, uint32_t value);
+/**
+ * \fn static const uint8_t* Frame_getVarint(const uint8_t* buffer, const uint8_t* end, uint32_t* pValue)
+ * \brief Read a value written by Frame_putVarint, without reading from end on.
+ *
+ * \return const uint8_t* : first byte after the value, NULL if it is truncated or too long.
+ */
+static const uint8_t* Frame_getVarint(const uint8_t* buffer, const uint8_t* end, uint32_t* pValue);
+/**
+ * \fn static uint32_t Frame_zigzag(int32_t value)
+ * \brief Map the signed values to the unsigned ones, small magnitudes to small values.
+ */
+static uint32_t Frame_zigzag(int32_t value);
+/**
+ * \fn static int32_t Frame_unzigzag(uint32_t value)
+ * \brief Inverse of Frame_zigzag.
+ */
+static int32_t Frame_unzigzag(uint32_t value);
+/**
+ * \fn static bool_e Frame_quantize(float difference, float step, int32_t* pSteps)
+ * \brief Round a difference of the delta telemetry to a number of steps.
+ *
+ * \return bool_e : FALSE if it is too large for a varint (or not a number), it is sent in a keyframe.
+ */
+static bool_e Frame_quantize(float difference, float step, int32_t* pSteps);
+/**
+ * \fn static float Frame_wrapHeading(float heading)
+ * \brief Bring a heading or a difference of headings between -pi and pi.
+ */
+static float Frame_wrapHeading(float heading);
+/**
+ * \fn static bool_e Frame_hasPose(const PilotState* pState)
+ * \brief Whether a PilotState carries a pose, a robot without odometry stays at (0, 0, 0).
+ */
+static bool_e Frame_hasPose(const PilotState* pState);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+size_t Frame_encode(uint8_t* buffer, FrameType type, const uint8_t* payload, uint16_t length)
+{
+	buffer[0] = (uint8_t) (FRAME_MAGIC >> 8);
+	buffer[1] = (uint8_t) (FRAME_MAGIC & 0xFF);
+	buffer[2] = FRAME_VERSION;
+	buffer[3] = (uint8_t) type;
+	buffer[4] = (uint8_t) (length >> 8);
+	buffer[5] = (uint8_t) (length & 0xFF);
+	if(payload != NULL && payload != buffer + FRAME_HEADER_SIZE)
+	{
+		memcpy(buffer + FRAME_HEADER_SIZE, payload, length);
+	}
+	return FRAME_HEADER_SIZE + length;
+}
+
+size_t Frame_encodeDonnees(uint8_t* buffer, const DesDonnees* pDonnees)
+{
+	uint8_t* cursor = buffer + FRAME_HEADER_SIZE;
+	uint32_t luminosity;
+	uint16_t twist = 0;
+	memcpy(&luminosity, &pDonnees->luminosity, sizeof(luminosity));
+	cursor = Frame_putU32(cursor, (uint32_t) pDonnees->direction);
+	cursor = Frame_putU32(cursor, (uint32_t) pDonnees->power);
+	cursor = Frame_putU32(cursor, luminosity);
+	cursor = Frame_putU32(cursor, (uint32_t) pDonnees->bump);
+	cursor = Frame_putU32(cursor, (uint32_t) pDonnees->askLog);
+	cursor = Frame_putU32(cursor, (uint32_t) pDonnees->stop);
+	cursor = Frame_putU32(cursor, (uint32_t) pDonnees->robot);
+	cursor = Frame_putU32(cursor, pDonnees->request);
+	if(pDonnees->direction == TWIST)
+	{
+		cursor = Frame_putU32(cursor, (uint32_t) pDonnees->angular);
+		twist = FRAME_TWIST_SIZE;
+	}
+	if(pDonnees->captured == 0 && pDonnees->sent == 0 && pDonnees->sampled == 0)
+	{
+		return Frame_encode(buffer, FRAME_DONNEES, NULL, FRAME_DONNEES_SIZE + twist);
+	}
+	cursor = Frame_putU64(cursor, pDonnees->captured);
+	cursor = Frame_putU64(cursor, pDonnees->sent);
+	if(pDonnees->sampled != 0)
+	{
+		cursor = Frame_putU64(cursor, pDonnees->sampled);
+		return Frame_encode(buffer, FRAME_DONNEES, NULL, FRAME_DONNEES_SAMPLED_SIZE + twist);
+	}
+	return Frame_encode(buffer, FRAME_DONNEES, NULL, FRAME_DONNEES_TRACED_SIZE + twist);
+}
+
+bool_e Frame_decodeDonnees(const Frame* pFrame, DesDonnees* pDonnees)
+{
+	const uint8_t* cursor = pFrame->payload;
+	uint32_t value;
+	uint16_t twist = 0;
+	if(pFrame->type != FRAME_DONNEES || pFrame->length < FRAME_DONNEES_SIZE - 8)
+	{
+		return FALSE;
+	}
+	cursor = Frame_getU32(cursor, &value);
+	pDonnees->direction = (int32_t) value;
+	cursor = Frame_getU32(cursor, &value);
+	pDonnees->power = (int32_t) value;
+	cursor = Frame_getU32(cursor, &value);
+	memcpy(&pDonnees->luminosity, &value, sizeof(value));
+	cursor = Frame_getU32(cursor, &value);
+	pDonnees->bump = (int32_t) value;
+	cursor = Frame_getU32(cursor, &value);
+	pDonnees->askLog = (int32_t) value;
+	cursor = Frame_getU32(cursor, &value);
+	pDonnees->stop = (int32_t) value;
+	pDonnees->robot = 0;
+	pDonnees->request = 0;
+	if(pFrame->length >= FRAME_DONNEES_SIZE - 4)
+	{
+		cursor = Frame_getU32(cursor, &value);
+		pDonnees->robot = (int32_t) value;
+	}
+	if(pFrame->length >= FRAME_DONNEES_SIZE)
+	{
+		cursor = Frame_getU32(cursor, &value);
+		pDonnees->request = value;
+	}
+	pDonnees->angular = 0;
+	if(pDonnees->direction == TWIST)
+	{
+		//Written by the telcos which know the TWIST, after the robot and the request.
+		if(pFrame->length < FRAME_DONNEES_SIZE + FRAME_TWIST_SIZE)
+		{
+			return FALSE;
+		}
+		cursor = Frame_getU32(cursor, &value);
+		pDonnees->angular = (int32_t) value;
+		twist = FRAME_TWIST_SIZE;
+	}
+	pDonnees->captured = 0;
+	pDonnees->sent = 0;
+	pDonnees->sampled = 0;
+	if(pFrame->length >= FRAME_DONNEES_TRACED_SIZE + twist)
+	{
+		cursor = Frame_getU64(cursor, &pDonnees->captured);
+		cursor = Frame_getU64(cursor, &pDonnees->sent);
+	}
+	if(pFrame->length >= FRAME_DONNEES_SAMPLED_SIZE + twist)
+	{
+		cursor = Frame_getU64(cursor, &pDonnees->sampled);
+	}
+	return TRUE;
+}
+
+size_t Frame_encodeSubscribe(uint8_t* buffer, uint32_t robot, uint32_t period_ms, uint16_t port, uint32_t flags)
+{
+	uint8_t* cursor = buffer + FRAME_HEADER_SIZE;
+	cursor = Frame_putU32(cursor, period_ms);
+	cursor = Frame_putU32(cursor, port);
+	cursor = Frame_putU32(cursor, robot);
+	cursor = Frame_putU32(cursor, flags);
+	return Frame_encode(buffer, FRAME_SUBSCRIBE, NULL, FRAME_SUBSCRIBE_SIZE);
+}
+
+bool_e Frame_decodeSubscribe(const Frame* pFrame, uint32_t* pRobot, uint32_t* pPeriod_ms, uint16_t* pPort, uint32_t* pFlags)
+{
+	uint32_t port = 0;
+	*pRobot = 0;
+	*pFlags = 0;
+	if(pFrame->type != FRAME_SUBSCRIBE || pFrame->length < 4)
+	{
+		return FALSE;
+	}
+	Frame_getU32(pFrame->payload, pPeriod_ms);
+	if(pFrame->length >= 8)
+	{
+		Frame_getU32(pFrame->payload + 4, &port);
+	}
+	if(pFrame->length >= 12)
+	{
+		Frame_getU32(pFrame->payload + 8, pRobot);
+	}
+	if(pFrame->length >= FRAME_SUBSCRIBE_SIZE)
+	{
+		Frame_getU32(pFrame->payload + 12, pFlags);
+	}
+	*pPort = (uint16_t) port;
+	return TRUE;
+}
+
+size_t Frame_encodeVelocity(uint8_t* buffer, uint32_t sequence, uint32_t robot, const VelocityVector* pVector)
+{
+	uint8_t* cursor = buffer + FRAME_HEADER_SIZE;
+	cursor = Frame_putU32(cursor, sequence);
+	cursor = Frame_putU32(cursor, (uint32_t) pVector->dir);
+	cursor = Frame_putU32(cursor, (uint32_t) pVector->power);
+	cursor = Frame_putU32(cursor, robot);
+	if(pVector->dir == TWIST)
+	{
+		cursor = Frame_putU32(cursor, (uint32_t) pVector->angular);
+		return Frame_encode(buffer, FRAME_VELOCITY, NULL, FRAME_VELOCITY_SIZE + FRAME_TWIST_SIZE);
+	}
+	return Frame_encode(buffer, FRAME_VELOCITY, NULL, FRAME_VELOCITY_SIZE);
+}
+
+bool_e Frame_decodeVelocity(const Frame* pFrame, uint32_t* pSequence, uint32_t* pRobot, VelocityVector* pVector)
+{
+	const uint8_t* cursor = pFrame->payload;
+	uint32_t value;
+	if(pFrame->type != FRAME_VELOCITY || pFrame->length < FRAME_VELOCITY_SIZE - 4)
+	{
+		return FALSE;
+	}
+	cursor = Frame_getU32(cursor, pSequence);
+	cursor = Frame_getU32(cursor, &value);
+	pVector->dir = (Direction) value;
+	cursor = Frame_getU32(cursor, &value);
+	pVector->power = (int32_t) value;
+	pVector->angular = 0;
+	*pRobot = 0;
+	if(pFrame->length >= FRAME_VELOCITY_SIZE)
+	{
+		cursor = Frame_getU32(cursor, pRobot);
+	}
+	if(pVector->dir == TWIST && pFrame->length >= FRAME_VELOCITY_SIZE + FRAME_TWIST_SIZE)
+	{
+		cursor = Frame_getU32(cursor, &value);
+		pVector->angular = (int32_t) value;
+	}
+	return TRUE;
+}
+
+size_t Frame_encodeTelemetryDatagram(uint8_t* buffer, uint32_t sequence, uint32_t robot, const PilotState* pState)
+{
+	uint8_t frame[FRAME_MAX_SIZE];
+	size_t size = Frame_encodeTelemetry(frame, robot, pState) - FRAME_HEADER_SIZE;
+	Frame_putU32(buffer + FRAME_HEADER_SIZE, sequence);
+	memcpy(buffer + FRAME_HEADER_SIZE + 4, frame + FRAME_HEADER_SIZE, size);
+	return Frame_encode(buffer, FRAME_TELEMETRY_DGRAM, NULL, (uint16_t) (4 + size));
+}
+
+bool_e Frame_decodeTelemetryDatagram(const Frame* pFrame, uint32_t* pSequence, uint32_t* pRobot, PilotState* pState)
+{
+	Frame telemetry;
+	if(pFrame->type != FRAME_TELEMETRY_DGRAM || pFrame->length < 4 + FRAME_TELEMETRY_SIZE - 4)
+	{
+		return FALSE;
+	}
+	Frame_getU32(pFrame->payload, pSequence);
+	telemetry.version = pFrame->version;
+	telemetry.type = FRAME_TELEMETRY;
+	telemetry.length = pFrame->length - 4;
+	telemetry.payload = pFrame->payload + 4;
+	return Frame_decodeTelemetry(&telemetry, pRobot, pState);
+}
+
+void Frame_initTelemetryCodec(TelemetryCodec* pCodec)
+{
+	memset(&pCodec->reference, 0, sizeof(pCodec->reference));
+	pCodec->nb_deltas = 0;
+	pCodec->synchronized = FALSE;
+}
+
+size_t Frame_encodeTelemetryDelta(uint8_t* buffer, uint32_t robot, const PilotState* pState, TelemetryCodec* pCodec)
+{
+	uint8_t* cursor = buffer + FRAME_HEADER_SIZE + 1;
+	uint8_t fields = (robot != 0)? FRAME_DELTA_ROBOT : 0;
+	float difference = pState->luminosity - pCodec->reference.luminosity;
+	float steps = difference / FRAME_LUMINOSITY_STEP;
+	int32_t pose[3];
+	uint32_t luminosity;
+	uint32_t coordinate;
+	//A change too large for the quantization (or not a number), or a time going backwards, is sent as a keyframe.
+	if(pCodec->synchronized == FALSE || pCodec->nb_deltas >= FRAME_KEYFRAME_PERIOD || !(steps > -1e9f && steps < 1e9f)
+			|| Frame_quantize(pState->x - pCodec->reference.x, FRAME_POSITION_STEP, &pose[0]) == FALSE
+			|| Frame_quantize(pState->y - pCodec->reference.y, FRAME_POSITION_STEP, &pose[1]) == FALSE
+			|| Frame_quantize(Frame_wrapHeading(pState->heading - pCodec->reference.heading), FRAME_HEADING_STEP, &pose[2]) == FALSE
+			|| (pState->sampled != 0 && (pState->sampled < pCodec->reference.sampled
+					|| pState->sampled - pCodec->reference.sampled > FRAME_SAMPLED_MAX_DELTA_NS)))
+	{
+		fields |= FRAME_DELTA_KEYFRAME;
+		if(robot != 0)
+		{
+			cursor = Frame_putVarint(cursor, robot);
+		}
+		memcpy(&luminosity, &pState->luminosity, sizeof(luminosity));
+		cursor = Frame_putVarint(cursor, Frame_zigzag(pState->speed));
+		cursor = Frame_putVarint(cursor, Frame_zigzag(pState->collision));
+		cursor = Frame_putU32(cursor, luminosity);
+		if(pState->sampled != 0)
+		{
+			fields |= FRAME_DELTA_SAMPLED;
+			cursor = Frame_putU64(cursor, pState->sampled);
+		}
+		if(Frame_hasPose(pState) == TRUE)
+		{
+			fields |= FRAME_DELTA_POSE;
+			memcpy(&coordinate, &pState->x, sizeof(coordinate));
+			cursor = Frame_putU32(cursor, coordinate);
+			memcpy(&coordinate, &pState->y, sizeof(coordinate));
+			cursor = Frame_putU32(cursor, coordinate);
+			memcpy(&coordinate, &pState->heading, sizeof(coordinate));
+			cursor = Frame_putU32(cursor, coordinate);
+		}
+		pCodec->reference = *pState;
+		pCodec->nb_deltas = 0;
+		pCodec->synchronized = TRUE;
+	}
+	else
+	{
+		int32_t quantized = (int32_t) (steps + ((steps >= 0)? 0.5f : -0.5f));
+		if(robot != 0)
+		{
+			cursor = Frame_putVarint(cursor, robot);
+		}
+		if(pState->speed != pCodec->reference.speed)
+		{
+			fields |= FRAME_DELTA_SPEED;
+			cursor = Frame_putVarint(cursor, Frame_zigzag((int32_t) ((uint32_t) pState->speed - (uint32_t) pCodec->reference.speed)));
+		}
+		if(pState->collision != pCodec->reference.collision)
+		{
+			fields |= FRAME_DELTA_COLLISION;
+			cursor = Frame_putVarint(cursor, Frame_zigzag(pState->collision));
+		}
+		if(quantized != 0)
+		{
+			fields |= FRAME_DELTA_LUMINOSITY;
+			cursor = Frame_putVarint(cursor, Frame_zigzag(quantized));
+			//As the telco computes it.
+			pCodec->reference.luminosity += quantized * FRAME_LUMINOSITY_STEP;
+		}
+		if(pState->sampled != 0)
+		{
+			uint32_t elapsed_us = (uint32_t) ((pState->sampled - pCodec->reference.sampled) / 1000);
+			fields |= FRAME_DELTA_SAMPLED;
+			cursor = Frame_putVarint(cursor, elapsed_us);
+			//As the telco computes it, the error stays below 1 us.
+			pCodec->reference.sampled += (uint64_t) elapsed_us * 1000;
+		}
+		if(pose[0] != 0 || pose[1] != 0 || pose[2] != 0)
+		{
+			fields |= FRAME_DELTA_POSE;
+			cursor = Frame_putVarint(cursor, Frame_zigzag(pose[0]));
+			cursor = Frame_putVarint(cursor, Frame_zigzag(pose[1]));
+			cursor = Frame_putVarint(cursor, Frame_zigzag(pose[2]));
+			//As the telco computes it.
+			pCodec->reference.x += pose[0] * FRAME_POSITION_STEP;
+			pCodec->reference.y += pose[1] * FRAME_POSITION_STEP;
+			pCodec->reference.heading = Frame_wrapHeading(pCodec->reference.heading + pose[2] * FRAME_HEADING_STEP);
+		}
+		pCodec->reference.speed = pState->speed;
+		pCodec->reference.collision = pState->collision;
+		pCodec->nb_deltas++;
+	}
+	buffer[FRAME_HEADER_SIZE] = fields;
+	return Frame_encode(buffer, FRAME_TELEMETRY_DELTA, NULL, (uint16_t) (cursor - buffer - FRAME_HEADER_SIZE));
+}
+
+bool_e Frame_decodeTelemetryDelta(const Frame* pFrame, uint32_t* pRobot, PilotState* pState, TelemetryCodec* pCodec)
+{
+	const uint8_t* end = pFrame->payload + pFrame->length;
+	const uint8_t* cursor = pFrame->payload + 1;
+	PilotState reference = pCodec->reference;
+	uint32_t value;
+	uint8_t fields;
+	if(pFrame->type != FRAME_TELEMETRY_DELTA || pFrame->length < 1)
+	{
+		return FALSE;
+	}
+	fields = pFrame->payload[0];
+	if((fields & FRAME_DELTA_KEYFRAME) == 0 && pCodec->synchronized == FALSE)
+	{
+		return FALSE;
+	}
+	*pRobot = 0;
+	if((fields & FRAME_DELTA_ROBOT) && (cursor = Frame_getVarint(cursor, end, pRobot)) == NULL)
+	{
+		return FALSE;
+	}
+	if(fields & FRAME_DELTA_KEYFRAME)
+	{
+		if((cursor = Frame_getVarint(cursor, end, &value)) == NULL)
+		{
+			return FALSE;
+		}
+		reference.speed = Frame_unzigzag(value);
+		if((cursor = Frame_getVarint(cursor, end, &value)) == NULL || end - cursor < 4)
+		{
+			return FALSE;
+		}
+		reference.collision = Frame_unzigzag(value);
+		cursor = Frame_getU32(cursor, &value);
+		memcpy(&reference.luminosity, &value, sizeof(value));
+		reference.sampled = 0;
+		if(fields & FRAME_DELTA_SAMPLED)
+		{
+			if(end - cursor < 8)
+			{
+				return FALSE;
+			}
+			cursor = Frame_getU64(cursor, &reference.sampled);
+		}
+		reference.x = 0;
+		reference.y = 0;
+		reference.heading = 0;
+		if(fields & FRAME_DELTA_POSE)
+		{
+			if(end - cursor < 12)
+			{
+				return FALSE;
+			}
+			cursor = Frame_getU32(cursor, &value);
+			memcpy(&reference.x, &value, sizeof(value));
+			cursor = Frame_getU32(cursor, &value);
+			memcpy(&reference.y, &value, sizeof(value));
+			cursor = Frame_getU32(cursor, &value);
+			memcpy(&reference.heading, &value, sizeof(value));
+		}
+	}
+	else
+	{
+		if(fields & FRAME_DELTA_SPEED)
+		{
+			if((cursor = Frame_getVarint(cursor, end, &value)) == NULL)
+			{
+				return FALSE;
+			}
+			reference.speed = (int32_t) ((uint32_t) reference.speed + (uint32_t) Frame_unzigzag(value));
+		}
+		if(fields & FRAME_DELTA_COLLISION)
+		{
+			if((cursor = Frame_getVarint(cursor, end, &value)) == NULL)
+			{
+				return FALSE;
+			}
+			reference.collision = Frame_unzigzag(value);
+		}
+		if(fields & FRAME_DELTA_LUMINOSITY)
+		{
+			if((cursor = Frame_getVarint(cursor, end, &value)) == NULL)
+			{
+				return FALSE;
+			}
+			reference.luminosity += Frame_unzigzag(value) * FRAME_LUMINOSITY_STEP;
+		}
+		if(fields & FRAME_DELTA_SAMPLED)
+		{
+			if((cursor = Frame_getVarint(cursor, end, &value)) == NULL)
+			{
+				return FALSE;
+			}
+			reference.sampled += (uint64_t) value * 1000;
+		}
+		if(fields & FRAME_DELTA_POSE)
+		{
+			uint32_t pose[3];
+			for(int i = 0; i < 3; i++)
+			{
+				if((cursor = Frame_getVarint(cursor, end, &pose[i])) == NULL)
+				{
+					return FALSE;
+				}
+			}
+			reference.x += Frame_unzigzag(pose[0]) * FRAME_POSITION_STEP;
+			reference.y += Frame_unzigzag(pose[1]) * FRAME_POSITION_STEP;
+			reference.heading = Frame_wrapHeading(reference.heading + Frame_unzigzag(pose[2]) * FRAME_HEADING_STEP);
+		}
+	}
+	pCodec->reference = reference;
+	pCodec->synchronized = TRUE;
+	*pState = reference;
+	if((fields & FRAME_DELTA_SAMPLED) == 0)
+	{
+		pState->sampled = 0;
+	}
+	return TRUE;
+}
+
+size_t Frame_encodeHeartbeat(uint8_t* buffer, uint32_t robot)
+{
+	Frame_putU32(buffer + FRAME_HEADER_SIZE, robot);
+	return Frame_encode(buffer, FRAME_HEARTBEAT, NULL, FRAME_HEARTBEAT_SIZE);
+}
+
+bool_e Frame_decodeHeartbeat(const Frame* pFrame, uint32_t* pRobot)
+{
+	if(pFrame->type != FRAME_HEARTBEAT)
+	{
+		return FALSE;
+	}
+	*pRobot = 0;
+	if(pFrame->length >= FRAME_HEARTBEAT_SIZE)
+	{
+		Frame_getU32(pFrame->payload, pRobot);
+	}
+	return TRUE;
+}
+
+size_t Frame_encodePing(uint8_t* buffer, uint64_t originate, uint64_t receive, uint64_t transmit)
+{
+	uint8_t* cursor = buffer + FRAME_HEADER_SIZE;
+	cursor = Frame_putU64(cursor, originate);
+	cursor = Frame_putU64(cursor, receive);
+	cursor = Frame_putU64(cursor, transmit);
+	return Frame_encode(buffer, FRAME_PING, NULL, FRAME_PING_SIZE);
+}
+
+bool_e Frame_decodePing(const Frame* pFrame, uint64_t* pOriginate, uint64_t* pReceive, uint64_t* pTransmit)
+{
+	const uint8_t* cursor = pFrame->payload;
+	if(pFrame->type != FRAME_PING || pFrame->length < FRAME_PING_SIZE)
+	{
+		return FALSE;
+	}
+	cursor = Frame_getU64(cursor, pOriginate);
+	cursor = Frame_getU64(cursor, pReceive);
+	cursor = Frame_getU64(cursor, pTransmit);
+	return TRUE;
+}
+
+size_t Frame_encodeTrajectory(uint8_t* buffer, uint32_t robot, uint32_t flags, const TrajectorySegment* pSegments, int nb_segments)
+{
+	uint8_t* cursor = buffer + FRAME_HEADER_SIZE;
+	uint16_t size = FRAME_SEGMENT_SIZE;
+	nb_segments = Frame_fitTrajectory(pSegments, nb_segments);
+	flags &= ~TRAJECTORY_TWIST;
+	for(int i = 0; i < nb_segments; i++)
+	{
+		if(pSegments[i].vector.dir == TWIST)
+		{
+			flags |= TRAJECTORY_TWIST;
+			size = FRAME_SEGMENT_SIZE + FRAME_TWIST_SIZE;
+		}
+	}
+	cursor = Frame_putU32(cursor, robot);
+	cursor = Frame_putU32(cursor, flags);
+	for(int i = 0; i < nb_segments; i++)
+	{
+		cursor = Frame_putU32(cursor, pSegments[i].offset_ms);
+		cursor = Frame_putU32(cursor, (uint32_t) pSegments[i].vector.dir);
+		cursor = Frame_putU32(cursor, (uint32_t) pSegments[i].vector.power);
+		if(flags & TRAJECTORY_TWIST)
+		{
+			cursor = Frame_putU32(cursor, (uint32_t) ((pSegments[i].vector.dir == TWIST)? pSegments[i].vector.angular : 0));
+		}
+	}
+	return Frame_encode(buffer, FRAME_TRAJECTORY, NULL, FRAME_TRAJECTORY_SIZE + nb_segments * size);
+}
+
+int Frame_fitTrajectory(const TrajectorySegment* pSegments, int nb_segments)
+{
+	int nb_fit = (nb_segments > FRAME_TRAJECTORY_MAX_SEGMENTS)? FRAME_TRAJECTORY_MAX_SEGMENTS : nb_segments;
+	for(int i = 0; i < nb_fit; i++)
+	{
+		if(pSegments[i].vector.dir == TWIST)
+		{
+			return (nb_fit > FRAME_TRAJECTORY_MAX_TWISTS)? FRAME_TRAJECTORY_MAX_TWISTS : nb_fit;
+		}
+	}
+	return nb_fit;
+}
+
+bool_e Frame_decodeTrajectory(const Frame* pFrame, uint32_t* pRobot, uint32_t* pFlags, TrajectorySegment* pSegments, int* pNb)
+{
+	const uint8_t* cursor = pFrame->payload;
+	uint32_t value;
+	uint16_t twist;
+	if(pFrame->type != FRAME_TRAJECTORY || pFrame->length < FRAME_TRAJECTORY_SIZE)
+	{
+		return FALSE;
+	}
+	cursor = Frame_getU32(cursor, pRobot);
+	cursor = Frame_getU32(cursor, pFlags);
+	twist = (*pFlags & TRAJECTORY_TWIST)? FRAME_TWIST_SIZE : 0;
+	*pFlags &= ~TRAJECTORY_TWIST;
+	*pNb = (pFrame->length - FRAME_TRAJECTORY_SIZE) / (FRAME_SEGMENT_SIZE + twist);
+	for(int i = 0; i < *pNb; i++)
+	{
+		cursor = Frame_getU32(cursor, &pSegments[i].offset_ms);
+		cursor = Frame_getU32(cursor, &value);
+		pSegments[i].vector.dir = (Direction) value;
+		cursor = Frame_getU32(cursor, &value);
+		pSegments[i].vector.power = (int32_t) value;
+		pSegments[i].vector.angular = 0;
+		if(twist != 0)
+		{
+			cursor = Frame_getU32(cursor, &value);
+			pSegments[i].vector.angular = (int32_t) value;
+		}
+	}
+	return TRUE;
+}
+
+bool_e Frame_parse(const uint8_t* buffer, size_t size, Frame* pFrame)
+{
+	if(size < FRAME_HEADER_SIZE || Frame_parseHeader(buffer, pFrame) == FALSE
+			|| size < (size_t) FRAME_HEADER_SIZE + pFrame->length)
+	{
+		return FALSE;
+	}
+	pFrame->payload = buffer + FRAME_HEADER_SIZE;
+	return TRUE;
+}
+
+bool_e Frame_isNewer(uint32_t sequence, uint32_t last)
+{
+	//Serial number arithmetic, the sequence numbers may wrap around.
+	return ((int32_t) (sequence - last) > 0)? TRUE : FALSE;
+}
+
+size_t Frame_encodeTelemetry(uint8_t* buffer, uint32_t robot, const PilotState* pState)
+{
+	uint8_t* cursor = buffer + FRAME_HEADER_SIZE;
+	uint32_t luminosity;
+	uint32_t coordinate;
+	memcpy(&luminosity, &pState->luminosity, sizeof(luminosity));
+	cursor = Frame_putU32(cursor, (uint32_t) pState->speed);
+	cursor = Frame_putU32(cursor, (uint32_t) pState->collision);
+	cursor = Frame_putU32(cursor, luminosity);
+	cursor = Frame_putU32(cursor, robot);
+	if(Frame_hasPose(pState) == TRUE)
+	{
+		cursor = Frame_putU64(cursor, pState->sampled);
+		memcpy(&coordinate, &pState->x, sizeof(coordinate));
+		cursor = Frame_putU32(cursor, coordinate);
+		memcpy(&coordinate, &pState->y, sizeof(coordinate));
+		cursor = Frame_putU32(cursor, coordinate);
+		memcpy(&coordinate, &pState->heading, sizeof(coordinate));
+		cursor = Frame_putU32(cursor, coordinate);
+		return Frame_encode(buffer, FRAME_TELEMETRY, NULL, FRAME_TELEMETRY_POSE_SIZE);
+	}
+	if(pState->sampled != 0)
+	{
+		cursor = Frame_putU64(cursor, pState->sampled);
+		return Frame_encode(buffer, FRAME_TELEMETRY, NULL, FRAME_TELEMETRY_SAMPLED_SIZE);
+	}
+	return Frame_encode(buffer, FRAME_TELEMETRY, NULL, FRAME_TELEMETRY_SIZE);
+}
+
+bool_e Frame_decodeTelemetry(const Frame* pFrame, uint32_t* pRobot, PilotState* pState)
+{
+	const uint8_t* cursor = pFrame->payload;
+	uint32_t value;
+	if(pFrame->type != FRAME_TELEMETRY || pFrame->length < FRAME_TELEMETRY_SIZE - 4)
+	{
+		return FALSE;
+	}
+	cursor = Frame_getU32(cursor, &value);
+	pState->speed = (int32_t) value;
+	cursor = Frame_getU32(cursor, &value);
+	pState->collision = (int32_t) value;
+	cursor = Frame_getU32(cursor, &value);
+	memcpy(&pState->luminosity, &value, sizeof(value));
+	*pRobot = 0;
+	if(pFrame->length >= FRAME_TELEMETRY_SIZE)
+	{
+		cursor = Frame_getU32(cursor, pRobot);
+	}
+	pState->sampled = 0;
+	if(pFrame->length >= FRAME_TELEMETRY_SAMPLED_SIZE)
+	{
+		cursor = Frame_getU64(cursor, &pState->sampled);
+	}
+	pState->x = 0;
+	pState->y = 0;
+	pState->heading = 0;
+	if(pFrame->length >= FRAME_TELEMETRY_POSE_SIZE)
+	{
+		cursor = Frame_getU32(cursor, &value);
+		memcpy(&pState->x, &value, sizeof(value));
+		cursor = Frame_getU32(cursor, &value);
+		memcpy(&pState->y, &value, sizeof(value));
+		cursor = Frame_getU32(cursor, &value);
+		memcpy(&pState->heading, &value, sizeof(value));
+	}
+	return TRUE;
+}
+
+void Decoder_init(Decoder* pDecoder)
+{
+	pDecoder->start = 0;
+	pDecoder->end = 0;
+}
+
+int Decoder_getSpace(Decoder* pDecoder, struct iovec iov[2])
+{
+	size_t free = DECODER_CAPACITY - (pDecoder->end - pDecoder->start);
+	size_t position = pDecoder->end & (DECODER_CAPACITY - 1);
+	size_t untilWrap = DECODER_CAPACITY - position;
+	if(free == 0)
+	{
+		return 0;
+	}
+	iov[0].iov_base = pDecoder->buffer + position;
+	if(free <= untilWrap)
+	{
+		iov[0].iov_len = free;
+		return 1;
+	}
+	iov[0].iov_len = untilWrap;
+	iov[1].iov_base = pDecoder->buffer;
+	iov[1].iov_len = free - untilWrap;
+	return 2;
+}
+
+void Decoder_commit(Decoder* pDecoder, size_t size)
+{
+	pDecoder->end += size;
+}
+
+size_t Decoder_feed(Decoder* pDecoder, const void* data, size_t size)
+{
+	struct iovec iov[2];
+	size_t copied = 0;
+	int nb_iov = Decoder_getSpace(pDecoder, iov);
+	for(int i = 0; i < nb_iov && copied < size; i++)
+	{
+		size_t part = (size - copied < iov[i].iov_len)? size - copied : iov[i].iov_len;
+		memcpy(iov[i].iov_base, (const uint8_t*) data + copied, part);
+		copied += part;
+	}
+	Decoder_commit(pDecoder, copied);
+	return copied;
+}
+
+DecoderStatus Decoder_next(Decoder* pDecoder, Frame* pFrame)
+{
+	uint8_t header[FRAME_HEADER_SIZE];
+	size_t available = pDecoder->end - pDecoder->start;
+	size_t position = pDecoder->start & (DECODER_CAPACITY - 1);
+	size_t size;
+	if(available < FRAME_HEADER_SIZE)
+	{
+		return DECODER_NEED_MORE;
+	}
+	for(int i = 0; i < FRAME_HEADER_SIZE; i++)
+	{
+		header[i] = pDecoder->buffer[(position + i) & (DECODER_CAPACITY - 1)];
+	}
+	if(Frame_parseHeader(header, pFrame) == FALSE)
+	{
+		return DECODER_ERROR;
+	}
+	size = FRAME_HEADER_SIZE + pFrame->length;
+	if(available < size)
+	{
+		return DECODER_NEED_MORE;
+	}
+	if(position + size <= DECODER_CAPACITY)
+	{
+		pFrame->payload = pDecoder->buffer + position + FRAME_HEADER_SIZE;
+	}
+	else
+	{
+		//The frame wraps around the end of the ring, it is copied to stay contiguous.
+		size_t untilWrap = DECODER_CAPACITY - position;
+		memcpy(pDecoder->frame, pDecoder->buffer + position, untilWrap);
+		memcpy(pDecoder->frame + untilWrap, pDecoder->buffer, size - untilWrap);
+		pFrame->payload = pDecoder->frame + FRAME_HEADER_SIZE;
+	}
+	pDecoder->start += size;
+	return DECODER_FRAME;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static uint8_t* Frame_putU32(uint8_t* buffer, uint32_t value)
+{
+	buffer[0] = (uint8_t) (value >> 24);
+	buffer[1] = (uint8_t) (value >> 16);
+	buffer[2] = (uint8_t) (value >> 8);
+	buffer[3] = (uint8_t) value;
+	return buffer + 4;
+}
+
+static const uint8_t* Frame_getU32(const uint8_t* buffer, uint32_t* pValue)
+{
+	*pValue = ((uint32_t) buffer[0] << 24) | ((uint32_t) buffer[1] << 16) | ((uint32_t) buffer[2] << 8) | (uint32_t) buffer[3];
+	return buffer + 4;
+}
+
+static uint8_t* Frame_putU64(uint8_t* buffer, uint64_t value)
+{
+	buffer = Frame_putU32(buffer, (uint32_t) (value >> 32));
+	return Frame_putU32(buffer, (uint32_t) value);
+}
+
+static const uint8_t* Frame_getU64(const uint8_t* buffer, uint64_t* pValue)
+{
+	uint32_t high;
+	uint32_t low;
+	buffer = Frame_getU32(buffer, &high);
+	buffer = Frame_getU32(buffer, &low);
+	*pValue = ((uint64_t) high << 32) | low;
+	return buffer;
+}
+
+static uint8_t* Frame_putVarint(uint8_t* buffer, uint32_t value)
+{
+	while(value >= 0x80)
+	{
+		*buffer++ = (uint8_t) (value | 0x80);
+		value >>= 7;
+	}
+	*buffer++ = (uint8_t) value;
+	return buffer;
+}
+
+static const uint8_t* Frame_getVarint(const uint8_t* buffer, const uint8_t* end, uint32_t* pValue)
+{
+	uint32_t value = 0;
+	for(int shift = 0; shift < 35 && buffer < end; shift += 7)
+	{
+		uint8_t byte = *buffer++;
+		value |= (uint32_t) (byte & 0x7F) << shift;
+		if((byte & 0x80) == 0)
+		{
+			*pValue = value;
+			return buffer;
+		}
+	}
+	return NULL;
+}
+
+static uint32_t Frame_zigzag(int32_t value)
+{
+	return ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+}
+
+static int32_t Frame_unzigzag(uint32_t value)
+{
+	return (int32_t) ((value >> 1) ^ (~(value & 1) + 1));
+}
+
+static bool_e Frame_quantize(float difference, float step, int32_t* pSteps)
+{
+	float steps = difference / step;
+	if(!(steps > -1e9f && steps < 1e9f))
+	{
+		return FALSE;
+	}
+	*pSteps = (int32_t) (steps + ((steps >= 0)? 0.5f : -0.5f));
+	return TRUE;
+}
+
+static float Frame_wrapHeading(float heading)
+{
+	if(heading > FRAME_PI)
+	{
+		return heading - 2 * FRAME_PI;
+	}
+	if(heading <= -FRAME_PI)
+	{
+		return heading + 2 * FRAME_PI;
+	}
+	return heading;
+}
+
+static bool_e Frame_hasPose(const PilotState* pState)
+{
+	return (pState->x != 0 || pState->y != 0 || pState->heading != 0)? TRUE : FALSE;
+}
+
+static bool_e Frame_parseHeader(const uint8_t* header, Frame* pFrame)
+{
+	if(((header[0] << 8) | header[1]) != FRAME_MAGIC || header[2] != FRAME_VERSION)
+	{
+		return FALSE;
+	}
+	pFrame->version = header[2];
+	pFrame->type = header[3];
+	pFrame->length = (uint16_t) ((header[4] << 8) | header[5]);
+	return (pFrame->length <= FRAME_MAX_PAYLOAD)? TRUE : FALSE;
+}
@@ -0,0 +1,428 @@
+/**
+ * @file  frame.h
+ *
+ * @brief Framing of the messages exchanged between telco and commando.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+#ifndef SRC_COMMUN_FRAME_H_
+#define SRC_COMMUN_FRAME_H_
+/* ----------------------  INCLUDES ------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+#include "../commun.h"
+#include "prose.h"
+/* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/*
+ * A frame is a fixed header followed by its payload, every field is sent
+ * in network byte order:
+ *
+ *  | magic (16) | version (8) | type (8) | length (16) | payload (length) |
+ */
+#define FRAME_MAGIC (0x5253)
+#define FRAME_VERSION (1)
+#define FRAME_HEADER_SIZE (6)
+#define FRAME_MAX_PAYLOAD (256)
+#define FRAME_MAX_SIZE (FRAME_HEADER_SIZE + FRAME_MAX_PAYLOAD)
+/**
+ * \brief Size of the payload of a FRAME_DONNEES (8 fields of 32 bits).
+ *
+ * Every payload ends with the id of the robot and the id of the request on 32 bits. A payload
+ * without the request (4 bytes shorter) has the request 0, without both (8 bytes shorter)
+ * it addresses the robot 0 too.
+ */
+#define FRAME_DONNEES_SIZE (32)
+/**
+ * \brief Size of the payload of a traced FRAME_DONNEES : FRAME_DONNEES_SIZE then the captured
+ *        and sent timestamps of the DesDonnees on 64 bits (see trace.h).
+ */
+#define FRAME_DONNEES_TRACED_SIZE (FRAME_DONNEES_SIZE + 16)
+/**
+ * \brief Size of the payload of an answer carrying the time of its sample : FRAME_DONNEES_TRACED_SIZE
+ *        then the sampled timestamp on 64 bits.
+ */
+#define FRAME_DONNEES_SAMPLED_SIZE (FRAME_DONNEES_TRACED_SIZE + 8)
+/**
+ * \brief Size of the angular velocity of a TWIST (32 bits) : after the request in a FRAME_DONNEES, before
+ *        its timestamps, after the robot in a FRAME_VELOCITY and at the end of a twist segment.
+ */
+#define FRAME_TWIST_SIZE (4)
+/**
+ * \brief Size of the payload of a FRAME_SUBSCRIBE (period in ms, UDP port, robot, FrameSubscribeFlag on 32 bits).
+ */
+#define FRAME_SUBSCRIBE_SIZE (16)
+/**
+ * \brief Size of the payload of a FRAME_TELEMETRY (speed, collision, luminosity, robot on 32 bits).
+ */
+#define FRAME_TELEMETRY_SIZE (16)
+/**
+ * \brief Size of the payload of a FRAME_TELEMETRY followed by the time of its sample on 64 bits.
+ */
+#define FRAME_TELEMETRY_SAMPLED_SIZE (FRAME_TELEMETRY_SIZE + 8)
+/**
+ * \brief Size of the payload of a FRAME_TELEMETRY followed by the time of its sample (0 if unknown)
+ *        and the pose x, y, heading of the robot as floats.
+ */
+#define FRAME_TELEMETRY_POSE_SIZE (FRAME_TELEMETRY_SAMPLED_SIZE + 12)
+/**
+ * \brief Size of the payload of a FRAME_VELOCITY (sequence, direction, power, robot on 32 bits), a TWIST is
+ *        followed by its angular velocity.
+ */
+#define FRAME_VELOCITY_SIZE (16)
+/**
+ * \brief Size of the payload of a FRAME_HEARTBEAT (robot on 32 bits).
+ */
+#define FRAME_HEARTBEAT_SIZE (4)
+/**
+ * \brief Size of the payload of a FRAME_PING (originate, receive and transmit timestamps on 64 bits).
+ */
+#define FRAME_PING_SIZE (24)
+/**
+ * \brief Size of the head of the payload of a FRAME_TRAJECTORY (robot and TrajectoryFlag on 32 bits).
+ */
+#define FRAME_TRAJECTORY_SIZE (8)
+/**
+ * \brief Size of a TrajectorySegment in a FRAME_TRAJECTORY (offset, direction and power on 32 bits).
+ */
+#define FRAME_SEGMENT_SIZE (12)
+/**
+ * \brief Segments carried by one FRAME_TRAJECTORY, a longer trajectory is streamed in several frames.
+ */
+#define FRAME_TRAJECTORY_MAX_SEGMENTS ((FRAME_MAX_PAYLOAD - FRAME_TRAJECTORY_SIZE) / FRAME_SEGMENT_SIZE)
+/**
+ * \brief Segments carried by one FRAME_TRAJECTORY with TRAJECTORY_TWIST, each one followed by its angular velocity.
+ */
+#define FRAME_TRAJECTORY_MAX_TWISTS ((FRAME_MAX_PAYLOAD - FRAME_TRAJECTORY_SIZE) / (FRAME_SEGMENT_SIZE + FRAME_TWIST_SIZE))
+/**
+ * \brief Samples of a delta telemetry stream between two keyframes, which carry the exact values.
+ */
+#define FRAME_KEYFRAME_PERIOD (32)
+/**
+ * \brief Quantization of the luminosity in the delta telemetry, smaller changes are not sent.
+ */
+#define FRAME_LUMINOSITY_STEP (0.001f)
+/**
+ * \brief Quantization of the position (mm) and of the heading (rad) in the delta telemetry.
+ */
+#define FRAME_POSITION_STEP (0.5f)
+#define FRAME_HEADING_STEP (0.001f)
+/**
+ * \brief Size of the reception ring of a Decoder (power of 2), holds several frames.
+ */
+#define DECODER_CAPACITY (2048)
+/* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
+/**
+ * \enum FrameType
+ * \brief Type of the payload carried by a frame.
+ */
+typedef enum
+{
+	FRAME_DONNEES = 1, /**< a DesDonnees */
+	FRAME_SUBSCRIBE,   /**< telco -> commando : push the telemetry every period ms (0 to unsubscribe), to a UDP port if not 0 */
+	FRAME_TELEMETRY,   /**< commando -> telco : a PilotState pushed to a subscriber */
+	FRAME_VELOCITY,    /**< telco -> commando, datagram : a sequenced VelocityVector, the latest wins */
+	FRAME_TELEMETRY_DGRAM, /**< commando -> telco, datagram : a sequenced PilotState, the latest wins */
+	FRAME_HEARTBEAT,   /**< telco -> commando : the telco is alive, the watchdog of the robot is fed */
+	FRAME_TELEMETRY_DELTA, /**< commando -> telco : the fields of a PilotState which changed, see TelemetryCodec */
+	FRAME_PING,        /**< telco -> commando -> telco : the timestamps of a round trip, to estimate the offset of the clocks */
+	FRAME_TRAJECTORY,  /**< telco -> commando : timed segments executed by the pilot on its own clock, or a cancel */
+	NB_FRAME_TYPES
+}FrameType;
+/**
+ * \enum FrameSubscribeFlag
+ * \brief Options of a FRAME_SUBSCRIBE.
+ */
+typedef enum
+{
+	FRAME_SUBSCRIBE_DELTA = 0x01 /**< push the telemetry as FRAME_TELEMETRY_DELTA (TCP only) */
+}FrameSubscribeFlag;
+/**
+ * \enum FrameDeltaField
+ * \brief Bits of the first byte of a FRAME_TELEMETRY_DELTA, the fields present follow in this order.
+ */
+typedef enum
+{
+	FRAME_DELTA_KEYFRAME = 0x01,   /**< every field follows with its exact value, the luminosity as a float */
+	FRAME_DELTA_ROBOT = 0x02,      /**< varint, the robot is 0 when absent */
+	FRAME_DELTA_SPEED = 0x04,      /**< zigzag varint, difference with the previous speed */
+	FRAME_DELTA_COLLISION = 0x08,  /**< zigzag varint, the new collision state */
+	FRAME_DELTA_LUMINOSITY = 0x10, /**< zigzag varint, difference with the previous luminosity in FRAME_LUMINOSITY_STEP */
+	FRAME_DELTA_SAMPLED = 0x20,    /**< time of the sample : 64 bits in a keyframe, else varint of the us since the previous one */
+	FRAME_DELTA_POSE = 0x40        /**< x, y, heading : floats in a keyframe, else zigzag varints of their differences in
+	                                    FRAME_POSITION_STEP and FRAME_HEADING_STEP */
+}FrameDeltaField;
+/**
+ * \enum DecoderStatus
+ * \brief Result of Decoder_next.
+ */
+typedef enum
+{
+	DECODER_NEED_MORE = 0, /**< no complete frame yet, feed more bytes */
+	DECODER_FRAME,         /**< a frame has been decoded */
+	DECODER_ERROR          /**< the stream is corrupted, the connection must be dropped */
+}DecoderStatus;
+/* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
+/**
+ * \struct Frame
+ * \brief A decoded frame, the payload points into the Decoder buffer.
+ */
+typedef struct
+{
+	uint8_t version;
+	uint8_t type;
+	uint16_t length;
+	const uint8_t* payload;
+}Frame;
+/**
+ * \struct TelemetryCodec
+ * \brief State shared by the two ends of a delta telemetry stream, each one has its own copy.
+ *
+ * The reference is the PilotState as the telco decodes it, so the quantization errors
+ * of the luminosity do not add up.
+ */
+typedef struct
+{
+	PilotState reference;
+	unsigned int nb_deltas; //samples since the last keyframe.
+	bool_e synchronized; //FALSE until a keyframe, the deltas are useless before.
+}TelemetryCodec;
+/**
+ * \struct Decoder
+ * \brief Reassembles the frames of a byte stream in a ring, without any allocation.
+ *
+ * start and end only grow, the position in the ring is taken modulo DECODER_CAPACITY.
+ */
+typedef struct
+{
+	uint8_t buffer[DECODER_CAPACITY];
+	uint8_t frame[FRAME_MAX_SIZE]; //copy of a frame wrapping around the end of the ring.
+	size_t start; //first byte not decoded yet.
+	size_t end; //first free byte.
+}Decoder;
+/* ----------------------  PUBLIC VARIBLES -----------------------------------*/
+/* ----------------------  PUBLIC FUNCTIONS PROTOTYPES  ----------------------*/
+/**
+ * \fn extern size_t Frame_encode(uint8_t* buffer, FrameType type, const uint8_t* payload, uint16_t length)
+ * \brief Write a header and its payload into buffer (at least FRAME_HEADER_SIZE + length bytes).
+ *
+ * \return size_t : number of bytes written.
+ */
+extern size_t Frame_encode(uint8_t* buffer, FrameType type, const uint8_t* payload, uint16_t length);
+/**
+ * \fn extern size_t Frame_encodeDonnees(uint8_t* buffer, const DesDonnees* pDonnees)
+ * \brief Write a complete FRAME_DONNEES into buffer (at least FRAME_MAX_SIZE bytes).
+ *
+ * \return size_t : number of bytes written.
+ */
+extern size_t Frame_encodeDonnees(uint8_t* buffer, const DesDonnees* pDonnees);
+/**
+ * \fn extern bool_e Frame_decodeDonnees(const Frame* pFrame, DesDonnees* pDonnees)
+ * \brief Read the DesDonnees carried by a FRAME_DONNEES.
+ *
+ * \return bool_e : FALSE if the frame is not a valid FRAME_DONNEES.
+ */
+extern bool_e Frame_decodeDonnees(const Frame* pFrame, DesDonnees* pDonnees);
+/**
+ * \fn extern size_t Frame_encodeSubscribe(uint8_t* buffer, uint32_t robot, uint32_t period_ms, uint16_t port, uint32_t flags)
+ * \brief Write a complete FRAME_SUBSCRIBE into buffer (at least FRAME_MAX_SIZE bytes).
+ *
+ * \param uint32_t flags : FrameSubscribeFlag, ignored by the commandos which do not know them.
+ *
+ * \param uint16_t port : UDP port of the telco the telemetry is pushed to, 0 to push it on the TCP connection.
+ * \return size_t : number of bytes written.
+ */
+extern size_t Frame_encodeSubscribe(uint8_t* buffer, uint32_t robot, uint32_t period_ms, uint16_t port, uint32_t flags);
+/**
+ * \fn extern bool_e Frame_decodeSubscribe(const Frame* pFrame, uint32_t* pRobot, uint32_t* pPeriod_ms, uint16_t* pPort, uint32_t* pFlags)
+ * \brief Read the robot, the period, the UDP port and the FrameSubscribeFlag carried by a FRAME_SUBSCRIBE.
+ *
+ * \return bool_e : FALSE if the frame is not a valid FRAME_SUBSCRIBE.
+ */
+extern bool_e Frame_decodeSubscribe(const Frame* pFrame, uint32_t* pRobot, uint32_t* pPeriod_ms, uint16_t* pPort, uint32_t* pFlags);
+/**
+ * \fn extern size_t Frame_encodeVelocity(uint8_t* buffer, uint32_t sequence, uint32_t robot, const VelocityVector* pVector)
+ * \brief Write a complete FRAME_VELOCITY into buffer (at least FRAME_MAX_SIZE bytes).
+ *
+ * \return size_t : number of bytes written.
+ */
+extern size_t Frame_encodeVelocity(uint8_t* buffer, uint32_t sequence, uint32_t robot, const VelocityVector* pVector);
+/**
+ * \fn extern bool_e Frame_decodeVelocity(const Frame* pFrame, uint32_t* pSequence, uint32_t* pRobot, VelocityVector* pVector)
+ * \brief Read the sequence number, the robot and the VelocityVector carried by a FRAME_VELOCITY.
+ *
+ * \return bool_e : FALSE if the frame is not a valid FRAME_VELOCITY.
+ */
+extern bool_e Frame_decodeVelocity(const Frame* pFrame, uint32_t* pSequence, uint32_t* pRobot, VelocityVector* pVector);
+/**
+ * \fn extern size_t Frame_encodeTelemetry(uint8_t* buffer, uint32_t robot, const PilotState* pState)
+ * \brief Write a complete FRAME_TELEMETRY into buffer (at least FRAME_MAX_SIZE bytes).
+ *
+ * \return size_t : number of bytes written.
+ */
+extern size_t Frame_encodeTelemetry(uint8_t* buffer, uint32_t robot, const PilotState* pState);
+/**
+ * \fn extern bool_e Frame_decodeTelemetry(const Frame* pFrame, uint32_t* pRobot, PilotState* pState)
+ * \brief Read the robot and the PilotState carried by a FRAME_TELEMETRY.
+ *
+ * \return bool_e : FALSE if the frame is not a valid FRAME_TELEMETRY.
+ */
+extern bool_e Frame_decodeTelemetry(const Frame* pFrame, uint32_t* pRobot, PilotState* pState);
+/**
+ * \fn extern size_t Frame_encodeTelemetryDatagram(uint8_t* buffer, uint32_t sequence, uint32_t robot, const PilotState* pState)
+ * \brief Write a complete FRAME_TELEMETRY_DGRAM into buffer (at least FRAME_MAX_SIZE bytes).
+ *
+ * \return size_t : number of bytes written.
+ */
+extern size_t Frame_encodeTelemetryDatagram(uint8_t* buffer, uint32_t sequence, uint32_t robot, const PilotState* pState);
+/**
+ * \fn extern bool_e Frame_decodeTelemetryDatagram(const Frame* pFrame, uint32_t* pSequence, uint32_t* pRobot, PilotState* pState)
+ * \brief Read the sequence number, the robot and the PilotState carried by a FRAME_TELEMETRY_DGRAM.
+ *
+ * \return bool_e : FALSE if the frame is not a valid FRAME_TELEMETRY_DGRAM.
+ */
+extern bool_e Frame_decodeTelemetryDatagram(const Frame* pFrame, uint32_t* pSequence, uint32_t* pRobot, PilotState* pState);
+/**
+ * \fn extern void Frame_initTelemetryCodec(TelemetryCodec* pCodec)
+ * \brief Start a delta telemetry stream again, the next sample is a keyframe.
+ */
+extern void Frame_initTelemetryCodec(TelemetryCodec* pCodec);
+/**
+ * \fn extern size_t Frame_encodeTelemetryDelta(uint8_t* buffer, uint32_t robot, const PilotState* pState, TelemetryCodec* pCodec)
+ * \brief Write a complete FRAME_TELEMETRY_DELTA into buffer (at least FRAME_MAX_SIZE bytes).
+ *        If the frame is not delivered, Frame_initTelemetryCodec must be called.
+ *
+ * \return size_t : size of the frame.
+ */
+extern size_t Frame_encodeTelemetryDelta(uint8_t* buffer, uint32_t robot, const PilotState* pState, TelemetryCodec* pCodec);
+/**
+ * \fn extern bool_e Frame_decodeTelemetryDelta(const Frame* pFrame, uint32_t* pRobot, PilotState* pState, TelemetryCodec* pCodec)
+ * \brief Read the robot and rebuild the PilotState of a FRAME_TELEMETRY_DELTA.
+ *
+ * \return bool_e : FALSE if the frame is not a valid FRAME_TELEMETRY_DELTA or no keyframe has been received yet.
+ */
+extern bool_e Frame_decodeTelemetryDelta(const Frame* pFrame, uint32_t* pRobot, PilotState* pState, TelemetryCodec* pCodec);
+/**
+ * \fn extern size_t Frame_encodeHeartbeat(uint8_t* buffer, uint32_t robot)
+ * \brief Write a complete FRAME_HEARTBEAT into buffer (at least FRAME_MAX_SIZE bytes).
+ *
+ * \return size_t : size of the frame.
+ */
+extern size_t Frame_encodeHeartbeat(uint8_t* buffer, uint32_t robot);
+/**
+ * \fn extern bool_e Frame_decodeHeartbeat(const Frame* pFrame, uint32_t* pRobot)
+ * \brief Read the robot carried by a FRAME_HEARTBEAT.
+ *
+ * \return bool_e : FALSE if the frame is not a valid FRAME_HEARTBEAT.
+ */
+extern bool_e Frame_decodeHeartbeat(const Frame* pFrame, uint32_t* pRobot);
+/**
+ * \fn extern size_t Frame_encodePing(uint8_t* buffer, uint64_t originate, uint64_t receive, uint64_t transmit)
+ * \brief Write a complete FRAME_PING into buffer (at least FRAME_MAX_SIZE bytes).
+ *
+ * \param uint64_t originate : time the telco sent the ping, in its clock.
+ * \param uint64_t receive : time the commando received it, in its clock (0 in the ping of the telco).
+ * \param uint64_t transmit : time the commando sent it back, in its clock (0 in the ping of the telco).
+ * \return size_t : number of bytes written.
+ */
+extern size_t Frame_encodePing(uint8_t* buffer, uint64_t originate, uint64_t receive, uint64_t transmit);
+/**
+ * \fn extern bool_e Frame_decodePing(const Frame* pFrame, uint64_t* pOriginate, uint64_t* pReceive, uint64_t* pTransmit)
+ * \brief Read the timestamps carried by a FRAME_PING.
+ *
+ * \return bool_e : FALSE if the frame is not a valid FRAME_PING.
+ */
+extern bool_e Frame_decodePing(const Frame* pFrame, uint64_t* pOriginate, uint64_t* pReceive, uint64_t* pTransmit);
+/**
+ * \fn extern size_t Frame_encodeTrajectory(uint8_t* buffer, uint32_t robot, uint32_t flags, const TrajectorySegment* pSegments, int nb_segments)
+ * \brief Write a complete FRAME_TRAJECTORY into buffer (at least FRAME_MAX_SIZE bytes).
+ *
+ * \param uint32_t flags : TrajectoryFlag, TRAJECTORY_TWIST is set when a segment is a TWIST.
+ * \param int nb_segments : at most Frame_fitTrajectory of them, the next ones are not written.
+ * \return size_t : number of bytes written.
+ */
+extern size_t Frame_encodeTrajectory(uint8_t* buffer, uint32_t robot, uint32_t flags, const TrajectorySegment* pSegments, int nb_segments);
+/**
+ * \fn extern int Frame_fitTrajectory(const TrajectorySegment* pSegments, int nb_segments)
+ * \brief Number of the first segments which fit in one FRAME_TRAJECTORY, fewer when one of them is a TWIST.
+ */
+extern int Frame_fitTrajectory(const TrajectorySegment* pSegments, int nb_segments);
+/**
+ * \fn extern bool_e Frame_decodeTrajectory(const Frame* pFrame, uint32_t* pRobot, uint32_t* pFlags, TrajectorySegment* pSegments, int* pNb)
+ * \brief Read the segments carried by a FRAME_TRAJECTORY.
+ *
+ * \param TrajectorySegment* pSegments : room for FRAME_TRAJECTORY_MAX_SEGMENTS segments.
+ * \return bool_e : FALSE if the frame is not a valid FRAME_TRAJECTORY.
+ */
+extern bool_e Frame_decodeTrajectory(const Frame* pFrame, uint32_t* pRobot, uint32_t* pFlags, TrajectorySegment* pSegments, int* pNb);
+/**
+ * \fn extern bool_e Frame_parse(const uint8_t* buffer, size_t size, Frame* pFrame)
+ * \brief Read the frame held by a datagram.
+ *
+ * \return bool_e : FALSE if the datagram is not a valid frame.
+ */
+extern bool_e Frame_parse(const uint8_t* buffer, size_t size, Frame* pFrame);
+/**
+ * \fn extern bool_e Frame_isNewer(uint32_t sequence, uint32_t last)
+ * \brief Compare two sequence numbers, taking the wrap around into account.
+ *
+ * \return bool_e : TRUE if sequence comes after last.
+ */
+extern bool_e Frame_isNewer(uint32_t sequence, uint32_t last);
+/**
+ * \fn extern void Decoder_init(Decoder* pDecoder)
+ * \brief Empty the decoder.
+ */
+extern void Decoder_init(Decoder* pDecoder);
+/**
+ * \fn extern int Decoder_getSpace(Decoder* pDecoder, struct iovec iov[2])
+ * \brief Describe the free part of the ring, so that a single readv can fill it entirely.
+ *
+ * \return int : number of iovec used (0 when the ring is full).
+ */
+extern int Decoder_getSpace(Decoder* pDecoder, struct iovec iov[2]);
+/**
+ * \fn extern void Decoder_commit(Decoder* pDecoder, size_t size)
+ * \brief Account for size bytes written in the space given by Decoder_getSpace.
+ */
+extern void Decoder_commit(Decoder* pDecoder, size_t size);
+/**
+ * \fn extern size_t Decoder_feed(Decoder* pDecoder, const void* data, size_t size)
+ * \brief Copy bytes received into the decoder.
+ *
+ * \return size_t : number of bytes accepted (less than size when the buffer is full).
+ */
+extern size_t Decoder_feed(Decoder* pDecoder, const void* data, size_t size);
+/**
+ * \fn extern DecoderStatus Decoder_next(Decoder* pDecoder, Frame* pFrame)
+ * \brief Extract the next complete frame. The payload stays valid until the next call on the decoder.
+ */
+extern DecoderStatus Decoder_next(Decoder* pDecoder, Frame* pFrame);
+
+#endif /* SRC_COMMUN_FRAME_H_ */
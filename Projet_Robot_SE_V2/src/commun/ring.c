@@ -0,0 +1,190 @@
+/**
+ * @file  ring.c
+ *
+ * @brief Lock-free ring between one producer thread and one consumer thread.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static size_t Ring_roundCapacity(size_t capacity)
+ * \brief Round a capacity up to a power of 2, so that the index is a mask.
+ */
+static size_t Ring_roundCapacity(size_t capacity);
+/**
+ * \fn static Ring* Ring_allocate(size_t size)
+ * \brief Allocate a handle aligned on a cache line, followed by size bytes.
+ */
+static Ring* Ring_allocate(size_t size);
+/**
+ * \fn static void Ring_setUp(Ring* pRing, void* memory, size_t capacity, size_t element_size)
+ * \brief Point a handle to the memory of a ring, from which only the current indexes are read.
+ */
+static void Ring_setUp(Ring* pRing, void* memory, size_t capacity, size_t element_size);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+size_t Ring_getSize(size_t capacity, size_t element_size)
+{
+	return sizeof(RingIndexes) + Ring_roundCapacity(capacity) * element_size;
+}
+
+Ring* Ring_init(void* memory, size_t capacity, size_t element_size)
+{
+	memset(memory, 0, sizeof(RingIndexes));
+	return Ring_attach(memory, capacity, element_size);
+}
+
+Ring* Ring_attach(void* memory, size_t capacity, size_t element_size)
+{
+	Ring* pRing = Ring_allocate(0);
+	Ring_setUp(pRing, memory, capacity, element_size);
+	return pRing;
+}
+
+Ring* Ring_new(size_t capacity, size_t element_size)
+{
+	//The memory of the ring follows its handle, they are freed together.
+	Ring* pRing = Ring_allocate(Ring_getSize(capacity, element_size));
+	memset(pRing + 1, 0, sizeof(RingIndexes));
+	Ring_setUp(pRing, pRing + 1, capacity, element_size);
+	return pRing;
+}
+
+void Ring_free(Ring* pRing)
+{
+	free(pRing);
+}
+
+bool_e Ring_push(Ring* pRing, const void* element)
+{
+	size_t head = pRing->head;
+	if(pRing->corrupted == TRUE)
+	{
+		return FALSE;
+	}
+	if(head - pRing->cached_tail == pRing->capacity)
+	{
+		//Only read the index of the consumer when the ring looks full.
+		pRing->cached_tail = __atomic_load_n(&pRing->indexes->tail, __ATOMIC_ACQUIRE);
+		if(head - pRing->cached_tail > pRing->capacity)
+		{
+			pRing->corrupted = TRUE;
+			return FALSE;
+		}
+		if(head - pRing->cached_tail == pRing->capacity)
+		{
+			return FALSE;
+		}
+	}
+	memcpy(pRing->elements + (head & (pRing->capacity - 1)) * pRing->element_size, element, pRing->element_size);
+	pRing->head = head + 1;
+	__atomic_store_n(&pRing->indexes->head, head + 1, __ATOMIC_RELEASE);
+	return TRUE;
+}
+
+bool_e Ring_pop(Ring* pRing, void* element)
+{
+	size_t tail = pRing->tail;
+	if(pRing->corrupted == TRUE)
+	{
+		return FALSE;
+	}
+	if(tail == pRing->cached_head)
+	{
+		//Only read the index of the producer when the ring looks empty.
+		pRing->cached_head = __atomic_load_n(&pRing->indexes->head, __ATOMIC_ACQUIRE);
+		if(pRing->cached_head - tail > pRing->capacity)
+		{
+			pRing->corrupted = TRUE;
+			return FALSE;
+		}
+		if(tail == pRing->cached_head)
+		{
+			return FALSE;
+		}
+	}
+	memcpy(element, pRing->elements + (tail & (pRing->capacity - 1)) * pRing->element_size, pRing->element_size);
+	pRing->tail = tail + 1;
+	__atomic_store_n(&pRing->indexes->tail, tail + 1, __ATOMIC_RELEASE);
+	return TRUE;
+}
+
+bool_e Ring_isEmpty(Ring* pRing)
+{
+	return (pRing->tail == __atomic_load_n(&pRing->indexes->head, __ATOMIC_ACQUIRE))? TRUE : FALSE;
+}
+
+bool_e Ring_isCorrupted(Ring* pRing)
+{
+	return pRing->corrupted;
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static size_t Ring_roundCapacity(size_t capacity)
+{
+	size_t rounded = 1;
+	while(rounded < capacity)
+	{
+		rounded <<= 1;
+	}
+	return rounded;
+}
+
+static Ring* Ring_allocate(size_t size)
+{
+	void* memory = NULL;
+	//Aligned, so that the indexes of the producer and of the consumer stay on their own cache lines.
+	if(posix_memalign(&memory, RING_CACHE_LINE, sizeof(Ring) + size) != 0)
+	{
+		printf("ERROR : pRing is NULL \n");
+		while(1);
+	}
+	return (Ring*) memory;
+}
+
+static void Ring_setUp(Ring* pRing, void* memory, size_t capacity, size_t element_size)
+{
+	pRing->indexes = (RingIndexes*) memory;
+	pRing->elements = (uint8_t*) memory + sizeof(RingIndexes);
+	pRing->capacity = Ring_roundCapacity(capacity);
+	pRing->element_size = element_size;
+	pRing->head = __atomic_load_n(&pRing->indexes->head, __ATOMIC_ACQUIRE);
+	pRing->cached_tail = __atomic_load_n(&pRing->indexes->tail, __ATOMIC_ACQUIRE);
+	pRing->tail = pRing->cached_tail;
+	pRing->cached_head = pRing->head;
+	pRing->corrupted = (pRing->head - pRing->tail > pRing->capacity)? TRUE : FALSE;
+}
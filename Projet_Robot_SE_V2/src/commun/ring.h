@@ -0,0 +1,134 @@
+/**
+ * @file  ring.h
+ *
+ * @brief Lock-free ring between one producer thread and one consumer thread.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+#ifndef SRC_COMMUN_RING_H_
+#define SRC_COMMUN_RING_H_
+/* ----------------------  INCLUDES ------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include "prose.h"
+/* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/**
+ * \brief Size of a cache line, the indexes of the producer and the consumer are kept on different ones.
+ */
+#define RING_CACHE_LINE (64)
+/**
+ * \struct Ring
+ * \brief Single-producer / single-consumer ring of fixed size elements.
+ *
+ * Neither side ever blocks: Ring_push fails when the ring is full and
+ * Ring_pop fails when it is empty. The indexes and the elements can be placed
+ * in any memory (see Ring_getSize), the ring itself is a private handle on it:
+ * its capacity, its element size and the index each side writes are never read
+ * back from that memory, which may be shared with an untrusted process.
+ */
+typedef struct Ring_t Ring;
+/* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
+/* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
+/**
+ * \struct RingIndexes
+ * \brief Indexes published in the memory of a ring, the elements follow them.
+ */
+typedef struct
+{
+	size_t head __attribute__((aligned(RING_CACHE_LINE))); //next slot to write, published by the producer.
+	size_t tail __attribute__((aligned(RING_CACHE_LINE))); //next slot to read, published by the consumer.
+}RingIndexes;
+
+struct Ring_t
+{
+	RingIndexes* indexes;
+	uint8_t* elements;
+	size_t capacity; //number of elements, power of 2.
+	size_t element_size;
+	size_t head __attribute__((aligned(RING_CACHE_LINE))); //producer side.
+	size_t cached_tail; //copy of tail known by the producer.
+	size_t tail __attribute__((aligned(RING_CACHE_LINE))); //consumer side.
+	size_t cached_head; //copy of head known by the consumer.
+	bool_e corrupted; //the other side published an index out of the ring, nothing is exchanged anymore.
+};
+/* ----------------------  PUBLIC VARIBLES -----------------------------------*/
+/* ----------------------  PUBLIC FUNCTIONS PROTOTYPES  ----------------------*/
+/**
+ * \fn extern size_t Ring_getSize(size_t capacity, size_t element_size)
+ * \brief Memory needed by the indexes and the elements of a ring.
+ *
+ * \param size_t capacity : number of elements, rounded up to a power of 2.
+ */
+extern size_t Ring_getSize(size_t capacity, size_t element_size);
+/**
+ * \fn extern Ring* Ring_init(void* memory, size_t capacity, size_t element_size)
+ * \brief Build an empty ring in memory (at least Ring_getSize bytes) and return a handle on it.
+ */
+extern Ring* Ring_init(void* memory, size_t capacity, size_t element_size);
+/**
+ * \fn extern Ring* Ring_attach(void* memory, size_t capacity, size_t element_size)
+ * \brief Return a handle on a ring built by Ring_init, by another process, with the same capacity and element size.
+ */
+extern Ring* Ring_attach(void* memory, size_t capacity, size_t element_size);
+/**
+ * \fn extern Ring* Ring_new(size_t capacity, size_t element_size)
+ * \brief Initialize in memory an empty ring.
+ */
+extern Ring* Ring_new(size_t capacity, size_t element_size);
+/**
+ * \fn extern void Ring_free(Ring* pRing)
+ * \brief Destruct a ring, the memory given to Ring_init or Ring_attach is left to its owner.
+ */
+extern void Ring_free(Ring* pRing);
+/**
+ * \fn extern bool_e Ring_push(Ring* pRing, const void* element)
+ * \brief Copy an element into the ring, producer side.
+ *
+ * \return bool_e : FALSE if the ring is full or corrupted.
+ */
+extern bool_e Ring_push(Ring* pRing, const void* element);
+/**
+ * \fn extern bool_e Ring_pop(Ring* pRing, void* element)
+ * \brief Copy the oldest element out of the ring, consumer side.
+ *
+ * \return bool_e : FALSE if the ring is empty or corrupted.
+ */
+extern bool_e Ring_pop(Ring* pRing, void* element);
+/**
+ * \fn extern bool_e Ring_isEmpty(Ring* pRing)
+ * \brief Check if there is nothing to read, consumer side.
+ */
+extern bool_e Ring_isEmpty(Ring* pRing);
+/**
+ * \fn extern bool_e Ring_isCorrupted(Ring* pRing)
+ * \brief Check if the other side has published an index out of the ring.
+ */
+extern bool_e Ring_isCorrupted(Ring* pRing);
+
+#endif /* SRC_COMMUN_RING_H_ */
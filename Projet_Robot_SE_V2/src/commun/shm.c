@@ -0,0 +1,290 @@
+/**
+ * @file  shm.c
+ *
+ * @brief Shared memory transport between a telco and a commando of the same host.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "shm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+#define SHM_MAGIC (0x52534D31)
+#define SHM_NB_FDS (3)
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/**
+ * \struct ShmHeader
+ * \brief Start of the region, where the rings are.
+ */
+typedef struct
+{
+	uint32_t magic;
+	uint32_t message_size;
+	uint64_t commands_offset;
+	uint64_t replies_offset;
+}ShmHeader;
+/* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static size_t Shm_align(size_t size)
+ * \brief Round up to a cache line, so that the rings do not share one.
+ */
+static size_t Shm_align(size_t size);
+/**
+ * \fn static Shm* Shm_map(int memory_fd, int to_commando, int to_telco, bool_e create)
+ * \brief Map the region, and build the rings in it when create is TRUE.
+ *
+ * \return Shm* : NULL if the region can not be mapped or is not a valid one.
+ */
+static Shm* Shm_map(int memory_fd, int to_commando, int to_telco, bool_e create);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+socklen_t Shm_getAddress(struct sockaddr_un* pAddress)
+{
+	memset(pAddress, 0, sizeof(*pAddress));
+	pAddress->sun_family = AF_UNIX;
+	//Abstract name (leading 0): nothing to remove from the file system when the commando stops.
+	memcpy(pAddress->sun_path + 1, SHM_SOCKET_NAME, strlen(SHM_SOCKET_NAME));
+	return (socklen_t) (offsetof(struct sockaddr_un, sun_path) + 1 + strlen(SHM_SOCKET_NAME));
+}
+
+Shm* Shm_new()
+{
+	Shm* pShm = NULL;
+	size_t ring_size = Shm_align(Ring_getSize(SHM_RING_CAPACITY, sizeof(ShmMessage)));
+	size_t size = Shm_align(sizeof(ShmHeader)) + 2 * ring_size;
+	int memory_fd = memfd_create("robot_se", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	//Non-blocking for both ends (the flags are shared), they are polled and never waited on.
+	int to_commando = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	int to_telco = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if(memory_fd != -1 && to_commando != -1 && to_telco != -1 && ftruncate(memory_fd, size) == 0)
+	{
+		//The telco can neither shrink the region under the commando nor change the seals.
+		fcntl(memory_fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+		pShm = Shm_map(memory_fd, to_commando, to_telco, TRUE);
+	}
+	if(pShm == NULL)
+	{
+		perror("ERROR : shared memory");
+		if(memory_fd != -1)
+		{
+			close(memory_fd);
+		}
+		if(to_commando != -1)
+		{
+			close(to_commando);
+		}
+		if(to_telco != -1)
+		{
+			close(to_telco);
+		}
+	}
+	return pShm;
+}
+
+bool_e Shm_send(Shm* pShm, int un_socket)
+{
+	int fds[SHM_NB_FDS] = {pShm->memory_fd, pShm->to_commando, pShm->to_telco};
+	union
+	{
+		char buffer[CMSG_SPACE(sizeof(fds))];
+		struct cmsghdr align;
+	}control;
+	uint8_t magic = (uint8_t) SHM_MAGIC;
+	struct iovec iov = {&magic, sizeof(magic)};
+	struct msghdr message;
+	struct cmsghdr* pControl;
+	memset(&message, 0, sizeof(message));
+	memset(&control, 0, sizeof(control));
+	message.msg_iov = &iov;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+	pControl = CMSG_FIRSTHDR(&message);
+	pControl->cmsg_level = SOL_SOCKET;
+	pControl->cmsg_type = SCM_RIGHTS;
+	pControl->cmsg_len = CMSG_LEN(sizeof(fds));
+	memcpy(CMSG_DATA(pControl), fds, sizeof(fds));
+	return (sendmsg(un_socket, &message, MSG_NOSIGNAL) == (ssize_t) sizeof(magic))? TRUE : FALSE;
+}
+
+Shm* Shm_receive(int un_socket)
+{
+	int fds[SHM_NB_FDS];
+	union
+	{
+		char buffer[CMSG_SPACE(sizeof(fds))];
+		struct cmsghdr align;
+	}control;
+	uint8_t magic = 0;
+	struct iovec iov = {&magic, sizeof(magic)};
+	struct msghdr message;
+	struct cmsghdr* pControl;
+	Shm* pShm = NULL;
+	ssize_t size;
+	memset(&message, 0, sizeof(message));
+	message.msg_iov = &iov;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+	do
+	{
+		size = recvmsg(un_socket, &message, MSG_CMSG_CLOEXEC);
+	}while(size == -1 && errno == EINTR);
+	pControl = CMSG_FIRSTHDR(&message);
+	if(size != (ssize_t) sizeof(magic) || pControl == NULL || pControl->cmsg_level != SOL_SOCKET
+			|| pControl->cmsg_type != SCM_RIGHTS || pControl->cmsg_len != CMSG_LEN(sizeof(fds)))
+	{
+		return NULL;
+	}
+	memcpy(fds, CMSG_DATA(pControl), sizeof(fds));
+	if(magic == (uint8_t) SHM_MAGIC)
+	{
+		pShm = Shm_map(fds[0], fds[1], fds[2], FALSE);
+	}
+	if(pShm == NULL)
+	{
+		for(int i = 0; i < SHM_NB_FDS; i++)
+		{
+			close(fds[i]);
+		}
+	}
+	return pShm;
+}
+
+void Shm_free(Shm* pShm)
+{
+	Ring_free(pShm->commands);
+	Ring_free(pShm->replies);
+	munmap(pShm->memory, pShm->size);
+	close(pShm->memory_fd);
+	close(pShm->to_commando);
+	close(pShm->to_telco);
+	free(pShm);
+}
+
+bool_e Shm_push(Ring* pRing, int eventfd, const ShmMessage* pMessage)
+{
+	if(Ring_push(pRing, pMessage) == FALSE)
+	{
+		return FALSE;
+	}
+	Shm_notify(eventfd);
+	return TRUE;
+}
+
+void Shm_notify(int eventfd)
+{
+	uint64_t value = 1;
+	if(write(eventfd, &value, sizeof(value)) == -1)
+	{
+		perror("ERROR : eventfd");
+	}
+}
+
+void Shm_clear(int eventfd)
+{
+	uint64_t value;
+	if(read(eventfd, &value, sizeof(value)) == -1 && errno != EAGAIN)
+	{
+		perror("ERROR : eventfd");
+	}
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static size_t Shm_align(size_t size)
+{
+	return (size + RING_CACHE_LINE - 1) & ~((size_t) RING_CACHE_LINE - 1);
+}
+
+static Shm* Shm_map(int memory_fd, int to_commando, int to_telco, bool_e create)
+{
+	size_t ring_size = Shm_align(Ring_getSize(SHM_RING_CAPACITY, sizeof(ShmMessage)));
+	size_t commands_offset = Shm_align(sizeof(ShmHeader));
+	size_t size = commands_offset + 2 * ring_size;
+	ShmHeader* pHeader;
+	struct stat status;
+	void* memory;
+	Shm* pShm;
+	if(fstat(memory_fd, &status) == -1 || (size_t) status.st_size != size)
+	{
+		//Built by another version of the commando.
+		return NULL;
+	}
+	memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, memory_fd, 0);
+	if(memory == MAP_FAILED)
+	{
+		return NULL;
+	}
+	pHeader = (ShmHeader*) memory;
+	if(create == TRUE)
+	{
+		pHeader->magic = SHM_MAGIC;
+		pHeader->message_size = sizeof(ShmMessage);
+		pHeader->commands_offset = commands_offset;
+		pHeader->replies_offset = commands_offset + ring_size;
+	}
+	else if(pHeader->magic != SHM_MAGIC || pHeader->message_size != sizeof(ShmMessage)
+			|| pHeader->commands_offset != commands_offset || pHeader->replies_offset != commands_offset + ring_size)
+	{
+		munmap(memory, size);
+		return NULL;
+	}
+	pShm = (Shm*) malloc(sizeof(Shm));
+	if(pShm == NULL)
+	{
+		printf("ERROR : pShm is NULL \n");
+		while(1);
+	}
+	pShm->memory = memory;
+	pShm->size = size;
+	pShm->memory_fd = memory_fd;
+	pShm->to_commando = to_commando;
+	pShm->to_telco = to_telco;
+	//Laid out from the constants of this process, the header written in the region is never trusted.
+	if(create == TRUE)
+	{
+		pShm->commands = Ring_init((uint8_t*) memory + commands_offset, SHM_RING_CAPACITY, sizeof(ShmMessage));
+		pShm->replies = Ring_init((uint8_t*) memory + commands_offset + ring_size, SHM_RING_CAPACITY, sizeof(ShmMessage));
+	}
+	else
+	{
+		pShm->commands = Ring_attach((uint8_t*) memory + commands_offset, SHM_RING_CAPACITY, sizeof(ShmMessage));
+		pShm->replies = Ring_attach((uint8_t*) memory + commands_offset + ring_size, SHM_RING_CAPACITY, sizeof(ShmMessage));
+	}
+	return pShm;
+}
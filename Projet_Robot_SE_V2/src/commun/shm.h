@@ -0,0 +1,149 @@
+/**
+ * @file  shm.h
+ *
+ * @brief Shared memory transport between a telco and a commando of the same host.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+#ifndef SRC_COMMUN_SHM_H_
+#define SRC_COMMUN_SHM_H_
+/* ----------------------  INCLUDES ------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "prose.h"
+#include "../commun.h"
+#include "ring.h"
+/* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/**
+ * \brief Abstract unix socket on which the commando hands its shared memory out.
+ */
+#define SHM_SOCKET_NAME "robot_se_commando"
+/**
+ * \brief Number of messages each ring of a shared memory holds.
+ */
+#define SHM_RING_CAPACITY (64)
+/**
+ * \struct Shm
+ * \brief A region shared by a telco and a commando, with a ring in each direction.
+ *
+ * The region is a sealed memfd created by the commando and passed over a unix
+ * socket with its two eventfds. The messages are plain structures, nothing is
+ * encoded nor copied through the kernel; the eventfds only wake the reader.
+ */
+typedef struct Shm_t Shm;
+/* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
+/* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
+/**
+ * \struct ShmMessage
+ * \brief Element of the rings, type is a FrameType (donnees, subscribe, heartbeat, telemetry, ping or trajectory).
+ */
+typedef struct
+{
+	uint32_t type;
+	uint32_t robot; //robot of the subscribe or of the telemetry.
+	union
+	{
+		DesDonnees donnees;
+		uint32_t period_ms; //subscribe.
+		PilotState state; //telemetry.
+		uint64_t ping[3]; //originate, receive and transmit timestamps of a FRAME_PING.
+		struct
+		{
+			uint32_t flags; //TrajectoryFlag.
+			TrajectorySegment segment; //one message per segment, unused with TRAJECTORY_CANCEL.
+		} trajectory;
+	};
+}ShmMessage;
+
+struct Shm_t
+{
+	void* memory;
+	size_t size;
+	int memory_fd; //memfd of the region, to hand it out.
+	int to_commando; //eventfd signaled when a command is pushed.
+	int to_telco; //eventfd signaled when a reply or a sample is pushed.
+	Ring* commands; //telco -> commando, private handle on the ring of the region.
+	Ring* replies; //commando -> telco, private handle on the ring of the region.
+};
+/* ----------------------  PUBLIC VARIBLES -----------------------------------*/
+/* ----------------------  PUBLIC FUNCTIONS PROTOTYPES  ----------------------*/
+/**
+ * \fn extern socklen_t Shm_getAddress(struct sockaddr_un* pAddress)
+ * \brief Fill the address of the abstract unix socket of the commando.
+ *
+ * \return socklen_t : size of the address.
+ */
+extern socklen_t Shm_getAddress(struct sockaddr_un* pAddress);
+/**
+ * \fn extern Shm* Shm_new()
+ * \brief Create a shared memory with its rings and its eventfds (commando).
+ *
+ * \return Shm* : NULL if the memfd or the eventfds could not be created.
+ */
+extern Shm* Shm_new();
+/**
+ * \fn extern bool_e Shm_send(Shm* pShm, int un_socket)
+ * \brief Hand the memory and the eventfds out over a unix socket (commando).
+ *
+ * \return bool_e : FALSE if they could not be sent.
+ */
+extern bool_e Shm_send(Shm* pShm, int un_socket);
+/**
+ * \fn extern Shm* Shm_receive(int un_socket)
+ * \brief Map a shared memory handed out by the commando (telco).
+ *
+ * \return Shm* : NULL if nothing valid has been received.
+ */
+extern Shm* Shm_receive(int un_socket);
+/**
+ * \fn extern void Shm_free(Shm* pShm)
+ * \brief Unmap the shared memory and close the eventfds.
+ */
+extern void Shm_free(Shm* pShm);
+/**
+ * \fn extern bool_e Shm_push(Ring* pRing, int eventfd, const ShmMessage* pMessage)
+ * \brief Push a message into a ring and wake its reader up.
+ *
+ * \return bool_e : FALSE if the ring is full.
+ */
+extern bool_e Shm_push(Ring* pRing, int eventfd, const ShmMessage* pMessage);
+/**
+ * \fn extern void Shm_notify(int eventfd)
+ * \brief Wake the reader of a ring up.
+ */
+extern void Shm_notify(int eventfd);
+/**
+ * \fn extern void Shm_clear(int eventfd)
+ * \brief Reset an eventfd before the ring it signals is drained, it does not wait.
+ */
+extern void Shm_clear(int eventfd);
+
+#endif /* SRC_COMMUN_SHM_H_ */
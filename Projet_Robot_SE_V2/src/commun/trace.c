@@ -0,0 +1,218 @@
+/**
+ * @file  trace.c
+ *
+ * @brief Timestamps of a velocity command along its path, from the key pressed to the motors.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+/* ----------------------  INCLUDES  ---------------------------------------- */
+#include "trace.h"
+#include <stdio.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <time.h>
+/* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+/**
+ * \brief Histograms : the capture to the motors, then each stage from the previous one.
+ */
+#define TRACE_TOTAL (0)
+/* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
+/* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/**
+ * \struct TraceHistogram
+ * \brief Distribution of the time spent in a stage, updated atomically.
+ */
+typedef struct
+{
+	unsigned long buckets[TRACE_NB_BUCKETS];
+	unsigned long count;
+	unsigned long long total_ns;
+	uint64_t max_ns;
+}TraceHistogram;
+/**
+ * \struct TraceStats
+ * \brief What the control loops record, shared with their child processes once the trace is enabled.
+ */
+typedef struct
+{
+	TraceHistogram histograms[TRACE_NB_STAGES];
+	unsigned long nb_skewed; //traces dropped because a stage is earlier than the previous one.
+}TraceStats;
+/* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
+/* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+static bool_e trace_enabled = FALSE;
+static volatile sig_atomic_t trace_dump_requested = 0;
+static TraceStats local_stats;
+static TraceStats* pStats = &local_stats;
+static const char* const stage_names[TRACE_NB_STAGES] =
+{
+	[TRACE_TOTAL] = "capture -> motor",
+	[TRACE_SEND] = "capture -> send",
+	[TRACE_RECEIVE] = "send -> receive",
+	[TRACE_DISPATCH] = "receive -> dispatch",
+	[TRACE_MOTOR] = "dispatch -> motor"
+};
+/* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static void Trace_add(TraceHistogram* pHistogram, uint64_t ns)
+ * \brief Count a time in a histogram.
+ */
+static void Trace_add(TraceHistogram* pHistogram, uint64_t ns);
+/**
+ * \fn static double Trace_getPercentile(const unsigned long* buckets, unsigned long count, double percentile)
+ * \brief Upper bound in us of the bucket holding a percentile.
+ */
+static double Trace_getPercentile(const unsigned long* buckets, unsigned long count, double percentile);
+/* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
+void Trace_enable(void)
+{
+	//A control loop may run in a child process of its own, the histograms must be seen by the one which dumps them.
+	TraceStats* pShared = (TraceStats*) mmap(NULL, sizeof(TraceStats), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(pShared == MAP_FAILED)
+	{
+		perror("ERROR : mmap trace");
+	}
+	else
+	{
+		pStats = pShared;
+	}
+	trace_enabled = TRUE;
+}
+
+bool_e Trace_isEnabled(void)
+{
+	return trace_enabled;
+}
+
+uint64_t Trace_now(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec + 1;
+}
+
+void Trace_record(const Trace* pTrace)
+{
+	for(int stage = TRACE_SEND; stage < TRACE_NB_STAGES; stage++)
+	{
+		if(pTrace->stamps[stage] < pTrace->stamps[stage - 1] || pTrace->stamps[stage - 1] == 0)
+		{
+			//Another host, or a stage not recorded.
+			__atomic_fetch_add(&pStats->nb_skewed, 1, __ATOMIC_RELAXED);
+			return;
+		}
+	}
+	for(int stage = TRACE_SEND; stage < TRACE_NB_STAGES; stage++)
+	{
+		Trace_add(&pStats->histograms[stage], pTrace->stamps[stage] - pTrace->stamps[stage - 1]);
+	}
+	Trace_add(&pStats->histograms[TRACE_TOTAL], pTrace->stamps[TRACE_MOTOR] - pTrace->stamps[TRACE_CAPTURE]);
+}
+
+void Trace_requestDump(void)
+{
+	trace_dump_requested = 1;
+}
+
+bool_e Trace_takeDump(void)
+{
+	if(trace_dump_requested == 0)
+	{
+		return FALSE;
+	}
+	trace_dump_requested = 0;
+	return TRUE;
+}
+
+void Trace_dump(void)
+{
+	unsigned long buckets[TRACE_NB_BUCKETS];
+	unsigned long count;
+	printf("LOG_TRACE : %lu commands traced, %lu dropped (clocks not comparable)\n",
+			__atomic_load_n(&pStats->histograms[TRACE_TOTAL].count, __ATOMIC_RELAXED), __atomic_load_n(&pStats->nb_skewed, __ATOMIC_RELAXED));
+	for(int stage = 0; stage < TRACE_NB_STAGES; stage++)
+	{
+		TraceHistogram* pHistogram = &pStats->histograms[stage];
+		count = 0;
+		for(int b = 0; b < TRACE_NB_BUCKETS; b++)
+		{
+			buckets[b] = __atomic_load_n(&pHistogram->buckets[b], __ATOMIC_RELAXED);
+			count += buckets[b];
+		}
+		if(count == 0)
+		{
+			continue;
+		}
+		printf("LOG_TRACE : %-20s mean %9.1f us  p50 < %7.0f us  p99 < %7.0f us  max %9.1f us\n", stage_names[stage],
+				__atomic_load_n(&pHistogram->total_ns, __ATOMIC_RELAXED) / 1e3 / count,
+				Trace_getPercentile(buckets, count, 0.50), Trace_getPercentile(buckets, count, 0.99),
+				__atomic_load_n(&pHistogram->max_ns, __ATOMIC_RELAXED) / 1e3);
+		for(int b = 0; b < TRACE_NB_BUCKETS; b++)
+		{
+			if(buckets[b] > 0)
+			{
+				printf("           [%7lu, %7lu) us %lu\n", (b == 0)? 0UL : 1UL << (b - 1), 1UL << b, buckets[b]);
+			}
+		}
+	}
+	fflush(stdout);
+}
+/* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static void Trace_add(TraceHistogram* pHistogram, uint64_t ns)
+{
+	uint64_t us = ns / 1000;
+	uint64_t max = __atomic_load_n(&pHistogram->max_ns, __ATOMIC_RELAXED);
+	int bucket = 0;
+	while(us > 0 && bucket < TRACE_NB_BUCKETS - 1)
+	{
+		us >>= 1;
+		bucket++;
+	}
+	__atomic_fetch_add(&pHistogram->buckets[bucket], 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&pHistogram->count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&pHistogram->total_ns, ns, __ATOMIC_RELAXED);
+	while(ns > max && __atomic_compare_exchange_n(&pHistogram->max_ns, &max, ns, FALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED) == FALSE)
+	{
+		//max has been reloaded, another thread has recorded meanwhile.
+	}
+}
+
+static double Trace_getPercentile(const unsigned long* buckets, unsigned long count, double percentile)
+{
+	unsigned long seen = 0;
+	for(int b = 0; b < TRACE_NB_BUCKETS; b++)
+	{
+		seen += buckets[b];
+		if(seen >= percentile * count)
+		{
+			return (double) (1UL << b);
+		}
+	}
+	return (double) (1UL << (TRACE_NB_BUCKETS - 1));
+}
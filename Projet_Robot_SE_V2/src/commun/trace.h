@@ -0,0 +1,109 @@
+/**
+ * @file  trace.h
+ *
+ * @brief Timestamps of a velocity command along its path, from the key pressed to the motors.
+ *
+ * @author agent
+ * @date Oct 17, 2026
+ * @version 1
+ * @section License
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2026, agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+#ifndef SRC_COMMUN_TRACE_H_
+#define SRC_COMMUN_TRACE_H_
+/* ----------------------  INCLUDES ------------------------------------------*/
+#include <stdint.h>
+#include "prose.h"
+/* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/**
+ * \brief Number of buckets of a histogram: [0, 1) us then [2^(b-1), 2^b) us, the last one is open.
+ */
+#define TRACE_NB_BUCKETS (24)
+/* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
+/**
+ * \enum TraceStage
+ * \brief Stages timestamped along the path of a velocity command.
+ */
+typedef enum
+{
+	TRACE_CAPTURE = 0, /**< key read by RemoteUI_captureChoice (telco) */
+	TRACE_SEND,        /**< DesDonnees sent by the Client (telco) */
+	TRACE_RECEIVE,     /**< frame read by the Server */
+	TRACE_DISPATCH,    /**< velocity taken by the control thread for the Pilot */
+	TRACE_MOTOR,       /**< Pilot_setVelocity returned, both Motor_setCmd done */
+	TRACE_NB_STAGES
+}TraceStage;
+/* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
+/**
+ * \struct Trace
+ * \brief CLOCK_MONOTONIC time in ns of each stage, 0 when the command is not traced.
+ *
+ * The telco and the commando read the same clock only on the same host, the stages
+ * across them are meaningful with the shared memory or the loopback.
+ */
+typedef struct
+{
+	uint64_t stamps[TRACE_NB_STAGES];
+}Trace;
+/* ----------------------  PUBLIC VARIBLES -----------------------------------*/
+/* ----------------------  PUBLIC FUNCTIONS PROTOTYPES  ----------------------*/
+/**
+ * \fn extern void Trace_enable(void)
+ * \brief Trace the velocity commands from now on, before any thread is started.
+ */
+extern void Trace_enable(void);
+/**
+ * \fn extern bool_e Trace_isEnabled(void)
+ * \brief Nothing is timestamped nor carried by the frames when FALSE.
+ */
+extern bool_e Trace_isEnabled(void);
+/**
+ * \fn extern uint64_t Trace_now(void)
+ * \brief CLOCK_MONOTONIC time in ns, never 0.
+ */
+extern uint64_t Trace_now(void);
+/**
+ * \fn extern void Trace_record(const Trace* pTrace)
+ * \brief Add the time between each stage and the previous one, and from the capture to the motors,
+ *        to their histograms. Any thread can record.
+ */
+extern void Trace_record(const Trace* pTrace);
+/**
+ * \fn extern void Trace_requestDump(void)
+ * \brief Ask for Trace_takeDump to return TRUE, async-signal-safe.
+ */
+extern void Trace_requestDump(void);
+/**
+ * \fn extern bool_e Trace_takeDump(void)
+ * \brief Consume a request of Trace_requestDump.
+ */
+extern bool_e Trace_takeDump(void);
+/**
+ * \fn extern void Trace_dump(void)
+ * \brief Print the histograms of the time spent in each stage.
+ */
+extern void Trace_dump(void);
+
+#endif /* SRC_COMMUN_TRACE_H_ */
@@ -39,6 +39,7 @@
 #include <stdlib.h>
 #include <termios.h>
 #include <unistd.h>
+#include <string.h>
 /* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
 /* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
 /**
@@ -57,15 +58,127 @@ typedef enum
 /* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
 static int Main_capture_choice();
 static int Main_display();
+/**
+ * \fn static RobotConfig* Main_loadConfigs(const char* path, int nb_robots, int nb_workers)
+ * \brief Read the configurations of the robots of a fleet, one line per robot (see Robot_parseConfig).
+ *
+ * \return RobotConfig* : nb_robots configurations checked for nb_workers, NULL if the file does not give them.
+ */
+static RobotConfig* Main_loadConfigs(const char* path, int nb_robots, int nb_workers);
+/**
+ * \fn static void Main_freeConfigs(RobotConfig* pConfigs, int nb_robots)
+ * \brief Free the configurations read by Main_loadConfigs.
+ */
+static void Main_freeConfigs(RobotConfig* pConfigs, int nb_robots);
 /* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
 /* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
 
 /**
  * starts the robot V1 application
+ *
+ * options : -r <nb robots, more than one needs -f> -w <nb workers, robot r is driven by the worker r % nb_workers>
+ *           -b <epoll|uring> -d <watchdog deadline in ms, 0 for none>
+ *           -c <rate of the control loop in Hz, 0 for none> -R (real-time control threads)
+ *           -A <acceleration of the wheels in percent/s, 0 for steps> -J <jerk in percent/s2, 0 for trapezoidal ramps>
+ *           -f <file of the Intox address and ports of each robot : libinfox opens a single Intox session per process,
+ *               a fleet on several Intox simulators gets a process per worker, one simulator each>
+ *           -v (print every frame received and every answer sent)
+ *           for the commando,
+ *           -i <robot id> for the telco, -T to trace the latency of the velocity commands (both).
  */
 int main (int argc, char *argv[])
 {
 	int main_loop = 0;
+	int nb_robots = 1;
+	int nb_workers = 1;
+	int robot = 0;
+	int deadline_ms = CONTROLLER_WATCHDOG_MS;
+	int rate_hz = 0;
+	bool_e realtime = FALSE;
+	bool_e verbose = FALSE;
+	float acceleration = ROBOT_ACCELERATION;
+	float jerk = ROBOT_JERK;
+	ServerBackend backend = SERVER_BACKEND_EPOLL;
+	const char* config_path = NULL;
+	RobotConfig* pConfigs = NULL;
+	int option;
+	while((option = getopt(argc, argv, "r:w:i:b:d:c:A:J:f:RvT")) != -1)
+	{
+		switch(option)
+		{
+			case 'r':
+				nb_robots = atoi(optarg);
+				break;
+			case 'w':
+				nb_workers = atoi(optarg);
+				break;
+			case 'i':
+				robot = atoi(optarg);
+				break;
+			case 'd':
+				deadline_ms = atoi(optarg);
+				break;
+			case 'c':
+				rate_hz = atoi(optarg);
+				break;
+			case 'R':
+				realtime = TRUE;
+				break;
+			case 'v':
+				verbose = TRUE;
+				break;
+			case 'A':
+				acceleration = atof(optarg);
+				break;
+			case 'J':
+				jerk = atof(optarg);
+				break;
+			case 'f':
+				config_path = optarg;
+				break;
+			case 'T':
+				Trace_enable();
+				break;
+			case 'b':
+				if(strcmp(optarg, "uring") == 0)
+				{
+					backend = SERVER_BACKEND_URING;
+					break;
+				}
+				if(strcmp(optarg, "epoll") == 0)
+				{
+					backend = SERVER_BACKEND_EPOLL;
+					break;
+				}
+				//fall through
+			default:
+				printf("usage : %s [-r nb_robots] [-w nb_workers] [-b epoll|uring] [-d deadline_ms] [-c rate_hz] [-R] [-v] [-A acceleration] [-J jerk] [-f robots_file] [-i robot] [-T]\n", argv[0]);
+				return 1;
+		}
+	}
+	if(Robot_checkMotionProfile(acceleration, jerk) == FALSE)
+	{
+		return 1;
+	}
+	if(nb_robots > 1 && config_path == NULL)
+	{
+		//The 3 sensors of a robot take 3 of the 4 sensor ports of its brick, the default ports fit a single robot.
+		printf("ERROR : -r %d needs the Intox address and ports of each robot (-f robots_file)\n", nb_robots);
+		return 1;
+	}
+	if(nb_robots < 1 || nb_workers < 1 || nb_workers > nb_robots)
+	{
+		//As Server_new does, the configurations are checked against the workers which will drive them.
+		nb_workers = 1;
+	}
+	if(config_path != NULL)
+	{
+		pConfigs = Main_loadConfigs(config_path, nb_robots, nb_workers);
+		if(pConfigs == NULL)
+		{
+			return 1;
+		}
+	}
 	while(main_loop == 0)
 	{
 		main_loop = Main_display();
@@ -73,14 +186,19 @@ int main (int argc, char *argv[])
 
 	if(main_loop == 1)
 	{
-		Server * pServer = Server_new();
+		Server * pServer = Server_new(nb_robots, nb_workers, pConfigs);
+		Server_setBackend(pServer, backend);
+		Server_setVerbose(pServer, verbose);
+		Server_setWatchdog(pServer, (deadline_ms > 0)? (unsigned int) deadline_ms : 0);
+		Server_setControlRate(pServer, (rate_hz > 0)? (unsigned int) rate_hz : 0, realtime);
+		Server_setMotionProfile(pServer, acceleration, jerk);
 		Server_start(pServer); //fonction bloquante ici
 		Server_stop(pServer);
 		Server_free(pServer);
 	}
 	else if(main_loop == 2)
 	{
-		RemoteUI* pRemoteUI = RemoteUI_new();
+		RemoteUI* pRemoteUI = RemoteUI_new(robot);
 		RemoteUI_start(pRemoteUI);
 		RemoteUI_stop(pRemoteUI);
 		RemoteUI_free(pRemoteUI);
@@ -89,9 +207,67 @@ int main (int argc, char *argv[])
 	{
 		printf("Bye \n");
 	}
+	Main_freeConfigs(pConfigs, nb_robots);
 	return 0;
 }
 
+static RobotConfig* Main_loadConfigs(const char* path, int nb_robots, int nb_workers)
+{
+	char line[256];
+	int nb_read = 0;
+	FILE* file = fopen(path, "r");
+	RobotConfig* pConfigs;
+	if(file == NULL)
+	{
+		perror("ERROR : robots file");
+		return NULL;
+	}
+	pConfigs = (RobotConfig*) malloc(nb_robots * sizeof(RobotConfig));
+	if(pConfigs == NULL)
+	{
+		printf("ERROR : pConfigs is NULL \n");
+		while(1);
+	}
+	while(nb_read < nb_robots && fgets(line, sizeof(line), file) != NULL)
+	{
+		//Empty lines and comments are skipped.
+		if(line[strspn(line, " \t\r\n")] == '\0' || line[strspn(line, " \t")] == '#')
+		{
+			continue;
+		}
+		if(Robot_parseConfig(line, &pConfigs[nb_read]) == FALSE)
+		{
+			printf("ERROR : invalid robot %d in %s : %s", nb_read, path, line);
+			break;
+		}
+		nb_read++;
+	}
+	fclose(file);
+	if(nb_read < nb_robots || Robot_checkConfigs(pConfigs, nb_robots, nb_workers) == FALSE)
+	{
+		if(nb_read < nb_robots)
+		{
+			printf("ERROR : %s gives %d of the %d robots\n", path, nb_read, nb_robots);
+		}
+		Main_freeConfigs(pConfigs, nb_read);
+		return NULL;
+	}
+	return pConfigs;
+}
+
+static void Main_freeConfigs(RobotConfig* pConfigs, int nb_robots)
+{
+	if(pConfigs == NULL)
+	{
+		return;
+	}
+	for(int i = 0; i < nb_robots; i++)
+	{
+		free((char*) pConfigs[i].intox_address);
+	}
+	free(pConfigs);
+}
+
 static int Main_capture_choice()
 {
 	int return_value = 0;
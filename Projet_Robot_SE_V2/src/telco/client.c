@@ -42,20 +42,174 @@
 #include <sys/types.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <fcntl.h>
 /* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+/**
+ * \brief Number of host names whose address is cached, and their longest length.
+ */
+#define CLIENT_ADDRESS_CACHE_SIZE (4)
+#define CLIENT_HOST_SIZE (64)
 /* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
 /* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
+/**
+ * \struct ClientAddress
+ * \brief Address resolved for a host name.
+ */
+typedef struct
+{
+	char host[CLIENT_HOST_SIZE];
+	struct in_addr address;
+}ClientAddress;
 /* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
 /* ----------------------  PRIVATE VARIABLES  ------------------------------- */
+static ClientAddress addresses[CLIENT_ADDRESS_CACHE_SIZE];
+static int nb_addresses = 0;
+static int next_address = 0; //entry replaced when the cache is full.
 /* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
+/**
+ * \fn static bool_e Client_write(Client* pClient, const uint8_t* buffer, size_t size)
+ * \brief Write a whole frame on the socket without blocking, what it does not take waits in tx.
+ *
+ * \return bool_e : FALSE if the connection is lost.
+ */
+static bool_e Client_write(Client* pClient, const uint8_t* buffer, size_t size);
+/**
+ * \fn static bool_e Client_fill(Client* pClient)
+ * \brief Read once from the socket into the decoder, without blocking.
+ *
+ * \return bool_e : FALSE if the connection is lost.
+ */
+static bool_e Client_fill(Client* pClient);
+/**
+ * \fn static bool_e Client_send(Client* pClient, const DesDonnees* pDonnees)
+ * \brief Send DesDonnees to the commando, through the shared memory or TCP.
+ *
+ * \return bool_e : FALSE if the connection is lost.
+ */
+static bool_e Client_send(Client* pClient, const DesDonnees* pDonnees);
+/**
+ * \fn static void Client_answer(Client* pClient, const DesDonnees* pDonnees)
+ * \brief Complete the pending state request a DesDonnees answers.
+ *        The answers of a commando that does not echo the ids (request 0) complete the oldest one.
+ */
+static void Client_answer(Client* pClient, const DesDonnees* pDonnees);
+/**
+ * \fn static void Client_complete(Client* pClient, int index, ClientStatus status, const DesDonnees* pDonnees)
+ * \brief Remove the pending state request at index and queue its completion.
+ */
+static void Client_complete(Client* pClient, int index, ClientStatus status, const DesDonnees* pDonnees);
+/**
+ * \fn static long Client_getElapsed(const struct timespec* pSince)
+ * \brief Time in us since pSince.
+ */
+static long Client_getElapsed(const struct timespec* pSince);
+/**
+ * \fn static bool_e Client_connectLocal(Client* pClient)
+ * \brief Connect to the unix socket of a commando of this host and map the shared memory it hands out.
+ *
+ * \return bool_e : FALSE if there is no such commando, TCP is used then.
+ */
+static bool_e Client_connectLocal(Client* pClient);
+/**
+ * \fn static bool_e Client_push(Client* pClient, const ShmMessage* pMessage)
+ * \brief Push a command into the shared memory. A velocity the full ring does not take replaces the one
+ *        left behind before, like a lost datagram; any other command waits CLIENT_PUSH_TIMEOUT_MS at most.
+ *
+ * \return bool_e : FALSE if the connection is lost.
+ */
+static bool_e Client_push(Client* pClient, const ShmMessage* pMessage);
+/**
+ * \fn static bool_e Client_flushVelocity(Client* pClient)
+ * \brief Push the velocity a full ring has left behind, if any.
+ *
+ * \return bool_e : FALSE if it is still left behind.
+ */
+static bool_e Client_flushVelocity(Client* pClient);
+/**
+ * \fn static bool_e Client_isAlive(Client* pClient)
+ * \brief Check the unix socket of a shared memory has not been closed by the commando.
+ */
+static bool_e Client_isAlive(Client* pClient);
+/**
+ * \fn static int Client_readShm(Client* pClient)
+ * \brief Client_read for a shared memory, the messages are popped from the ring of the replies.
+ */
+static int Client_readShm(Client* pClient);
+/**
+ * \fn static long Client_getSilence(Client* pClient)
+ * \brief Time in ms since the last message to the commando.
+ */
+static long Client_getSilence(Client* pClient);
+/**
+ * \fn static bool_e Client_resolve(const char* host, struct in_addr* pAddress)
+ * \brief Resolve a host name, from the cache if it has already been resolved.
+ *
+ * \return bool_e : FALSE if the host name is unknown.
+ */
+static bool_e Client_resolve(const char* host, struct in_addr* pAddress);
+/**
+ * \fn static void Client_forget(const char* host)
+ * \brief Remove a host name from the cache, it is resolved again next time.
+ */
+static void Client_forget(const char* host);
+/**
+ * \fn static bool_e Client_connect(Client* pClient)
+ * \brief Connect to the commando, through a shared memory if it is on this host.
+ *
+ * \return bool_e : FALSE if the commando is not reachable.
+ */
+static bool_e Client_connect(Client* pClient);
+/**
+ * \fn static bool_e Client_connectTcp(Client* pClient)
+ * \brief Non-blocking connect of un_socket, given up after CLIENT_CONNECT_TIMEOUT_MS.
+ *
+ * \return bool_e : FALSE if the connection failed, errno tells why.
+ */
+static bool_e Client_connectTcp(Client* pClient);
+/**
+ * \fn static void Client_close(Client* pClient)
+ * \brief Close the connection to the commando (not the UDP socket, which is not connection oriented).
+ */
+static void Client_close(Client* pClient);
+/**
+ * \fn static void Client_disconnect(Client* pClient)
+ * \brief Close a lost connection, complete its pending requests with CLIENT_LOST and
+ *        schedule an immediate attempt to reconnect.
+ */
+static void Client_disconnect(Client* pClient);
+/**
+ * \fn static void Client_reconnect(Client* pClient)
+ * \brief Attempt to reconnect, and restore the session once connected. The delay before the
+ *        next attempt is doubled on failure.
+ */
+static void Client_reconnect(Client* pClient);
+/**
+ * \fn static void Client_ping(Client* pClient)
+ * \brief Send a FRAME_PING stamped with the clock of the telco.
+ */
+static void Client_ping(Client* pClient);
+/**
+ * \fn static void Client_pong(Client* pClient, uint64_t originate, uint64_t receive, uint64_t transmit)
+ * \brief Estimate the offset of the clock of the commando from a ping come back, with the
+ *        round trip of the CLIENT_CLOCK_SAMPLES last ones which is the shortest.
+ */
+static void Client_pong(Client* pClient, uint64_t originate, uint64_t receive, uint64_t transmit);
 /* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
-void Client_start(Client* pClient)
+bool_e Client_start(Client* pClient)
 {
-	pClient->un_socket = socket(PF_INET, SOCK_STREAM, 0);
 	pClient->adresse_du_serveur.sin_family = AF_INET;
 	pClient->adresse_du_serveur.sin_port = htons(PORT_DU_SERVEUR);
-	pClient->adresse_du_serveur.sin_addr = *((struct in_addr *)gethostbyname(pClient->ip)->h_addr_list[0]);
-	connect(pClient->un_socket, (struct sockaddr *)&pClient->adresse_du_serveur,sizeof(pClient->adresse_du_serveur));
+	if(Client_connect(pClient) == FALSE)
+	{
+		printf("ERROR : commando %s not reachable, retrying\n", pClient->ip);
+		clock_gettime(CLOCK_MONOTONIC, &pClient->lost);
+		pClient->backoff_ms = CLIENT_RECONNECT_MIN_MS;
+		pClient->reconnect_at = pClient->lost;
+		return FALSE;
+	}
+	return TRUE;
 }
 
 Client* Client_new(void)
@@ -66,47 +220,862 @@ Client* Client_new(void)
 		printf("ERROR : pRobot is NULL /n");
 		while(1);
 	}
+	pClient->robot = 0;
+	pClient->shm = NULL;
+	pClient->velocity_unsent = FALSE;
+	pClient->un_socket = -1;
+	pClient->tx_len = 0;
+	pClient->telemetry_fd = -1;
+	pClient->socket_datagramme = -1;
+	pClient->datagram = FALSE;
+	pClient->sequence = 0;
+	pClient->telemetry_sequence = 0;
+	pClient->telemetry_delta = TRUE;
+	pClient->nb_requests = 0;
+	pClient->nb_pending = 0;
+	pClient->nb_inflight = 0;
+	pClient->completions = Ring_new(CLIENT_MAX_PENDING, sizeof(ClientCompletion));
+	pClient->connected = FALSE;
+	pClient->subscription_ms = 0;
+	pClient->nb_reconnections = 0;
+	pClient->nb_clock_samples = 0;
+	pClient->synchronized = FALSE;
+	pClient->offset_ns = 0;
+	pClient->rtt_ns = 0;
+	//Restored as is on a reconnection, the robot stays still until a key is pressed.
+	memset(&pClient->donnees, 0, sizeof(pClient->donnees));
+	pClient->donnees.direction = STOP;
 	return pClient;
 }
 
 void Client_stop(Client* pClient)
 {
-	close(pClient->un_socket);
+	struct pollfd fd = {pClient->un_socket, POLLOUT, 0};
+	if(pClient->connected == TRUE && pClient->tx_len > 0 && poll(&fd, 1, CLIENT_PUSH_TIMEOUT_MS) == 1)
+	{
+		//The last frames, the stop among them, are not lost with the socket.
+		Client_flush(pClient);
+	}
+	Client_close(pClient);
+	pClient->connected = FALSE;
+	if(pClient->socket_datagramme != -1)
+	{
+		close(pClient->socket_datagramme);
+		pClient->socket_datagramme = -1;
+	}
 }
 
 void Client_free(Client* pClient)
 {
+	Ring_free(pClient->completions);
 	free(pClient);
 }
 
 void Client_sendMsg(Client* pClient)
 {
-	DesDonnees data;
-	data = pClient->donnees;
-	int quantite_envoyee;
-	quantite_envoyee = write(pClient->un_socket, &data, sizeof(data));
-	printf("LOG_MSG_SENT\n");
-}
-
-void Client_readMsg(Client* pClient)
-{
-	printf("dans read avant connexion\n");
-	DesDonnees data;
-	printf("dans read\n");
-	read(pClient->un_socket, &data, sizeof(data));
-	pClient->donnees = data;
-	printf("LOG_MSG_RCV : \n");
-	printf("- asklog : %d\n", pClient->donnees.askLog);
-	printf("- power : %d\n", pClient->donnees.power);
-	printf("- direction : %d\n", pClient->donnees.direction);
-	printf("- bump : %d\n", pClient->donnees.bump);
-	printf("- luminosity : %f\n", pClient->donnees.luminosity);
-	printf("- stop : %d\n", pClient->donnees.stop);
-	/*pClient->donnees.direction = ntohl(data.direction);
-	pClient->donnees.power = ntohl(data.power);
-	pClient->donnees.luminosity = ntohl(data.luminosity);
-	pClient->donnees.bump = ntohl(data.bump);
-	pClient->donnees.askLog = ntohl(data.askLog);
-	pClient->donnees.stop = ntohl(data.stop);*/
+	uint8_t buffer[FRAME_MAX_SIZE];
+	size_t size;
+	pClient->donnees.robot = pClient->robot;
+	if(pClient->datagram == TRUE && pClient->donnees.askLog == 0 && pClient->donnees.stop == 0)
+	{
+		VelocityVector vector = {(Direction) pClient->donnees.direction, pClient->donnees.power, pClient->donnees.angular};
+		size = Frame_encodeVelocity(buffer, ++pClient->sequence, pClient->robot, &vector);
+		if(send(pClient->socket_datagramme, buffer, size, 0) == (ssize_t) size)
+		{
+			clock_gettime(CLOCK_MONOTONIC, &pClient->last_sent);
+			printf("LOG_MSG_SENT (UDP)\n");
+		}
+		//The datagrams carry no trace.
+		pClient->donnees.captured = 0;
+		return;
+	}
+	if(pClient->connected == FALSE)
+	{
+		//The velocity is sent once reconnected.
+		printf("LOG_MSG_NOT_SENT : reconnecting to the commando\n");
+		pClient->donnees.captured = 0;
+		return;
+	}
+	//In the timebase of the commando, which measures the one-way delay (0 until the clocks are synchronized).
+	pClient->donnees.sent = Client_toCommando(pClient, Trace_now());
+	pClient->donnees.captured = Client_toCommando(pClient, pClient->donnees.captured);
+	if(Client_send(pClient, &pClient->donnees) == TRUE)
+	{
+		printf("LOG_MSG_SENT%s\n", (pClient->shm != NULL)? " (shared memory)" : "");
+	}
+	//Only the first sending of a key pressed is traced.
+	pClient->donnees.captured = 0;
+	pClient->donnees.sent = 0;
+}
+
+uint32_t Client_ask(Client* pClient)
+{
+	DesDonnees donnees = pClient->donnees;
+	if(pClient->nb_inflight == CLIENT_MAX_PENDING || pClient->connected == FALSE)
+	{
+		return 0;
+	}
+	//0 is left to the answers of a commando that does not echo the ids.
+	if(++pClient->nb_requests == 0)
+	{
+		pClient->nb_requests = 1;
+	}
+	donnees.robot = pClient->robot;
+	donnees.askLog = 1;
+	donnees.request = pClient->nb_requests;
+	donnees.captured = 0;
+	donnees.sent = Client_toCommando(pClient, Trace_now());
+	if(Client_send(pClient, &donnees) == FALSE)
+	{
+		return 0;
+	}
+	pClient->pending[pClient->nb_pending].request = donnees.request;
+	pClient->pending[pClient->nb_pending].sent = pClient->last_sent;
+	pClient->nb_pending++;
+	pClient->nb_inflight++;
+	return donnees.request;
+}
+
+bool_e Client_getCompletion(Client* pClient, ClientCompletion* pCompletion)
+{
+	if(Ring_pop(pClient->completions, pCompletion) == FALSE)
+	{
+		return FALSE;
+	}
+	pClient->nb_inflight--;
+	return TRUE;
+}
+
+void Client_subscribe(Client* pClient, unsigned int period_ms)
+{
+	uint8_t buffer[FRAME_MAX_SIZE];
+	struct sockaddr_in adresse;
+	socklen_t adresse_size = sizeof(adresse);
+	uint16_t port = 0;
+	pClient->subscription_ms = period_ms;
+	if(pClient->connected == FALSE)
+	{
+		return;
+	}
+	if(pClient->shm != NULL)
+	{
+		ShmMessage message = {.type = FRAME_SUBSCRIBE, .robot = pClient->robot, .period_ms = period_ms};
+		Client_push(pClient, &message);
+		return;
+	}
+	if(pClient->datagram == TRUE && getsockname(pClient->socket_datagramme, (struct sockaddr *)&adresse, &adresse_size) == 0)
+	{
+		port = ntohs(adresse.sin_port);
+	}
+	uint32_t flags = (pClient->telemetry_delta == TRUE && port == 0)? FRAME_SUBSCRIBE_DELTA : 0;
+	size_t size = Frame_encodeSubscribe(buffer, pClient->robot, period_ms, port, flags);
+	Frame_initTelemetryCodec(&pClient->telemetry_codec);
+	Client_write(pClient, buffer, size);
+}
+
+bool_e Client_sendTrajectory(Client* pClient, const TrajectorySegment* pSegments, int nb_segments, TrajectoryFlag flag)
+{
+	uint8_t buffer[FRAME_MAX_SIZE];
+	int nb_sent = 0;
+	if(pClient->connected == FALSE)
+	{
+		return FALSE;
+	}
+	while(nb_sent < nb_segments)
+	{
+		if(pClient->shm != NULL)
+		{
+			ShmMessage message = {.type = FRAME_TRAJECTORY, .robot = pClient->robot,
+					.trajectory = {.flags = flag, .segment = pSegments[nb_sent]}};
+			if(Client_push(pClient, &message) == FALSE)
+			{
+				return FALSE;
+			}
+			nb_sent++;
+		}
+		else
+		{
+			int nb = Frame_fitTrajectory(&pSegments[nb_sent], nb_segments - nb_sent);
+			if(Client_write(pClient, buffer, Frame_encodeTrajectory(buffer, pClient->robot, flag, &pSegments[nb_sent], nb)) == FALSE)
+			{
+				return FALSE;
+			}
+			nb_sent += nb;
+		}
+		//The next ones go on the trajectory the first one replaced.
+		flag = TRAJECTORY_APPEND;
+	}
+	return TRUE;
+}
+
+bool_e Client_cancelTrajectory(Client* pClient)
+{
+	uint8_t buffer[FRAME_MAX_SIZE];
+	if(pClient->connected == FALSE)
+	{
+		return FALSE;
+	}
+	if(pClient->shm != NULL)
+	{
+		ShmMessage message = {.type = FRAME_TRAJECTORY, .robot = pClient->robot, .trajectory = {.flags = TRAJECTORY_CANCEL}};
+		return Client_push(pClient, &message);
+	}
+	return Client_write(pClient, buffer, Frame_encodeTrajectory(buffer, pClient->robot, TRAJECTORY_CANCEL, NULL, 0));
+}
+
+bool_e Client_setDatagram(Client* pClient, bool_e enabled)
+{
+	if(enabled == TRUE && pClient->shm != NULL)
+	{
+		//Nothing is faster than the shared memory, and it never blocks the commando either.
+		printf("LOG_UDP : useless with the shared memory of a local commando\n");
+		return FALSE;
+	}
+	if(enabled == TRUE && pClient->socket_datagramme == -1)
+	{
+		pClient->socket_datagramme = socket(PF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+		if(pClient->socket_datagramme == -1
+				|| connect(pClient->socket_datagramme, (struct sockaddr *)&pClient->adresse_du_serveur, sizeof(pClient->adresse_du_serveur)) == -1)
+		{
+			perror("ERROR : UDP channel");
+			if(pClient->socket_datagramme != -1)
+			{
+				close(pClient->socket_datagramme);
+				pClient->socket_datagramme = -1;
+			}
+			return FALSE;
+		}
+	}
+	pClient->datagram = enabled;
+	//The commando only applies the velocity datagrams of a UDP socket bound to a connection.
+	Client_subscribe(pClient, pClient->subscription_ms);
+	return TRUE;
+}
+
+int Client_readDatagram(Client* pClient)
+{
+	uint8_t buffer[FRAME_MAX_SIZE];
+	ssize_t size;
+	uint32_t sequence;
+	uint32_t robot;
+	PilotState state;
+	Frame frame;
+	int nb_samples = 0;
+	while((size = recv(pClient->socket_datagramme, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0)
+	{
+		if(Frame_parse(buffer, size, &frame) == TRUE && Frame_decodeTelemetryDatagram(&frame, &sequence, &robot, &state) == TRUE
+				&& robot == (uint32_t) pClient->robot && Frame_isNewer(sequence, pClient->telemetry_sequence) == TRUE)
+		{
+			pClient->telemetry_sequence = sequence;
+			pClient->telemetry = state;
+			nb_samples++;
+		}
+	}
+	return nb_samples;
+}
+
+uint64_t Client_toCommando(Client* pClient, uint64_t time)
+{
+	if(pClient->synchronized == FALSE || time == 0)
+	{
+		return 0;
+	}
+	return (uint64_t) ((int64_t) time + pClient->offset_ns);
+}
+
+long Client_getAge(Client* pClient, uint64_t sampled)
+{
+	int64_t age;
+	if(pClient->synchronized == FALSE || sampled == 0)
+	{
+		return -1;
+	}
+	age = (int64_t) (Client_toCommando(pClient, Trace_now()) - sampled);
+	//Within the error of the offset.
+	return (age < 0)? 0 : (long) (age / 1000);
+}
+
+int Client_keepAlive(Client* pClient)
+{
+	uint8_t buffer[FRAME_MAX_SIZE];
+	long silence;
+	long timeout = CLIENT_HEARTBEAT_MS;
+	long age;
+	long ping_ms;
+	if(pClient->connected == FALSE)
+	{
+		age = Client_getElapsed(&pClient->reconnect_at) / 1000;
+		if(age < 0)
+		{
+			return (int) -age;
+		}
+		Client_reconnect(pClient);
+		return (pClient->connected == TRUE)? 0 : (int) pClient->backoff_ms;
+	}
+	silence = Client_getSilence(pClient);
+	while(pClient->nb_pending > 0)
+	{
+		//The oldest request expires first.
+		age = Client_getElapsed(&pClient->pending[0].sent) / 1000;
+		if(age < CLIENT_REQUEST_TIMEOUT_MS)
+		{
+			timeout = CLIENT_REQUEST_TIMEOUT_MS - age;
+			break;
+		}
+		Client_complete(pClient, 0, CLIENT_TIMEOUT, NULL);
+	}
+	if(pClient->shm != NULL && Client_flushVelocity(pClient) == FALSE)
+	{
+		//Pushed again as soon as the commando has drained its ring.
+		timeout = 1;
+	}
+	//Faster until the offset is estimated on a full window after a connection.
+	ping_ms = (pClient->nb_clock_samples < CLIENT_CLOCK_SAMPLES)? CLIENT_HEARTBEAT_MS : CLIENT_PING_MS;
+	age = Client_getElapsed(&pClient->last_ping) / 1000;
+	if(age >= ping_ms)
+	{
+		Client_ping(pClient);
+		age = 0;
+	}
+	if(ping_ms - age < timeout)
+	{
+		timeout = ping_ms - age;
+	}
+	if(silence < CLIENT_HEARTBEAT_MS)
+	{
+		return (int) ((CLIENT_HEARTBEAT_MS - silence < timeout)? CLIENT_HEARTBEAT_MS - silence : timeout);
+	}
+	if(pClient->shm != NULL)
+	{
+		ShmMessage message = {.type = FRAME_HEARTBEAT, .robot = pClient->robot};
+		Client_push(pClient, &message);
+	}
+	else
+	{
+		Client_write(pClient, buffer, Frame_encodeHeartbeat(buffer, pClient->robot));
+	}
+	return (int) timeout;
+}
+
+bool_e Client_flush(Client* pClient)
+{
+	ssize_t quantite_envoyee;
+	if(pClient->connected == FALSE || pClient->shm != NULL)
+	{
+		return pClient->connected;
+	}
+	if(pClient->tx_len == 0)
+	{
+		return TRUE;
+	}
+	do
+	{
+		quantite_envoyee = send(pClient->un_socket, pClient->tx, pClient->tx_len, MSG_NOSIGNAL | MSG_DONTWAIT);
+	}while(quantite_envoyee == -1 && errno == EINTR);
+	if(quantite_envoyee == -1)
+	{
+		if(errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			return TRUE;
+		}
+		perror("ERROR : LOG_MSG_NOT_SENT");
+		Client_disconnect(pClient);
+		return FALSE;
+	}
+	memmove(pClient->tx, pClient->tx + quantite_envoyee, pClient->tx_len - quantite_envoyee);
+	pClient->tx_len -= quantite_envoyee;
+	return TRUE;
+}
+
+int Client_read(Client* pClient)
+{
+	Frame frame;
+	DecoderStatus status;
+	PilotState state;
+	DesDonnees donnees;
+	uint32_t robot;
+	uint64_t originate;
+	uint64_t receive;
+	uint64_t transmit;
+	int nb_telemetry = 0;
+	if(pClient->connected == FALSE)
+	{
+		return -1;
+	}
+	if(pClient->shm != NULL)
+	{
+		return Client_readShm(pClient);
+	}
+	if(Client_fill(pClient) == FALSE)
+	{
+		Client_disconnect(pClient);
+		return -1;
+	}
+	while((status = Decoder_next(&pClient->decoder, &frame)) == DECODER_FRAME)
+	{
+		if(Frame_decodeDonnees(&frame, &donnees) == TRUE)
+		{
+			Client_answer(pClient, &donnees);
+		}
+		else if((Frame_decodeTelemetry(&frame, &robot, &state) == TRUE
+				|| Frame_decodeTelemetryDelta(&frame, &robot, &state, &pClient->telemetry_codec) == TRUE)
+				&& robot == (uint32_t) pClient->robot)
+		{
+			pClient->telemetry = state;
+			nb_telemetry++;
+		}
+		else if(Frame_decodePing(&frame, &originate, &receive, &transmit) == TRUE)
+		{
+			Client_pong(pClient, originate, receive, transmit);
+		}
+	}
+	if(status == DECODER_ERROR)
+	{
+		printf("ERROR : corrupted stream from the commando\n");
+		Client_disconnect(pClient);
+		return -1;
+	}
+	return nb_telemetry;
 }
 /* ----------------------  PRIVATE FUNCTIONS  ------------------------------- */
+static bool_e Client_write(Client* pClient, const uint8_t* buffer, size_t size)
+{
+	ssize_t quantite_envoyee = 0;
+	if(pClient->tx_len == 0)
+	{
+		do
+		{
+			quantite_envoyee = send(pClient->un_socket, buffer, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+		}while(quantite_envoyee == -1 && errno == EINTR);
+		if(quantite_envoyee == -1)
+		{
+			if(errno != EAGAIN && errno != EWOULDBLOCK)
+			{
+				perror("ERROR : LOG_MSG_NOT_SENT");
+				Client_disconnect(pClient);
+				return FALSE;
+			}
+			quantite_envoyee = 0;
+		}
+	}
+	if(pClient->tx_len + size - quantite_envoyee > CLIENT_TX_SIZE)
+	{
+		//The socket buffer is full as well, the commando no longer reads.
+		printf("ERROR : LOG_MSG_NOT_SENT : the commando does not read its socket\n");
+		Client_disconnect(pClient);
+		return FALSE;
+	}
+	//After the bytes already waiting, the frames keep their order.
+	memcpy(pClient->tx + pClient->tx_len, buffer + quantite_envoyee, size - quantite_envoyee);
+	pClient->tx_len += size - quantite_envoyee;
+	clock_gettime(CLOCK_MONOTONIC, &pClient->last_sent);
+	return TRUE;
+}
+
+static bool_e Client_fill(Client* pClient)
+{
+	struct iovec iov[2];
+	struct msghdr message = {.msg_iov = iov};
+	ssize_t quantite_lue;
+	message.msg_iovlen = Decoder_getSpace(&pClient->decoder, iov);
+	do
+	{
+		quantite_lue = recvmsg(pClient->un_socket, &message, MSG_DONTWAIT);
+	}while(quantite_lue == -1 && errno == EINTR);
+	if(quantite_lue == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+	{
+		//Nothing yet, the UI is never blocked.
+		return TRUE;
+	}
+	if(quantite_lue <= 0)
+	{
+		return FALSE;
+	}
+	Decoder_commit(&pClient->decoder, quantite_lue);
+	return TRUE;
+}
+
+static bool_e Client_send(Client* pClient, const DesDonnees* pDonnees)
+{
+	uint8_t buffer[FRAME_MAX_SIZE];
+	if(pClient->connected == FALSE)
+	{
+		return FALSE;
+	}
+	if(pClient->shm != NULL)
+	{
+		ShmMessage message = {.type = FRAME_DONNEES, .robot = pClient->robot, .donnees = *pDonnees};
+		return Client_push(pClient, &message);
+	}
+	return Client_write(pClient, buffer, Frame_encodeDonnees(buffer, pDonnees));
+}
+
+static void Client_answer(Client* pClient, const DesDonnees* pDonnees)
+{
+	int index;
+	for(index = 0; index < pClient->nb_pending; index++)
+	{
+		if(pDonnees->request == 0 || pClient->pending[index].request == pDonnees->request)
+		{
+			Client_complete(pClient, index, CLIENT_ANSWERED, pDonnees);
+			return;
+		}
+	}
+	//Answer to a request already timed out.
+}
+
+static void Client_complete(Client* pClient, int index, ClientStatus status, const DesDonnees* pDonnees)
+{
+	ClientCompletion completion = {.request = pClient->pending[index].request, .status = status};
+	completion.latency_us = Client_getElapsed(&pClient->pending[index].sent);
+	if(pDonnees != NULL)
+	{
+		completion.donnees = *pDonnees;
+	}
+	pClient->nb_pending--;
+	memmove(&pClient->pending[index], &pClient->pending[index + 1], (pClient->nb_pending - index) * sizeof(ClientRequest));
+	//Cannot fail, nb_inflight bounds the completions not popped yet.
+	Ring_push(pClient->completions, &completion);
+}
+
+static bool_e Client_connectLocal(Client* pClient)
+{
+	struct sockaddr_un address;
+	socklen_t size = Shm_getAddress(&address);
+	pClient->un_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(pClient->un_socket == -1 || connect(pClient->un_socket, (struct sockaddr *)&address, size) == -1
+			|| (pClient->shm = Shm_receive(pClient->un_socket)) == NULL)
+	{
+		if(pClient->un_socket != -1)
+		{
+			close(pClient->un_socket);
+		}
+		return FALSE;
+	}
+	pClient->velocity_unsent = FALSE;
+	printf("LOG_CONNECTION : shared memory with the commando\n");
+	return TRUE;
+}
+
+static bool_e Client_push(Client* pClient, const ShmMessage* pMessage)
+{
+	struct timespec since;
+	if(pMessage->type == FRAME_DONNEES && pMessage->donnees.askLog == 0 && pMessage->donnees.stop == 0)
+	{
+		//Never waited for, the latest velocity wins and Client_keepAlive pushes it once the ring has room.
+		pClient->velocity = *pMessage;
+		pClient->velocity_unsent = TRUE;
+		Client_flushVelocity(pClient);
+		return TRUE;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &since);
+	//Behind the velocity left behind, the order of the commands is kept.
+	while(Client_flushVelocity(pClient) == FALSE || Shm_push(pClient->shm->commands, pClient->shm->to_commando, pMessage) == FALSE)
+	{
+		//Drained by the next loop of the commando, unless it is stuck.
+		if(Client_isAlive(pClient) == FALSE || Client_getElapsed(&since) / 1000 >= CLIENT_PUSH_TIMEOUT_MS)
+		{
+			Client_disconnect(pClient);
+			return FALSE;
+		}
+		poll(NULL, 0, 1);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &pClient->last_sent);
+	return TRUE;
+}
+
+static bool_e Client_flushVelocity(Client* pClient)
+{
+	if(pClient->velocity_unsent == TRUE && Shm_push(pClient->shm->commands, pClient->shm->to_commando, &pClient->velocity) == TRUE)
+	{
+		pClient->velocity_unsent = FALSE;
+		clock_gettime(CLOCK_MONOTONIC, &pClient->last_sent);
+	}
+	return (pClient->velocity_unsent == TRUE)? FALSE : TRUE;
+}
+
+static bool_e Client_isAlive(Client* pClient)
+{
+	uint8_t byte;
+	ssize_t result = recv(pClient->un_socket, &byte, sizeof(byte), MSG_DONTWAIT);
+	//Nothing is ever sent on it, it is readable only once the commando has closed it.
+	return (result == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))? TRUE : FALSE;
+}
+
+static int Client_readShm(Client* pClient)
+{
+	ShmMessage message;
+	bool_e received = FALSE;
+	int nb_telemetry = 0;
+	//Reset first, a message pushed meanwhile signals it again.
+	Shm_clear(pClient->shm->to_telco);
+	while(Ring_pop(pClient->shm->replies, &message) == TRUE)
+	{
+		received = TRUE;
+		if(message.type == FRAME_DONNEES)
+		{
+			Client_answer(pClient, &message.donnees);
+		}
+		else if(message.type == FRAME_TELEMETRY && message.robot == (uint32_t) pClient->robot)
+		{
+			pClient->telemetry = message.state;
+			nb_telemetry++;
+		}
+		else if(message.type == FRAME_PING)
+		{
+			Client_pong(pClient, message.ping[0], message.ping[1], message.ping[2]);
+		}
+	}
+	if(received == FALSE && Client_isAlive(pClient) == FALSE)
+	{
+		Client_disconnect(pClient);
+		return -1;
+	}
+	return nb_telemetry;
+}
+
+static long Client_getSilence(Client* pClient)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - pClient->last_sent.tv_sec) * 1000 + (now.tv_nsec - pClient->last_sent.tv_nsec) / 1000000;
+}
+
+static long Client_getElapsed(const struct timespec* pSince)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - pSince->tv_sec) * 1000000 + (now.tv_nsec - pSince->tv_nsec) / 1000;
+}
+
+static bool_e Client_resolve(const char* host, struct in_addr* pAddress)
+{
+	struct addrinfo hints = {.ai_family = AF_INET, .ai_socktype = SOCK_STREAM};
+	struct addrinfo* pResult;
+	int index;
+	for(index = 0; index < nb_addresses; index++)
+	{
+		if(strcmp(addresses[index].host, host) == 0)
+		{
+			*pAddress = addresses[index].address;
+			return TRUE;
+		}
+	}
+	if(getaddrinfo(host, NULL, &hints, &pResult) != 0 || pResult == NULL)
+	{
+		printf("ERROR : unknown host %s\n", host);
+		return FALSE;
+	}
+	*pAddress = ((struct sockaddr_in *) pResult->ai_addr)->sin_addr;
+	freeaddrinfo(pResult);
+	if(strlen(host) < CLIENT_HOST_SIZE)
+	{
+		index = (nb_addresses < CLIENT_ADDRESS_CACHE_SIZE)? nb_addresses++ : next_address++ % CLIENT_ADDRESS_CACHE_SIZE;
+		strcpy(addresses[index].host, host);
+		addresses[index].address = *pAddress;
+	}
+	return TRUE;
+}
+
+static void Client_forget(const char* host)
+{
+	int index;
+	for(index = 0; index < nb_addresses; index++)
+	{
+		if(strcmp(addresses[index].host, host) == 0)
+		{
+			addresses[index] = addresses[--nb_addresses];
+			return;
+		}
+	}
+}
+
+static bool_e Client_connect(Client* pClient)
+{
+	if(Client_resolve(pClient->ip, &pClient->adresse_du_serveur.sin_addr) == FALSE)
+	{
+		return FALSE;
+	}
+	//A commando on the loopback is on this host, the commands skip the network stack.
+	if((ntohl(pClient->adresse_du_serveur.sin_addr.s_addr) >> 24) != 127 || Client_connectLocal(pClient) == FALSE)
+	{
+		if(Client_connectTcp(pClient) == FALSE)
+		{
+			if(errno != ECONNREFUSED)
+			{
+				//No answer at all, the host may have moved.
+				Client_forget(pClient->ip);
+			}
+			return FALSE;
+		}
+	}
+	pClient->telemetry_fd = (pClient->shm != NULL)? pClient->shm->to_telco : pClient->un_socket;
+	pClient->tx_len = 0;
+	Decoder_init(&pClient->decoder);
+	pClient->connected = TRUE;
+	clock_gettime(CLOCK_MONOTONIC, &pClient->last_sent);
+	//The commando may have moved to another host, its clock is estimated again from the next call to Client_keepAlive.
+	pClient->nb_clock_samples = 0;
+	pClient->synchronized = FALSE;
+	pClient->last_ping.tv_sec = 0;
+	pClient->last_ping.tv_nsec = 0;
+	return TRUE;
+}
+
+static bool_e Client_connectTcp(Client* pClient)
+{
+	struct pollfd fd;
+	int error = 0;
+	socklen_t size = sizeof(error);
+	pClient->un_socket = socket(PF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(pClient->un_socket == -1)
+	{
+		return FALSE;
+	}
+	if(connect(pClient->un_socket, (struct sockaddr *)&pClient->adresse_du_serveur, sizeof(pClient->adresse_du_serveur)) == -1)
+	{
+		error = errno;
+		if(error == EINPROGRESS)
+		{
+			fd.fd = pClient->un_socket;
+			fd.events = POLLOUT;
+			error = ETIMEDOUT;
+			if(poll(&fd, 1, CLIENT_CONNECT_TIMEOUT_MS) == 1)
+			{
+				getsockopt(pClient->un_socket, SOL_SOCKET, SO_ERROR, &error, &size);
+			}
+		}
+	}
+	if(error != 0)
+	{
+		close(pClient->un_socket);
+		pClient->un_socket = -1;
+		errno = error;
+		return FALSE;
+	}
+	//Left non-blocking : a commando which stops reading never freezes the UI in Client_write.
+	return TRUE;
+}
+
+static void Client_close(Client* pClient)
+{
+	if(pClient->shm != NULL)
+	{
+		Shm_free(pClient->shm);
+		pClient->shm = NULL;
+	}
+	if(pClient->un_socket != -1)
+	{
+		close(pClient->un_socket);
+		pClient->un_socket = -1;
+	}
+	pClient->telemetry_fd = -1;
+}
+
+static void Client_disconnect(Client* pClient)
+{
+	if(pClient->connected == FALSE)
+	{
+		return;
+	}
+	printf("ERROR : connection with the commando lost, reconnecting\n");
+	Client_close(pClient);
+	pClient->connected = FALSE;
+	while(pClient->nb_pending > 0)
+	{
+		Client_complete(pClient, 0, CLIENT_LOST, NULL);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &pClient->lost);
+	pClient->reconnect_at = pClient->lost;
+	pClient->backoff_ms = CLIENT_RECONNECT_MIN_MS;
+}
+
+static void Client_reconnect(Client* pClient)
+{
+	DesDonnees donnees = pClient->donnees;
+	if(Client_connect(pClient) == FALSE)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &pClient->reconnect_at);
+		pClient->reconnect_at.tv_sec += pClient->backoff_ms / 1000;
+		pClient->reconnect_at.tv_nsec += (pClient->backoff_ms % 1000) * 1000000;
+		if(pClient->reconnect_at.tv_nsec >= 1000000000)
+		{
+			pClient->reconnect_at.tv_sec++;
+			pClient->reconnect_at.tv_nsec -= 1000000000;
+		}
+		pClient->backoff_ms = (2 * pClient->backoff_ms < CLIENT_RECONNECT_MAX_MS)? 2 * pClient->backoff_ms : CLIENT_RECONNECT_MAX_MS;
+		return;
+	}
+	if(pClient->shm != NULL && pClient->datagram == TRUE)
+	{
+		//Now on this host, the shared memory replaces the UDP channel.
+		pClient->datagram = FALSE;
+	}
+	if(pClient->subscription_ms != 0 || pClient->datagram == TRUE)
+	{
+		Client_subscribe(pClient, pClient->subscription_ms);
+	}
+	//The watchdog of the commando has stopped the robot meanwhile, it goes on as it was driven.
+	donnees.robot = pClient->robot;
+	donnees.askLog = 0;
+	donnees.stop = 0;
+	donnees.request = 0;
+	donnees.captured = 0;
+	if(Client_send(pClient, &donnees) == TRUE)
+	{
+		pClient->nb_reconnections++;
+		printf("LOG_RECONNECTION : control restored %ld ms after the loss\n", Client_getElapsed(&pClient->lost) / 1000);
+	}
+}
+
+static void Client_ping(Client* pClient)
+{
+	uint8_t buffer[FRAME_MAX_SIZE];
+	struct timespec last_sent = pClient->last_sent;
+	clock_gettime(CLOCK_MONOTONIC, &pClient->last_ping);
+	if(pClient->shm != NULL)
+	{
+		ShmMessage message = {.type = FRAME_PING, .robot = pClient->robot, .ping = {Trace_now(), 0, 0}};
+		Client_push(pClient, &message);
+	}
+	else
+	{
+		Client_write(pClient, buffer, Frame_encodePing(buffer, Trace_now(), 0, 0));
+	}
+	//A ping does not feed the watchdog of the robot, the heartbeats go on.
+	pClient->last_sent = last_sent;
+}
+
+static void Client_pong(Client* pClient, uint64_t originate, uint64_t receive, uint64_t transmit)
+{
+	uint64_t now = Trace_now();
+	ClientClockSample sample;
+	int nb_samples;
+	int best = 0;
+	if(receive == 0 || transmit < receive || now < originate)
+	{
+		//Not stamped by the commando.
+		return;
+	}
+	//Each clock measures its own interval, the offset is exact if both ways take as long.
+	sample.rtt_ns = (int64_t) (now - originate) - (int64_t) (transmit - receive);
+	sample.offset_ns = ((int64_t) (receive - originate) + (int64_t) (transmit - now)) / 2;
+	pClient->clock_samples[pClient->nb_clock_samples % CLIENT_CLOCK_SAMPLES] = sample;
+	pClient->nb_clock_samples++;
+	nb_samples = (pClient->nb_clock_samples < CLIENT_CLOCK_SAMPLES)? pClient->nb_clock_samples : CLIENT_CLOCK_SAMPLES;
+	for(int i = 1; i < nb_samples; i++)
+	{
+		if(pClient->clock_samples[i].rtt_ns < pClient->clock_samples[best].rtt_ns)
+		{
+			best = i;
+		}
+	}
+	if(pClient->synchronized == FALSE)
+	{
+		printf("LOG_CLOCK : offset of the commando %lld us, round trip %lld us\n",
+				(long long) sample.offset_ns / 1000, (long long) sample.rtt_ns / 1000);
+	}
+	pClient->offset_ns = pClient->clock_samples[best].offset_ns;
+	pClient->rtt_ns = pClient->clock_samples[best].rtt_ns;
+	pClient->synchronized = TRUE;
+}
@@ -35,20 +35,138 @@
 #define SRC_TELCO_CLIENT_H_
 #include "../commun.h"
 /* ----------------------  INCLUDES ------------------------------------------*/
+#include "../commun/frame.h"
+#include "../commun/shm.h"
+#include "../commun/ring.h"
+#include "../commun/trace.h"
+#include <time.h>
 /* ----------------------  PUBLIC TYPE DEFINITIONS ---------------------------*/
+/**
+ * \brief Longest silence towards the commando, well below its watchdog deadline.
+ */
+#define CLIENT_HEARTBEAT_MS (100)
+/**
+ * \brief Number of state requests that can wait for their answer at once.
+ */
+#define CLIENT_MAX_PENDING (16)
+/**
+ * \brief Time after which a state request not answered is completed with CLIENT_TIMEOUT.
+ */
+#define CLIENT_REQUEST_TIMEOUT_MS (1000)
+/**
+ * \brief Longest wait for a TCP connection, instead of the timeout of the kernel.
+ */
+#define CLIENT_CONNECT_TIMEOUT_MS (250)
+/**
+ * \brief Bytes kept for a TCP socket whose buffer is full, a commando which lets more pile up is lost.
+ */
+#define CLIENT_TX_SIZE (8 * FRAME_MAX_SIZE)
+/**
+ * \brief Longest wait for room in the ring of a shared memory, a commando which does not drain it is lost.
+ */
+#define CLIENT_PUSH_TIMEOUT_MS (250)
+/**
+ * \brief Delays between two attempts to reconnect, doubled from the min up to the max.
+ *
+ * The first attempt is immediate. The max bounds the time to control once the commando is back.
+ */
+#define CLIENT_RECONNECT_MIN_MS (10)
+#define CLIENT_RECONNECT_MAX_MS (250)
+/**
+ * \brief Period of the pings estimating the offset of the clock of the commando, shortened to
+ *        CLIENT_HEARTBEAT_MS until CLIENT_CLOCK_SAMPLES have been received after a connection.
+ */
+#define CLIENT_PING_MS (1000)
+/**
+ * \brief Round trips kept to estimate the offset, the one of the shortest is used as in the clock
+ *        filter of NTP : the less a ping has been queued, the less its offset is biased.
+ */
+#define CLIENT_CLOCK_SAMPLES (8)
 /**
  * \struct Client
  * \brief Client object.
  */
 typedef struct Client_t Client;
 /* ----------------------  PUBLIC ENUMERATIONS -------------------------------*/
+/**
+ * \enum ClientStatus
+ * \brief How a state request has been completed.
+ */
+typedef enum
+{
+	CLIENT_ANSWERED = 0,
+	CLIENT_TIMEOUT,
+	CLIENT_LOST //the connection was lost before the answer.
+}ClientStatus;
 /* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
+/**
+ * \struct ClientCompletion
+ * \brief Completion of a state request, popped by Client_getCompletion.
+ */
+typedef struct
+{
+	uint32_t request; //id returned by Client_ask.
+	ClientStatus status;
+	DesDonnees donnees; //answer of the commando when CLIENT_ANSWERED.
+	long latency_us; //time between the request and its completion.
+}ClientCompletion;
+/**
+ * \struct ClientRequest
+ * \brief State request sent and waiting for its answer.
+ */
+typedef struct
+{
+	uint32_t request;
+	struct timespec sent;
+}ClientRequest;
+/**
+ * \struct ClientClockSample
+ * \brief Offset of the clock of the commando measured by a ping, and the round trip of that ping.
+ */
+typedef struct
+{
+	int64_t offset_ns; //clock of the commando minus clock of the telco.
+	int64_t rtt_ns; //round trip without the time spent in the commando.
+}ClientClockSample;
 struct Client_t
 {
 	const char * ip;
-	int un_socket;
+	int robot; //robot of the fleet driven by this telco, 0 when the commando drives only one.
+	int un_socket; //TCP socket (non-blocking), or unix socket when the commando is on this host.
+	uint8_t tx[CLIENT_TX_SIZE]; //bytes the TCP socket could not take yet, written by Client_flush.
+	size_t tx_len;
+	Shm* shm; //rings shared with a commando of this host, NULL over TCP.
+	ShmMessage velocity; //latest velocity the full ring of shm has not taken yet.
+	bool_e velocity_unsent;
+	int telemetry_fd; //readable when the commando pushed something (un_socket or the eventfd of shm).
+	int socket_datagramme; //UDP socket, -1 until the datagram channel is used.
+	bool_e datagram; //TRUE to send the velocity commands and receive the telemetry over UDP.
+	uint32_t sequence; //sequence number of the last velocity datagram sent.
+	uint32_t telemetry_sequence; //sequence number of the last telemetry datagram received.
+	bool_e telemetry_delta; //TRUE to ask for the telemetry as FRAME_TELEMETRY_DELTA over TCP.
+	TelemetryCodec telemetry_codec;
 	struct sockaddr_in adresse_du_serveur;
 	DesDonnees donnees;
+	PilotState telemetry; //last telemetry pushed by the commando.
+	Decoder decoder; //reassembles the frames received from the commando.
+	struct timespec last_sent; //time of the last message to the commando.
+	uint32_t nb_requests; //id of the last state request.
+	ClientRequest pending[CLIENT_MAX_PENDING]; //state requests waiting for their answer, oldest first.
+	int nb_pending;
+	int nb_inflight; //pending requests plus completions not popped yet, never above CLIENT_MAX_PENDING.
+	Ring* completions; //ClientCompletion of the state requests.
+	bool_e connected; //FALSE while waiting to reconnect, Client_keepAlive reconnects.
+	unsigned int subscription_ms; //period of the telemetry subscribed, subscribed again on a reconnection.
+	long backoff_ms; //delay before the next attempt to reconnect.
+	struct timespec reconnect_at; //time of the next attempt to reconnect.
+	struct timespec lost; //time the connection was lost.
+	int nb_reconnections;
+	ClientClockSample clock_samples[CLIENT_CLOCK_SAMPLES]; //last round trips, the oldest is replaced.
+	int nb_clock_samples; //since the connection, the samples of a previous commando are forgotten.
+	bool_e synchronized; //TRUE once a ping has come back, offset_ns and rtt_ns are valid.
+	int64_t offset_ns; //clock of the commando minus clock of the telco (CLOCK_MONOTONIC).
+	int64_t rtt_ns; //round trip of the sample offset_ns comes from.
+	struct timespec last_ping; //time of the last ping sent.
 };
 /* ----------------------  PUBLIC VARIBLES -----------------------------------*/
 /* ----------------------  PUBLIC FUNCTIONS PROTOTYPES  ----------------------*/
@@ -63,10 +181,13 @@ extern Client* Client_new();
  */
 extern void Client_free(Client* pClient);
 /**
- * \fn
- * \brief
+ * \fn extern bool_e Client_start(Client* pClient)
+ * \brief Connect to the commando at ip, within CLIENT_CONNECT_TIMEOUT_MS.
+ *        The address resolved is cached for the reconnections.
+ *
+ * \return bool_e : FALSE if the commando is not reachable yet, Client_keepAlive keeps trying.
  */
-extern void Client_start(Client* pClient);
+extern bool_e Client_start(Client* pClient);
 /**
  * \fn
  * \brief
@@ -78,8 +199,98 @@ extern void Client_stop(Client* pClient);
  */
 extern void Client_sendMsg(Client* pClient);
 /**
- * \fn
- * \brief
+ * \fn extern uint32_t Client_ask(Client* pClient)
+ * \brief Send a state request without waiting for its answer, several can be in flight at once.
+ *        Its completion is popped later with Client_getCompletion.
+ *
+ * \return uint32_t : id of the request, 0 if CLIENT_MAX_PENDING requests are already in flight.
+ */
+extern uint32_t Client_ask(Client* pClient);
+/**
+ * \fn extern bool_e Client_getCompletion(Client* pClient, ClientCompletion* pCompletion)
+ * \brief Pop the completion of a state request (answered or timed out).
+ *
+ * \return bool_e : FALSE if there is none.
+ */
+extern bool_e Client_getCompletion(Client* pClient, ClientCompletion* pCompletion);
+/**
+ * \fn extern void Client_subscribe(Client* pClient, unsigned int period_ms)
+ * \brief Ask the commando to push its telemetry every period_ms (0 to stop).
+ */
+extern void Client_subscribe(Client* pClient, unsigned int period_ms);
+/**
+ * \fn extern bool_e Client_sendTrajectory(Client* pClient, const TrajectorySegment* pSegments, int nb_segments, TrajectoryFlag flag)
+ * \brief Upload timed segments the commando executes on its own clock, in several frames if needed.
+ *        With TRAJECTORY_APPEND they are streamed after the segments already uploaded, otherwise
+ *        they replace them; a velocity sent afterwards cancels the trajectory.
+ *
+ * \param const TrajectorySegment* pSegments : offsets in ms from the start of the trajectory, not decreasing.
+ * \return bool_e : FALSE if the connection is lost.
+ */
+extern bool_e Client_sendTrajectory(Client* pClient, const TrajectorySegment* pSegments, int nb_segments, TrajectoryFlag flag);
+/**
+ * \fn extern bool_e Client_cancelTrajectory(Client* pClient)
+ * \brief Cancel the trajectory of the robot and stop it.
+ *
+ * \return bool_e : FALSE if the connection is lost.
+ */
+extern bool_e Client_cancelTrajectory(Client* pClient);
+/**
+ * \fn extern int Client_keepAlive(Client* pClient)
+ * \brief Send a heartbeat if nothing has been sent for CLIENT_HEARTBEAT_MS, so that the watchdog
+ *        of the commando does not stop an idle robot, and time out the state requests not answered.
+ *        Once the connection is lost, reconnect with a backoff and restore the session
+ *        (last velocity, telemetry subscribed).
+ *
+ * \return int : time in ms before the next call is needed, to use as a poll timeout.
+ */
+extern int Client_keepAlive(Client* pClient);
+/**
+ * \fn extern bool_e Client_flush(Client* pClient)
+ * \brief Write the bytes the TCP socket could not take, to be called when un_socket is writable
+ *        (poll it for POLLOUT while tx_len is not 0).
+ *
+ * \return bool_e : FALSE if the connection is lost (the sockets are closed and Client_keepAlive reconnects).
+ */
+extern bool_e Client_flush(Client* pClient);
+/**
+ * \fn extern int Client_read(Client* pClient)
+ * \brief Read what the commando sent without blocking, to be called when telemetry_fd (or un_socket) is readable.
+ *        The answers to the state requests are queued for Client_getCompletion.
+ *
+ * \return int : number of telemetry samples received (the latest is in telemetry), -1 if the connection is lost
+ *               (the sockets are closed and Client_keepAlive reconnects).
+ */
+extern int Client_read(Client* pClient);
+/**
+ * \fn extern bool_e Client_setDatagram(Client* pClient, bool_e enabled)
+ * \brief Use (or not) the UDP channel for the velocity commands and the telemetry.
+ *        The stop and the state requests always go through TCP, and the UDP socket is bound to the
+ *        TCP session by a subscription (with the current period) : the commando refuses any other source.
+ *
+ * \return bool_e : FALSE if the UDP channel could not be opened, or is useless with a shared memory.
+ */
+extern bool_e Client_setDatagram(Client* pClient, bool_e enabled);
+/**
+ * \fn extern int Client_readDatagram(Client* pClient)
+ * \brief Read the telemetry datagrams, to be called when socket_datagramme is readable.
+ *        The datagrams older than the last one received are dropped.
+ *
+ * \return int : number of newer telemetry samples received (the latest is in telemetry).
+ */
+extern int Client_readDatagram(Client* pClient);
+/**
+ * \fn extern uint64_t Client_toCommando(Client* pClient, uint64_t time)
+ * \brief Convert a Trace_now of the telco into the timebase of the commando.
+ *
+ * \return uint64_t : 0 until the clocks are synchronized.
+ */
+extern uint64_t Client_toCommando(Client* pClient, uint64_t time);
+/**
+ * \fn extern long Client_getAge(Client* pClient, uint64_t sampled)
+ * \brief Age of a sample stamped by the commando (PilotState.sampled), as seen now by the telco.
+ *
+ * \return long : age in us, -1 if the clocks are not synchronized or the sample is not stamped.
  */
-extern void Client_readMsg(Client* pClient);
+extern long Client_getAge(Client* pClient, uint64_t sampled);
 #endif /* SRC_TELCO_CLIENT_H_ */
@@ -37,16 +37,38 @@
 #include <stdlib.h>
 #include <termios.h>
 #include <unistd.h>
+#include <poll.h>
 /* ----------------------  PRIVATE CONFIGURATIONS  -------------------------- */
+/**
+ * \brief Period of the telemetry pushed by the commando once subscribed.
+ */
+#define TELEMETRY_PERIOD_MS (100)
+/**
+ * \brief Linear and angular velocity of the curves of LOG_CURVE_LEFT and LOG_CURVE_RIGHT (TWIST, in %).
+ */
+#define CURVE_LINEAR (100)
+#define CURVE_ANGULAR (50)
 /* ----------------------  PRIVATE TYPE DEFINITIONS  ------------------------ */
 struct RemoteUI_t
 {
 	Client* client;
+	bool_e subscribed; //TRUE when the commando pushes its telemetry.
+	bool_e running; //Used to get out or stay into the while loop.
 };
 /* ----------------------  PRIVATE STRUCTURES  ------------------------------ */
 /* ----------------------  PRIVATE ENUMERATIONS  ---------------------------- */
 /* ----------------------  PRIVATE VARIABLES  ------------------------------- */
-bool_e quit_case = TRUE; //Used to get out or stay into the while loop.
+/**
+ * \brief Trajectory uploaded by LOG_TRAJECTORY : a square, driven by the commando on its own clock.
+ */
+static const TrajectorySegment square[] =
+{
+	{0, {FORWARD, 100}}, {1000, {RIGHT, 100}},
+	{1500, {FORWARD, 100}}, {2500, {RIGHT, 100}},
+	{3000, {FORWARD, 100}}, {4000, {RIGHT, 100}},
+	{4500, {FORWARD, 100}}, {5500, {RIGHT, 100}},
+	{6000, {STOP, 0}}
+};
 /* ----------------------  PRIVATE FUNCTIONS PROTOTYPES  -------------------- */
 /**
  * \fn static void RemoteUI_captureChoice(RemoteUI* pRemoteUI)
@@ -69,11 +91,43 @@ static void RemoteUI_askMVt(RemoteUI* pRemoteUI,Direction dir);
  * \return VelocityVector: translate to a VelocityVector with a speed and a direction.
  */
 static VelocityVector RemoteUI_translate(Direction dir);
+/**
+ * \fn static void RemoteUI_askTwist(RemoteUI* pRemoteUI, int linear, int angular)
+ * \brief Ask the pilot to drive along a curve, with a linear and an angular velocity.
+ *
+ * \param int angular : positive to the left, as LEFT.
+ */
+static void RemoteUI_askTwist(RemoteUI* pRemoteUI, int linear, int angular);
 /**
  * \fn static void RemoteUI_ask4Log()
  * \brief Gets the states and values of the sensors from the Pilot to be printed.
  */
 static void RemoteUI_ask4Log();
+/**
+ * \fn static void RemoteUI_printAnswers(RemoteUI* pRemoteUI)
+ * \brief Print the completions of the state requests sent by RemoteUI_ask4Log.
+ */
+static void RemoteUI_printAnswers(RemoteUI* pRemoteUI);
+/**
+ * \fn static void RemoteUI_toggleTelemetry(RemoteUI* pRemoteUI)
+ * \brief Subscribe to (or unsubscribe from) the telemetry pushed by the commando.
+ */
+static void RemoteUI_toggleTelemetry(RemoteUI* pRemoteUI);
+/**
+ * \fn static void RemoteUI_printTelemetry(RemoteUI* pRemoteUI)
+ * \brief Print the last telemetry pushed by the commando on a single line, with the pose and the age of the sample.
+ */
+static void RemoteUI_printTelemetry(RemoteUI* pRemoteUI);
+/**
+ * \fn static void RemoteUI_toggleDatagram(RemoteUI* pRemoteUI)
+ * \brief Send the velocity commands and receive the telemetry over UDP (or back over TCP).
+ */
+static void RemoteUI_toggleDatagram(RemoteUI* pRemoteUI);
+/**
+ * \fn static void RemoteUI_askTrajectory(RemoteUI* pRemoteUI)
+ * \brief Upload the square trajectory, it replaces the one the robot may be driving.
+ */
+static void RemoteUI_askTrajectory(RemoteUI* pRemoteUI);
 /**
  * \fn static void RemoteUI_askClearLog()
  * \brief Ask the user if he really wants to clear the logs.
@@ -107,15 +161,18 @@ static void RemoteUI_display(RemoteUI* pRemoteUI);
  */
 static void RemoteUI_setIP(RemoteUI* pRemoteUI, const char * ip);
 /* ----------------------  PUBLIC FUNCTIONS  -------------------------------- */
-RemoteUI* RemoteUI_new()
+RemoteUI* RemoteUI_new(int robot)
 {
 	RemoteUI* pRemoteUI = (RemoteUI*) malloc(sizeof(RemoteUI));
-	pRemoteUI->client = Client_new();
 	if(pRemoteUI == NULL)
 	{
 		printf("ERROR : pAdminUI i NULL \n");
 		while(1);
 	}
+	pRemoteUI->client = Client_new();
+	pRemoteUI->client->robot = robot;
+	pRemoteUI->subscribed = FALSE;
+	pRemoteUI->running = TRUE;
 	return pRemoteUI;
 }
 void RemoteUI_start(RemoteUI* pRemoteUI)
@@ -126,7 +183,7 @@ void RemoteUI_start(RemoteUI* pRemoteUI)
 }
 static void RemoteUI_run(RemoteUI* pRemoteUI)
 {
-	while (quit_case)
+	while (pRemoteUI->running)
 	{
 		RemoteUI_display(pRemoteUI);
 	}
@@ -149,7 +206,54 @@ static void RemoteUI_captureChoice(RemoteUI* pRemoteUI)
 	newt = oldt;
 	newt.c_lflag &= ~(ICANON | ECHO);
 	tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-	log_key_e command = getchar();
+	char key = 0;
+	int timeout;
+	while(key == 0)
+	{
+		//The heartbeats keep the watchdog of the commando fed while no key is pressed,
+		//and a lost connection is restored from there.
+		timeout = Client_keepAlive(pRemoteUI->client);
+		//The telemetry pushed by the commando is printed while waiting for the key.
+		//With a shared memory, the socket only tells when the commando is gone.
+		//Set at each turn, the sockets change on a reconnection.
+		struct pollfd fds[4] = {{STDIN_FILENO, POLLIN, 0},
+				{pRemoteUI->client->telemetry_fd, POLLIN | ((pRemoteUI->client->tx_len > 0)? POLLOUT : 0), 0},
+				{pRemoteUI->client->socket_datagramme, POLLIN, 0},
+				{(pRemoteUI->client->shm != NULL)? pRemoteUI->client->un_socket : -1, POLLIN, 0}};
+		if(poll(fds, 4, timeout) < 0)
+		{
+			break;
+		}
+		if(fds[2].revents != 0 && Client_readDatagram(pRemoteUI->client) > 0)
+		{
+			RemoteUI_printTelemetry(pRemoteUI);
+		}
+		if((fds[1].revents & POLLOUT) && Client_flush(pRemoteUI->client) == FALSE)
+		{
+			//Restored by Client_keepAlive.
+			fds[1].revents = 0;
+		}
+		if((fds[1].revents & ~POLLOUT) != 0 || fds[3].revents != 0)
+		{
+			//A lost connection (-1) is restored by Client_keepAlive.
+			if(Client_read(pRemoteUI->client) > 0)
+			{
+				RemoteUI_printTelemetry(pRemoteUI);
+			}
+		}
+		//Answered or timed out (in Client_keepAlive) state requests.
+		RemoteUI_printAnswers(pRemoteUI);
+		if((fds[0].revents & POLLIN) && read(STDIN_FILENO, &key, 1) != 1)
+		{
+			key = 0;
+		}
+	}
+	if(Trace_isEnabled() == TRUE)
+	{
+		//Start of the path traced to the motors, carried by the velocity sent for this key.
+		pRemoteUI->client->donnees.captured = Trace_now();
+	}
+	log_key_e command = key;
 	tcsetattr(STDIN_FILENO,TCSANOW, &oldt);
 
 	switch(command)
@@ -166,6 +270,12 @@ static void RemoteUI_captureChoice(RemoteUI* pRemoteUI)
 		case LOG_FORWARD:
 			RemoteUI_askMVt(pRemoteUI,FORWARD);
 			break;
+		case LOG_CURVE_LEFT:
+			RemoteUI_askTwist(pRemoteUI, CURVE_LINEAR, CURVE_ANGULAR);
+			break;
+		case LOG_CURVE_RIGHT:
+			RemoteUI_askTwist(pRemoteUI, CURVE_LINEAR, -CURVE_ANGULAR);
+			break;
 		case LOG_CLEAR:
 			RemoteUI_askClearLog();
 			break;
@@ -175,6 +285,18 @@ static void RemoteUI_captureChoice(RemoteUI* pRemoteUI)
 		case LOG_ROBOT_STATE:
 			RemoteUI_ask4Log(pRemoteUI);
 			break;
+		case LOG_TELEMETRY:
+			RemoteUI_toggleTelemetry(pRemoteUI);
+			break;
+		case LOG_DATAGRAM:
+			RemoteUI_toggleDatagram(pRemoteUI);
+			break;
+		case LOG_TRAJECTORY:
+			RemoteUI_askTrajectory(pRemoteUI);
+			break;
+		case LOG_CANCEL:
+			Client_cancelTrajectory(pRemoteUI->client);
+			break;
 		case LOG_QUIT:
 			RemoteUI_quit(pRemoteUI);
 			break;
@@ -188,6 +310,15 @@ static void RemoteUI_askMVt(RemoteUI* pRemoteUI,Direction dir)
 	VelocityVector vel = RemoteUI_translate(dir);
 	pRemoteUI->client->donnees.direction = vel.dir;
 	pRemoteUI->client->donnees.power = vel.power;
+	pRemoteUI->client->donnees.angular = 0;
+	Client_sendMsg(pRemoteUI->client);
+}
+
+static void RemoteUI_askTwist(RemoteUI* pRemoteUI, int linear, int angular)
+{
+	pRemoteUI->client->donnees.direction = TWIST;
+	pRemoteUI->client->donnees.power = linear;
+	pRemoteUI->client->donnees.angular = angular;
 	Client_sendMsg(pRemoteUI->client);
 }
 
@@ -201,15 +332,65 @@ static VelocityVector RemoteUI_translate(Direction dir)
 
 static void RemoteUI_ask4Log(RemoteUI* pRemoteUI)
 {
-	pRemoteUI->client->donnees.askLog = 1;
-	Client_sendMsg(pRemoteUI->client);
-	Client_readMsg(pRemoteUI->client);
-	printf("\n Collision; %d", pRemoteUI->client->donnees.bump);
-	printf("\n Luminosity: %f", pRemoteUI->client->donnees.luminosity);
-	printf("\n Speed: %d:\n", pRemoteUI->client->donnees.power);
+	//The answer is printed by RemoteUI_printAnswers, the keyboard is not blocked meanwhile.
+	if(Client_ask(pRemoteUI->client) == 0)
+	{
+		printf("\n Request not sent (too many in flight or reconnecting)\n");
+	}
+}
+
+static void RemoteUI_printAnswers(RemoteUI* pRemoteUI)
+{
+	ClientCompletion completion;
+	while(Client_getCompletion(pRemoteUI->client, &completion) == TRUE)
+	{
+		if(completion.status != CLIENT_ANSWERED)
+		{
+			printf("\n Request %u: %s\n", completion.request, (completion.status == CLIENT_LOST)? "connection lost" : "no answer");
+			continue;
+		}
+		printf("\n Request %u (%ld us)", completion.request, completion.latency_us);
+		printf("\n Collision; %d", completion.donnees.bump);
+		printf("\n Luminosity: %f", completion.donnees.luminosity);
+		printf("\n Speed: %d:", completion.donnees.power);
+		printf("\n Sample age: %ld us\n", Client_getAge(pRemoteUI->client, completion.donnees.sampled));
+	}
 }
 
 
+static void RemoteUI_toggleTelemetry(RemoteUI* pRemoteUI)
+{
+	pRemoteUI->subscribed = (pRemoteUI->subscribed == TRUE)? FALSE : TRUE;
+	Client_subscribe(pRemoteUI->client, (pRemoteUI->subscribed == TRUE)? TELEMETRY_PERIOD_MS : 0);
+}
+
+static void RemoteUI_askTrajectory(RemoteUI* pRemoteUI)
+{
+	if(Client_sendTrajectory(pRemoteUI->client, square, sizeof(square) / sizeof(square[0]), TRAJECTORY_REPLACE) == TRUE)
+	{
+		printf("Trajectoire envoyée (%d segments)\n", (int) (sizeof(square) / sizeof(square[0])));
+	}
+}
+
+static void RemoteUI_toggleDatagram(RemoteUI* pRemoteUI)
+{
+	bool_e enabled = (pRemoteUI->client->datagram == TRUE)? FALSE : TRUE;
+	if(Client_setDatagram(pRemoteUI->client, enabled) == TRUE)
+	{
+		printf("Canal UDP %s\n", (enabled == TRUE)? "activé" : "désactivé");
+	}
+}
+
+static void RemoteUI_printTelemetry(RemoteUI* pRemoteUI)
+{
+	//-1 until the clock of the commando is estimated.
+	long age_us = Client_getAge(pRemoteUI->client, pRemoteUI->client->telemetry.sampled);
+	printf("\r Collision: %d Luminosity: %f Speed: %d Pose: %.0f %.0f mm %.2f rad Age: %ld us   ",
+			pRemoteUI->client->telemetry.collision, pRemoteUI->client->telemetry.luminosity, pRemoteUI->client->telemetry.speed,
+			pRemoteUI->client->telemetry.x, pRemoteUI->client->telemetry.y, pRemoteUI->client->telemetry.heading, age_us);
+	fflush(stdout);
+}
+
 static void RemoteUI_askClearLog()
 {
 	RemoteUI_eraseLog();
@@ -222,22 +403,28 @@ static void RemoteUI_eraseLog()
 
 static void RemoteUI_quit(RemoteUI* pRemoteUI)
 {
-	quit_case = FALSE;
+	pRemoteUI->running = FALSE;
 	pRemoteUI->client->donnees.stop = 1;
 	Client_sendMsg(pRemoteUI->client);
 }
 
 static void RemoteUI_display(RemoteUI* pRemoteUI)
 {
-	printf("Robot V2\n");
+	printf("Robot V2 (robot %d)\n", pRemoteUI->client->robot);
 	printf("Vous pouvez faire les actions suivantes :\n");
 	printf("q:aller à gauche\n");
 	printf("d:aller à droite\n");
 	printf("z:avancer\n");
 	printf("s:reculer\n");
+	printf("w:tourner à gauche en avançant\n");
+	printf("x:tourner à droite en avançant\n");
 	printf(" :stopper\n");
 	printf("e:effacer les logs\n");
 	printf("r:afficher l'état du robot\n");
+	printf("t:activer/désactiver la télémétrie\n");
+	printf("u:activer/désactiver le canal UDP\n");
+	printf("p:parcourir un carré\n");
+	printf("c:annuler la trajectoire\n");
 	printf("a:quitter\n");
 	RemoteUI_captureChoice(pRemoteUI);
 }
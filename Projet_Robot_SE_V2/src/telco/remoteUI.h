@@ -50,9 +50,15 @@ typedef enum
 	LOG_RIGHT = 'd',      /**< LOG_RIGHT */
 	LOG_FORWARD = 'z',    /**< LOG_FORWARD */
 	LOG_BACKWARD = 's',   /**< LOG_BACKWARD */
+	LOG_CURVE_LEFT = 'w', /**< LOG_CURVE_LEFT */
+	LOG_CURVE_RIGHT = 'x',/**< LOG_CURVE_RIGHT */
 	LOG_STOP = ' ',       /**< LOG_STOP */
 	LOG_CLEAR = 'e',      /**< LOG_CLEAR */
 	LOG_ROBOT_STATE = 'r',/**< LOG_ROBOT_STATE */
+	LOG_TELEMETRY = 't',  /**< LOG_TELEMETRY */
+	LOG_DATAGRAM = 'u',   /**< LOG_DATAGRAM */
+	LOG_TRAJECTORY = 'p', /**< LOG_TRAJECTORY */
+	LOG_CANCEL = 'c',     /**< LOG_CANCEL */
 	LOG_QUIT = 'a'        /**< LOG_QUIT */
 }log_key_e;
 /* ----------------------  PUBLIC STRUCTURES ---------------------------------*/
@@ -71,10 +77,12 @@ extern void RemoteUI_start(RemoteUI* pRemoteUI);
 extern void RemoteUI_stop(RemoteUI* pRemoteUI);
 
 /**
- * \fn extern RemoteUI* RemoteUI_new()
+ * \fn extern RemoteUI* RemoteUI_new(int robot)
  * \brief Initialize in memory RemoteUI.
+ *
+ * \param int robot : robot of the fleet to drive, 0 when the commando drives only one.
  */
-extern RemoteUI* RemoteUI_new();
+extern RemoteUI* RemoteUI_new(int robot);
 
 /**
  * \fn extern void RemoteUI_free(RemoteUI* pRemoteUI)